@@ -0,0 +1,151 @@
+/** Microbenchmark of the cost of debug logging in a sampling tick.
+ *
+ * Every tick scales the counters of a set of processes (as event::scale()
+ * does) and logs every sample. The tick is measured with the log statement
+ * compiled out, written to the asynchronous binary log, and written through
+ * Boost.Log (both filtered out at runtime and formatted into a sink).
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#define BOOST_LOG_DYN_LINK 1
+
+#include <boost/format.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/program_options.hpp>
+#include <boost/smart_ptr/make_shared_object.hpp>
+
+#include <util/async_log.h>
+#include <util/log.h>
+
+namespace logging = boost::log;
+namespace po = boost::program_options;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct counts {
+  uint64_t value;
+  uint64_t enabled;
+  uint64_t running;
+};
+
+/** Equivalent to a log statement removed at compile time. */
+struct no_log {
+  static void log(uint64_t, uint64_t, uint64_t) {}
+};
+
+struct async_log {
+  static void log(uint64_t value, uint64_t enabled, uint64_t running) {
+    aser::util::async_log::write(
+        "value: %1%, enabled: %2%, running: %3%", value, enabled, running);
+  }
+};
+
+struct sync_log {
+  static void log(uint64_t value, uint64_t enabled, uint64_t running) {
+    BOOST_LOG_TRIVIAL(debug)
+      << boost::format("value: %1%, enabled: %2%, running: %3%")
+        % value % enabled % running;
+  }
+};
+
+template<typename Log>
+double tick(const std::vector<counts>& current, std::vector<counts>& prev) {
+  double sum = 0;
+  for (size_t i = 0; i < current.size(); ++i) {
+    auto value = current[i].value - prev[i].value;
+    auto enabled = current[i].enabled - prev[i].enabled;
+    auto running = current[i].running - prev[i].running;
+    prev[i] = current[i];
+    Log::log(value, enabled, running);
+    if (running == 0)
+      continue;
+    auto scaling = static_cast<double>(running) / enabled;
+    sum += value / scaling;
+  }
+  return sum;
+}
+
+template<typename Log>
+void run(const char* name, size_t events, unsigned ticks) {
+  std::vector<counts> current(events, counts{0, 0, 0});
+  std::vector<counts> prev(events, counts{0, 0, 0});
+
+  clock_type::duration elapsed {};
+  double checksum = 0;
+  for (unsigned t = 0; t < ticks; ++t) {
+    for (size_t i = 0; i < events; ++i) {
+      current[i].value += 1000 + i;
+      current[i].enabled += 100;
+      current[i].running += 50;
+    }
+
+    auto start = clock_type::now();
+    checksum += tick<Log>(current, prev);
+    elapsed += clock_type::now() - start;
+
+    // Leave time for the background thread, as a monitor sleeps between
+    // ticks.
+    aser::util::async_log::flush();
+  }
+
+  auto us = std::chrono::duration<double, std::micro>(elapsed).count();
+  std::cout << boost::format(
+      "%1%: %2$.2f us/tick, %3$.1f ns/event (checksum %4%)\n")
+    % name % (us / ticks) % (us * 1000 / (ticks * events)) % checksum;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("help", "print help message")
+    ("events", po::value<size_t>()->default_value(768),
+        "events per tick (e.g., 256 processes with 3 events each)")
+    ("ticks", po::value<unsigned>()->default_value(200),
+        "number of ticks")
+  ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 1;
+  }
+
+  auto events = vm["events"].as<size_t>();
+  auto ticks = vm["ticks"].as<unsigned>();
+
+  // Messages are formatted into a sink that discards them.
+  using backend_type = logging::sinks::text_ostream_backend;
+  auto backend = boost::make_shared<backend_type>();
+  backend->add_stream(boost::make_shared<std::ofstream>("/dev/null"));
+  logging::core::get()->add_sink(
+      boost::make_shared<logging::sinks::synchronous_sink<backend_type>>(
+        backend));
+
+  run<no_log>("compiled out", events, ticks);
+  run<async_log>("async", events, ticks);
+  run<sync_log>("boost.log", events, ticks);
+
+  logging::core::get()->set_filter(
+      logging::trivial::severity >= logging::trivial::info);
+  run<sync_log>("boost.log (filtered)", events, ticks);
+
+  std::cout << boost::format("async records dropped: %1%\n")
+    % aser::util::async_log::dropped();
+
+  return 0;
+}
@@ -0,0 +1,94 @@
+/** Microbenchmark comparing the algorithms to partition a cache.
+ *
+ * Random miss curves (decreasing, with cliffs) are partitioned repeatedly,
+ * as a monitor does on every interval. The benchmark reports the time per
+ * partition for every algorithm.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include <util/cache_partition.h>
+
+namespace po = boost::program_options;
+using namespace aser::util;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+void run(
+    const char* name,
+    partition_algorithm algorithm,
+    unsigned processes,
+    unsigned ways,
+    unsigned rounds) {
+  std::mt19937_64 gen(1);
+  std::uniform_real_distribution<double> drop(0, 1000);
+  std::bernoulli_distribution cliff(0.1);
+
+  partition_solver solver({ways, algorithm, 0});
+  std::vector<partition_request> requests(processes);
+  std::vector<unsigned> allocation;
+  double misses = 0;
+  clock_type::duration elapsed {};
+
+  for (unsigned r = 0; r < rounds; ++r) {
+    for (auto& request : requests) {
+      request.misses.assign(ways + 1, 0);
+      request.min_ways = 0;
+      request.reserved_ways = 0;
+      for (auto w = ways; w-- > 0;) {
+        request.misses[w] = request.misses[w + 1]
+          + drop(gen) * (cliff(gen) ? 10 : 1);
+      }
+    }
+
+    auto start = clock_type::now();
+    solver.solve(requests, allocation);
+    elapsed += clock_type::now() - start;
+
+    misses += partition_solver::total_misses(requests, allocation);
+  }
+
+  auto us = std::chrono::duration<double, std::micro>(elapsed).count();
+  std::cout << boost::format("%1%: %2$.2f us/partition (misses %3$.0f)\n")
+    % name % (us / rounds) % (misses / rounds);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("help", "print help message")
+    ("processes", po::value<unsigned>()->default_value(32),
+        "number of processes")
+    ("ways", po::value<unsigned>()->default_value(20),
+        "number of ways in the cache")
+    ("rounds", po::value<unsigned>()->default_value(10000),
+        "number of partitions")
+  ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 1;
+  }
+
+  auto processes = vm["processes"].as<unsigned>();
+  auto ways = vm["ways"].as<unsigned>();
+  auto rounds = vm["rounds"].as<unsigned>();
+
+  run("lookahead", partition_algorithm::LOOKAHEAD, processes, ways, rounds);
+  run("hull", partition_algorithm::HULL, processes, ways, rounds);
+
+  return 0;
+}
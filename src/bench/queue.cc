@@ -0,0 +1,110 @@
+/** Microbenchmark comparing the lock-based concurrent queue with the
+ * lock-free MPSC queue.
+ *
+ * Several producers push timestamps as fast as they can while a single
+ * consumer pops them. The benchmark reports the throughput and the latency
+ * (time since the value was pushed) observed by the consumer.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include <util/concurrent_queue.h>
+#include <util/mpsc_queue.h>
+#include <util/stats.h>
+
+namespace po = boost::program_options;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+int64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      clock_type::now().time_since_epoch()).count();
+}
+
+template<typename Queue>
+void run(const char* name, Queue& queue, unsigned producers, unsigned items) {
+  std::vector<double> latencies;
+  latencies.reserve(static_cast<size_t>(producers) * items);
+
+  auto start = clock_type::now();
+
+  std::vector<std::thread> threads;
+  for (unsigned p = 0; p < producers; ++p) {
+    threads.emplace_back([&] {
+      for (unsigned i = 0; i < items; ++i)
+        queue.push(now());
+    });
+  }
+
+  for (size_t i = 0; i < static_cast<size_t>(producers) * items; ++i) {
+    auto ts = queue.pop();
+    latencies.push_back(now() - ts);
+  }
+
+  auto elapsed = std::chrono::duration<double>(clock_type::now() - start);
+
+  for (auto& t : threads)
+    t.join();
+
+  auto s = aser::util::summarize(std::move(latencies));
+  std::cout << boost::format(
+      "%1%: %2% producers, %3$.3g values/s, "
+      "latency (ns): mean %4$.0f, p50 %5$.0f, p99 %6$.0f, max %7$.0f\n")
+    % name % producers
+    % (producers * static_cast<double>(items) / elapsed.count())
+    % s.mean % s.p50 % s.p99 % s.max;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("help", "print help message")
+    ("producers", po::value<unsigned>()->default_value(4),
+        "maximum number of producers")
+    ("items", po::value<unsigned>()->default_value(1000000),
+        "values pushed by each producer")
+    ("capacity", po::value<size_t>()->default_value(1024),
+        "capacity of the lock-free queue")
+  ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 1;
+  }
+
+  auto max_producers = vm["producers"].as<unsigned>();
+  auto items = vm["items"].as<unsigned>();
+  auto capacity = vm["capacity"].as<size_t>();
+
+  for (unsigned producers = 1; producers <= max_producers; producers *= 2) {
+    {
+    aser::util::concurrent_queue<int64_t> queue;
+    run("concurrent_queue", queue, producers, items);
+    }
+    {
+    aser::util::mpsc_queue<int64_t> queue(capacity);
+    run("mpsc_queue", queue, producers, items);
+    }
+    if (producers == 1) {
+      aser::util::spsc_queue<int64_t> queue(capacity);
+      run("spsc_queue", queue, producers, items);
+    }
+  }
+
+  return 0;
+}
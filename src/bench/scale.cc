@@ -0,0 +1,92 @@
+/** Microbenchmark comparing the instruction sets used to scale counts.
+ *
+ * A batch of events is scaled repeatedly in relative mode, as a monitor
+ * does on every tick. The benchmark reports the time per event for every
+ * instruction set supported by the CPU.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include <perf/scale.h>
+
+namespace po = boost::program_options;
+using namespace aser::perf;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+void run(const char* name, scale_isa isa, size_t events, unsigned ticks) {
+  if (!scale_isa_supported(isa)) {
+    std::cout << boost::format("%1%: not supported\n") % name;
+    return;
+  }
+
+  std::mt19937_64 gen(1);
+  std::uniform_int_distribution<uint64_t> step(1, 1 << 20);
+
+  count_buffer current(events);
+  count_buffer previous(events);
+  sample_buffer samples(events);
+  double checksum = 0;
+  clock_type::duration elapsed {};
+
+  for (unsigned t = 0; t < ticks; ++t) {
+    for (size_t i = 0; i < events; ++i) {
+      auto enabled = step(gen);
+      current.value[i] += step(gen);
+      current.enabled[i] += enabled;
+      current.running[i] += enabled / 2;
+    }
+
+    auto start = clock_type::now();
+    auto result = scale_counts(
+        current, previous, event_read_mode::RELATIVE, samples, isa);
+    elapsed += clock_type::now() - start;
+
+    if (result.error != scale_error::NONE)
+      throw_scale_error(result.error);
+    checksum += samples.value[t % events];
+  }
+
+  auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+  std::cout << boost::format("%1%: %2$.2f ns/event (checksum %3%)\n")
+    % name % (ns / (static_cast<double>(events) * ticks)) % checksum;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("help", "print help message")
+    ("events", po::value<size_t>()->default_value(4096),
+        "events scaled on every tick")
+    ("ticks", po::value<unsigned>()->default_value(1000),
+        "number of ticks")
+  ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 1;
+  }
+
+  auto events = vm["events"].as<size_t>();
+  auto ticks = vm["ticks"].as<unsigned>();
+
+  run("scalar", scale_isa::SCALAR, events, ticks);
+  run("avx2", scale_isa::AVX2, events, ticks);
+  run("avx512", scale_isa::AVX512, events, ticks);
+
+  return 0;
+}
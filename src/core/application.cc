@@ -0,0 +1,99 @@
+#include "application.h"
+
+#include <algorithm>
+
+#include <util/cgroup.h>
+#include <util/proc.h>
+
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+application::application(pid_t root, std::string cgroup_root)
+  : root_{root}
+  , cgroup_root_{std::move(cgroup_root)}
+{
+  refresh();
+}
+
+bool application::refresh() {
+  auto processes = cgroup_root_.empty()
+    ? util::process_tree(root_)
+    : util::cgroup_processes(cgroup_path(cgroup_root_, root_));
+  std::sort(begin(processes), end(processes));
+
+  std::vector<pid_t> threads;
+  for (auto pid : processes) {
+    auto tids = util::threads(pid);
+    threads.insert(end(threads), begin(tids), end(tids));
+  }
+  std::sort(begin(threads), end(threads));
+
+  bool changed = processes != processes_ || threads != threads_;
+  processes_ = std::move(processes);
+  threads_ = std::move(threads);
+  return changed;
+}
+
+/** Inserts a value in a sorted vector.
+ *
+ * @return True if the value was inserted; false if it was already there.
+ */
+static bool insert_sorted(std::vector<pid_t>& v, pid_t value) {
+  auto it = std::lower_bound(begin(v), end(v), value);
+  if (it != end(v) && *it == value)
+    return false;
+  v.insert(it, value);
+  return true;
+}
+
+/** Removes a value from a sorted vector. */
+static void erase_sorted(std::vector<pid_t>& v, pid_t value) {
+  auto it = std::lower_bound(begin(v), end(v), value);
+  if (it != end(v) && *it == value)
+    v.erase(it);
+}
+
+std::vector<pid_t> application::add_process(pid_t pid) {
+  insert_sorted(processes_, pid);
+
+  std::vector<pid_t> added;
+  for (auto tid : util::threads(pid)) {
+    if (insert_sorted(threads_, tid))
+      added.push_back(tid);
+  }
+  return added;
+}
+
+void application::remove_process(pid_t pid) {
+  erase_sorted(processes_, pid);
+  erase_sorted(threads_, pid);
+}
+
+bool application::add_thread(pid_t tid) {
+  return insert_sorted(threads_, tid);
+}
+
+void application::remove_thread(pid_t tid) {
+  erase_sorted(threads_, tid);
+}
+
+bool application::contains(pid_t pid) const {
+  return std::binary_search(begin(processes_), end(processes_), pid);
+}
+
+bool application::contains_thread(pid_t tid) const {
+  return std::binary_search(begin(threads_), end(threads_), tid);
+}
+
+std::string application::cgroup_root(const pt::ptree& properties) {
+  return properties.get<std::string>("application.cgroup", "");
+}
+
+std::string application::cgroup_path(
+    const std::string& cgroup_root,
+    pid_t root) {
+  return cgroup_root + "/" + std::to_string(root);
+}
+
+} // namespace aser
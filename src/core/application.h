@@ -0,0 +1,122 @@
+#ifndef CORE_APPLICATION_H_
+#define CORE_APPLICATION_H_
+
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace aser {
+
+/** An application is the set of processes (and their threads) that belong
+ * to a benchmark, such as the processes created by a shell-script wrapper,
+ * MPI ranks or forked workers.
+ *
+ * Membership is tracked either through a control group dedicated to the
+ * application or through the process tree rooted at the benchmark process.
+ * In the first case, processes that escape the process tree (e.g., daemons)
+ * still belong to the application.
+ */
+class application {
+public:
+  /** Constructor.
+   *
+   * @param root The benchmark process.
+   * @param cgroup_root Directory containing a control group for each
+   *     application (see cgroup_path()). If empty, membership is tracked
+   *     through the process tree.
+   */
+  application(pid_t root, std::string cgroup_root = "");
+
+  /** Returns the benchmark process. */
+  pid_t root() const noexcept {
+    return root_;
+  }
+
+  /** Refreshes the processes and threads that belong to the application.
+   *
+   * @return True if the membership changed; false otherwise.
+   */
+  bool refresh();
+
+  /** Adds a process and its threads without a full refresh (e.g., when a
+   * process in the application forks).
+   *
+   * @param pid The process identifier.
+   * @return The threads that were added.
+   */
+  std::vector<pid_t> add_process(pid_t pid);
+
+  /** Removes a process that finished, along with its main thread.
+   *
+   * The rest of its threads are expected to be removed as they finish.
+   *
+   * @param pid The process identifier.
+   */
+  void remove_process(pid_t pid);
+
+  /** Adds a thread without a full refresh (e.g., when a process in the
+   * application creates a thread).
+   *
+   * @param tid The thread identifier.
+   * @return True if the thread was added; false if it was already known.
+   */
+  bool add_thread(pid_t tid);
+
+  /** Removes a thread that finished.
+   *
+   * @param tid The thread identifier.
+   */
+  void remove_thread(pid_t tid);
+
+  /** Returns the processes in the application (as of the last refresh). */
+  const std::vector<pid_t>& processes() const noexcept {
+    return processes_;
+  }
+
+  /** Returns the threads in the application (as of the last refresh). */
+  const std::vector<pid_t>& threads() const noexcept {
+    return threads_;
+  }
+
+  /** Checks whether a process belongs to the application (as of the last
+   * refresh).
+   */
+  bool contains(pid_t pid) const;
+
+  /** Checks whether a thread belongs to the application (as of the last
+   * update).
+   */
+  bool contains_thread(pid_t tid) const;
+
+  /** Returns the directory containing the per-application control groups,
+   * or an empty string if control groups are not used.
+   *
+   * @param properties Configuration properties.
+   */
+  static std::string cgroup_root(
+      const boost::property_tree::ptree& properties);
+
+  /** Returns the path of the control group for an application.
+   *
+   * @param cgroup_root Directory containing the per-application groups.
+   * @param root The benchmark process.
+   */
+  static std::string cgroup_path(const std::string& cgroup_root, pid_t root);
+
+private:
+  pid_t root_;
+  std::string cgroup_root_;
+
+  /** Processes in the application (sorted). */
+  std::vector<pid_t> processes_;
+
+  /** Threads in the application (sorted). */
+  std::vector<pid_t> threads_;
+};
+
+} // namespace aser
+
+#endif // CORE_APPLICATION_H_
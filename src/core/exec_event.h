@@ -1,18 +1,120 @@
 #ifndef CORE_EXEC_EVENT_H_
 #define CORE_EXEC_EVENT_H_
 
+#include <sys/resource.h>
 #include <unistd.h>
 
+#include <type_traits>
+
 namespace aser {
 
+/** An execution event.
+ *
+ * Every event carries a payload whose meaning depends on the event type.
+ * The payload is stored inline, so events can be copied and queued without
+ * any heap allocation.
+ */
 struct exec_event {
-  enum class event_type { PROCESS_CREATED };
+  enum class event_type {
+    /** The execution manager created a benchmark process. */
+    PROCESS_CREATED,
+
+    /** A process in an application forked a new process (fork). */
+    PROCESS_FORKED,
+
+    /** A process in an application created a new thread (thread). */
+    THREAD_CREATED,
+
+    /** A process in an application called exec. */
+    PROCESS_EXEC,
+
+    /** A process in an application changed its name. */
+    PROCESS_COMM,
+
+    /** A thread in an application finished (thread). */
+    THREAD_EXITED,
+
+    /** A process in an application finished (exit). */
+    PROCESS_EXITED,
+
+    /** An application entered a new execution phase (phase). */
+    PHASE_CHANGED,
+
+    /** An actuator acted on an application (actuator). */
+    ACTUATOR_RESULT
+  };
+
+  /** Number of event types. */
+  static constexpr unsigned num_event_types =
+    static_cast<unsigned>(event_type::ACTUATOR_RESULT) + 1;
+
+  struct exit_payload {
+    /** Exit status, as returned by wait. */
+    int status;
+
+    /** Whether usage is valid. */
+    bool has_usage;
+
+    /** Resources used by the process (only for benchmark processes). */
+    rusage usage;
+  };
+
+  struct fork_payload {
+    /** Process that called fork. */
+    pid_t parent;
+  };
+
+  struct thread_payload {
+    /** Thread identifier. */
+    pid_t tid;
+
+    /** Exit status, as returned by wait (only for THREAD_EXITED). */
+    int status;
+  };
+
+  struct phase_payload {
+    /** Identifier of the new phase. */
+    unsigned phase;
+
+    /** Identifier of the previous phase. */
+    unsigned previous;
+  };
+
+  struct actuator_payload {
+    /** Actuator identifier. */
+    unsigned actuator;
+
+    /** Result of the action (zero on success, an errno value otherwise). */
+    int result;
+
+    /** Value the actuator applied (e.g., a number of cache ways). */
+    double value;
+  };
+
+  /** Payload for every event type. The first member is the largest one, so
+   * that value-initializing the union clears it completely. */
+  union payload_type {
+    exit_payload exit;
+    fork_payload fork;
+    thread_payload thread;
+    phase_payload phase;
+    actuator_payload actuator;
+  };
 
   event_type type;
+
+  /** The process the event refers to. */
   pid_t pid;
+
+  /** Benchmark process of the application the process belongs to. */
+  pid_t root { -1 };
+
+  payload_type payload {};
 };
 
+static_assert(std::is_trivially_copyable<exec_event>::value,
+    "Execution events must be trivially copyable");
+
 } // namespace aser
 
 #endif // CORE_EXEC_EVENT_H_
-
@@ -1,7 +1,11 @@
 #include "exec_manager.h"
 
+#include <core/application.h>
 #include <core/exec_monitor.h>
+#include <core/process_event_source.h>
+#include <util/cgroup.h>
 #include <util/factory.h>
+#include <util/log.h>
 
 namespace pt = boost::property_tree;
 
@@ -12,13 +16,33 @@ exec_manager::exec_manager(const pt::ptree& properties)
       properties.get<std::string>("exec_monitor.type"),
       *this,
       static_cast<const pt::ptree&>(properties))}
-{}
+  , cgroup_root_{application::cgroup_root(properties)}
+{
+  if (properties.get<bool>("exec_manager.process_events", false)) {
+    process_events_.reset(new process_event_source(
+        [this](const exec_event& event) {
+          exec_monitor_->enqueue_event(event);
+        }));
+  }
+}
 
-exec_manager::~exec_manager() = default;
+exec_manager::~exec_manager() {
+  for (auto& elem : cgroups_) {
+    try {
+      util::remove_cgroup(elem.second);
+    } catch (const std::exception& e) {
+      LOG(e.what());
+    }
+  }
+}
 
 void exec_manager::start() {
   exec_monitor_->initialize();
+  if (process_events_)
+    process_events_->start();
   start_impl();
+  if (process_events_)
+    process_events_->stop();
 }
 
 void exec_manager::prepare_exec_monitor() {
@@ -35,10 +59,50 @@ void exec_manager::stop_exec_monitor() {
 }
 
 void exec_manager::notify_process_creation(pid_t pid) {
+  if (!cgroup_root_.empty()) {
+    auto path = application::cgroup_path(cgroup_root_, pid);
+    util::create_cgroup(path);
+    cgroups_[pid] = path;
+    util::add_to_cgroup(path, pid);
+  }
+
+  if (process_events_)
+    process_events_->track(pid);
+
   exec_monitor_->enqueue_event(
-      {exec_event::event_type::PROCESS_CREATED, pid}
+      {exec_event::event_type::PROCESS_CREATED, pid, pid}
   );
 }
 
+void exec_manager::notify_process_exit(
+    pid_t pid,
+    int status,
+    const rusage& usage) {
+  exec_event event {exec_event::event_type::PROCESS_EXITED, pid, pid};
+  event.payload.exit.status = status;
+  event.payload.exit.has_usage = true;
+  event.payload.exit.usage = usage;
+  exec_monitor_->enqueue_event(event);
+
+  auto it = cgroups_.find(pid);
+  if (it == end(cgroups_))
+    return;
+
+  // The group cannot be removed while descendants of the process are still
+  // running, in which case it is removed along with the manager.
+  try {
+    util::remove_cgroup(it->second);
+    cgroups_.erase(it);
+  } catch (const std::exception& e) {
+    LOG(e.what());
+  }
+}
+
+bool exec_manager::query_metrics(
+    pid_t pid,
+    process_metrics& metrics) const {
+  return exec_monitor_->metrics(pid, metrics);
+}
+
 } // namespace aser
 
@@ -1,14 +1,22 @@
 #ifndef CORE_EXEC_MANAGER_H_
 #define CORE_EXEC_MANAGER_H_
 
+#include <sys/resource.h>
+
 #include <atomic>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <core/process_metrics.h>
+
 namespace aser {
 
 class exec_monitor;
+class process_event_source;
 
 /** Base class to manage the execution of benchmarks. */
 class exec_manager {
@@ -32,6 +40,11 @@ public:
     return execution_ended_;
   }
 
+  /** Returns the execution monitor. */
+  const exec_monitor& monitor() const {
+    return *exec_monitor_;
+  }
+
 protected:
   virtual void start_impl() = 0;
 
@@ -43,14 +56,57 @@ protected:
   void start_exec_monitor();
   void stop_exec_monitor();
 
+  /** Notifies the execution monitor that a process has been created.
+   *
+   * If process events are enabled, the execution monitor is notified about
+   * the events for the process and its descendants from now on. If
+   * applications are tracked through control groups, the process is also
+   * moved into its own control group. The process should not have
+   * started its execution yet, so that all its children and threads belong
+   * to the group too.
+   *
+   * @param pid The process identifier.
+   */
   void notify_process_creation(pid_t pid);
 
+  /** Notifies the execution monitor that a benchmark process has finished,
+   * so that it can release any state for the process.
+   *
+   * @param pid The process identifier.
+   * @param status The termination status, as returned by wait.
+   * @param usage The resources used by the process.
+   */
+  void notify_process_exit(pid_t pid, int status, const rusage& usage);
+
+  /** Returns the latest metrics the execution monitor has published for a
+   * process.
+   *
+   * @param pid The process identifier.
+   * @param metrics Where to store the metrics.
+   * @return True if there are metrics for the process; false otherwise.
+   */
+  bool query_metrics(pid_t pid, process_metrics& metrics) const;
+
 private:
   typedef std::unique_ptr<exec_monitor> exec_monitor_ptr;
 
   exec_monitor_ptr exec_monitor_;
   std::atomic<bool> execution_ended_ { false };
 
+  /** Directory containing the per-application control groups (empty if
+   * control groups are not used).
+   */
+  std::string cgroup_root_;
+
+  /** Control groups created for the applications that have not been
+   * removed yet (indexed by the benchmark process). */
+  std::map<pid_t, std::string> cgroups_;
+
+  /** Source of the events for the processes in the applications (null if
+   * process events are disabled).
+   */
+  std::unique_ptr<process_event_source> process_events_;
+
   exec_manager(const exec_manager&) = delete;
   exec_manager(exec_manager&&) = delete;
   exec_manager& operator=(const exec_manager&) = delete;
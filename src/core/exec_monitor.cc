@@ -3,13 +3,35 @@
 #include <cassert>
 
 #include <core/exec_manager.h>
+#include <util/alloc_tracker.h>
 #include <util/log.h>
+#include <util/timer_service.h>
 
 namespace aser {
 
 exec_monitor::exec_monitor(exec_manager& exec_manager)
   : exec_manager_(exec_manager)
-{}
+{
+  register_event_handler(
+      exec_event::event_type::PROCESS_CREATED,
+      [&](const exec_event& event) {
+        add_process_entries(event.pid);
+      });
+  // Metrics for a process are not published anymore once it finishes.
+  register_event_handler(
+      exec_event::event_type::PROCESS_EXITED,
+      [&](const exec_event& event) {
+        {
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        metrics_.erase(event.pid);
+        }
+        history_.erase(event.pid);
+      });
+}
+
+exec_monitor::~exec_monitor() {
+  util::timer_service::instance().cancel_all(this);
+}
 
 void exec_monitor::initialize() {
   assert(!initialized_);
@@ -30,35 +52,88 @@ void exec_monitor::prepare() {
 void exec_monitor::start() {
   assert(initialized_);
   thread_ = std::thread([&] {
+    open_cache_miss_counter();
     while (!exec_manager_.is_execution_over()) {
-      loop_impl();
+      tick();
       process_events();
     }
   });
 }
 
+void exec_monitor::tick() {
+  auto allocations = util::thread_allocations();
+  loop_impl();
+  allocations = util::thread_allocations() - allocations;
+  auto cache_misses = read_cache_misses();
+
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  if (stats_.ticks >= warmup_ticks_)
+    stats_.steady_allocations += allocations;
+  ++stats_.ticks;
+  stats_.allocations += allocations;
+  stats_.cache_misses = cache_misses;
+}
+
+#ifdef __linux__
+
+void exec_monitor::open_cache_miss_counter() {
+  using namespace perf;
+  auto events = create_generic_events("linux");
+  try {
+    std::unique_ptr<event<event_linux_impl>> counter{
+      new event<event_linux_impl>{
+        {event_type::HARDWARE, events.cache_misses,
+          event_modifiers::EXCLUDE_NONE}}};
+    counter->open(0, true);
+    cache_misses_ = std::move(counter);
+  } catch (const std::exception& e) {
+    LOG(boost::format("Cache misses of the monitor thread are not "
+          "available: %1%") % e.what());
+  }
+}
+
+uint64_t exec_monitor::read_cache_misses() {
+  if (!cache_misses_)
+    return 0;
+  cache_misses_->read();
+  return cache_misses_->counts()[0];
+}
+
+#else
+
+void exec_monitor::open_cache_miss_counter() {}
+
+uint64_t exec_monitor::read_cache_misses() {
+  return 0;
+}
+
+#endif
+
 void exec_monitor::process_events() {
-  while (true) {
-    auto res = event_queue_.pop(std::chrono::seconds(0));
-    if (!res.first)
-      break;
+  if (event_queue_.pop_all(pending_events_) > 0) {
+    for (auto& event : pending_events_)
+      event_handler(event);
+    pending_events_.clear();
+  }
 
-    event_handler(res.second);
+  if (tasks_.pop_all(pending_tasks_) > 0) {
+    for (auto& task : pending_tasks_)
+      task();
+    pending_tasks_.clear();
   }
 }
 
 void exec_monitor::event_handler(const exec_event& event) {
-  LOG(boost::format("Processing event (type: %1%, pid: %2%)")
-      % static_cast<int>(event.type)
-      % event.pid);
-  auto it = event_handlers_.find(event.type);
-  if (it == end(event_handlers_)) {
-    LOG("No handler registered");
+  LOG_ASYNC("Processing event (type: %1%, pid: %2%)",
+      static_cast<int>(event.type), event.pid);
+  auto& handlers = event_handlers_[static_cast<unsigned>(event.type)];
+  if (handlers.empty()) {
+    LOG_ASYNC("No handler registered");
     return;
   }
 
-  auto& func = it->second;
-  func(event);
+  for (auto& func : handlers)
+    func(event);
 }
 
 void exec_monitor::join() {
@@ -73,8 +148,88 @@ void exec_monitor::enqueue_event(exec_event event) {
 void exec_monitor::register_event_handler(
     const exec_event::event_type& type,
     const event_handler_func& func) {
-  auto res = event_handlers_.emplace(type, func);
-  assert(res.second);
+  event_handlers_[static_cast<unsigned>(type)].push_back(func);
+}
+
+util::timer_id exec_monitor::schedule(
+    std::chrono::nanoseconds delay,
+    task_func task) {
+  return util::timer_service::instance().schedule(
+      delay,
+      [this, task] { tasks_.push(task); },
+      this);
+}
+
+bool exec_monitor::cancel_timer(util::timer_id id) {
+  return util::timer_service::instance().cancel(id);
+}
+
+bool exec_monitor::metrics(pid_t pid, process_metrics& metrics) const {
+  std::lock_guard<std::mutex> lock(metrics_mutex_);
+  auto it = metrics_.find(pid);
+  if (it == end(metrics_) || !it->second.published)
+    return false;
+  metrics = it->second.metrics;
+  return true;
+}
+
+exec_monitor::monitor_stats exec_monitor::stats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return stats_;
+}
+
+void exec_monitor::add_process_entries(pid_t pid) {
+  {
+  std::lock_guard<std::mutex> lock(metrics_mutex_);
+  metrics_.emplace(pid, metrics_entry{process_metrics{}, false});
+  }
+
+  if (history_capacity_ > 0) {
+    history_.emplace(
+        pid,
+        util::sample_ring(
+          num_history_columns, history_capacity_, history_ewma_alpha_));
+  }
+}
+
+void exec_monitor::publish_metrics(
+    pid_t pid,
+    const process_metrics& metrics) {
+  {
+  std::lock_guard<std::mutex> lock(metrics_mutex_);
+  // Processes that were not announced through an event get their entry
+  // now.
+  metrics_[pid] = metrics_entry{metrics, true};
+  }
+
+  if (history_capacity_ == 0)
+    return;
+
+  auto it = history_.find(pid);
+  if (it == end(history_)) {
+    add_process_entries(pid);
+    it = history_.find(pid);
+  }
+
+  auto time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - creation_time_).count();
+  it->second.push(
+      time, {metrics.ipc, metrics.bandwidth, metrics.llc_occupancy});
+}
+
+void exec_monitor::enable_history(size_t capacity, double ewma_alpha) {
+  history_capacity_ = capacity;
+  history_ewma_alpha_ = ewma_alpha;
+  history_.clear();
+}
+
+void exec_monitor::set_warmup_ticks(uint64_t ticks) {
+  warmup_ticks_ = ticks;
+}
+
+const util::sample_ring* exec_monitor::history(pid_t pid) const {
+  auto it = history_.find(pid);
+  return it == end(history_) ? nullptr : &it->second;
 }
 
 } // namespace aser
@@ -3,12 +3,22 @@
 
 #include <unistd.h>
 
+#include <array>
+#include <chrono>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include <core/exec_event.h>
-#include <util/concurrent_queue.h>
+#include <core/process_metrics.h>
+#include <perf/event.h>
+#include <perf/event_linux.h>
+#include <util/mpsc_queue.h>
+#include <util/sample_ring.h>
+#include <util/timer_wheel.h>
 
 namespace aser {
 
@@ -17,13 +27,48 @@ class exec_manager;
 /** Base class to monitor the execution of benchmarks. */
 class exec_monitor {
 public:
+  /** Columns in the metric history of a process (see history()). */
+  enum history_column : unsigned {
+    IPC = 0,
+    BANDWIDTH,
+    LLC_OCCUPANCY,
+    num_history_columns
+  };
+
+  /** Statistics for the monitor thread.
+   *
+   * A tick is a single call to loop_impl(), which holds the steady-state
+   * path (waiting for the next sample, reading the counters and acting on
+   * them). Events and tasks run between ticks, and they are not included,
+   * as they handle changes in the applications (e.g., new processes).
+   */
+  struct monitor_stats {
+    /** Number of ticks. */
+    uint64_t ticks;
+
+    /** Heap allocations during the ticks (see util::thread_allocations()).
+     */
+    uint64_t allocations;
+
+    /** Heap allocations during the ticks after the warm-up. */
+    uint64_t steady_allocations;
+
+    /** Cache misses of the monitor thread (zero if they cannot be
+     * measured). */
+    uint64_t cache_misses;
+  };
+
   /** Constructor.
    *
    * @param exec_manager Execution manager in charge of the execution.
    */
   exec_monitor(exec_manager& exec_manager);
 
-  virtual ~exec_monitor() = default;
+  /** Destructor.
+   *
+   * Pending timers are canceled.
+   */
+  virtual ~exec_monitor();
 
   /** Initializes the execution monitor. */
   void initialize();
@@ -50,11 +95,30 @@ public:
   void enqueue_event(exec_event event);
 
   /** Handles an execution event.
+   *
+   * Every handler registered for the event type is invoked, in order of
+   * registration.
    *
    * @param event The execution event.
    */
   void event_handler(const exec_event& event);
 
+  /** Returns the latest metrics published for a process.
+   *
+   * This method can be safely called from any thread.
+   *
+   * @param pid The process identifier.
+   * @param metrics Where to store the metrics.
+   * @return True if there are metrics for the process; false otherwise.
+   */
+  bool metrics(pid_t pid, process_metrics& metrics) const;
+
+  /** Returns the statistics for the monitor thread.
+   *
+   * This method can be safely called from any thread.
+   */
+  monitor_stats stats() const;
+
 protected:
   /** Function definition for an event handler. */
   typedef std::function<void(const exec_event&)> event_handler_func;
@@ -68,7 +132,9 @@ protected:
    */
   virtual void loop_impl() = 0;
 
-  /** Registers and event handler.
+  /** Registers an event handler.
+    *
+    * Multiple handlers can be registered for the same event type.
     *
     * @param type Event type.
     * @param func Handler function.
@@ -77,7 +143,69 @@ protected:
       const exec_event::event_type& type,
       const event_handler_func& func);
 
+  /** Function definition for a deferred task. */
+  typedef std::function<void()> task_func;
+
+  /** Schedules a task to run on the monitor thread after a delay.
+   *
+   * Timers run on the process-wide timer service. Once a timer expires, the
+   * task is queued and it runs along with the pending events.
+   *
+   * @param delay Time until the timer expires.
+   * @param task The task.
+   * @return The timer identifier.
+   */
+  util::timer_id schedule(std::chrono::nanoseconds delay, task_func task);
+
+  /** Cancels a timer.
+   *
+   * @param id The timer identifier.
+   * @return True if the timer was canceled before expiring (and the task
+   *     will not run); false otherwise.
+   */
+  bool cancel_timer(util::timer_id id);
+
+  /** Publishes the latest metrics for a process.
+   *
+   * If the history is enabled, the metrics are also appended to the history
+   * of the process.
+   *
+   * @param pid The process identifier.
+   * @param metrics The metrics.
+   */
+  void publish_metrics(pid_t pid, const process_metrics& metrics);
+
+  /** Enables keeping a history of the metrics published for every
+   * process.
+   *
+   * Histories have a fixed capacity, which is allocated once for every
+   * process, and they are released when the process finishes.
+   *
+   * @param capacity Number of samples kept for every process.
+   * @param ewma_alpha Weight of the newest sample in moving averages.
+   */
+  void enable_history(size_t capacity, double ewma_alpha = 0.1);
+
+  /** Returns the history of the metrics published for a process.
+   *
+   * This method must be called from the monitor thread.
+   *
+   * @param pid The process identifier.
+   * @return The history, or nullptr if there is none.
+   */
+  const util::sample_ring* history(pid_t pid) const;
+
+  /** Sets the number of ticks after which the monitor is expected not to
+   * allocate memory anymore (see monitor_stats::steady_allocations).
+   *
+   * @param ticks Number of ticks.
+   */
+  void set_warmup_ticks(uint64_t ticks);
+
 private:
+  /** Number of events that can be pending before producers have to wait. */
+  static constexpr size_t event_queue_capacity = 4096;
+
   /** Associated exec_manager. */
   exec_manager& exec_manager_;
 
@@ -87,19 +215,84 @@ private:
   /** Handle for the thread that runs the loop implementation. */
   std::thread thread_;
 
-  /** Event queue. */
-  util::concurrent_queue<exec_event> event_queue_;
+  /** Event queue. Events are enqueued by the execution manager and the
+   * process event source, and consumed by the monitor thread. */
+  util::mpsc_queue<exec_event> event_queue_ { event_queue_capacity };
+
+  /** Event handlers (indexed by event type). */
+  std::array<std::vector<event_handler_func>, exec_event::num_event_types>
+    event_handlers_;
+
+  /** Events being processed (reused to avoid allocations). */
+  std::vector<exec_event> pending_events_;
+
+  /** Tasks whose timers expired. */
+  util::mpsc_queue<task_func> tasks_;
+
+  /** Tasks being processed (reused to avoid allocations). */
+  std::vector<task_func> pending_tasks_;
 
-  /** Event handlers. */
-  std::map<exec_event::event_type, event_handler_func> event_handlers_;
+  /** Metrics for a process. */
+  struct metrics_entry {
+    process_metrics metrics;
+
+    /** Whether any metrics have been published. */
+    bool published;
+  };
+
+  /** Latest metrics published for each process. Entries are created when
+   * processes are added, so that publishing does not allocate. */
+  std::map<pid_t, metrics_entry> metrics_;
+
+  /** Mutex protecting metrics_. */
+  mutable std::mutex metrics_mutex_;
+
+  /** Number of samples kept in every history (zero if disabled). */
+  size_t history_capacity_ { 0 };
+
+  double history_ewma_alpha_ { 0.1 };
+
+  /** History of the metrics published for each process. */
+  std::map<pid_t, util::sample_ring> history_;
+
+  /** Time at which the monitor was created (for history timestamps). */
+  std::chrono::steady_clock::time_point creation_time_ {
+    std::chrono::steady_clock::now() };
+
+  /** Ticks before allocations count as steady-state allocations. */
+  uint64_t warmup_ticks_ { 10 };
+
+  monitor_stats stats_ { 0, 0, 0, 0 };
+
+  /** Mutex protecting stats_. */
+  mutable std::mutex stats_mutex_;
+
+#ifdef __linux__
+  /** Counter for the cache misses of the monitor thread. */
+  std::unique_ptr<perf::event<perf::event_linux_impl>> cache_misses_;
+#endif
 
   exec_monitor(const exec_monitor&) = delete;
   exec_monitor(exec_monitor&&) = delete;
   exec_monitor& operator=(const exec_monitor&) = delete;
   exec_monitor& operator=(exec_monitor&&) = delete;
 
-  /** Processes pending events. */
+  /** Runs a single tick of the loop, updating the statistics. */
+  void tick();
+
+  /** Processes all the pending events and tasks in a single batch. */
   void process_events();
+
+  /** Opens the counter for the cache misses of the calling thread. */
+  void open_cache_miss_counter();
+
+  /** Returns the cache misses of the calling thread since the counter was
+   * opened. */
+  uint64_t read_cache_misses();
+
+  /** Creates the entries for a new process, so that publishing its metrics
+   * does not allocate. */
+  void add_process_entries(pid_t pid);
 };
 
 } // namespace aser
@@ -37,7 +37,21 @@ void process_monitor<Process>::check_duplicated_pid(pid_t pid) const {
 
 template<typename Process>
 std::pair<pid_t, int> process_monitor<Process>::wait_for_any() {
-  auto pid = ended_process_queue_.pop();
+  return collect(ended_process_queue_.pop());
+}
+
+template<typename Process>
+template<class Rep, class Period>
+std::pair<bool, std::pair<pid_t, int>> process_monitor<Process>::wait_for_any(
+    const std::chrono::duration<Rep, Period>& timeout) {
+  auto res = ended_process_queue_.pop(timeout);
+  if (!res.first)
+    return {false, {-1, 0}};
+  return {true, collect(res.second)};
+}
+
+template<typename Process>
+std::pair<pid_t, int> process_monitor<Process>::collect(pid_t pid) {
   auto it = status_.find(pid);
   assert(it != end(status_));
 
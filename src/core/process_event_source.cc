@@ -0,0 +1,96 @@
+#include "process_event_source.h"
+
+#include <util/log.h>
+#include <util/proc.h>
+
+namespace aser {
+
+process_event_source::process_event_source(callback_func callback)
+  : callback_{std::move(callback)}
+  , connector_{[this](const util::proc_connector::event& event) {
+      handle(event);
+    }}
+{}
+
+void process_event_source::start() {
+  connector_.start();
+}
+
+void process_event_source::stop() {
+  connector_.stop();
+}
+
+void process_event_source::track(pid_t root) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  roots_[root] = root;
+  for (auto pid : util::process_tree(root))
+    roots_[pid] = root;
+}
+
+size_t process_event_source::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return roots_.size();
+}
+
+void process_event_source::handle(const util::proc_connector::event& event) {
+  using proc_event = util::proc_connector::event;
+  using event_type = exec_event::event_type;
+
+  exec_event e {event_type::PROCESS_CREATED, event.tgid};
+  {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto tracked = [&](pid_t pid) {
+    auto it = roots_.find(pid);
+    return it != end(roots_) ? it->second : -1;
+  };
+
+  switch (event.type) {
+  case proc_event::event_type::FORK:
+    if (event.pid != event.tgid) {
+      e.root = tracked(event.tgid);
+      e.type = event_type::THREAD_CREATED;
+      e.payload.thread.tid = event.pid;
+    } else {
+      e.root = tracked(event.parent_tgid);
+      e.type = event_type::PROCESS_FORKED;
+      e.payload.fork.parent = event.parent_tgid;
+      if (e.root != -1)
+        roots_[event.tgid] = e.root;
+    }
+    break;
+  case proc_event::event_type::EXEC:
+    e.root = tracked(event.tgid);
+    e.type = event_type::PROCESS_EXEC;
+    break;
+  case proc_event::event_type::COMM:
+    e.root = tracked(event.tgid);
+    e.type = event_type::PROCESS_COMM;
+    break;
+  case proc_event::event_type::EXIT:
+    e.root = tracked(event.tgid);
+    if (event.pid != event.tgid) {
+      e.type = event_type::THREAD_EXITED;
+      e.payload.thread.tid = event.pid;
+      e.payload.thread.status = event.exit_code;
+    } else {
+      e.type = event_type::PROCESS_EXITED;
+      e.payload.exit.status = event.exit_code;
+      roots_.erase(event.tgid);
+      // The execution manager reports the termination of benchmark
+      // processes itself (along with their resource usage).
+      if (event.tgid == e.root)
+        e.root = -1;
+    }
+    break;
+  }
+  }
+
+  if (e.root == -1)
+    return;
+
+  LOG(boost::format("Process event (type: %1%, pid: %2%, application: %3%)")
+      % static_cast<int>(e.type) % e.pid % e.root);
+  callback_(e);
+}
+
+} // namespace aser
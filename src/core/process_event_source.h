@@ -0,0 +1,74 @@
+#ifndef CORE_PROCESS_EVENT_SOURCE_H_
+#define CORE_PROCESS_EVENT_SOURCE_H_
+
+#include <unistd.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include <core/exec_event.h>
+#include <util/proc_connector.h>
+
+namespace aser {
+
+/** Process event source.
+ *
+ * This class turns the process events reported by the kernel into execution
+ * events for the applications it tracks. An application is tracked from the
+ * moment its benchmark process is added, and every process it creates is
+ * tracked too, so that forks, execs, name changes and exits are reported
+ * as soon as they take place (instead of being discovered later by polling
+ * /proc). Events for other processes are discarded, and so is the
+ * termination of benchmark processes, which the execution manager reports.
+ */
+class process_event_source {
+public:
+  using callback_func = std::function<void(const exec_event&)>;
+
+  /** Constructor.
+   *
+   * @param callback Function to call for every execution event. It is
+   *     invoked from the listener thread.
+   */
+  process_event_source(callback_func callback);
+
+  /** Starts reporting events. */
+  void start();
+
+  /** Stops reporting events. */
+  void stop();
+
+  /** Tracks the application rooted at a given process.
+   *
+   * The processes that already belong to the application are tracked too.
+   * This method can be safely called from any thread.
+   *
+   * @param root The benchmark process.
+   */
+  void track(pid_t root);
+
+  /** Returns the number of processes being tracked. */
+  size_t size() const;
+
+private:
+  callback_func callback_;
+
+  util::proc_connector connector_;
+
+  /** Application (benchmark process) for each tracked process. */
+  std::map<pid_t, pid_t> roots_;
+
+  /** Mutex protecting roots_. */
+  mutable std::mutex mutex_;
+
+  /** Handles a process event from the kernel.
+   *
+   * @param event The event.
+   */
+  void handle(const util::proc_connector::event& event);
+};
+
+} // namespace aser
+
+#endif // CORE_PROCESS_EVENT_SOURCE_H_
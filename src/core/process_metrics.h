@@ -0,0 +1,23 @@
+#ifndef CORE_PROCESS_METRICS_H_
+#define CORE_PROCESS_METRICS_H_
+
+namespace aser {
+
+/** Live metrics for a process, as published by an execution monitor.
+ *
+ * Metrics that the monitor does not measure are left as zero.
+ */
+struct process_metrics {
+  /** Instructions per cycle. */
+  double ipc { 0 };
+
+  /** Memory bandwidth (bytes per second). */
+  double bandwidth { 0 };
+
+  /** Last-level cache occupancy (bytes). */
+  double llc_occupancy { 0 };
+};
+
+} // namespace aser
+
+#endif // CORE_PROCESS_METRICS_H_
@@ -3,10 +3,11 @@
 
 #include <unistd.h>
 
+#include <chrono>
 #include <future>
 #include <map>
 
-#include <util/concurrent_queue.h>
+#include <util/mpsc_queue.h>
 
 namespace aser {
 
@@ -41,15 +42,34 @@ public:
    */
   std::pair<pid_t, int> wait_for_any();
 
+  /** Blocks the caller until a process finishes its execution, or until
+   * the timeout expires.
+   *
+   * @param timeout Timeout to wait before the call fails.
+   * @return A pair consisting of a boolean indicating whether a process
+   *     finished, and the pid and termination status of the process (only
+   *     valid if a process finished).
+   */
+  template<class Rep, class Period>
+  std::pair<bool, std::pair<pid_t, int>> wait_for_any(
+      const std::chrono::duration<Rep, Period>& timeout);
+
+  /** Returns the number of processes that have not been waited for. */
+  size_t size() const {
+    return status_.size();
+  }
+
 private:
   /** Map containing the (future) status for every pid. */
   std::map<pid_t, std::future<int>> status_;
 
   /** Queue containing the processes that ended their execution. */
-  util::concurrent_queue<pid_t> ended_process_queue_;
+  util::mpsc_queue<pid_t> ended_process_queue_;
 
   void check_duplicated_pid(pid_t pid) const;
 
+  std::pair<pid_t, int> collect(pid_t pid);
+
   int wait_for_pid(pid_t pid);
   int wait_for_process(process_ptr process);
 
@@ -0,0 +1,58 @@
+#include "admission_policy.h"
+
+#include <util/factory.h>
+#include <util/log.h>
+
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+util::registar<admission_policy, fill_policy, const pt::ptree&>
+  fill_policy_registar("fill");
+
+util::registar<admission_policy, bandwidth_policy, const pt::ptree&>
+  bandwidth_policy_registar("bandwidth-aware");
+
+int fill_policy::select(
+    const std::vector<candidate>&,
+    const std::vector<co_runner>&) {
+  return 0;
+}
+
+bandwidth_policy::bandwidth_policy(const pt::ptree& properties)
+  : max_bandwidth_{properties.get<double>("max_bandwidth")}
+  , max_llc_occupancy_{properties.get<double>("max_llc_occupancy", 0)}
+  , min_ipc_{properties.get<double>("min_ipc", 0)}
+{}
+
+int bandwidth_policy::select(
+    const std::vector<candidate>& queue,
+    const std::vector<co_runner>& running) {
+  double bandwidth = 0;
+  double occupancy = 0;
+  for (auto& r : running) {
+    bandwidth += r.metrics.bandwidth;
+    occupancy += r.metrics.llc_occupancy;
+    if (r.metrics.ipc > 0 && r.metrics.ipc < min_ipc_) {
+      LOG(boost::format("Job %1% is slowed down (IPC %2%)")
+          % r.job % r.metrics.ipc);
+      return -1;
+    }
+  }
+
+  for (size_t i = 0; i < queue.size(); ++i) {
+    auto& profile = queue[i].profile;
+    if (bandwidth + profile.bandwidth > max_bandwidth_)
+      continue;
+    if (max_llc_occupancy_ > 0
+        && occupancy + profile.llc_occupancy > max_llc_occupancy_)
+      continue;
+    return i;
+  }
+
+  LOG(boost::format("Resource limits reached (%1% bytes/s, %2% bytes of "
+        "LLC)") % bandwidth % occupancy);
+  return -1;
+}
+
+} // namespace aser
@@ -0,0 +1,99 @@
+#ifndef EXEC_MANAGER_ADMISSION_POLICY_H_
+#define EXEC_MANAGER_ADMISSION_POLICY_H_
+
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <core/process_metrics.h>
+
+namespace aser {
+
+/** Base class for the policies that decide which jobs a batch manager
+ * starts, and when.
+ *
+ * Policies are created through util::create<admission_policy>(), passing
+ * the policy configuration properties.
+ */
+class admission_policy {
+public:
+  /** A job waiting in the queue. */
+  struct candidate {
+    /** Job identifier. */
+    unsigned job;
+
+    /** Expected behavior of the job (zero metrics if unknown). */
+    process_metrics profile;
+  };
+
+  /** A job that is running. */
+  struct co_runner {
+    /** Job identifier. */
+    unsigned job;
+
+    /** Latest metrics for the job (its expected behavior if the monitor
+     * has not published any metrics yet).
+     */
+    process_metrics metrics;
+  };
+
+  virtual ~admission_policy() = default;
+
+  /** Selects the next job to start.
+   *
+   * This method is only called when there is at least one free slot and
+   * one job in the queue.
+   *
+   * @param queue Jobs waiting to start, in arrival order.
+   * @param running Jobs currently running.
+   * @return The position in the queue of the job to start, or -1 to wait.
+   */
+  virtual int select(
+      const std::vector<candidate>& queue,
+      const std::vector<co_runner>& running) = 0;
+};
+
+/** Policy that starts jobs in FIFO order as long as there are free slots. */
+class fill_policy : public admission_policy {
+public:
+  fill_policy(const boost::property_tree::ptree&) {}
+
+  int select(
+      const std::vector<candidate>& queue,
+      const std::vector<co_runner>& running) final;
+};
+
+/** Policy that keeps the aggregated memory bandwidth of the running jobs
+ * under a given limit (max_bandwidth, in bytes per second).
+ *
+ * The first queued job whose expected bandwidth fits under the limit is
+ * started. Optionally, the expected last-level cache occupancy must also
+ * fit under max_llc_occupancy (in bytes), and no job is started while any
+ * running job has an IPC below min_ipc, as the running jobs are already
+ * slowed down by contention. Limits that are zero or not given are not
+ * enforced, and so are metrics that are zero (unknown). If no job fits,
+ * the policy waits for the running jobs to finish or to change their
+ * behavior.
+ */
+class bandwidth_policy : public admission_policy {
+public:
+  bandwidth_policy(const boost::property_tree::ptree& properties);
+
+  int select(
+      const std::vector<candidate>& queue,
+      const std::vector<co_runner>& running) final;
+
+private:
+  /** Maximum aggregated bandwidth (bytes per second). */
+  double max_bandwidth_;
+
+  /** Maximum aggregated last-level cache occupancy (bytes). */
+  double max_llc_occupancy_;
+
+  /** Minimum IPC of the running jobs to start another one. */
+  double min_ipc_;
+};
+
+} // namespace aser
+
+#endif // EXEC_MANAGER_ADMISSION_POLICY_H_
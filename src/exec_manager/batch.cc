@@ -0,0 +1,200 @@
+#include "batch.h"
+
+#include <algorithm>
+
+#include <core/process_monitor.h>
+#include <util/factory.h>
+#include <util/log.h>
+#include <util/parse.h>
+#include <util/process.h>
+#include <util/stats.h>
+
+namespace chrono = std::chrono;
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+util::registar<exec_manager, batch_manager, const pt::ptree&>
+  batch_manager_registar("batch");
+
+static double to_ms(batch_manager::clock::duration d) {
+  return chrono::duration<double, std::milli>(d).count();
+}
+
+batch_manager::batch_manager(const pt::ptree& properties)
+  : exec_manager(properties)
+  , benchs_(util::parse_vector<benchmark>(
+        properties.get_child("exec_manager.benchmarks")))
+  , slots_{properties.get<unsigned>("exec_manager.slots")}
+  , decision_interval_{properties.get<unsigned>(
+        "exec_manager.decision_interval", 100)}
+  , records_(benchs_.size())
+{
+  if (slots_ == 0)
+    throw std::invalid_argument("At least one slot is required");
+
+  unsigned id = 0;
+  for (auto& b : benchs_)
+    b.id = id++;
+
+  for (auto& elem : properties.get_child("exec_manager.benchmarks")) {
+    auto& pt = elem.second;
+    isolated_times_.push_back(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::duration<double, std::milli>(
+            pt.get<double>("isolated_time", 0))));
+
+    auto& p = profiles_[pt.get<std::string>("name")];
+    p.metrics.ipc = pt.get<double>("profile.ipc", p.metrics.ipc);
+    p.metrics.bandwidth =
+      pt.get<double>("profile.bandwidth", p.metrics.bandwidth);
+    p.metrics.llc_occupancy =
+      pt.get<double>("profile.llc_occupancy", p.metrics.llc_occupancy);
+  }
+
+  auto& policy_properties = properties.get_child("exec_manager.policy");
+  policy_ = util::create<admission_policy>(
+      policy_properties.get<std::string>("type"),
+      static_cast<const pt::ptree&>(policy_properties));
+
+  queue_.reserve(benchs_.size());
+  running_.reserve(slots_);
+  candidates_.reserve(benchs_.size());
+  co_runners_.reserve(slots_);
+}
+
+void batch_manager::start_impl() {
+  LOG(boost::format("Starting execution (%1% jobs)") % benchs_.size());
+
+  for (auto& b : benchs_)
+    queue_.push_back(b.id);
+
+  process_monitor<process_type> monitor;
+
+  prepare_exec_monitor();
+  start_exec_monitor();
+
+  auto t0 = clock::now();
+  size_t finished = 0;
+
+  while (finished < benchs_.size()) {
+    admit_jobs(monitor);
+
+    // If the policy decided to wait, it has to be consulted again after a
+    // while, as the behavior of the running jobs may change.
+    if (!queue_.empty() && running_.size() < slots_) {
+      auto res = monitor.wait_for_any(decision_interval_);
+      if (!res.first) {
+        update_profiles();
+        continue;
+      }
+      complete(res.second.first);
+    } else {
+      complete(monitor.wait_for_any().first);
+    }
+    ++finished;
+  }
+
+  makespan_ = clock::now() - t0;
+
+  execution_end();
+  stop_exec_monitor();
+
+  report();
+}
+
+void batch_manager::admit_jobs(process_monitor<process_type>& monitor) {
+  while (running_.size() < slots_ && !queue_.empty()) {
+    candidates_.clear();
+    for (auto id : queue_)
+      candidates_.push_back({id, profiles_[benchs_[id].name].metrics});
+
+    co_runners_.clear();
+    for (auto& r : running_) {
+      process_metrics metrics;
+      if (!query_metrics(r.process->pid(), metrics))
+        metrics = profiles_[benchs_[r.id].name].metrics;
+      co_runners_.push_back({r.id, metrics});
+    }
+
+    auto idx = policy_->select(candidates_, co_runners_);
+    if (idx < 0) {
+      // Leaving the machine idle would stall the batch forever.
+      if (!running_.empty())
+        break;
+      idx = 0;
+    }
+    assert(static_cast<size_t>(idx) < queue_.size());
+
+    auto id = queue_[idx];
+    queue_.erase(begin(queue_) + idx);
+
+    LOG(boost::format("Starting job %1%") % id);
+    auto process = std::make_shared<process_type>(benchs_[id].args);
+    process->prepare();
+    notify_process_creation(process->pid());
+    monitor.add_process(process);
+    records_[id].start = clock::now();
+    process->start();
+    running_.push_back({id, std::move(process)});
+  }
+}
+
+void batch_manager::update_profiles() {
+  for (auto& r : running_) {
+    process_metrics metrics;
+    if (!query_metrics(r.process->pid(), metrics))
+      continue;
+
+    // Cumulative average of all the observations for the benchmark.
+    auto& p = profiles_[benchs_[r.id].name];
+    ++p.samples;
+    auto update = [&](double& mean, double value) {
+      mean += (value - mean) / p.samples;
+    };
+    update(p.metrics.ipc, metrics.ipc);
+    update(p.metrics.bandwidth, metrics.bandwidth);
+    update(p.metrics.llc_occupancy, metrics.llc_occupancy);
+  }
+}
+
+void batch_manager::complete(pid_t pid) {
+  update_profiles();
+
+  auto it = std::find_if(begin(running_), end(running_),
+      [&](const running_job& j) { return j.process->pid() == pid; });
+  assert(it != end(running_));
+
+  LOG(boost::format("Job %1% finished") % it->id);
+  records_[it->id].end = clock::now();
+  notify_process_exit(
+      pid,
+      it->process->termination_status(),
+      it->process->resource_usage());
+  std::swap(*it, running_.back());
+  running_.pop_back();
+}
+
+double batch_manager::slowdown(unsigned id) const {
+  auto isolated = isolated_times_[id];
+  if (isolated == chrono::nanoseconds(0))
+    return 0;
+  return to_ms(records_[id].service_time()) / to_ms(isolated);
+}
+
+void batch_manager::report() const {
+  std::vector<double> slowdowns;
+  for (auto& b : benchs_) {
+    auto s = slowdown(b.id);
+    LOGI(boost::format("%1%: %2% ms (slowdown: %3%)")
+        % b.name % to_ms(records_[b.id].service_time()) % s);
+    if (s > 0)
+      slowdowns.push_back(s);
+  }
+
+  auto s = util::summarize(std::move(slowdowns));
+  LOGI(boost::format("Makespan: %1% ms") % to_ms(makespan_));
+  LOGI(boost::format("Slowdown: mean %1%, p50 %2%, p95 %3%, max %4%")
+      % s.mean % s.p50 % s.p95 % s.max);
+}
+
+} // namespace aser
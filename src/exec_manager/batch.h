@@ -0,0 +1,147 @@
+#ifndef EXEC_MANAGER_BATCH_H_
+#define EXEC_MANAGER_BATCH_H_
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <core/benchmark.h>
+#include <core/exec_manager.h>
+#include <exec_manager/admission_policy.h>
+
+namespace aser {
+
+namespace util {
+class sync_process;
+}
+
+template<typename Process>
+class process_monitor;
+
+/** Batch execution manager.
+ *
+ * This execution manager runs a batch of independent jobs (one per
+ * benchmark) using at most a given number of slots. An admission policy
+ * decides which of the queued jobs start, and whether to start any at all,
+ * based on the metrics the execution monitor publishes for the running jobs
+ * and on the expected behavior of the queued ones. The expected behavior of
+ * a benchmark comes from its configuration (profile) and it is refined with
+ * the metrics observed whenever a job for that benchmark runs.
+ *
+ * When the policy decides to wait, it is consulted again after a job
+ * finishes or after the decision interval expires. The manager reports the
+ * makespan of the batch and the slowdown of every job, which uses the
+ * isolated execution time of the benchmark (isolated_time, in ms) if given.
+ */
+class batch_manager : public exec_manager {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /** Timing information for a job. */
+  struct job_record {
+    clock::time_point start;
+    clock::time_point end;
+
+    clock::duration service_time() const {
+      return end - start;
+    }
+  };
+
+  /** Constructor.
+   *
+   * @param properties Configuration properties.
+   */
+  batch_manager(const boost::property_tree::ptree& properties);
+
+  /** Returns the records for every job. */
+  const std::vector<job_record>& records() const {
+    return records_;
+  }
+
+  /** Returns the time it took to execute the whole batch. */
+  clock::duration makespan() const {
+    return makespan_;
+  }
+
+  /** Returns the slowdown for a job, or zero if the isolated execution
+   * time for the benchmark is unknown.
+   *
+   * @param id The job identifier.
+   */
+  double slowdown(unsigned id) const;
+
+private:
+  using process_type = util::sync_process;
+  using process_ptr = std::shared_ptr<process_type>;
+
+  /** Expected behavior of a benchmark. */
+  struct profile {
+    process_metrics metrics;
+    unsigned samples;
+  };
+
+  /** A job that is running. */
+  struct running_job {
+    unsigned id;
+    process_ptr process;
+  };
+
+  std::vector<benchmark> benchs_;
+
+  /** Isolated execution time for each benchmark (zero if unknown). */
+  std::vector<std::chrono::nanoseconds> isolated_times_;
+
+  /** Profile for each benchmark name. */
+  std::map<std::string, profile> profiles_;
+
+  /** Maximum number of jobs running at the same time. */
+  unsigned slots_;
+
+  /** Time to wait before consulting the policy again. */
+  std::chrono::milliseconds decision_interval_;
+
+  std::unique_ptr<admission_policy> policy_;
+
+  /** Jobs waiting to start, in arrival order. */
+  std::vector<unsigned> queue_;
+
+  /** Jobs currently running. */
+  std::vector<running_job> running_;
+
+  /** Arguments for the policy (the storage is reused across decisions). */
+  std::vector<admission_policy::candidate> candidates_;
+  std::vector<admission_policy::co_runner> co_runners_;
+
+  std::vector<job_record> records_;
+
+  clock::duration makespan_ {};
+
+  void start_impl() final;
+
+  /** Starts queued jobs until either the policy decides to wait or there
+   * are no free slots.
+   *
+   * @param monitor Process monitor that will wait for the jobs.
+   */
+  void admit_jobs(process_monitor<process_type>& monitor);
+
+  /** Refines the benchmark profiles with the metrics of the running jobs. */
+  void update_profiles();
+
+  /** Records the termination of a job.
+   *
+   * @param pid The pid of the process executing the job.
+   */
+  void complete(pid_t pid);
+
+  /** Logs a summary of the execution. */
+  void report() const;
+};
+
+} // namespace aser
+
+#endif // EXEC_MANAGER_BATCH_H_
@@ -0,0 +1,32 @@
+#include "fixed_work.h"
+
+#include <perf/event_dummy.h>
+#include <perf/event_linux.h>
+#include <util/factory.h>
+
+namespace pt = boost::property_tree;
+
+using namespace aser::perf;
+
+namespace aser {
+
+#ifdef __linux__
+
+// Overflow notifications rely on the Linux overflow listener, so even the
+// dummy variant is only available in Linux builds.
+
+util::registar<
+    exec_manager,
+    fixed_work_manager<event<event_linux_impl>>,
+    const pt::ptree&>
+  fixed_work_manager_linux_registar("fixed-work[linux]");
+
+util::registar<
+    exec_manager,
+    fixed_work_manager<event<event_dummy_impl>>,
+    const pt::ptree&>
+  fixed_work_manager_dummy_registar("fixed-work[dummy]");
+
+#endif
+
+} // namespace aser
@@ -0,0 +1,157 @@
+#ifndef EXEC_MANAGER_FIXED_WORK_H_
+#define EXEC_MANAGER_FIXED_WORK_H_
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <core/benchmark.h>
+#include <core/exec_manager.h>
+#include <util/concurrent_queue.h>
+
+namespace aser {
+
+namespace util {
+class sync_process;
+}
+
+/** Fixed-work execution manager.
+ *
+ * Instead of running the benchmarks to completion, this execution manager
+ * runs each benchmark for a given number of retired (user-level)
+ * instructions. Optionally, a number of instructions can be skipped first
+ * (fast-forward). The execution monitor is only notified about a process
+ * once its measurement starts.
+ *
+ * Both boundaries are detected with counter overflows. The instruction
+ * counter keeps counting across the end of the fast-forward, so the
+ * instructions retired before the manager handles the notification are
+ * included in the measurement, and the end of the measurement is moved
+ * accordingly. The counter disables itself at the end of the measurement,
+ * so the count is snapshotted at the boundary regardless of when the
+ * manager gets to handle the notification. The measured time, on the
+ * other hand, starts once the manager handles the notification. A
+ * benchmark that retires its budget is either stopped (SIGSTOP) or left
+ * running so that it keeps generating contention, depending on the
+ * configuration. The execution finishes once every benchmark has either
+ * retired its budget or ended its execution.
+ */
+template<typename Event>
+class fixed_work_manager : public exec_manager {
+public:
+  /** Measurement results for a benchmark. */
+  struct result {
+    /** True if the benchmark retired its whole budget. */
+    bool completed;
+
+    /** Instructions retired during the measurement. */
+    double instructions;
+
+    /** Duration of the measurement. */
+    std::chrono::nanoseconds duration;
+  };
+
+  /** Constructor.
+   *
+   * @param properties Configuration properties.
+   */
+  fixed_work_manager(const boost::property_tree::ptree& properties);
+
+  /** Returns the results for every benchmark (indexed by benchmark id). */
+  const std::vector<result>& results() const {
+    return results_;
+  }
+
+private:
+  using process_type = util::sync_process;
+  using process_ptr = std::shared_ptr<process_type>;
+  using clock = std::chrono::steady_clock;
+
+  /** Action to take once a benchmark retires its budget. */
+  enum class budget_action { CONTINUE, STOP };
+
+  /** Execution phase of a benchmark. */
+  enum class phase { FAST_FORWARD, MEASUREMENT, DONE };
+
+  /** Notification for the manager thread. */
+  struct notification {
+    enum class notification_type { OVERFLOW, EXITED };
+
+    notification_type type;
+    unsigned id;
+  };
+
+  /** Instructions to retire during the measurement. */
+  uint64_t instructions_;
+
+  /** Instructions to skip before the measurement starts. */
+  uint64_t fast_forward_;
+
+  /** Action to take once a benchmark retires its budget. */
+  budget_action budget_action_;
+
+  std::vector<benchmark> benchs_;
+  std::vector<process_ptr> processes_;
+
+  /** Instruction counter for each benchmark. */
+  std::vector<Event> counters_;
+
+  /** Current phase for each benchmark. */
+  std::vector<phase> phases_;
+
+  /** Time when the measurement started for each benchmark. */
+  std::vector<clock::time_point> start_times_;
+
+  /** Instructions counted so far in the measurement of each benchmark. */
+  std::vector<double> measured_;
+
+  std::vector<result> results_;
+
+  /** Overflows and process terminations, in order of arrival. */
+  util::concurrent_queue<notification> notifications_;
+
+  void start_impl() final;
+
+  void prepare_bench(const benchmark& bench);
+
+  /** Starts the measurement for a benchmark.
+   *
+   * @param id The benchmark identifier.
+   */
+  void start_measurement(unsigned id);
+
+  /** Counts the instructions retired by a benchmark after an overflow
+   * during its measurement.
+   *
+   * If the budget has not been retired yet, the counter is armed again.
+   *
+   * @param id The benchmark identifier.
+   * @return True if the benchmark retired its whole budget.
+   */
+  bool budget_retired(unsigned id);
+
+  /** Finishes the measurement for a benchmark.
+   *
+   * @param id The benchmark identifier.
+   * @param completed Whether the benchmark retired its whole budget.
+   */
+  void finish_measurement(unsigned id, bool completed);
+
+  /** Returns the identifier of the benchmark whose counter uses a given
+   * file descriptor.
+   */
+  unsigned find_bench_by_fd(int fd) const;
+
+  /** Returns the identifier of the benchmark with the given pid. */
+  unsigned find_bench_by_pid(pid_t pid) const;
+
+  static budget_action parse_budget_action(const std::string& action);
+};
+
+} // namespace aser
+
+#include <exec_manager/impl/fixed_work.h>
+
+#endif // EXEC_MANAGER_FIXED_WORK_H_
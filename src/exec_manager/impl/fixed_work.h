@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <thread>
+
+#include <core/process_monitor.h>
+#include <perf/event.h>
+#include <perf/overflow_listener.h>
+#include <util/kill.h>
+#include <util/log.h>
+#include <util/parse.h>
+#include <util/process.h>
+
+namespace aser {
+
+template<typename Event>
+fixed_work_manager<Event>::fixed_work_manager(
+    const boost::property_tree::ptree& properties)
+  : exec_manager(properties)
+  , instructions_{properties.get<uint64_t>("exec_manager.instructions")}
+  , fast_forward_{properties.get<uint64_t>("exec_manager.fast_forward", 0)}
+  , budget_action_{parse_budget_action(
+        properties.get<std::string>("exec_manager.on_budget", "continue"))}
+  , benchs_(util::parse_vector<benchmark>(
+        properties.get_child("exec_manager.benchmarks")))
+  , processes_(benchs_.size())
+  , phases_(benchs_.size(), phase::FAST_FORWARD)
+  , start_times_(benchs_.size())
+  , measured_(benchs_.size(), 0)
+  , results_(benchs_.size(), result{false, 0, {}})
+{
+  if (instructions_ == 0)
+    throw std::invalid_argument("Instruction budget must be positive");
+
+  unsigned id = 0;
+  for (auto& b : benchs_)
+    b.id = id++;
+
+  auto generic_events = perf::create_generic_events(
+      properties.get<std::string>("exec_manager.event"));
+
+  perf::event_info info = {
+    perf::event_type::HARDWARE,
+    generic_events.instructions,
+    perf::event_modifiers::EXCLUDE_KERNEL | perf::event_modifiers::EXCLUDE_HV,
+    fast_forward_ > 0 ? fast_forward_ : instructions_
+  };
+
+  counters_.reserve(benchs_.size());
+  for (size_t i = 0; i < benchs_.size(); ++i)
+    counters_.emplace_back(info);
+}
+
+template<typename Event>
+void fixed_work_manager<Event>::start_impl() {
+  LOG("Starting execution");
+
+  for (auto& b : benchs_)
+    prepare_bench(b);
+
+  // Overflows are handled in the manager thread, along with process
+  // terminations. The counter keeps counting across the end of the
+  // fast-forward, so the instructions retired while the notification is
+  // pending are added to the measurement, and it disables itself at the
+  // end of the budget, so the extra latency does not affect the count.
+  perf::overflow_listener listener([&](int fd) {
+    notifications_.push({
+        notification::notification_type::OVERFLOW,
+        find_bench_by_fd(fd)});
+  });
+  listener.start();
+
+  for (auto& c : counters_)
+    c.notify_overflow(listener.signal(), listener.thread_id());
+
+  process_monitor<process_type> monitor;
+  for (auto& p : processes_)
+    monitor.add_process(p);
+
+  prepare_exec_monitor();
+
+  for (auto& b : benchs_) {
+    auto& counter = counters_[b.id];
+    if (fast_forward_ > 0) {
+      // The counter keeps counting after the fast-forward overflow, until
+      // a second one.
+      counter.rearm(fast_forward_, 2);
+    } else {
+      phases_[b.id] = phase::MEASUREMENT;
+      counter.rearm(instructions_);
+      start_times_[b.id] = clock::now();
+    }
+    processes_[b.id]->start();
+  }
+
+  start_exec_monitor();
+
+  std::thread waiter([&] {
+    for (size_t i = 0; i < processes_.size(); ++i) {
+      auto pid = monitor.wait_for_any().first;
+      notifications_.push({
+          notification::notification_type::EXITED,
+          find_bench_by_pid(pid)});
+    }
+  });
+
+  auto pending = benchs_.size();
+  while (pending > 0) {
+    auto n = notifications_.pop();
+    if (n.type == notification::notification_type::EXITED) {
+      auto& p = processes_[n.id];
+      notify_process_exit(
+          p->pid(),
+          p->termination_status(),
+          p->resource_usage());
+    }
+
+    if (phases_[n.id] == phase::DONE)
+      continue;
+
+    if (n.type == notification::notification_type::EXITED) {
+      finish_measurement(n.id, false);
+      --pending;
+    } else if (phases_[n.id] == phase::FAST_FORWARD) {
+      start_measurement(n.id);
+    } else if (budget_retired(n.id)) {
+      finish_measurement(n.id, true);
+      --pending;
+    }
+  }
+
+  execution_end();
+  stop_exec_monitor();
+  listener.stop();
+
+  LOG("Cleaning up");
+
+  for (auto& p : processes_) {
+    try {
+      util::kill_process(*p);
+    } catch (const std::exception& e) {
+      LOG(e.what());
+    } catch (...) {
+      LOG("Unexpected error trying to kill a process");
+    }
+  }
+
+  waiter.join();
+
+  for (auto& b : benchs_) {
+    auto& r = results_[b.id];
+    LOGI(boost::format("%1%: %2% instructions in %3% ms (%4%)")
+        % b.name
+        % r.instructions
+        % std::chrono::duration_cast<std::chrono::milliseconds>(
+            r.duration).count()
+        % (r.completed ? "completed" : "ended before its budget"));
+  }
+}
+
+template<typename Event>
+void fixed_work_manager<Event>::prepare_bench(const benchmark& bench) {
+  LOG(boost::format("Preparing bench %1%") % bench.id);
+  auto process = std::make_shared<process_type>(bench.args);
+  process->prepare();
+  // The process is blocked until start() is called, so attaching the
+  // counter right away does not count any of its instructions.
+  counters_[bench.id].open(process->pid(), true);
+  if (fast_forward_ == 0)
+    notify_process_creation(process->pid());
+  processes_[bench.id] = std::move(process);
+}
+
+template<typename Event>
+void fixed_work_manager<Event>::start_measurement(unsigned id) {
+  LOG(boost::format("Bench %1% finished its fast-forward") % id);
+  auto& counter = counters_[id];
+  counter.read();
+  start_times_[id] = clock::now();
+
+  // The instructions retired since the overflow already belong to the
+  // measurement, and the next overflow is moved to the end of the budget.
+  auto retired = counter.scale(perf::event_read_mode::RELATIVE).value;
+  measured_[id] = std::max(0.0, retired - fast_forward_);
+  auto left = std::max(1.0, instructions_ - measured_[id]);
+  counter.set_period(static_cast<uint64_t>(left));
+
+  phases_[id] = phase::MEASUREMENT;
+  notify_process_creation(processes_[id]->pid());
+}
+
+template<typename Event>
+bool fixed_work_manager<Event>::budget_retired(unsigned id) {
+  auto& counter = counters_[id];
+  counter.read();
+  measured_[id] += counter.scale(perf::event_read_mode::RELATIVE).value;
+  if (measured_[id] >= instructions_)
+    return true;
+
+  // The second fast-forward overflow disabled the counter before the
+  // measurement started (the fast-forward notification was handled late),
+  // so it is armed again for the rest of the budget.
+  LOG(boost::format("Bench %1% overflowed before its budget (%2% left)")
+      % id % (instructions_ - measured_[id]));
+  counter.rearm(static_cast<uint64_t>(instructions_ - measured_[id]));
+  return false;
+}
+
+template<typename Event>
+void fixed_work_manager<Event>::finish_measurement(
+    unsigned id,
+    bool completed) {
+  LOG(boost::format("Bench %1% finished its measurement (completed: %2%)")
+      % id % completed);
+
+  auto& r = results_[id];
+  r.completed = completed;
+  if (phases_[id] == phase::MEASUREMENT) {
+    r.duration = clock::now() - start_times_[id];
+    auto& counter = counters_[id];
+    counter.read();
+    measured_[id] += counter.scale(perf::event_read_mode::RELATIVE).value;
+    r.instructions = measured_[id];
+  }
+  phases_[id] = phase::DONE;
+
+  if (completed && budget_action_ == budget_action::STOP) {
+    try {
+      util::suspend(processes_[id]->pid());
+    } catch (const std::exception& e) {
+      LOG(e.what());
+    }
+  }
+}
+
+template<typename Event>
+unsigned fixed_work_manager<Event>::find_bench_by_fd(int fd) const {
+  auto it = std::find_if(begin(counters_), end(counters_),
+      [&](const Event& e) { return e.fd() == fd; });
+  assert(it != end(counters_));
+  return it - begin(counters_);
+}
+
+template<typename Event>
+unsigned fixed_work_manager<Event>::find_bench_by_pid(pid_t pid) const {
+  auto it = std::find_if(begin(processes_), end(processes_),
+      [&](const process_ptr& p) { return p->pid() == pid; });
+  assert(it != end(processes_));
+  return it - begin(processes_);
+}
+
+template<typename Event>
+typename fixed_work_manager<Event>::budget_action
+fixed_work_manager<Event>::parse_budget_action(const std::string& action) {
+  if (action == "continue")
+    return budget_action::CONTINUE;
+  if (action == "stop")
+    return budget_action::STOP;
+  throw std::invalid_argument(
+      boost::str(boost::format("Invalid budget action: %1%") % action));
+}
+
+} // namespace aser
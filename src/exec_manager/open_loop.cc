@@ -0,0 +1,220 @@
+#include "open_loop.h"
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+
+#include <core/process_monitor.h>
+#include <util/factory.h>
+#include <util/log.h>
+#include <util/parse.h>
+#include <util/process.h>
+#include <util/stats.h>
+
+namespace chrono = std::chrono;
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+util::registar<exec_manager, open_loop_manager, const pt::ptree&>
+  open_loop_manager_registar("open-loop");
+
+static double to_ms(open_loop_manager::clock::duration d) {
+  return chrono::duration<double, std::milli>(d).count();
+}
+
+open_loop_manager::open_loop_manager(const pt::ptree& properties)
+  : exec_manager(properties)
+  , benchs_(util::parse_vector<benchmark>(
+        properties.get_child("exec_manager.benchmarks")))
+  , slots_{properties.get<unsigned>("exec_manager.slots")}
+{
+  if (slots_ == 0)
+    throw std::invalid_argument("At least one slot is required");
+  if (benchs_.empty())
+    throw std::invalid_argument("At least one benchmark is required");
+
+  unsigned id = 0;
+  for (auto& b : benchs_)
+    b.id = id++;
+
+  for (auto& elem : properties.get_child("exec_manager.benchmarks")) {
+    isolated_times_.push_back(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::duration<double, std::milli>(
+            elem.second.get<double>("isolated_time", 0))));
+  }
+
+  auto& arrivals = properties.get_child("exec_manager.arrivals");
+  auto type = arrivals.get<std::string>("type");
+  if (type == "poisson")
+    generate_poisson_arrivals(arrivals);
+  else if (type == "trace")
+    read_trace_arrivals(arrivals);
+  else
+    throw std::invalid_argument(
+        boost::str(boost::format("Invalid arrival type: %1%") % type));
+
+  std::stable_sort(begin(arrivals_), end(arrivals_),
+      [](const arrival& a, const arrival& b) { return a.time < b.time; });
+
+  records_.resize(arrivals_.size());
+  for (size_t i = 0; i < arrivals_.size(); ++i)
+    records_[i].bench = arrivals_[i].bench;
+
+  running_.reserve(slots_);
+}
+
+void open_loop_manager::generate_poisson_arrivals(const pt::ptree& pt) {
+  auto rate = pt.get<double>("rate");
+  auto jobs = pt.get<unsigned>("jobs");
+  if (rate <= 0)
+    throw std::invalid_argument("Arrival rate must be positive");
+
+  std::mt19937_64 generator(pt.get<uint64_t>("seed", 0));
+  std::exponential_distribution<double> interarrival(rate);
+  std::uniform_int_distribution<unsigned> bench(0, benchs_.size() - 1);
+
+  double time = 0;
+  for (unsigned i = 0; i < jobs; ++i) {
+    time += interarrival(generator);
+    arrivals_.push_back({
+        chrono::duration_cast<chrono::nanoseconds>(
+            chrono::duration<double>(time)),
+        bench(generator)});
+  }
+}
+
+void open_loop_manager::read_trace_arrivals(const pt::ptree& pt) {
+  auto add_arrival = [&](double time, const std::string& name) {
+    arrivals_.push_back({
+        chrono::duration_cast<chrono::nanoseconds>(
+            chrono::duration<double, std::milli>(time)),
+        find_bench(name)});
+  };
+
+  auto file = pt.get_optional<std::string>("file");
+  if (file) {
+    // Each line contains the arrival time (in ms) and the benchmark name.
+    std::ifstream trace(*file);
+    if (!trace)
+      throw std::invalid_argument(
+          boost::str(boost::format("Cannot open trace %1%") % *file));
+    double time;
+    std::string name;
+    while (trace >> time >> name)
+      add_arrival(time, name);
+  } else {
+    for (auto& elem : pt.get_child("jobs")) {
+      add_arrival(
+          elem.second.get<double>("time"),
+          elem.second.get<std::string>("benchmark"));
+    }
+  }
+}
+
+unsigned open_loop_manager::find_bench(const std::string& name) const {
+  auto it = std::find_if(begin(benchs_), end(benchs_),
+      [&](const benchmark& b) { return b.name == name; });
+  if (it == end(benchs_))
+    throw std::invalid_argument(
+        boost::str(boost::format("Unknown benchmark: %1%") % name));
+  return it->id;
+}
+
+void open_loop_manager::start_impl() {
+  LOG(boost::format("Starting execution (%1% jobs)") % arrivals_.size());
+
+  process_monitor<process_type> monitor;
+
+  prepare_exec_monitor();
+  start_exec_monitor();
+
+  auto t0 = clock::now();
+  size_t next = 0;
+  size_t finished = 0;
+
+  while (finished < arrivals_.size()) {
+    auto now = clock::now();
+    for (; next < arrivals_.size() && t0 + arrivals_[next].time <= now;
+        ++next) {
+      records_[next].arrival = t0 + arrivals_[next].time;
+      queue_.push_back(next);
+    }
+
+    while (running_.size() < slots_ && !queue_.empty()) {
+      auto id = queue_.front();
+      queue_.pop_front();
+
+      LOG(boost::format("Launching job %1%") % id);
+      auto& bench = benchs_[records_[id].bench];
+      auto process = std::make_shared<process_type>(bench.args);
+      process->prepare();
+      notify_process_creation(process->pid());
+      monitor.add_process(process);
+      records_[id].start = clock::now();
+      process->start();
+      running_.push_back({id, std::move(process)});
+    }
+
+    // Block until either a job finishes or the next job arrives.
+    if (next < arrivals_.size()) {
+      auto res = monitor.wait_for_any(t0 + arrivals_[next].time - clock::now());
+      if (!res.first)
+        continue;
+      complete(res.second.first);
+    } else {
+      complete(monitor.wait_for_any().first);
+    }
+    ++finished;
+  }
+
+  execution_end();
+  stop_exec_monitor();
+
+  report();
+}
+
+void open_loop_manager::complete(pid_t pid) {
+  auto it = std::find_if(begin(running_), end(running_),
+      [&](const running_job& j) { return j.process->pid() == pid; });
+  assert(it != end(running_));
+
+  LOG(boost::format("Job %1% finished") % it->id);
+  records_[it->id].end = clock::now();
+  notify_process_exit(
+      pid,
+      it->process->termination_status(),
+      it->process->resource_usage());
+  std::swap(*it, running_.back());
+  running_.pop_back();
+}
+
+double open_loop_manager::slowdown(const job_record& record) const {
+  auto reference = isolated_times_[record.bench] > chrono::nanoseconds(0)
+    ? clock::duration(isolated_times_[record.bench])
+    : record.service_time();
+  if (reference == clock::duration::zero())
+    return 1;
+  return to_ms(record.end - record.arrival) / to_ms(reference);
+}
+
+void open_loop_manager::report() const {
+  std::vector<double> delays, service_times, slowdowns;
+  for (auto& r : records_) {
+    delays.push_back(to_ms(r.queueing_delay()));
+    service_times.push_back(to_ms(r.service_time()));
+    slowdowns.push_back(slowdown(r));
+  }
+
+  auto log_summary = [](const char* name, const util::summary& s) {
+    LOGI(boost::format("%1%: mean %2%, p50 %3%, p95 %4%, p99 %5%, max %6%")
+        % name % s.mean % s.p50 % s.p95 % s.p99 % s.max);
+  };
+
+  LOGI(boost::format("Jobs: %1%") % records_.size());
+  log_summary("Queueing delay (ms)", util::summarize(std::move(delays)));
+  log_summary("Service time (ms)", util::summarize(std::move(service_times)));
+  log_summary("Slowdown", util::summarize(std::move(slowdowns)));
+}
+
+} // namespace aser
@@ -0,0 +1,137 @@
+#ifndef EXEC_MANAGER_OPEN_LOOP_H_
+#define EXEC_MANAGER_OPEN_LOOP_H_
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <core/benchmark.h>
+#include <core/exec_manager.h>
+
+namespace aser {
+
+namespace util {
+class sync_process;
+}
+
+/** Open-loop execution manager.
+ *
+ * This execution manager launches a stream of jobs according to their
+ * arrival times, which are either generated by a Poisson process or read
+ * from a trace. Every job executes one of the configured benchmarks. At most
+ * a given number of jobs (slots) run at the same time; jobs arriving when
+ * all the slots are busy wait in a FIFO queue.
+ *
+ * For every job, the manager records the queueing delay, the service time
+ * and the slowdown. The slowdown uses the isolated execution time of the
+ * benchmark, if it is given in the configuration (isolated_time, in ms), or
+ * the service time otherwise. The execution finishes once every job has
+ * finished.
+ */
+class open_loop_manager : public exec_manager {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /** Timing information for a job. */
+  struct job_record {
+    /** Benchmark executed by the job. */
+    unsigned bench;
+
+    /** Time when the job arrived. */
+    clock::time_point arrival;
+
+    /** Time when the job started its execution. */
+    clock::time_point start;
+
+    /** Time when the job finished its execution. */
+    clock::time_point end;
+
+    clock::duration queueing_delay() const {
+      return start - arrival;
+    }
+
+    clock::duration service_time() const {
+      return end - start;
+    }
+  };
+
+  /** Constructor.
+   *
+   * @param properties Configuration properties.
+   */
+  open_loop_manager(const boost::property_tree::ptree& properties);
+
+  /** Returns the records for every job (in arrival order). */
+  const std::vector<job_record>& records() const {
+    return records_;
+  }
+
+  /** Returns the slowdown for a job.
+   *
+   * @param record The record for the job.
+   * @return The response time divided by the reference time for the job.
+   */
+  double slowdown(const job_record& record) const;
+
+private:
+  using process_type = util::sync_process;
+  using process_ptr = std::shared_ptr<process_type>;
+
+  /** A job arrival. */
+  struct arrival {
+    /** Time since the beginning of the execution. */
+    std::chrono::nanoseconds time;
+
+    /** Benchmark to execute. */
+    unsigned bench;
+  };
+
+  /** A job that is running. */
+  struct running_job {
+    unsigned id;
+    process_ptr process;
+  };
+
+  std::vector<benchmark> benchs_;
+
+  /** Isolated execution time for each benchmark (zero if unknown). */
+  std::vector<std::chrono::nanoseconds> isolated_times_;
+
+  /** Maximum number of jobs running at the same time. */
+  unsigned slots_;
+
+  /** Job arrivals, sorted by time. */
+  std::vector<arrival> arrivals_;
+
+  /** Jobs waiting for a slot. */
+  std::deque<unsigned> queue_;
+
+  /** Jobs currently running. */
+  std::vector<running_job> running_;
+
+  std::vector<job_record> records_;
+
+  void start_impl() final;
+
+  /** Records the termination of a job.
+   *
+   * @param pid The pid of the process executing the job.
+   */
+  void complete(pid_t pid);
+
+  /** Logs a summary of the execution. */
+  void report() const;
+
+  unsigned find_bench(const std::string& name) const;
+
+  void generate_poisson_arrivals(const boost::property_tree::ptree& pt);
+  void read_trace_arrivals(const boost::property_tree::ptree& pt);
+};
+
+} // namespace aser
+
+#endif // EXEC_MANAGER_OPEN_LOOP_H_
@@ -0,0 +1,346 @@
+#include "cache_partitioner.h"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include <core/exec_manager.h>
+#include <perf/event_dummy.h>
+#include <perf/event_linux.h>
+#include <perf/event_manager.h>
+#include <util/factory.h>
+#include <util/log.h>
+#include <util/proc.h>
+#include <util/resctrl.h>
+#include <util/topology.h>
+
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+util::registar<exec_monitor, cache_partitioner,
+    exec_manager&, const pt::ptree&>
+  cache_partitioner_registar("cache-partitioner");
+
+template<typename Impl>
+cache_partitioner::counter_factory cache_partitioner::make_counter_factory(
+    perf::event_info event) {
+  return [event](pid_t pid) {
+    // Readers must be copyable, so the manager is shared.
+    auto manager = std::make_shared<perf::event_manager<perf::event<Impl>>>(
+        std::vector<perf::event_info>{event}, pid, true);
+    return [manager] {
+      return manager->read_events(perf::event_read_mode::RELATIVE)[0].value;
+    };
+  };
+}
+
+/** Reads the ways of the cache, or the configured number of ways if cache
+ * allocation is not supported. */
+static util::l3_allocation_info read_allocation_info(
+    const pt::ptree& properties,
+    bool& enforce) {
+  auto root = properties.get<std::string>(
+      "exec_monitor.resctrl_root", "/sys/fs/resctrl");
+  auto ways = properties.get_optional<unsigned>("exec_monitor.ways");
+  try {
+    auto info = util::read_l3_allocation_info(root);
+    enforce = true;
+    if (ways)
+      info.ways = std::min(info.ways, *ways);
+    return info;
+  } catch (const std::runtime_error& e) {
+    if (!ways)
+      throw;
+    LOG(boost::format("%1%; partitions are only logged") % e.what());
+    enforce = false;
+    return util::l3_allocation_info{*ways, 1, {}};
+  }
+}
+
+cache_partitioner::cache_partitioner(
+    exec_manager& exec_manager,
+    const pt::ptree& properties)
+  : mrc_monitor(exec_manager, properties)
+  , solver_{{1, util::partition_algorithm::LOOKAHEAD, 0}}
+  , resctrl_root_{properties.get<std::string>(
+        "exec_monitor.resctrl_root", "/sys/fs/resctrl")}
+  , probe_period_{properties.get<unsigned>("exec_monitor.probe_period", 4)}
+  , probe_alpha_{properties.get<double>("exec_monitor.probe_alpha", 0.5)}
+{
+  auto source = properties.get<std::string>(
+      "exec_monitor.curve_source", "mrc");
+  if (source == "mrc")
+    source_ = curve_source::MRC;
+  else if (source == "probe")
+    source_ = curve_source::PROBE;
+  else
+    throw std::invalid_argument("Invalid curve source: " + source);
+
+  auto info = read_allocation_info(properties, enforce_);
+  ways_ = info.ways;
+  domains_ = info.domains;
+  min_ways_ = properties.get<unsigned>("exec_monitor.min_ways", info.min_ways);
+  solver_ = util::partition_solver({
+      ways_,
+      util::parse_partition_algorithm(properties.get<std::string>(
+          "exec_monitor.partition_algorithm", "lookahead")),
+      properties.get<double>("exec_monitor.hysteresis", 0.05)});
+
+  std::istringstream reserved(
+      properties.get<std::string>("exec_monitor.reserved_ways", ""));
+  unsigned ways;
+  while (reserved >> ways)
+    reserved_.push_back(ways);
+
+  auto sysfs_root = properties.get<std::string>(
+      "exec_monitor.sysfs_root", "/sys");
+  auto llc_size = properties.get<double>(
+      "exec_monitor.llc_size", util::llc_size(sysfs_root) / 1024.0) * 1024;
+  if (source_ == curve_source::MRC && llc_size <= 0)
+    throw std::invalid_argument("Unknown size of the last-level cache");
+  way_size_ = llc_size / ways_;
+
+  if (source_ == curve_source::PROBE) {
+    disable_sampling();
+
+    using namespace perf;
+    auto name = properties.get<std::string>("exec_monitor.event", "linux");
+    event_info event {
+      event_type::HARDWARE,
+      create_generic_events(name).cache_misses,
+      event_modifiers::EXCLUDE_NONE};
+    if (name == "dummy")
+      counter_factory_ = make_counter_factory<event_dummy_impl>(event);
+#ifdef __linux__
+    else
+      counter_factory_ = make_counter_factory<event_linux_impl>(event);
+#endif
+  }
+
+  register_event_handler(
+      exec_event::event_type::PROCESS_CREATED,
+      [&](const exec_event& event) {
+        add_process(event.pid);
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_EXITED,
+      [&](const exec_event& event) {
+        if (event.pid == event.root)
+          remove_process(event.pid);
+      });
+}
+
+void cache_partitioner::loop_impl() {
+  if (source_ == curve_source::MRC) {
+    mrc_monitor::loop_impl();
+    mrc_requests();
+  } else {
+    std::this_thread::sleep_for(sampling_interval_);
+    probe_requests();
+  }
+
+  if (partitions_.empty())
+    return;
+
+  try {
+    if (solver_.solve(requests_, allocation_)) {
+      std::ostringstream ways;
+      for (size_t i = 0; i < partitions_.size(); ++i)
+        ways << " " << partitions_[i].pid << ":" << allocation_[i];
+      LOG(boost::format("New cache partition (process:ways):%1%")
+          % ways.str());
+    }
+  } catch (const std::invalid_argument& e) {
+    LOG(boost::format("Error partitioning the cache: %1%") % e.what());
+    return;
+  }
+
+  auto allocation = allocation_;
+  if (source_ == curve_source::PROBE
+      && probe_period_ > 0
+      && ++intervals_ % probe_period_ == 0)
+    probe(allocation);
+
+  if (allocation != applied_)
+    apply(allocation);
+}
+
+void cache_partitioner::mrc_requests() {
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    auto pid = partitions_[i].pid;
+    auto& misses = requests_[i].misses;
+    if (!curve(pid, curve_) || curve_.empty()) {
+      std::fill(begin(misses), end(misses), 0);
+      continue;
+    }
+
+    // Misses with a cache of a given number of bins, interpolating
+    // between points (there are no hits without cache).
+    auto accesses = static_cast<double>(samples(pid));
+    for (unsigned w = 0; w <= ways_; ++w) {
+      auto bins = w * way_size_ / bin_size();
+      auto bin = static_cast<size_t>(bins);
+      double ratio;
+      if (bin >= curve_.size()) {
+        ratio = curve_.back();
+      } else {
+        auto low = bin == 0 ? 1.0 : curve_[bin - 1];
+        ratio = low + (curve_[bin] - low) * (bins - bin);
+      }
+      misses[w] = accesses * ratio;
+    }
+  }
+}
+
+void cache_partitioner::probe_requests() {
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    auto& p = partitions_[i];
+    if (!p.counters || i >= applied_.size())
+      continue;
+
+    auto measured = p.counters();
+    auto& probed = p.probed[applied_[i]];
+    probed = probed < 0
+      ? measured
+      : probe_alpha_ * measured + (1 - probe_alpha_) * probed;
+  }
+
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    auto& probed = partitions_[i].probed;
+    auto& misses = requests_[i].misses;
+
+    // Interpolates between the allocations measured (flat beyond them).
+    int prev = -1;
+    for (unsigned w = 0; w <= ways_; ++w) {
+      if (probed[w] < 0)
+        continue;
+      for (auto u = prev + 1; u < static_cast<int>(w); ++u) {
+        misses[u] = prev < 0
+          ? probed[w]
+          : probed[prev] + (probed[w] - probed[prev]) * (u - prev) / (w - prev);
+      }
+      misses[w] = probed[w];
+      prev = w;
+    }
+    for (auto u = prev + 1; u <= static_cast<int>(ways_); ++u)
+      misses[u] = prev < 0 ? 0 : probed[prev];
+
+    // More ways never add misses.
+    for (unsigned w = 1; w <= ways_; ++w)
+      misses[w] = std::min(misses[w], misses[w - 1]);
+  }
+}
+
+void cache_partitioner::probe(std::vector<unsigned>& allocation) {
+  auto n = static_cast<unsigned>(partitions_.size());
+  if (n < 2)
+    return;
+
+  auto p = probe_cursor_;
+  probe_cursor_ = (probe_cursor_ + 1) % n;
+  if (probe_cursor_ == 0)
+    probe_up_ = !probe_up_;
+  if (requests_[p].reserved_ways > 0)
+    return;
+
+  // The way comes from the process with the most ways, or goes to the
+  // process with the fewest.
+  auto other = n;
+  for (unsigned q = 0; q < n; ++q) {
+    if (q == p || requests_[q].reserved_ways > 0)
+      continue;
+    if (probe_up_ ? allocation[q] > requests_[q].min_ways
+          && (other == n || allocation[q] > allocation[other])
+        : other == n || allocation[q] < allocation[other])
+      other = q;
+  }
+  if (other == n)
+    return;
+
+  if (probe_up_) {
+    ++allocation[p];
+    --allocation[other];
+  } else if (allocation[p] > requests_[p].min_ways) {
+    --allocation[p];
+    ++allocation[other];
+  }
+}
+
+void cache_partitioner::apply(const std::vector<unsigned>& allocation) {
+  // Partitions are laid out in order, as ways must be contiguous.
+  unsigned first = 0;
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    auto& p = partitions_[i];
+    if (!p.group.empty() && allocation[i] > 0) {
+      try {
+        util::set_l3_ways(p.group, domains_, first, allocation[i]);
+      } catch (const std::exception& e) {
+        LOG(boost::format("Error partitioning the cache for process %1%: "
+              "%2%") % p.pid % e.what());
+      }
+    }
+    first += allocation[i];
+  }
+  applied_ = allocation;
+}
+
+void cache_partitioner::add_process(pid_t pid) {
+  auto reserved = created_ < reserved_.size() ? reserved_[created_] : 0;
+  ++created_;
+
+  partitioned_process p{
+    pid, "", nullptr, std::vector<double>(ways_ + 1, -1)};
+  if (enforce_) {
+    p.group = resctrl_root_ + "/aser-" + std::to_string(pid);
+    try {
+      util::create_resctrl_group(p.group);
+      // Tasks created afterwards inherit the group.
+      for (auto tid : util::threads(pid))
+        util::add_to_resctrl_group(p.group, tid);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error creating the resctrl group for process %1%: "
+            "%2%") % pid % e.what());
+    }
+  }
+  if (counter_factory_) {
+    try {
+      p.counters = counter_factory_(pid);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error attaching counters to process %1%: %2%")
+          % pid % e.what());
+    }
+  }
+
+  partitions_.push_back(std::move(p));
+  requests_.push_back({std::vector<double>(ways_ + 1, 0), min_ways_, reserved});
+  // The solver starts from scratch, as the current allocation does not
+  // cover the new process.
+  allocation_.clear();
+}
+
+void cache_partitioner::remove_process(pid_t pid) {
+  auto it = std::find_if(begin(partitions_), end(partitions_),
+      [pid](const partitioned_process& p) { return p.pid == pid; });
+  if (it == end(partitions_))
+    return;
+
+  auto i = it - begin(partitions_);
+  if (!it->group.empty()) {
+    try {
+      util::remove_resctrl_group(it->group);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error removing the resctrl group for process %1%: "
+            "%2%") % pid % e.what());
+    }
+  }
+  partitions_.erase(it);
+  requests_.erase(begin(requests_) + i);
+  if (i < static_cast<long>(allocation_.size()))
+    allocation_.erase(begin(allocation_) + i);
+  if (i < static_cast<long>(applied_.size()))
+    applied_.erase(begin(applied_) + i);
+}
+
+} // namespace aser
@@ -0,0 +1,147 @@
+#ifndef EXEC_MONITOR_CACHE_PARTITIONER_H_
+#define EXEC_MONITOR_CACHE_PARTITIONER_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <exec_monitor/mrc_monitor.h>
+#include <perf/event.h>
+#include <util/cache_partition.h>
+
+namespace aser {
+
+/** Execution monitor that partitions the last-level cache among processes.
+ *
+ * Every exec_monitor.sampling_length milliseconds, the ways of the cache
+ * are partitioned (see util::partition_solver) to minimize the total
+ * misses, with the algorithm in exec_monitor.partition_algorithm
+ * ("lookahead", the default, or "hull"). The allocation changes only if
+ * the misses drop by exec_monitor.hysteresis (0.05 by default).
+ *
+ * The misses of every process with every number of ways come from
+ * exec_monitor.curve_source:
+ *  - "mrc" (default): the miss ratio curves estimated online (see
+ *    mrc_monitor, whose options apply), scaled by the accesses sampled.
+ *  - "probe": the cache misses measured with every number of ways the
+ *    process has had (exec_monitor.event selects the implementation).
+ *    Every exec_monitor.probe_period intervals (4 by default), a process
+ *    gets a way more or less than the solver chooses, so that all the
+ *    allocations are explored. Misses for unexplored allocations are
+ *    interpolated.
+ *
+ * Every process gets at least exec_monitor.min_ways ways (the minimum of
+ * the hardware by default). exec_monitor.reserved_ways is a list of
+ * reservations, in order of process creation (e.g., "4 0 2"): a process
+ * with a reservation gets exactly those ways.
+ *
+ * Partitions are enforced through a resctrl group per process under
+ * exec_monitor.resctrl_root (/sys/fs/resctrl by default). If cache
+ * allocation is not supported and exec_monitor.ways is given, partitions
+ * are only logged. The size of the cache is exec_monitor.llc_size KB
+ * (read from sysfs by default).
+ */
+class cache_partitioner : public mrc_monitor {
+public:
+  cache_partitioner(
+      exec_manager& exec_manager,
+      const boost::property_tree::ptree& properties);
+
+  /** Returns the current allocation (ways per process, in order of
+   * creation). */
+  const std::vector<unsigned>& allocation() const noexcept {
+    return applied_;
+  }
+
+private:
+  enum class curve_source { MRC, PROBE };
+
+  /** Reads the misses of a process since the previous read. */
+  typedef std::function<double()> miss_reader;
+
+  /** Creates the counters for a process. */
+  typedef std::function<miss_reader(pid_t)> counter_factory;
+
+  struct partitioned_process {
+    pid_t pid;
+
+    /** Resource control group (empty if partitions are only logged). */
+    std::string group;
+
+    miss_reader counters;
+
+    /** Misses measured with every number of ways (negative if never
+     * measured). */
+    std::vector<double> probed;
+  };
+
+  curve_source source_;
+  util::partition_solver solver_;
+  unsigned ways_;
+  unsigned min_ways_;
+
+  /** Reserved ways, in order of process creation. */
+  std::vector<unsigned> reserved_;
+
+  /** Number of processes created. */
+  unsigned created_ { 0 };
+
+  /** Size of a way (bytes). */
+  double way_size_;
+
+  std::string resctrl_root_;
+  std::vector<unsigned> domains_;
+
+  /** Whether the partitions are enforced. */
+  bool enforce_;
+
+  unsigned probe_period_;
+  unsigned intervals_ { 0 };
+  unsigned probe_cursor_ { 0 };
+  bool probe_up_ { true };
+
+  /** Weight of the latest measurement of the misses. */
+  double probe_alpha_;
+
+  counter_factory counter_factory_;
+
+  /** Processes, in order of creation. */
+  std::vector<partitioned_process> partitions_;
+
+  std::vector<util::partition_request> requests_;
+
+  /** Allocation chosen by the solver, and allocation applied (which may
+   * differ while probing). */
+  std::vector<unsigned> allocation_;
+  std::vector<unsigned> applied_;
+
+  /** Curve being read (reused across intervals). */
+  std::vector<double> curve_;
+
+  void loop_impl() final;
+
+  void add_process(pid_t pid);
+  void remove_process(pid_t pid);
+
+  /** Computes the requests from the miss ratio curves. */
+  void mrc_requests();
+
+  /** Records the misses with the applied allocation, and computes the
+   * requests from the misses measured. */
+  void probe_requests();
+
+  /** Moves a way to or from a process, in turns. */
+  void probe(std::vector<unsigned>& allocation);
+
+  /** Enforces an allocation. */
+  void apply(const std::vector<unsigned>& allocation);
+
+  template<typename Impl>
+  static counter_factory make_counter_factory(perf::event_info event);
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_CACHE_PARTITIONER_H_
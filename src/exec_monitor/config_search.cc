@@ -0,0 +1,262 @@
+#include "config_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace aser {
+
+constexpr size_t config_search::none;
+
+search_strategy parse_search_strategy(const std::string& name) {
+  if (name == "hill-climbing")
+    return search_strategy::HILL_CLIMBING;
+  if (name == "ucb")
+    return search_strategy::UCB;
+  if (name == "thompson")
+    return search_strategy::THOMPSON;
+  throw std::invalid_argument("Invalid search strategy: " + name);
+}
+
+config_search::config_search(config cfg, const configuration& initial)
+  : config_(std::move(cfg))
+  , size_{1}
+  , gen_{config_.seed}
+{
+  if (config_.levels.empty())
+    throw std::invalid_argument("The configuration space has no dimensions");
+  for (auto levels : config_.levels) {
+    if (levels == 0)
+      throw std::invalid_argument("Every dimension needs a level");
+    // Arms are indexed by configuration, so the space must be enumerable.
+    if (size_ > (size_t(1) << 24) / levels)
+      throw std::invalid_argument("The configuration space is too large");
+    size_ *= levels;
+  }
+  if (config_.budget < 0 || config_.budget > 1)
+    throw std::invalid_argument("The exploration budget must be in [0, 1]");
+  if (config_.memory == 0)
+    throw std::invalid_argument("The memory must be positive");
+
+  applied_ = encode(initial);
+  state_ = &phases_.emplace(0, make_phase(applied_)).first->second;
+}
+
+size_t config_search::encode(const configuration& c) const {
+  if (c.size() != config_.levels.size())
+    throw std::invalid_argument("Invalid configuration");
+
+  size_t index = 0;
+  for (size_t d = 0; d < c.size(); ++d) {
+    if (c[d] >= config_.levels[d])
+      throw std::invalid_argument("Invalid configuration");
+    index = index * config_.levels[d] + c[d];
+  }
+  return index;
+}
+
+void config_search::decode(size_t index, configuration& c) const {
+  c.resize(config_.levels.size());
+  for (auto d = config_.levels.size(); d-- > 0;) {
+    c[d] = index % config_.levels[d];
+    index /= config_.levels[d];
+  }
+}
+
+config_search::phase_state config_search::make_phase(size_t start) const {
+  return phase_state{{}, start, 0, start, none, 0, 0, 0};
+}
+
+void config_search::set_phase(uint64_t phase) {
+  auto it = phases_.find(phase);
+  if (it == end(phases_))
+    it = phases_.emplace(phase, make_phase(state_->best)).first;
+  else if (&it->second == state_)
+    return;
+  state_ = &it->second;
+  pending_ = false;
+}
+
+bool config_search::reward(const configuration& c, double& reward) const {
+  auto it = state_->arms.find(encode(c));
+  if (it == end(state_->arms))
+    return false;
+  reward = it->second.mean;
+  return true;
+}
+
+config_search::configuration config_search::best() const {
+  configuration c;
+  decode(state_->best, c);
+  return c;
+}
+
+void config_search::record(double reward) {
+  auto& s = *state_;
+  auto res = s.arms.emplace(applied_, arm{0, 0, 0});
+  auto& a = res.first->second;
+
+  // Exponentially weighted mean and variance, with plain averages for the
+  // first measurements.
+  ++a.count;
+  auto weight = 1.0 / std::min(a.count, config_.memory);
+  auto delta = reward - a.mean;
+  a.mean += weight * delta;
+  a.variance = (1 - weight) * (a.variance + weight * delta * delta);
+  ++s.measurements;
+
+  s.best = applied_;
+  for (auto& b : s.arms) {
+    if (b.second.mean > s.arms.at(s.best).mean)
+      s.best = b.first;
+  }
+
+  // Hill climbing moves to the neighbor tried if it improves.
+  if (applied_ == s.probe && s.probe != s.current) {
+    auto current = s.arms.find(s.current);
+    if (current == end(s.arms)
+        || a.mean > current->second.mean
+          + std::abs(current->second.mean) * config_.min_gain) {
+      s.current = s.probe;
+      s.tried = 0;
+      s.cursor = gen_();
+    } else {
+      ++s.tried;
+    }
+    s.probe = none;
+  }
+}
+
+const config_search::configuration& config_search::step(double reward) {
+  if (pending_ && !std::isnan(reward))
+    record(reward);
+
+  auto next = state_->best;
+  exploring_ = false;
+  tokens_ = std::min(1.0, tokens_ + config_.budget);
+  if (tokens_ >= 1) {
+    auto candidate = choose();
+    if (candidate != state_->best) {
+      next = candidate;
+      exploring_ = true;
+      tokens_ -= 1;
+    }
+  }
+
+  applied_ = next;
+  pending_ = true;
+  decode(next, next_);
+  return next_;
+}
+
+size_t config_search::choose() {
+  switch (config_.strategy) {
+  case search_strategy::HILL_CLIMBING:
+    return choose_hill_climbing();
+  case search_strategy::UCB:
+    return choose_ucb();
+  case search_strategy::THOMPSON:
+    return choose_thompson();
+  }
+  return state_->best;
+}
+
+void config_search::find_neighbors(size_t index) {
+  neighbors_.clear();
+  size_t stride = 1;
+  for (auto d = config_.levels.size(); d-- > 0;) {
+    auto level = (index / stride) % config_.levels[d];
+    if (level > 0)
+      neighbors_.push_back(index - stride);
+    if (level + 1 < config_.levels[d])
+      neighbors_.push_back(index + stride);
+    stride *= config_.levels[d];
+  }
+}
+
+size_t config_search::choose_hill_climbing() {
+  auto& s = *state_;
+  if (s.arms.count(s.current) == 0) {
+    s.probe = s.current;
+    return s.current;
+  }
+
+  find_neighbors(s.current);
+  if (s.tried >= neighbors_.size()) {
+    // Local optimum (the best configuration is kept, so restarting only
+    // costs explorations).
+    s.current = std::uniform_int_distribution<size_t>(0, size_ - 1)(gen_);
+    s.tried = 0;
+    s.cursor = gen_();
+    s.probe = s.current;
+    return s.current;
+  }
+
+  s.probe = neighbors_[(s.cursor + s.tried) % neighbors_.size()];
+  return s.probe;
+}
+
+size_t config_search::next_untried() {
+  auto& s = *state_;
+  if (s.arms.size() >= size_)
+    return none;
+  while (s.arms.count(s.untried) > 0)
+    s.untried = (s.untried + 1) % size_;
+  return s.untried;
+}
+
+double config_search::scale() const {
+  double scale = 0;
+  for (auto& a : state_->arms)
+    scale = std::max(scale, std::abs(a.second.mean));
+  return scale > 0 ? scale : 1;
+}
+
+size_t config_search::choose_ucb() {
+  auto untried = next_untried();
+  if (untried != none)
+    return untried;
+
+  auto& s = *state_;
+  auto weight = config_.exploration * scale();
+  auto log_total = std::log(static_cast<double>(s.measurements));
+  auto best = s.best;
+  auto best_bound = -std::numeric_limits<double>::infinity();
+  for (auto& a : s.arms) {
+    auto bound = a.second.mean
+      + weight * std::sqrt(log_total / std::min(a.second.count, config_.memory));
+    if (bound > best_bound) {
+      best = a.first;
+      best_bound = bound;
+    }
+  }
+  return best;
+}
+
+size_t config_search::choose_thompson() {
+  auto& s = *state_;
+  std::normal_distribution<double> normal;
+  auto prior_sd = scale();
+
+  auto best = s.best;
+  auto best_draw = -std::numeric_limits<double>::infinity();
+  double mean = 0;
+  for (auto& a : s.arms) {
+    auto n = std::min(a.second.count, config_.memory);
+    auto sd = n < 2 ? prior_sd : std::sqrt(a.second.variance);
+    auto draw = a.second.mean + normal(gen_) * sd / std::sqrt(n);
+    if (draw > best_draw) {
+      best = a.first;
+      best_draw = draw;
+    }
+    mean += a.second.mean / s.arms.size();
+  }
+
+  // A single draw stands for all the untried configurations.
+  if (s.arms.size() < size_ && mean + normal(gen_) * prior_sd > best_draw)
+    best = next_untried();
+  return best;
+}
+
+} // namespace aser
@@ -0,0 +1,220 @@
+#ifndef EXEC_MONITOR_CONFIG_SEARCH_H_
+#define EXEC_MONITOR_CONFIG_SEARCH_H_
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace aser {
+
+/** Strategies to search a configuration space.
+ *
+ * HILL_CLIMBING: neighbors of the current configuration (one level up or
+ * down in a single dimension) are tried in turns, and the search moves to
+ * the first one that improves the reward by min_gain. Once no neighbor
+ * improves, the search restarts from a random configuration. Suited to
+ * large spaces, as it only measures a path through the space.
+ *
+ * UCB: every configuration is an arm of a bandit. Arms are tried once,
+ * and then the arm with the highest upper confidence bound (UCB1) is
+ * chosen.
+ *
+ * THOMPSON: the arm with the highest reward drawn from the (Gaussian)
+ * posterior of every arm is chosen. Untried arms share a prior centered on
+ * the mean of the tried arms, so they do not need to be tried once.
+ */
+enum class search_strategy { HILL_CLIMBING, UCB, THOMPSON };
+
+/** Parses the name of a search strategy ("hill-climbing", "ucb" or
+ * "thompson").
+ *
+ * @throw std::invalid_argument If the name is not valid.
+ */
+search_strategy parse_search_strategy(const std::string& name);
+
+/** Online search of a discrete configuration space.
+ *
+ * A configuration has a level for every dimension (e.g., the number of
+ * CPUs or cache ways). On every interval, the search gets the reward of
+ * the configuration applied during the interval, and it returns the
+ * configuration to apply next: either the best one known (exploitation) or
+ * one chosen by the strategy (exploration). Exploration is budgeted: at
+ * most a fraction of the intervals explore, so that the workload mostly
+ * runs with the best configuration known.
+ *
+ * Rewards are averaged over the last measurements of every configuration
+ * (exponentially weighted), so that the search follows slow changes.
+ * Workloads with distinct phases keep separate search states: once a phase
+ * comes back, its search resumes where it left off.
+ */
+class config_search {
+public:
+  /** Level of every dimension. */
+  typedef std::vector<unsigned> configuration;
+
+  struct config {
+    /** Number of levels of every dimension. */
+    std::vector<unsigned> levels;
+
+    search_strategy strategy;
+
+    /** Maximum fraction of the intervals spent exploring. */
+    double budget;
+
+    /** Minimum relative improvement for hill climbing to move. */
+    double min_gain;
+
+    /** Weight of the confidence bound in UCB, relative to the magnitude
+     * of the rewards. */
+    double exploration;
+
+    /** Number of measurements averaged for every configuration (the
+     * weight of a new measurement is at least 1 / memory). */
+    unsigned memory;
+
+    unsigned seed;
+  };
+
+  /** Constructor.
+   *
+   * @param cfg Configuration of the search.
+   * @param initial Configuration applied before the first interval.
+   * @throw std::invalid_argument If the space is empty or too large, or
+   *     the initial configuration is not in the space.
+   */
+  config_search(config cfg, const configuration& initial);
+
+  /** Switches to another phase.
+   *
+   * The reward of the interval in progress is discarded, as it mixes both
+   * phases. A new phase starts from the best configuration of the
+   * previous one.
+   *
+   * @param phase Phase identifier.
+   */
+  void set_phase(uint64_t phase);
+
+  /** Advances the search by one interval.
+   *
+   * @param reward Reward of the configuration returned by the previous call
+   *     (or the initial configuration); higher is better. NaN if the
+   *     interval was not measured, in which case nothing is recorded.
+   * @return The configuration to apply during the next interval.
+   */
+  const configuration& step(double reward);
+
+  /** Returns the best configuration known in the current phase. */
+  configuration best() const;
+
+  /** Returns whether the last configuration returned explores. */
+  bool exploring() const noexcept {
+    return exploring_;
+  }
+
+  /** Returns the mean reward of a configuration in the current phase.
+   *
+   * @param c The configuration.
+   * @param reward Where to store the mean reward.
+   * @return True if the configuration has been measured; false otherwise.
+   */
+  bool reward(const configuration& c, double& reward) const;
+
+  /** Returns the number of phases seen. */
+  size_t phases() const noexcept {
+    return phases_.size();
+  }
+
+  /** Returns the number of configurations in the space. */
+  size_t size() const noexcept {
+    return size_;
+  }
+
+private:
+  /** Index that marks no configuration. */
+  static constexpr size_t none = static_cast<size_t>(-1);
+
+  /** Measurements of a configuration. */
+  struct arm {
+    unsigned count;
+    double mean;
+    double variance;
+  };
+
+  struct phase_state {
+    /** Measured configurations, by index. */
+    std::unordered_map<size_t, arm> arms;
+
+    /** Configuration with the highest mean reward. */
+    size_t best;
+
+    /** Total number of measurements. */
+    unsigned measurements;
+
+    /** Current configuration of hill climbing, and neighbor being tried. */
+    size_t current;
+    size_t probe;
+
+    /** Neighbors of the current configuration tried without improvement,
+     * and the first neighbor tried. */
+    unsigned tried;
+    unsigned cursor;
+
+    /** Next index to look for an untried configuration. */
+    size_t untried;
+  };
+
+  config config_;
+  size_t size_;
+
+  std::map<uint64_t, phase_state> phases_;
+  phase_state* state_;
+
+  /** Configuration applied during the current interval. */
+  size_t applied_;
+
+  /** Whether the reward of the current interval is recorded. */
+  bool pending_ { false };
+
+  bool exploring_ { false };
+
+  /** Explorations available (one is spent on every exploration). */
+  double tokens_ { 0 };
+
+  std::mt19937_64 gen_;
+
+  /** Scratch space, reused across calls. */
+  configuration next_;
+  std::vector<size_t> neighbors_;
+
+  size_t encode(const configuration& c) const;
+  void decode(size_t index, configuration& c) const;
+
+  phase_state make_phase(size_t start) const;
+
+  /** Records a measurement of the applied configuration. */
+  void record(double reward);
+
+  /** Returns the configuration to explore. */
+  size_t choose();
+
+  size_t choose_hill_climbing();
+  size_t choose_ucb();
+  size_t choose_thompson();
+
+  /** Returns the next configuration that has never been measured, or none.
+   */
+  size_t next_untried();
+
+  /** Returns the magnitude of the mean rewards (one if unknown). */
+  double scale() const;
+
+  /** Fills neighbors_ with the neighbors of a configuration. */
+  void find_neighbors(size_t index);
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_CONFIG_SEARCH_H_
@@ -0,0 +1,489 @@
+#include "config_searcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <core/exec_manager.h>
+#include <perf/event_dummy.h>
+#include <perf/event_linux.h>
+#include <perf/event_manager.h>
+#include <util/factory.h>
+#include <util/log.h>
+#include <util/numa.h>
+#include <util/os.h>
+#include <util/power.h>
+#include <util/resctrl.h>
+
+namespace chrono = std::chrono;
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+util::registar<exec_monitor, config_searcher,
+    exec_manager&, const pt::ptree&>
+  config_searcher_registar("config-search");
+
+template<typename Impl>
+config_searcher::counter_factory config_searcher::make_counter_factory(
+    std::vector<perf::event_info> events) {
+  return [events](pid_t pid) {
+    // Readers must be copyable, so the manager is shared.
+    auto manager = std::make_shared<perf::event_manager<perf::event<Impl>>>(
+        events, pid, true);
+    return [manager] {
+      auto& samples = manager->read_events(perf::event_read_mode::RELATIVE);
+      return search_counts{
+        samples[0].value,
+        samples[1].value,
+        samples.size() > 2 ? samples[2].value : 0};
+    };
+  };
+}
+
+/** Reads a list of levels (empty if not given). */
+static std::vector<unsigned> read_levels(
+    const pt::ptree& properties,
+    const std::string& key) {
+  std::istringstream in(properties.get<std::string>(key, ""));
+  std::vector<unsigned> levels;
+  unsigned level;
+  while (in >> level)
+    levels.push_back(level);
+  std::sort(begin(levels), end(levels));
+  levels.erase(std::unique(begin(levels), end(levels)), end(levels));
+  return levels;
+}
+
+/** Returns the given fractions of a maximum value, rounded up to a
+ * granularity and not below a minimum. */
+static std::vector<unsigned> fractions(
+    unsigned max,
+    unsigned min,
+    unsigned granularity,
+    std::initializer_list<double> parts) {
+  std::vector<unsigned> levels;
+  for (auto part : parts) {
+    auto value = static_cast<unsigned>(std::ceil(max * part / granularity))
+      * granularity;
+    levels.push_back(std::min(max, std::max(min, value)));
+  }
+  levels.erase(std::unique(begin(levels), end(levels)), end(levels));
+  return levels;
+}
+
+void config_searcher::create_knobs(const pt::ptree& properties) {
+  auto resctrl_root = properties.get<std::string>(
+      "exec_monitor.resctrl_root", "/sys/fs/resctrl");
+
+  std::istringstream names(
+      properties.get<std::string>("exec_monitor.knobs", "cpus"));
+  std::string name;
+  while (names >> name) {
+    knob k{name, {}, nullptr};
+
+    if (name == "cpus") {
+      k.values = read_levels(properties, "exec_monitor.cpu_levels");
+      if (k.values.empty()) {
+        for (auto n = static_cast<unsigned>(cpus_.size()); n > 0; n /= 2)
+          k.values.insert(begin(k.values), n);
+      }
+      if (k.values.back() > cpus_.size())
+        throw std::invalid_argument("Not enough CPUs for the CPU levels");
+      k.apply = [this](unsigned cpus) {
+        num_cpus_ = cpus;
+        for (auto& a : apps_)
+          bind_application(a.second);
+      };
+    } else if (name == "cache") {
+      auto info = util::read_l3_allocation_info(resctrl_root);
+      k.values = read_levels(properties, "exec_monitor.cache_levels");
+      if (k.values.empty())
+        k.values = fractions(info.ways, info.min_ways, 1, {.25, .5, .75, 1});
+      if (k.values.front() == 0 || k.values.back() > info.ways)
+        throw std::invalid_argument("Invalid cache levels");
+      k.apply = [this, info](unsigned ways) {
+        util::set_l3_ways(group_, info.domains, 0, ways);
+      };
+    } else if (name == "bandwidth") {
+      auto info = util::read_mb_allocation_info(resctrl_root);
+      k.values = read_levels(properties, "exec_monitor.bandwidth_levels");
+      if (k.values.empty()) {
+        k.values = fractions(100, info.min_bandwidth, info.granularity,
+            {.25, .5, .75, 1});
+      }
+      if (k.values.front() == 0 || k.values.back() > 100)
+        throw std::invalid_argument("Invalid bandwidth levels");
+      k.apply = [this, info](unsigned bandwidth) {
+        util::set_mb_throttle(group_, info.domains, bandwidth);
+      };
+    } else if (name == "frequency") {
+      k.values = read_levels(properties, "exec_monitor.frequency_levels");
+      if (k.values.empty()) {
+        auto available = util::cpu_frequencies(sysfs_root_, cpus_[0]);
+        if (available.empty())
+          throw std::invalid_argument("Frequency scaling is not supported");
+        for (size_t i = 0; i < 4; ++i) {
+          k.values.push_back(
+              available[(available.size() - 1) * i / 3]);
+        }
+        k.values.erase(
+            std::unique(begin(k.values), end(k.values)), end(k.values));
+      }
+      for (auto cpu : cpus_)
+        saved_frequencies_.push_back(util::max_frequency(sysfs_root_, cpu));
+      k.apply = [this](unsigned frequency) {
+        for (auto cpu : cpus_)
+          util::set_max_frequency(sysfs_root_, cpu, frequency);
+      };
+    } else {
+      throw std::invalid_argument("Invalid knob: " + name);
+    }
+
+    if (k.values.empty())
+      throw std::invalid_argument("No levels for knob " + name);
+    if ((name == "cache" || name == "bandwidth") && group_.empty()) {
+      group_ = resctrl_root + "/aser-search";
+      util::create_resctrl_group(group_);
+    }
+    knobs_.push_back(std::move(k));
+  }
+
+  if (knobs_.empty())
+    throw std::invalid_argument("No knobs to search");
+}
+
+config_searcher::config_searcher(
+    exec_manager& exec_manager,
+    const pt::ptree& properties)
+  : exec_monitor(exec_manager)
+  , sampling_interval_{
+        chrono::milliseconds(properties.get<unsigned>(
+            "exec_monitor.sampling_length"))}
+  , cgroup_root_{application::cgroup_root(properties)}
+  , sysfs_root_{properties.get<std::string>("exec_monitor.sysfs_root", "/sys")}
+  , refresh_{!properties.get<bool>("exec_manager.process_events", false)}
+{
+  auto list = properties.get<std::string>("exec_monitor.cpus", "");
+  cpus_ = list.empty() ? util::allowed_cpus() : util::parse_cpu_list(list);
+  std::sort(begin(cpus_), end(cpus_));
+  if (cpus_.empty())
+    throw std::invalid_argument("No CPUs available");
+  num_cpus_ = cpus_.size();
+
+  create_knobs(properties);
+
+  config_search::config search_config;
+  for (auto& k : knobs_) {
+    search_config.levels.push_back(k.values.size());
+    applied_.push_back(k.values.size() - 1);
+  }
+  search_config.strategy = parse_search_strategy(
+      properties.get<std::string>("exec_monitor.search", "hill-climbing"));
+  search_config.budget = properties.get<double>(
+      "exec_monitor.search_budget", 0.2);
+  search_config.min_gain = properties.get<double>(
+      "exec_monitor.search_min_gain", 0.02);
+  search_config.exploration = properties.get<double>(
+      "exec_monitor.ucb_exploration", 1);
+  search_config.memory = properties.get<unsigned>(
+      "exec_monitor.search_memory", 8);
+  search_config.seed = properties.get<unsigned>(
+      "exec_monitor.search_seed", std::random_device()());
+  search_ = std::make_unique<config_search>(search_config, applied_);
+
+  auto objective = properties.get_child(
+      "exec_monitor.objective", pt::ptree());
+  objective_ = util::create<search_objective>(
+      objective.get<std::string>("type", "weighted-speedup"),
+      static_cast<const pt::ptree&>(objective));
+
+  for (size_t i = 0; i < knobs_.size(); ++i) {
+    try {
+      knobs_[i].apply(knobs_[i].values[applied_[i]]);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error applying %1%: %2%") % knobs_[i].name
+          % e.what());
+    }
+  }
+
+  auto predictor = properties.get_optional<std::string>(
+      "exec_monitor.phase_detection");
+  if (predictor) {
+    phase_detector::config phase_config;
+    phase_config.max_phases = properties.get<unsigned>(
+        "exec_monitor.phase_table_size", 16);
+    phase_config.threshold = properties.get<double>(
+        "exec_monitor.phase_threshold", 0.15);
+    phase_config.histogram_weight = 0;
+    phase_config.memory = 16;
+    phase_config.min_run = properties.get<unsigned>(
+        "exec_monitor.phase_min_run", 2);
+    phase_config.predictor = parse_phase_predictor(*predictor);
+    phase_config.max_run_length = 64;
+    // Invalid settings are reported before any application starts.
+    phase_detector{phase_config};
+    phase_config_ = std::make_unique<phase_detector::config>(phase_config);
+  }
+
+  using namespace perf;
+  auto name = properties.get<std::string>("exec_monitor.event", "linux");
+  auto generic = create_generic_events(name);
+  std::vector<event_info> events = {
+    {event_type::HARDWARE, generic.cycles, event_modifiers::EXCLUDE_NONE},
+    {event_type::HARDWARE, generic.instructions,
+      event_modifiers::EXCLUDE_NONE}
+  };
+  if (phase_config_) {
+    events.push_back({event_type::HARDWARE, generic.cache_misses,
+        event_modifiers::EXCLUDE_NONE});
+  }
+  if (name == "dummy")
+    counter_factory_ = make_counter_factory<event_dummy_impl>(events);
+#ifdef __linux__
+  else
+    counter_factory_ = make_counter_factory<event_linux_impl>(events);
+#endif
+
+  register_event_handler(
+      exec_event::event_type::PROCESS_CREATED,
+      [&](const exec_event& event) {
+        add_process(event.pid);
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_EXITED,
+      [&](const exec_event& event) {
+        if (event.pid == event.root)
+          remove_process(event.pid);
+        else if (apps_.count(event.root) > 0)
+          apps_.at(event.root).app.remove_process(event.pid);
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_FORKED,
+      [&](const exec_event& event) {
+        add_task(event.root, event.pid, true);
+      });
+  register_event_handler(
+      exec_event::event_type::THREAD_CREATED,
+      [&](const exec_event& event) {
+        add_task(event.root, event.payload.thread.tid, false);
+      });
+  register_event_handler(
+      exec_event::event_type::THREAD_EXITED,
+      [&](const exec_event& event) {
+        if (apps_.count(event.root) > 0)
+          apps_.at(event.root).app.remove_thread(event.payload.thread.tid);
+      });
+  register_event_handler(
+      exec_event::event_type::PHASE_CHANGED,
+      [&](const exec_event& event) {
+        auto it = apps_.find(event.root);
+        if (it == end(apps_))
+          return;
+        it->second.phase = event.payload.phase.phase;
+        update_phase();
+      });
+}
+
+config_searcher::~config_searcher() {
+  for (size_t i = 0; i < saved_frequencies_.size(); ++i) {
+    if (saved_frequencies_[i] == 0)
+      continue;
+    try {
+      util::set_max_frequency(sysfs_root_, cpus_[i], saved_frequencies_[i]);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error restoring the frequency of CPU %1%: %2%")
+          % cpus_[i] % e.what());
+    }
+  }
+
+  if (group_.empty())
+    return;
+  try {
+    util::remove_resctrl_group(group_);
+  } catch (const std::exception& e) {
+    LOG(boost::format("Error removing the resctrl group: %1%") % e.what());
+  }
+}
+
+void config_searcher::loop_impl() {
+  std::this_thread::sleep_for(sampling_interval_);
+
+  double energy = -1;
+  if (objective_->needs_energy()) {
+    auto now = util::package_energy(sysfs_root_);
+    if (now >= 0 && energy_ >= 0 && now >= energy_)
+      energy = now - energy_;
+    energy_ = now;
+  }
+
+  if (apps_.empty())
+    return;
+
+  auto seconds = chrono::duration<double>(sampling_interval_).count();
+  sample_.rate.clear();
+  sample_.reference_rate.clear();
+  sample_.instructions = 0;
+  sample_.energy = energy;
+  for (auto& a : apps_) {
+    auto& sa = a.second;
+    auto counts = sa.counters ? sa.counters() : search_counts{0, 0, 0};
+    auto rate = counts.instructions / seconds;
+    sa.reference_rate = std::max(sa.reference_rate, rate);
+    sample_.rate.push_back(rate);
+    sample_.reference_rate.push_back(sa.reference_rate);
+    sample_.instructions += counts.instructions;
+
+    if (counts.cycles > 0) {
+      process_metrics metrics;
+      metrics.ipc = counts.instructions / counts.cycles;
+      publish_metrics(a.first, metrics);
+    }
+
+    if (sa.detector && counts.instructions > 0)
+      detect_phase(a.first, sa, counts);
+  }
+
+  auto& next = search_->step(objective_->evaluate(sample_));
+  if (next != applied_)
+    apply(next);
+}
+
+void config_searcher::apply(const config_search::configuration& levels) {
+  std::ostringstream values;
+  for (size_t i = 0; i < knobs_.size(); ++i)
+    values << " " << knobs_[i].name << "=" << knobs_[i].values[levels[i]];
+  LOG(boost::format("%1% configuration:%2%")
+      % (search_->exploring() ? "Exploring" : "Applying") % values.str());
+
+  for (size_t i = 0; i < knobs_.size(); ++i) {
+    if (levels[i] == applied_[i])
+      continue;
+    try {
+      knobs_[i].apply(knobs_[i].values[levels[i]]);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error applying %1%: %2%") % knobs_[i].name
+          % e.what());
+    }
+  }
+  applied_ = levels;
+}
+
+void config_searcher::update_phase() {
+  std::vector<unsigned> phases;
+  for (auto& a : apps_)
+    phases.push_back(a.second.phase);
+  std::sort(begin(phases), end(phases));
+
+  // The phase of the workload is the multiset of the phases of the
+  // applications.
+  uint64_t phase = phases.size();
+  for (auto p : phases)
+    phase = phase * 0x100000001b3 ^ p;
+  search_->set_phase(phase);
+}
+
+void config_searcher::detect_phase(
+    pid_t pid,
+    searched_application& sa,
+    const search_counts& counts) {
+  auto& counters = sa.signature.counters;
+  counters[0] = counts.cycles / counts.instructions;
+  counters[1] = counts.cache_misses * 1000 / counts.instructions;
+
+  auto previous = sa.detector->phase();
+  auto phase = sa.detector->classify(sa.signature);
+  if (phase == previous)
+    return;
+
+  LOG_ASYNC("Process %1% entered phase %2% (predicted next: %3%)",
+      pid, phase, sa.detector->predict());
+
+  // The event is handled right away: this is the thread draining the event
+  // queue, so it cannot wait for room in it. The search switches to the
+  // phase before the step of this interval, whose reward mixes both phases.
+  exec_event event {exec_event::event_type::PHASE_CHANGED, pid, pid};
+  event.payload.phase.phase = phase;
+  event.payload.phase.previous = previous;
+  event_handler(event);
+}
+
+void config_searcher::add_process(pid_t pid) {
+  LOG(boost::format("Adding process %1%") % pid);
+  auto res = apps_.emplace(
+      pid,
+      searched_application{
+        application{pid, cgroup_root_}, nullptr, 0, 0, nullptr, {}});
+
+  auto& sa = res.first->second;
+  if (phase_config_) {
+    sa.detector = std::make_unique<phase_detector>(*phase_config_);
+    // Cycles per instruction and cache misses per kilo-instruction.
+    sa.signature.counters.resize(2);
+  }
+  try {
+    sa.counters = counter_factory_(pid);
+  } catch (const std::exception& e) {
+    LOG(boost::format("Error attaching counters to process %1%: %2%")
+        % pid % e.what());
+  }
+
+  if (!group_.empty()) {
+    // Tasks created afterwards inherit the group.
+    for (auto tid : sa.app.threads()) {
+      try {
+        util::add_to_resctrl_group(group_, tid);
+      } catch (const std::exception& e) {
+        LOG(boost::format("Error adding thread %1% to the resctrl group: "
+              "%2%") % tid % e.what());
+      }
+    }
+  }
+  bind_application(sa);
+  update_phase();
+}
+
+void config_searcher::remove_process(pid_t pid) {
+  auto it = apps_.find(pid);
+  if (it == end(apps_))
+    return;
+
+  LOG(boost::format("Removing process %1%") % pid);
+  apps_.erase(it);
+  update_phase();
+}
+
+void config_searcher::add_task(pid_t root, pid_t tid, bool process) {
+  auto it = apps_.find(root);
+  if (it == end(apps_))
+    return;
+
+  auto& sa = it->second;
+  if (process) {
+    for (auto t : sa.app.add_process(tid))
+      bind_thread(t);
+  } else if (sa.app.add_thread(tid)) {
+    bind_thread(tid);
+  }
+}
+
+void config_searcher::bind_application(searched_application& sa) {
+  if (refresh_)
+    sa.app.refresh();
+  for (auto tid : sa.app.threads())
+    bind_thread(tid);
+}
+
+void config_searcher::bind_thread(pid_t tid) {
+  try {
+    util::bind_process(tid, std::vector<unsigned>(
+          begin(cpus_), begin(cpus_) + num_cpus_));
+  } catch (const std::exception& e) {
+    LOG(boost::format("Error binding thread %1%: %2%") % tid % e.what());
+  }
+}
+
+} // namespace aser
@@ -0,0 +1,206 @@
+#ifndef EXEC_MONITOR_CONFIG_SEARCHER_H_
+#define EXEC_MONITOR_CONFIG_SEARCHER_H_
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <core/application.h>
+#include <core/exec_monitor.h>
+#include <exec_monitor/config_search.h>
+#include <exec_monitor/phase_detector.h>
+#include <exec_monitor/search_objective.h>
+#include <perf/event.h>
+
+namespace aser {
+
+/** Execution monitor that searches the resource configuration online.
+ *
+ * The configuration has a level for every knob in exec_monitor.knobs (a
+ * list; "cpus" by default):
+ *  - "cpus": the applications run on the first CPUs of exec_monitor.cpus
+ *    (a CPU list; the CPUs the monitor is allowed to run on by default).
+ *    Levels are given by exec_monitor.cpu_levels (numbers of CPUs; all,
+ *    half, a quarter, and so on by default).
+ *  - "cache": the applications share the first ways of the last-level
+ *    cache (exec_monitor.cache_levels; quarters of the cache by default).
+ *  - "bandwidth": the memory bandwidth of the applications is throttled
+ *    (exec_monitor.bandwidth_levels, in percent; quarters by default).
+ *  - "frequency": the maximum frequency of the CPUs
+ *    (exec_monitor.frequency_levels, in kHz; up to four of the frequencies
+ *    supported by default).
+ * Cache and bandwidth are controlled through a resctrl group under
+ * exec_monitor.resctrl_root (/sys/fs/resctrl by default), and the
+ * frequency through cpufreq under exec_monitor.sysfs_root (/sys by
+ * default; the limits of the CPUs are restored once the monitor is
+ * destroyed). The search starts with the highest level of every knob.
+ *
+ * Every exec_monitor.sampling_length milliseconds, the instructions of
+ * every application are read (exec_monitor.event selects the
+ * implementation), and the objective in exec_monitor.objective (with
+ * "type" "weighted-speedup", the default, "stp", "fairness" or "energy";
+ * see search_objective) is passed as the reward to the search (see
+ * config_search). The search uses exec_monitor.search ("hill-climbing",
+ * the default, "ucb" or "thompson"), and it explores on at most
+ * exec_monitor.search_budget of the intervals (0.2 by default). Other
+ * options are exec_monitor.search_min_gain (0.02),
+ * exec_monitor.ucb_exploration (1), exec_monitor.search_memory (8) and
+ * exec_monitor.search_seed.
+ *
+ * The search keeps a state for every phase of the workload, given by the
+ * number of applications and their phases (see
+ * exec_event::event_type::PHASE_CHANGED), so that the best configuration
+ * known for a recurring phase is applied again without searching.
+ *
+ * If exec_monitor.phase_detection is set to a predictor ("markov" or
+ * "run-length"; see phase_detector), the monitor detects the phases of
+ * every application from its cycles and last-level cache misses per
+ * instruction, and it dispatches a PHASE_CHANGED event to the registered
+ * handlers on every change. Other options are
+ * exec_monitor.phase_threshold (0.15), exec_monitor.phase_table_size (16)
+ * and exec_monitor.phase_min_run (2).
+ */
+class config_searcher : public exec_monitor {
+public:
+  config_searcher(
+      exec_manager& exec_manager,
+      const boost::property_tree::ptree& properties);
+
+  ~config_searcher();
+
+private:
+  /** Counts for an application since the previous read. */
+  struct search_counts {
+    double cycles;
+    double instructions;
+
+    /** Last-level cache misses (only read if phases are detected). */
+    double cache_misses;
+  };
+
+  /** Reads the counters of an application since the previous read. */
+  typedef std::function<search_counts()> counter_reader;
+
+  /** Creates the counters for an application. */
+  typedef std::function<counter_reader(pid_t)> counter_factory;
+
+  /** A resource controlled by the search. */
+  struct knob {
+    std::string name;
+
+    /** Value of every level (e.g., a number of CPUs), in increasing order.
+     */
+    std::vector<unsigned> values;
+
+    /** Applies a value. */
+    std::function<void(unsigned)> apply;
+  };
+
+  struct searched_application {
+    application app;
+    counter_reader counters;
+
+    /** Best rate reached (instructions per second). */
+    double reference_rate;
+
+    /** Current phase of the application. */
+    unsigned phase;
+
+    /** Phase detector (null if phases are not detected). */
+    std::unique_ptr<phase_detector> detector;
+
+    /** Signature of the latest interval, reused across intervals. */
+    phase_detector::signature signature;
+  };
+
+  std::chrono::milliseconds sampling_interval_;
+
+  std::string cgroup_root_;
+  std::string sysfs_root_;
+
+  /** CPUs available to the applications (sorted). */
+  std::vector<unsigned> cpus_;
+
+  /** Number of CPUs the applications run on. */
+  unsigned num_cpus_;
+
+  /** Resource control group of the applications (empty if unused). */
+  std::string group_;
+
+  std::vector<knob> knobs_;
+
+  /** Frequency limit of every CPU (kHz) before the search, indexed like
+   * cpus_ (empty if the frequency is not searched). */
+  std::vector<unsigned> saved_frequencies_;
+
+  /** Level of every knob currently applied. */
+  config_search::configuration applied_;
+
+  std::unique_ptr<config_search> search_;
+  std::unique_ptr<search_objective> objective_;
+
+  /** Applications, indexed by the benchmark process. */
+  std::map<pid_t, searched_application> apps_;
+
+  /** Whether the threads are discovered again when binding. */
+  bool refresh_;
+
+  counter_factory counter_factory_;
+
+  /** Energy read at the end of the previous interval (joules). */
+  double energy_ { -1 };
+
+  /** Measurements of the latest interval, reused across intervals. */
+  search_objective::sample sample_;
+
+  /** Configuration of the phase detectors (null if phases are not
+   * detected). */
+  std::unique_ptr<phase_detector::config> phase_config_;
+
+  void loop_impl() final;
+
+  void add_process(pid_t pid);
+  void remove_process(pid_t pid);
+
+  /** Adds a new task to an application and binds its threads. */
+  void add_task(pid_t root, pid_t tid, bool process);
+
+  /** Switches the search to the phase of the workload. */
+  void update_phase();
+
+  /** Classifies the latest interval of an application into a phase, and
+   * emits an event if the phase changes. */
+  void detect_phase(
+      pid_t pid,
+      searched_application& sa,
+      const search_counts& counts);
+
+  /** Applies the levels of the knobs that changed. */
+  void apply(const config_search::configuration& levels);
+
+  /** Binds all the threads of an application to the CPUs in use. */
+  void bind_application(searched_application& sa);
+
+  /** Binds a thread to the CPUs in use. */
+  void bind_thread(pid_t tid);
+
+  /** Creates the knobs in exec_monitor.knobs. */
+  void create_knobs(const boost::property_tree::ptree& properties);
+
+  /** Creates a counter factory for an event implementation.
+   *
+   * @param events Cycles, instructions and, optionally, cache misses.
+   */
+  template<typename Impl>
+  static counter_factory make_counter_factory(
+      std::vector<perf::event_info> events);
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_CONFIG_SEARCHER_H_
@@ -1,11 +1,17 @@
 #include "cpu_hopper.h"
 
-#include <iostream>
+#include <algorithm>
+#include <memory>
 #include <thread>
 
 #include <core/exec_manager.h>
+#include <perf/address_sampler.h>
+#include <perf/event_dummy.h>
+#include <perf/event_linux.h>
+#include <perf/event_manager.h>
 #include <util/factory.h>
 #include <util/log.h>
+#include <util/numa.h>
 #include <util/os.h>
 
 namespace chrono = std::chrono;
@@ -17,6 +23,21 @@ util::registar<exec_monitor, cpu_hopper,
     exec_manager&, const pt::ptree&>
   cpu_hopper_registar("cpu-hopper");
 
+template<typename Impl>
+cpu_hopper::counter_factory cpu_hopper::make_counter_factory(
+    std::vector<perf::event_info> events) {
+  return [events](pid_t pid) {
+    // Readers must be copyable, so the manager is shared.
+    auto manager = std::make_shared<perf::event_manager<perf::event<Impl>>>(
+        events, pid, true);
+    return [manager] {
+      auto& samples = manager->read_events(perf::event_read_mode::RELATIVE);
+      return migration_counts{
+        samples[0].value, samples[1].value, samples[2].value, samples[3].value};
+    };
+  };
+}
+
 cpu_hopper::cpu_hopper(
     exec_manager& exec_manager,
     const pt::ptree& properties)
@@ -24,66 +45,406 @@ cpu_hopper::cpu_hopper(
   , sampling_interval_{
         chrono::milliseconds(properties.get<unsigned>(
             "exec_monitor.sampling_length"))}
-  , allocated_cpus_(std::thread::hardware_concurrency(), false)
+  , cgroup_root_{application::cgroup_root(properties)}
+  , topology_{util::topology::read(
+        properties.get<std::string>("exec_monitor.sysfs_root", "/sys"))}
+  , processes_per_set_{
+        properties.get<unsigned>("exec_monitor.processes_per_set", 1)}
+  , refresh_{!properties.get<bool>("exec_manager.process_events", false)}
+  , migration_windows_{
+        properties.get<unsigned>("exec_monitor.migration_windows", 0)}
+  , migration_window_{
+        properties.get<unsigned>("exec_monitor.migration_window", 10)}
+  , page_migration_{
+        properties.get<bool>("exec_monitor.page_migration", false)}
+  , page_sample_event_{std::stoull(
+        properties.get<std::string>("exec_monitor.page_sample_event", "0"),
+        nullptr, 0)}
+  , page_sample_period_{
+        properties.get<uint64_t>("exec_monitor.page_sample_period", 10000)}
+  , page_migrator_config_{
+        properties.get<size_t>("exec_monitor.hot_pages", 4096),
+        properties.get<size_t>("exec_monitor.page_batch", 512),
+        properties.get<double>("exec_monitor.page_migration_rate", 256)
+          * 1024 * 1024}
 {
+  auto binding = properties.get<std::string>(
+      "exec_monitor.thread_binding", "set");
+  if (binding == "set")
+    thread_binding_ = thread_binding::SET;
+  else if (binding == "pinned")
+    thread_binding_ = thread_binding::PINNED;
+  else
+    throw std::invalid_argument("Invalid thread binding: " + binding);
+
+  util::cpu_mapper mapper(
+      topology_,
+      util::parse_placement(
+          properties.get<std::string>("exec_monitor.placement", "compact")),
+      util::allowed_cpus());
+  sets_ = mapper.cpu_sets(
+      properties.get<unsigned>("exec_monitor.cpus_per_process", 1));
+  if (sets_.empty())
+    throw std::invalid_argument("Not enough CPUs for a single set");
+  set_load_.assign(sets_.size(), 0);
+
+  // Applications rotate through every set, one set per step, so the
+  // schedule repeats once they are back home.
+  schedule_.resize(sets_.size());
+  for (unsigned step = 0; step < sets_.size(); ++step) {
+    for (unsigned home = 0; home < sets_.size(); ++home)
+      schedule_[step].push_back((home + step) % sets_.size());
+  }
+
+  if (migration_windows_ > 0) {
+    if (migration_window_ * (migration_windows_ + 1) > sampling_interval_)
+      throw std::invalid_argument("Migration windows exceed the interval");
+
+    using namespace perf;
+    auto name = properties.get<std::string>("exec_monitor.event", "linux");
+    auto generic = create_generic_events(name);
+    std::vector<event_info> events = {
+      {event_type::HARDWARE, generic.cycles, event_modifiers::EXCLUDE_NONE},
+      {event_type::HARDWARE, generic.instructions,
+        event_modifiers::EXCLUDE_NONE},
+      {event_type::HW_CACHE, generic.l1d_misses,
+        event_modifiers::EXCLUDE_NONE},
+      {event_type::HARDWARE, generic.cache_misses,
+        event_modifiers::EXCLUDE_NONE}
+    };
+    if (name == "dummy")
+      counter_factory_ = make_counter_factory<event_dummy_impl>(events);
+#ifdef __linux__
+    else
+      counter_factory_ = make_counter_factory<event_linux_impl>(events);
+#endif
+  }
+
+  if (page_migration_) {
+    // Nodes in the topology are numbered in order of their first CPU.
+    auto root = properties.get<std::string>("exec_monitor.sysfs_root", "/sys");
+    auto nodes = util::numa_nodes(root);
+    auto ids = util::numa_node_ids(root);
+    node_ids_.assign(topology_.num_nodes(), -1);
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+      for (auto cpu : nodes[i]) {
+        if (topology_.contains(cpu))
+          node_ids_[topology_.find(cpu).node] = ids[i];
+      }
+    }
+  }
+
   register_event_handler(
       exec_event::event_type::PROCESS_CREATED,
       [&](const exec_event& event) {
         add_process(event.pid);
       });
+  register_event_handler(
+      exec_event::event_type::PROCESS_EXITED,
+      [&](const exec_event& event) {
+        if (event.pid == event.root)
+          remove_process(event.pid);
+        else
+          remove_task(event.root, event.pid, true);
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_FORKED,
+      [&](const exec_event& event) {
+        add_task(event.root, event.pid, true);
+      });
+  register_event_handler(
+      exec_event::event_type::THREAD_CREATED,
+      [&](const exec_event& event) {
+        add_task(event.root, event.payload.thread.tid, false);
+      });
+  register_event_handler(
+      exec_event::event_type::THREAD_EXITED,
+      [&](const exec_event& event) {
+        remove_task(event.root, event.payload.thread.tid, false);
+      });
+}
+
+void cpu_hopper::finalize_impl() {
+  while (!cpu_mapping_.empty())
+    remove_process(begin(cpu_mapping_)->first);
 }
 
 void cpu_hopper::loop_impl() {
-  std::this_thread::sleep_for(sampling_interval_);
+  if (migration_windows_ > 0) {
+    measure_hop();
+  } else {
+    std::this_thread::sleep_for(sampling_interval_);
+    hop_processes();
+  }
+
+  // Pages move right after the hop, so that they are local for most of
+  // the interval.
+  if (page_migration_)
+    migrate_pages();
+}
+
+void cpu_hopper::add_page_migrator(bound_application& ba) {
+#ifdef __linux__
+  auto pid = ba.app.root();
+  try {
+    auto sampler = std::make_shared<perf::address_sampler>(
+        pid, page_sample_event_, page_sample_period_);
+    ba.memory.reset(new page_migrator(
+          pid,
+          page_migrator_config_,
+          [sampler](util::page_hotness& hotness) {
+            return sampler->drain([&](uint64_t address) {
+              hotness.add(address);
+            });
+          }));
+  } catch (const std::exception& e) {
+    LOG(boost::format("Error sampling the accesses of process %1%: %2%")
+        % pid % e.what());
+  }
+#endif
+}
+
+void cpu_hopper::migrate_pages() {
+  for (auto& m : cpu_mapping_) {
+    auto& ba = m.second;
+    if (!ba.memory)
+      continue;
+    try {
+      ba.memory->step(sampling_interval_);
+    } catch (const std::exception& e) {
+      // The process may have finished.
+      LOG(boost::format("Error migrating the pages of process %1%: %2%")
+          % m.first % e.what());
+    }
+  }
+}
+
+void cpu_hopper::measure_hop() {
+  // The windows after the hop end with the sampling interval, and the
+  // window before it ends at the hop.
+  auto start = chrono::steady_clock::now();
+  auto hop = start + sampling_interval_
+    - migration_window_ * migration_windows_;
+
+  std::this_thread::sleep_until(hop - migration_window_);
+  for (auto& m : cpu_mapping_) {
+    if (m.second.counters)
+      m.second.counters();
+  }
+
+  std::this_thread::sleep_until(hop);
+  for (auto& m : cpu_mapping_) {
+    auto& ba = m.second;
+    if (ba.counters)
+      ba.before = ba.counters();
+    ba.prev_set = ba.set;
+  }
+
   hop_processes();
+
+  for (unsigned w = 0; w < migration_windows_; ++w) {
+    std::this_thread::sleep_until(hop + migration_window_ * (w + 1));
+    for (auto& m : cpu_mapping_) {
+      if (m.second.counters)
+        m.second.after[w] = m.second.counters();
+    }
+  }
+
+  for (auto& m : cpu_mapping_) {
+    auto& ba = m.second;
+    if (!ba.counters)
+      continue;
+    // Sets follow the placement order, so their first CPUs tell how far
+    // the application moved.
+    auto distance = classify_migration(
+        topology_, sets_[ba.prev_set].front(), sets_[ba.set].front());
+    if (distance != migration_distance::NONE)
+      ba.profile.add(distance, ba.before, ba.after);
+  }
+}
+
+void cpu_hopper::report_migrations(const bound_application& ba) const {
+  for (unsigned d = 1; d < num_migration_distances; ++d) {
+    auto distance = static_cast<migration_distance>(d);
+    auto curve = ba.profile.curve(distance);
+    for (unsigned w = 0; w < curve.size(); ++w) {
+      auto& p = curve[w];
+      if (p.samples == 0)
+        continue;
+      LOGI(boost::format("Migration penalty for process %1% (%2%, window "
+            "%3%): IPC ratio %4%, L1D MPKI %5%, LLC MPKI %6% (%7% hops)")
+          % ba.app.root() % to_string(distance) % w % p.ipc_ratio
+          % p.l1d_mpki % p.llc_mpki % p.samples);
+    }
+  }
 }
 
 void cpu_hopper::add_process(pid_t pid) {
   LOG(boost::format("Adding process %1%") % pid);
-  auto cpu = find_available_cpu();
-  bind_process(pid, cpu);
-  
-  if (cpu_mapping_.size() == allocated_cpus_.size()) {
-    // XXX current implementation requires that there is always
-    // at least one unallocated CPU.
+  auto home = assign_home();
+  auto res = cpu_mapping_.emplace(
+      pid,
+      bound_application{
+        application{pid, cgroup_root_},
+        home,
+        home,
+        0,
+        {},
+        std::vector<unsigned>(sets_[home].size(), 0),
+        nullptr,
+        home,
+        migration_counts{0, 0, 0, 0},
+        std::vector<migration_counts>(migration_windows_),
+        migration_profile{migration_windows_},
+        nullptr});
+  assert(res.second);
+
+  if (counter_factory_) {
+    try {
+      res.first->second.counters = counter_factory_(pid);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error attaching counters to process %1%: %2%")
+          % pid % e.what());
+    }
+  }
+  if (page_migration_)
+    add_page_migrator(res.first->second);
+  ++set_load_[home];
+  bind_application(res.first->second, schedule_[step_][home]);
+}
+
+void cpu_hopper::remove_process(pid_t pid) {
+  auto it = cpu_mapping_.find(pid);
+  if (it == end(cpu_mapping_))
+    return;
+
+  LOG(boost::format("Removing process %1%") % pid);
+  report_migrations(it->second);
+  if (it->second.memory) {
+    auto& stats = it->second.memory->stats();
+    LOGI(boost::format("Page migration for process %1%: %2% bytes moved "
+          "(%3% pages), remote access ratio %4% (%5% samples)")
+        % pid % stats.moved_bytes % stats.moved_pages % stats.remote_ratio
+        % stats.samples);
+  }
+
+  {
+  auto& ba = it->second;
+  std::lock_guard<std::mutex> lock(finished_mutex_);
+  finished_[pid] = application_summary{
+    ba.home,
+    ba.hops,
+    static_cast<bool>(ba.counters),
+    static_cast<bool>(ba.memory),
+    ba.memory ? ba.memory->stats() : page_migration_stats{0, 0, 0, 0}};
+  }
+  --set_load_[it->second.home];
+  cpu_mapping_.erase(it);
+}
+
+unsigned cpu_hopper::assign_home() {
+  auto it = std::min_element(begin(set_load_), end(set_load_));
+  if (processes_per_set_ > 0 && *it >= processes_per_set_)
     throw std::runtime_error("Too many processes");
+  return it - begin(set_load_);
+}
+
+void cpu_hopper::add_task(pid_t root, pid_t tid, bool process) {
+  auto it = cpu_mapping_.find(root);
+  if (it == end(cpu_mapping_))
+    return;
+
+  auto& ba = it->second;
+  if (process) {
+    for (auto t : ba.app.add_process(tid))
+      bind_thread(ba, t);
+  } else if (ba.app.add_thread(tid)) {
+    bind_thread(ba, tid);
   }
 }
 
-void cpu_hopper::bind_process(pid_t pid, unsigned cpu) {
+void cpu_hopper::remove_task(pid_t root, pid_t tid, bool process) {
+  auto it = cpu_mapping_.find(root);
+  if (it == end(cpu_mapping_))
+    return;
+
+  auto& ba = it->second;
+  if (process)
+    ba.app.remove_process(tid);
+  else
+    ba.app.remove_thread(tid);
+  release_slot(ba, tid);
+}
+
+void cpu_hopper::bind_thread(bound_application& ba, pid_t tid) {
+  auto& set = sets_[ba.set];
   try {
-    util::bind_process(pid, cpu);
+    if (thread_binding_ == thread_binding::PINNED)
+      util::bind_process(tid, set[thread_slot(ba, tid)]);
+    else
+      util::bind_process(tid, set);
   } catch (const std::exception& e) {
-    // TODO can we check whether the error actually took place after the
-    // process ended its execution? Otherwise, it would be a real error.
-    // TODO alternatively, we can log this as a potential real error, instead
-    // of using the usual call to LOG, which it is used for debug purposes.
-    std::cerr << boost::format("Error binding process: %1%\n") % e.what();
+    LOG(boost::format("Error binding thread %1%: %2%") % tid % e.what());
   }
+}
 
-  cpu_mapping_[pid] = cpu;
-  allocated_cpus_[cpu] = true;
+unsigned cpu_hopper::thread_slot(bound_application& ba, pid_t tid) {
+  auto it = ba.slots.find(tid);
+  if (it != end(ba.slots))
+    return it->second;
+
+  auto slot = std::min_element(begin(ba.slot_load), end(ba.slot_load))
+    - begin(ba.slot_load);
+  ++ba.slot_load[slot];
+  ba.slots.emplace(tid, slot);
+  return slot;
 }
 
-void cpu_hopper::hop_processes() {
-  for (auto& m : cpu_mapping_)
-    hop_process(m.first, m.second);
+void cpu_hopper::release_slot(bound_application& ba, pid_t tid) {
+  auto it = ba.slots.find(tid);
+  if (it == end(ba.slots))
+    return;
+  --ba.slot_load[it->second];
+  ba.slots.erase(it);
 }
 
-void cpu_hopper::hop_process(pid_t pid, unsigned cpu) {
-  auto new_cpu = find_available_cpu();
-  LOG(boost::format("Hopping process %1% from cpu %2% to cpu %3%")
-     % pid % cpu % new_cpu); 
-  bind_process(pid, new_cpu);
-  allocated_cpus_[cpu] = false;
+void cpu_hopper::bind_application(bound_application& ba, unsigned set) {
+  if (refresh_) {
+    ba.app.refresh();
+    for (auto it = begin(ba.slots); it != end(ba.slots);) {
+      auto next = std::next(it);
+      if (!ba.app.contains_thread(it->first))
+        release_slot(ba, it->first);
+      it = next;
+    }
+  }
+
+  ba.set = set;
+  if (ba.memory)
+    ba.memory->set_target(node_ids_[topology_.find(sets_[set].front()).node]);
+  for (auto tid : ba.app.threads())
+    bind_thread(ba, tid);
 }
 
-unsigned cpu_hopper::find_available_cpu() const {
-  auto it = std::find(begin(allocated_cpus_), end(allocated_cpus_), false);
-  if (it == end(allocated_cpus_))
-    throw std::runtime_error("No available CPUs");
-  return (it - begin(allocated_cpus_));
+void cpu_hopper::hop_processes() {
+  step_ = (step_ + 1) % schedule_.size();
+  auto& step = schedule_[step_];
+  for (auto& m : cpu_mapping_) {
+    auto& ba = m.second;
+    auto set = step[ba.home];
+    if (set == ba.set)
+      continue;
+    LOG(boost::format("Hopping application %1% from set %2% to set %3%")
+       % ba.app.root() % ba.set % set);
+    bind_application(ba, set);
+    ++ba.hops;
+  }
 }
 
-} // namespace aser
+std::map<pid_t, cpu_hopper::application_summary>
+cpu_hopper::finished() const {
+  std::lock_guard<std::mutex> lock(finished_mutex_);
+  return finished_;
+}
 
+} // namespace aser
@@ -1,37 +1,216 @@
 #include <chrono>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <core/application.h>
 #include <core/exec_monitor.h>
+#include <exec_monitor/migration_cost.h>
+#include <exec_monitor/page_migrator.h>
+#include <perf/event.h>
+#include <util/cpu_mapper.h>
+#include <util/topology.h>
 
 namespace aser {
 
 /** This class implements a simple execution monitor that hops processes
- * around in a system. When a process is created, it is assigned a CPU.
- * After a programmable amount of time, all processes under the control
- * of the execution manager will hop to another CPU. This process continues
- * until the execution finishes.
+ * around in a system. When a process is created, it is assigned a set of
+ * CPUs. After a programmable amount of time, all processes under the
+ * control of the execution manager will hop to another set. This process
+ * continues until the execution finishes.
+ *
+ * Every process is handled as an application: all the threads of all the
+ * processes in the application are bound to the same set of CPUs.
+ *
+ * CPUs are chosen among those the monitor is allowed to run on, following
+ * the placement strategy in exec_monitor.placement (see util::placement;
+ * compact by default), and they are split into sets of
+ * exec_monitor.cpus_per_process CPUs (one by default). The topology is read
+ * from exec_monitor.sysfs_root. Up to exec_monitor.processes_per_set
+ * processes share a set (one by default; zero removes the limit), so there
+ * can be more processes than CPUs.
+ *
+ * Every application has a home set, and on every hop all the applications
+ * rotate to the next set. The rotation is computed ahead of time as a
+ * schedule, so that a hop is a single pass of affinity updates.
+ *
+ * The affinity is set for every thread, as it only applies to the thread
+ * it is set for. With exec_monitor.thread_binding set to "set" (default),
+ * every thread can run on any CPU in the set of its application. With
+ * "pinned", every thread is bound to a single CPU in the set (balancing
+ * the threads across the CPUs), and it keeps its position in the set when
+ * the application hops, so the threads keep their relative placement.
+ *
+ * Threads are discovered through procfs when an application is added.
+ * If process events are enabled, the threads are then tracked through the
+ * events; otherwise, they are discovered again on every hop.
+ *
+ * Setting exec_monitor.migration_windows to a positive number enables
+ * measuring the cost of every hop. Counters (cycles, instructions, L1D and
+ * LLC misses; exec_monitor.event selects the implementation) are read in
+ * a window of exec_monitor.migration_window milliseconds that ends just
+ * before the hop, and in that many windows of the same length that start
+ * just after it. The penalty curves for every distance of the hops (see
+ * migration_distance) are logged for every process once it finishes.
+ *
+ * Setting exec_monitor.page_migration to true makes the memory of every
+ * application follow it when it hops to another NUMA node (see
+ * page_migrator). Accesses are sampled with the raw precise memory event
+ * in exec_monitor.page_sample_event (one sample every
+ * exec_monitor.page_sample_period events) or, if there is none or it is not
+ * supported, with page faults. Up to exec_monitor.page_batch hot pages
+ * (512 by default) are moved after every interval, at most
+ * exec_monitor.page_migration_rate MB per second (256 by default). The
+ * bytes moved and the remote access ratio are logged for every process
+ * once it finishes.
+ *
+ * A summary of every application is kept once it finishes (see
+ * finished()).
  */
 class cpu_hopper : public exec_monitor {
 public:
+  /** Summary of an application once it finishes. */
+  struct application_summary {
+    /** Set the application was assigned to at the first step. */
+    unsigned home;
+
+    /** Number of hops to another set. */
+    unsigned hops;
+
+    /** Whether counters measured the cost of the hops. */
+    bool measured;
+
+    /** Whether the pages followed the application. */
+    bool pages_migrated;
+
+    /** Results of the migration of the pages (zero if they did not move).
+     */
+    page_migration_stats pages;
+  };
+
   cpu_hopper(
       exec_manager& exec_manager,
       const boost::property_tree::ptree& properties);
 
+  /** Returns the summary of every finished application, indexed by its
+   * benchmark process.
+   *
+   * This method can be safely called from any thread.
+   */
+  std::map<pid_t, application_summary> finished() const;
+
 private:
-  typedef std::map<pid_t, unsigned> cpu_mapping;
-  typedef std::vector<bool> cpu_allocation;
+  /** How threads are bound to the CPUs in a set. */
+  enum class thread_binding { SET, PINNED };
+
+  /** Reads the counters of an application since the previous read. */
+  typedef std::function<migration_counts()> counter_reader;
+
+  /** Creates the counters for an application. */
+  typedef std::function<counter_reader(pid_t)> counter_factory;
+
+  /** An application and the set of CPUs it is bound to. */
+  struct bound_application {
+    application app;
+
+    /** Set the application is assigned to at the first step. */
+    unsigned home;
+
+    /** Set the application is currently bound to. */
+    unsigned set;
+
+    /** Number of hops to another set. */
+    unsigned hops;
+
+    /** Position in the set of every pinned thread. */
+    std::map<pid_t, unsigned> slots;
+
+    /** Number of pinned threads in every position in the set. */
+    std::vector<unsigned> slot_load;
+
+    /** Counters to measure the cost of hops (empty if not measured). */
+    counter_reader counters;
+
+    /** Set the application was bound to before the latest hop. */
+    unsigned prev_set;
+
+    /** Counts in the windows before and after the latest hop. */
+    migration_counts before;
+    std::vector<migration_counts> after;
+
+    migration_profile profile;
+
+    /** Migration of the pages (null if pages are not migrated). */
+    std::unique_ptr<page_migrator> memory;
+  };
+
+  typedef std::map<pid_t, bound_application> cpu_mapping;
 
   /** Sampling interval between hops. */
   std::chrono::milliseconds sampling_interval_;
 
-  /** Process to CPU mapping. */
+  /** Directory containing the per-application control groups. */
+  std::string cgroup_root_;
+
+  /** Application to CPU mapping (indexed by the benchmark process). */
   cpu_mapping cpu_mapping_;
 
-  /** Map of allocated CPUs. */
-  cpu_allocation allocated_cpus_;
+  util::topology topology_;
+
+  /** Sets of CPUs. */
+  std::vector<std::vector<unsigned>> sets_;
+
+  /** Number of applications whose home is each set. */
+  std::vector<unsigned> set_load_;
+
+  /** Maximum number of applications per set (zero if unlimited). */
+  unsigned processes_per_set_;
+
+  /** Set for every home set at every step (schedule_[step][home]). */
+  std::vector<std::vector<unsigned>> schedule_;
+
+  /** Current step in the schedule. */
+  unsigned step_ { 0 };
+
+  thread_binding thread_binding_;
+
+  /** Whether the threads are discovered again on every hop. */
+  bool refresh_;
+
+  /** Number of windows measured after every hop (zero if the cost of hops
+   * is not measured). */
+  unsigned migration_windows_;
+
+  /** Length of the windows around every hop. */
+  std::chrono::milliseconds migration_window_;
+
+  counter_factory counter_factory_;
+
+  /** Whether the pages follow the applications. */
+  bool page_migration_;
+
+  /** Raw code of the precise memory event to sample (zero for none). */
+  uint64_t page_sample_event_;
+
+  uint64_t page_sample_period_;
+
+  page_migrator::config page_migrator_config_;
+
+  /** Identifier of every node in the topology. */
+  std::vector<int> node_ids_;
+
+  std::map<pid_t, application_summary> finished_;
+
+  /** Mutex protecting finished_. */
+  mutable std::mutex finished_mutex_;
+
+  /** Removes the applications whose exit was not handled before the
+   * execution finished. */
+  void finalize_impl() final;
 
   void loop_impl() final;
 
@@ -41,29 +220,82 @@ private:
    */
   void add_process(pid_t pid);
 
-  /** Binds a process to a CPU.
+  /** Removes a finished process and releases its set.
    *
    * @param pid The pid of the process.
-   * @param cpu The CPU number.
    */
-  void bind_process(pid_t pid, unsigned cpu);
+  void remove_process(pid_t pid);
+
+  /** Adds a new task to an application, and binds its threads.
+   *
+   * Tasks inherit the affinity of their parent, but the application may
+   * have hopped after the parent was bound, and pinned threads need their
+   * own CPU.
+   *
+   * @param root The benchmark process of the application.
+   * @param tid The identifier of the task.
+   * @param process Whether the task is a new process (fork).
+   */
+  void add_task(pid_t root, pid_t tid, bool process);
 
-  /** Hops all processes. */
+  /** Removes a finished task from an application.
+   *
+   * @param root The benchmark process of the application.
+   * @param tid The identifier of the task.
+   * @param process Whether the task is a process.
+   */
+  void remove_task(pid_t root, pid_t tid, bool process);
+
+  /** Binds a thread to the CPUs it should use in the current set of its
+   * application.
+   *
+   * @param ba The application.
+   * @param tid The identifier of the thread.
+   */
+  void bind_thread(bound_application& ba, pid_t tid);
+
+  /** Returns the position in the set of a pinned thread, assigning one to
+   * new threads. */
+  unsigned thread_slot(bound_application& ba, pid_t tid);
+
+  /** Releases the position of a pinned thread. */
+  void release_slot(bound_application& ba, pid_t tid);
+
+  /** Binds an application to a set of CPUs.
+   *
+   * @param ba The application.
+   * @param set The index of the set.
+   */
+  void bind_application(bound_application& ba, unsigned set);
+
+  /** Hops all processes to the next step in the schedule. */
   void hop_processes();
 
-  /** Hops a single process.
+  /** Hops all processes, measuring the counters around the hop. */
+  void measure_hop();
+
+  /** Logs the migration penalty curves for an application. */
+  void report_migrations(const bound_application& ba) const;
+
+  /** Creates the migration of the pages of a new application. */
+  void add_page_migrator(bound_application& ba);
+
+  /** Moves the hottest pages of every application to its node. */
+  void migrate_pages();
+
+  /** Creates a counter factory for an event implementation.
    *
-   * @param pid The pid of the process.
-   * @param cpu The new CPU number.
+   * @param events The events to measure.
    */
-  void hop_process(pid_t pid, unsigned cpu);
+  template<typename Impl>
+  static counter_factory make_counter_factory(
+      std::vector<perf::event_info> events);
 
-  /** Find an available (unallocated) CPU.
+  /** Chooses the home set for a new application.
    *
-   * @return The number of the available CPU.
+   * @return The index of the set with the fewest applications.
    */
-  unsigned find_available_cpu() const;
+  unsigned assign_home();
 };
 
 } // namespace aser
-
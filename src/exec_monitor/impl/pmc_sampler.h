@@ -1,7 +1,12 @@
+#include <algorithm>
+#include <limits>
 #include <thread>
 
 #include <core/exec_manager.h>
 #include <util/log.h>
+#include <util/numa.h>
+#include <util/os.h>
+#include <util/proc.h>
 
 namespace aser {
 
@@ -13,12 +18,34 @@ pmc_sampler<EventManager>::pmc_sampler(
   , sampling_interval_{
       std::chrono::milliseconds(properties.get<unsigned>(
           "exec_monitor.sampling_length"))}
+  , cgroup_root_{application::cgroup_root(properties)}
+  , collection_threads_{
+      properties.get<unsigned>("exec_monitor.collection_threads", 0)}
+  , snapshot_reads_{
+      properties.get<bool>("exec_monitor.snapshot_reads", true)}
+  , refresh_period_{properties.get<int>(
+      "exec_monitor.refresh_period",
+      properties.get<bool>("exec_manager.process_events", false) ? -1 : 1000)}
+  , start_barrier_{collection_threads_ + 1}
+  , done_barrier_{collection_threads_ + 1}
 {
   register_event_handler(
       exec_event::event_type::PROCESS_CREATED,
       [&](const exec_event& event) {
         add_process(event.pid);
       });
+  register_event_handler(
+      exec_event::event_type::PROCESS_EXITED,
+      [&](const exec_event& event) {
+        remove_process(event.root, event.pid);
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_FORKED,
+      [&](const exec_event& event) {
+        auto it = applications_.find(event.root);
+        if (it != end(applications_))
+          refresh(it->second);
+      });
 
   using namespace perf;
 
@@ -27,43 +54,419 @@ pmc_sampler<EventManager>::pmc_sampler(
 
   events_ = {
     {event_type::HARDWARE, default_events.cycles, event_modifiers::EXCLUDE_NONE},
-    {event_type::HARDWARE, default_events.instructions, event_modifiers::EXCLUDE_NONE}
+    {event_type::HARDWARE, default_events.instructions, event_modifiers::EXCLUDE_NONE},
+    {event_type::HARDWARE, default_events.cache_misses, event_modifiers::EXCLUDE_NONE}
   };
+
+  auto history_length =
+    properties.get<size_t>("exec_monitor.history_length", 0);
+  if (history_length > 0) {
+    enable_history(
+        history_length,
+        properties.get<double>("exec_monitor.history_ewma_alpha", 0.1));
+  }
+
+  set_warmup_ticks(properties.get<uint64_t>("exec_monitor.warmup_ticks", 10));
+
+  auto placement = properties.get_optional<std::string>(
+      "exec_monitor.placement");
+  if (placement) {
+    cpus_.reset(new util::cpu_mapper{util::cpu_mapper::create(
+        util::parse_placement(*placement),
+        properties.get<std::string>("exec_monitor.sysfs_root", "/sys"))});
+  }
+
+  if (collection_threads_ == 0) {
+    shards_.resize(1);
+  } else {
+    auto nodes = util::numa_nodes();
+    shards_.resize(collection_threads_);
+    for (size_t i = 0; i < shards_.size(); ++i)
+      shards_[i].cpus = nodes[i % nodes.size()];
+  }
+}
+
+template<typename EventManager>
+pmc_sampler<EventManager>::~pmc_sampler() {
+  stop_collection_threads();
+}
+
+template<typename EventManager>
+typename pmc_sampler<EventManager>::collection_stats
+pmc_sampler<EventManager>::last_collection() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return last_collection_;
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::initialize_impl() {
+  if (refresh_period_ > std::chrono::milliseconds(0))
+    schedule_refresh();
+
+  if (collection_threads_ == 0)
+    return;
+
+  for (auto& s : shards_)
+    s.thread = std::thread(&pmc_sampler::collection_thread, this, std::ref(s));
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::finalize_impl() {
+  stop_collection_threads();
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::stop_collection_threads() {
+  if (collection_threads_ == 0 || !shards_.front().thread.joinable())
+    return;
+
+  stopping_ = true;
+  start_barrier_.arrive_and_wait();
+  for (auto& s : shards_)
+    s.thread.join();
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::collection_thread(shard& s) {
+  try {
+    util::bind_thread(s.cpus);
+  } catch (const std::exception& e) {
+    LOG(boost::format("Error binding collection thread: %1%") % e.what());
+  }
+
+  while (true) {
+    start_barrier_.arrive_and_wait();
+    if (stopping_)
+      break;
+
+    try {
+      collect(s);
+    } catch (...) {
+      s.error = std::current_exception();
+    }
+    done_barrier_.arrive_and_wait();
+  }
 }
 
 template<typename EventManager>
 void pmc_sampler<EventManager>::loop_impl() {
   std::this_thread::sleep_for(sampling_interval_);
 
-  for (auto& elem : event_managers_) {
-    auto& mgr = elem.second;
-    auto& events = mgr.read_events(perf::event_read_mode::RELATIVE);
-    for (auto& e : events)
-      LOG(boost::format("enabled: %1%, count: %2%, scaling: %3%")
-          % e.enabled % e.value % e.scaling);
+  auto interval = std::chrono::duration<double>(sampling_interval_).count();
+
+  // Attaching counters is left to the monitor thread, so that the
+  // collection threads only read them.
+  for (auto& s : shards_)
+    s.work.clear();
+  for (auto& elem : applications_) {
+    auto& counters = elem.second;
+    shards_[counters.shard].work.push_back(&counters);
+  }
+
+  if (collection_threads_ == 0) {
+    collect(shards_.front());
+  } else {
+    start_barrier_.arrive_and_wait();
+    done_barrier_.arrive_and_wait();
+  }
+
+  for (auto& s : shards_) {
+    if (s.error) {
+      auto error = s.error;
+      s.error = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  update_collection_stats();
+
+  for (auto& elem : applications_) {
+    auto& samples = elem.second.samples;
+    auto& cycles = samples[event_index::CYCLES];
+    auto& instrs = samples[event_index::INSTRUCTIONS];
+    auto& misses = samples[event_index::CACHE_MISSES];
+
+    process_metrics metrics;
+    if (cycles.enabled && instrs.enabled && cycles.value > 0)
+      metrics.ipc = instrs.value / cycles.value;
+    if (misses.enabled)
+      metrics.bandwidth = misses.value * cache_line_size / interval;
+    publish_metrics(elem.first, metrics);
+  }
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::refresh(application_counters& counters) {
+  if (counters.app.refresh())
+    attach_uncovered(counters);
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::schedule_refresh() {
+  // Refreshing runs as a task, between ticks, so that it does not delay
+  // the samples.
+  schedule(refresh_period_, [this] {
+    for (auto& elem : applications_)
+      refresh(elem.second);
+    schedule_refresh();
+  });
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::collect(shard& s) {
+  s.vectorized = 0;
+  for (size_t i = 0; i < s.work.size(); ++i) {
+    auto now = clock::now();
+    if (i == 0)
+      s.first_read = now;
+    s.last_read = now;
+    read_counters(*s.work[i]);
+    if (!snapshot_reads_)
+      scale_samples(s, i, i + 1);
+  }
+  s.finished = clock::now();
+
+  if (snapshot_reads_)
+    scale_samples(s, 0, s.work.size());
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::read_counters(
+    application_counters& counters) {
+  for (auto& m : counters.event_managers)
+    m.second.read();
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::scale_samples(
+    shard& s,
+    size_t first,
+    size_t last) {
+  // The events of every process are laid out one after another, so that
+  // the vector kernels are not limited to the events of a single process.
+  size_t size = 0;
+  for (auto i = first; i < last; ++i) {
+    for (auto& m : s.work[i]->event_managers)
+      size += m.second.size();
+  }
+  s.counts.resize(size);
+  s.prev_counts.resize(size);
+  s.batch_samples.resize(size);
+
+  size_t offset = 0;
+  for (auto i = first; i < last; ++i) {
+    for (auto& m : s.work[i]->event_managers) {
+      m.second.gather(s.counts, s.prev_counts, offset);
+      offset += m.second.size();
+    }
+  }
+
+  auto mode = perf::event_read_mode::RELATIVE;
+  auto result = perf::scale_counts(
+      s.counts, s.prev_counts, mode, s.batch_samples);
+  s.vectorized += result.vectorized;
+
+  offset = 0;
+  for (auto i = first; i < last; ++i)
+    aggregate_samples(*s.work[i], s, offset, result.count);
+
+  if (result.error != perf::scale_error::NONE)
+    perf::throw_scale_error(result.error);
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::aggregate_samples(
+    application_counters& counters,
+    const shard& s,
+    size_t& offset,
+    size_t scaled) {
+  auto window = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      sampling_interval_).count();
+
+  auto& samples = counters.samples;
+  std::fill(begin(samples), end(samples),
+      perf::event_sample{0, 1, false, 0, static_cast<uint64_t>(window)});
+  for (auto& m : counters.event_managers) {
+    auto& events = m.second.scatter(
+        s.prev_counts, s.batch_samples, offset, scaled,
+        perf::event_read_mode::RELATIVE);
+    offset += m.second.size();
+    for (size_t i = 0; i < events.size(); ++i) {
+      auto& e = events[i];
+      LOG_ASYNC("pid: %1%, enabled: %2%, count: %3%, scaling: %4%, "
+          "window: %5%",
+          m.first, e.enabled, e.value, e.scaling, e.window);
+      if (!e.enabled)
+        continue;
+      // Counts are normalized to the sampling interval, so that the
+      // metrics of every process refer to windows of the same length.
+      auto value = e.window > 0 ? e.value * window / e.window : e.value;
+      samples[i].value += value;
+      samples[i].scaling = std::min(samples[i].scaling, e.scaling);
+      samples[i].enabled = true;
+      samples[i].timestamp = std::max(samples[i].timestamp, e.timestamp);
+    }
+  }
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::update_collection_stats() {
+  auto first_read = clock::time_point::max();
+  auto last_read = clock::time_point::min();
+  auto finished = clock::time_point::min();
+  unsigned shards = 0;
+  size_t vectorized = 0;
+  for (auto& s : shards_) {
+    if (s.work.empty())
+      continue;
+    ++shards;
+    vectorized += s.vectorized;
+    first_read = std::min(first_read, s.first_read);
+    last_read = std::max(last_read, s.last_read);
+    finished = std::max(finished, s.finished);
+  }
+
+  collection_stats stats { 0, 0, shards, vectorized };
+  if (first_read != clock::time_point::max()) {
+    using seconds = std::chrono::duration<double>;
+    stats.duration = seconds(finished - first_read).count();
+    stats.skew = seconds(last_read - first_read).count();
+  }
+
+  LOG_ASYNC("Collection time: %1% s, skew: %2% s",
+      stats.duration, stats.skew);
+
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  last_collection_ = stats;
+}
 
-#if 0
-    assert(default_events[0].code == perf::generic_events::cycles
-        && default_events[1].code == perf::generic_events::instructions);
-    auto& cycles = events[0];
-    auto& instrs = events[1];
-    if (cycles.enabled && instrs.enabled)
-      LOG(boost::format("IPC: %1%") % (instrs.value / cycles.value));
-#endif
+template<typename EventManager>
+unsigned pmc_sampler<EventManager>::assign_shard(pid_t pid) {
+  // Shards on the node where the process runs are preferred, as reading
+  // the counters accesses the task structures of the process.
+  auto cpu = util::last_cpu(pid);
+  auto best = std::numeric_limits<unsigned>::max();
+  auto best_local = false;
+  for (unsigned i = 0; i < shards_.size(); ++i) {
+    auto& cpus = shards_[i].cpus;
+    auto local = cpu >= 0
+      && std::find(begin(cpus), end(cpus), static_cast<unsigned>(cpu))
+        != end(cpus);
+    if (best == std::numeric_limits<unsigned>::max()
+        || (local && !best_local)
+        || (local == best_local && shards_[i].load < shards_[best].load)) {
+      best = i;
+      best_local = local;
+    }
   }
+
+  ++shards_[best].load;
+  return best;
 }
 
 template<typename EventManager>
 void pmc_sampler<EventManager>::add_process(pid_t pid) {
   LOG(boost::format("Adding process %1%") % pid);
 
-  // TODO add the option to bind the process to a CPU.
-  // XXX create a cpu_mapper helper class to handle this.
-
-  auto res = event_managers_.emplace(
-      pid, event_manager{events_, pid, true});
+  auto cpu = cpus_ ? static_cast<int>(cpus_->allocate()) : -1;
+  auto res = applications_.emplace(
+      pid,
+      application_counters{
+        application{pid, cgroup_root_},
+        {},
+        {},
+        typename event_manager::sample_list(
+            events_.size(), perf::event_sample{0, 1, false, 0, 0}),
+        assign_shard(pid),
+        cpu});
   assert(res.second);
+
+  auto& counters = res.first->second;
+  counters.event_managers.emplace(pid, event_manager{events_, pid, true});
+  counters.app.refresh();
+  attach_uncovered(counters);
+  bind_application(counters);
+
+  // The list of work for the shard must not grow while sampling.
+  auto& s = shards_[counters.shard];
+  s.work.reserve(s.load);
 }
 
-} // namespace aser
+template<typename EventManager>
+void pmc_sampler<EventManager>::bind_application(
+    const application_counters& counters) {
+  if (counters.cpu < 0)
+    return;
+
+  // Tasks created afterwards inherit the affinity.
+  for (auto tid : counters.app.threads()) {
+    try {
+      util::bind_process(tid, counters.cpu);
+    } catch (const std::exception& e) {
+      // The task may have finished in the meantime.
+      LOG(boost::format("Error binding task %1%: %2%") % tid % e.what());
+    }
+  }
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::remove_process(pid_t root, pid_t pid) {
+  auto it = applications_.find(root);
+  if (it == end(applications_))
+    return;
+
+  if (pid == root) {
+    LOG(boost::format("Removing application %1%") % root);
+    --shards_[it->second.shard].load;
+    if (it->second.cpu >= 0)
+      cpus_->release(it->second.cpu);
+    applications_.erase(it);
+    return;
+  }
+
+  auto& counters = it->second;
+  counters.inheriting.erase(pid);
+  counters.event_managers.erase(pid);
+}
+
+template<typename EventManager>
+void pmc_sampler<EventManager>::attach_uncovered(
+    application_counters& counters) {
+  for (auto pid : counters.app.processes()) {
+    if (counters.event_managers.count(pid) > 0
+        || counters.inheriting.count(pid) > 0)
+      continue;
+
+    if (is_covered(counters, pid)) {
+      counters.inheriting.insert(pid);
+      continue;
+    }
+
+    LOG(boost::format("Attaching counters to process %1% (application %2%)")
+        % pid % counters.app.root());
+    try {
+      counters.event_managers.emplace(pid, event_manager{events_, pid, true});
+    } catch (const std::exception& e) {
+      // The process may have finished in the meantime.
+      LOG(boost::format("Error attaching counters to process %1%: %2%")
+          % pid % e.what());
+    }
+  }
+}
 
+template<typename EventManager>
+bool pmc_sampler<EventManager>::is_covered(
+    const application_counters& counters,
+    pid_t pid) const {
+  // Every process that existed when counters were last attached has its
+  // own counters, so any process descending from a counted process was
+  // created afterwards and inherits them.
+  for (auto p = util::parent(pid); p > 1; p = util::parent(p)) {
+    if (counters.event_managers.count(p) > 0
+        || counters.inheriting.count(p) > 0)
+      return true;
+  }
+  return false;
+}
+
+} // namespace aser
@@ -0,0 +1,90 @@
+#include "migration_cost.h"
+
+#include <cassert>
+
+namespace aser {
+
+migration_distance classify_migration(
+    const util::topology& topo,
+    unsigned from,
+    unsigned to) {
+  auto& a = topo.find(from);
+  auto& b = topo.find(to);
+  if (a.cpu == b.cpu)
+    return migration_distance::NONE;
+  if (a.core == b.core)
+    return migration_distance::SMT;
+  if (a.llc == b.llc)
+    return migration_distance::LLC;
+  if (a.node == b.node)
+    return migration_distance::NODE;
+  return migration_distance::REMOTE;
+}
+
+std::string to_string(migration_distance distance) {
+  switch (distance) {
+  case migration_distance::NONE:
+    return "none";
+  case migration_distance::SMT:
+    return "smt";
+  case migration_distance::LLC:
+    return "llc";
+  case migration_distance::NODE:
+    return "node";
+  case migration_distance::REMOTE:
+    return "remote";
+  }
+  assert(false);
+  return "";
+}
+
+/** Returns whether a window has enough counts to compute its metrics. */
+static bool valid(const migration_counts& counts) {
+  return counts.cycles > 0 && counts.instructions > 0;
+}
+
+migration_profile::migration_profile(unsigned windows)
+  : windows_{windows}
+  , sums_(num_migration_distances * windows, migration_penalty{0, 0, 0, 0})
+{}
+
+void migration_profile::add(
+    migration_distance distance,
+    const migration_counts& before,
+    const std::vector<migration_counts>& after) {
+  assert(after.size() == windows_);
+  if (!valid(before))
+    return;
+
+  auto ipc = before.instructions / before.cycles;
+  auto l1d_mpki = before.l1d_misses * 1000 / before.instructions;
+  auto llc_mpki = before.llc_misses * 1000 / before.instructions;
+
+  auto base = static_cast<unsigned>(distance) * windows_;
+  for (unsigned w = 0; w < windows_; ++w) {
+    auto& counts = after[w];
+    if (!valid(counts))
+      continue;
+    auto& sum = sums_[base + w];
+    ++sum.samples;
+    sum.ipc_ratio += counts.instructions / counts.cycles / ipc;
+    sum.l1d_mpki += counts.l1d_misses * 1000 / counts.instructions - l1d_mpki;
+    sum.llc_mpki += counts.llc_misses * 1000 / counts.instructions - llc_mpki;
+  }
+}
+
+std::vector<migration_penalty> migration_profile::curve(
+    migration_distance distance) const {
+  auto base = begin(sums_) + static_cast<unsigned>(distance) * windows_;
+  std::vector<migration_penalty> result(base, base + windows_);
+  for (auto& p : result) {
+    if (p.samples == 0)
+      continue;
+    p.ipc_ratio /= p.samples;
+    p.l1d_mpki /= p.samples;
+    p.llc_mpki /= p.samples;
+  }
+  return result;
+}
+
+} // namespace aser
@@ -0,0 +1,104 @@
+#ifndef EXEC_MONITOR_MIGRATION_COST_H_
+#define EXEC_MONITOR_MIGRATION_COST_H_
+
+#include <string>
+#include <vector>
+
+#include <util/topology.h>
+
+namespace aser {
+
+/** Distance of a migration in the CPU topology.
+ *
+ * NONE: the CPU does not change.
+ * SMT: to an SMT sibling of the previous CPU.
+ * LLC: to another core sharing the last-level cache.
+ * NODE: to another last-level cache domain in the same NUMA node.
+ * REMOTE: to another NUMA node (usually on another socket).
+ */
+enum class migration_distance : unsigned { NONE, SMT, LLC, NODE, REMOTE };
+
+/** Number of migration distances. */
+constexpr unsigned num_migration_distances =
+  static_cast<unsigned>(migration_distance::REMOTE) + 1;
+
+/** Returns the distance of a migration between two CPUs. */
+migration_distance classify_migration(
+    const util::topology& topo,
+    unsigned from,
+    unsigned to);
+
+/** Returns the name of a migration distance. */
+std::string to_string(migration_distance distance);
+
+/** Counts in a measurement window. */
+struct migration_counts {
+  double cycles;
+  double instructions;
+  double l1d_misses;
+  double llc_misses;
+};
+
+/** Penalty in a window after migrating, relative to the window before. */
+struct migration_penalty {
+  /** Number of migrations measured. */
+  unsigned samples;
+
+  /** Mean ratio between the IPC after and before migrating. */
+  double ipc_ratio;
+
+  /** Mean increase in L1D and LLC misses per thousand instructions. */
+  double l1d_mpki;
+  double llc_mpki;
+};
+
+/** Migration penalty curves for every distance.
+ *
+ * Every migration is measured in a window just before it and in a
+ * sequence of windows of the same length just after it. The penalty in
+ * every window after the migration is the change of its metrics relative
+ * to the window before, so the curve shows how the penalty fades as the
+ * caches warm up again.
+ */
+class migration_profile {
+public:
+  /** Constructor.
+   *
+   * @param windows Number of windows measured after every migration.
+   */
+  explicit migration_profile(unsigned windows);
+
+  /** Adds a migration.
+   *
+   * Windows without cycles or instructions (e.g., while the process is
+   * not running) are skipped.
+   *
+   * @param distance The distance of the migration.
+   * @param before Counts in the window before migrating.
+   * @param after Counts in every window after migrating.
+   */
+  void add(
+      migration_distance distance,
+      const migration_counts& before,
+      const std::vector<migration_counts>& after);
+
+  /** Returns the penalty in every window after migrating.
+   *
+   * @param distance The distance of the migrations.
+   */
+  std::vector<migration_penalty> curve(migration_distance distance) const;
+
+  unsigned windows() const noexcept {
+    return windows_;
+  }
+
+private:
+  unsigned windows_;
+
+  /** Accumulated penalties (indexed by distance * windows_ + window). */
+  std::vector<migration_penalty> sums_;
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_MIGRATION_COST_H_
@@ -0,0 +1,147 @@
+#include "mrc_monitor.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include <core/exec_manager.h>
+#include <perf/address_sampler.h>
+#include <util/factory.h>
+#include <util/log.h>
+
+namespace chrono = std::chrono;
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+util::registar<exec_monitor, mrc_monitor,
+    exec_manager&, const pt::ptree&>
+  mrc_monitor_registar("mrc");
+
+mrc_monitor::mrc_monitor(
+    exec_manager& exec_manager,
+    const pt::ptree& properties)
+  : exec_monitor(exec_manager)
+  , sampling_interval_{
+        chrono::milliseconds(properties.get<unsigned>(
+            "exec_monitor.sampling_length"))}
+  , sample_event_{std::stoull(
+        properties.get<std::string>("exec_monitor.sample_event", "0"),
+        nullptr, 0)}
+  , sample_period_{
+        properties.get<uint64_t>("exec_monitor.sample_period", 1000)}
+  , decay_{properties.get<double>("exec_monitor.mrc_decay", 0.5)}
+{
+  shards_config_.max_lines =
+    properties.get<size_t>("exec_monitor.mrc_lines", 8192);
+  shards_config_.rate = properties.get<double>("exec_monitor.mrc_rate", 1);
+  shards_config_.line_size =
+    properties.get<size_t>("exec_monitor.mrc_line_size", 64);
+  auto bin_size = properties.get<size_t>("exec_monitor.mrc_bin_size", 64)
+    * 1024;
+  if (bin_size < shards_config_.line_size)
+    throw std::invalid_argument("MRC bins must hold at least a line");
+  shards_config_.bin_lines = bin_size / shards_config_.line_size;
+  shards_config_.bins = properties.get<size_t>("exec_monitor.mrc_bins", 256);
+  if (decay_ < 0 || decay_ > 1)
+    throw std::invalid_argument("MRC decay must be in [0, 1]");
+
+  // Checks the configuration before any process is added.
+  util::shards{shards_config_};
+  scratch_.reserve(shards_config_.bins);
+
+  register_event_handler(
+      exec_event::event_type::PROCESS_CREATED,
+      [&](const exec_event& event) {
+        add_process(event.pid);
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_EXITED,
+      [&](const exec_event& event) {
+        if (event.pid == event.root)
+          remove_process(event.pid);
+      });
+}
+
+bool mrc_monitor::curve(pid_t pid, std::vector<double>& curve) const {
+  std::lock_guard<std::mutex> lock(curves_mutex_);
+  auto it = curves_.find(pid);
+  if (it == end(curves_) || !it->second.published)
+    return false;
+  curve = it->second.curve;
+  return true;
+}
+
+size_t mrc_monitor::samples(pid_t pid) const {
+  auto it = processes_.find(pid);
+  return it == end(processes_) ? 0 : it->second.samples;
+}
+
+void mrc_monitor::loop_impl() {
+  std::this_thread::sleep_for(sampling_interval_);
+  update_curves();
+}
+
+void mrc_monitor::update_curves() {
+  for (auto& p : processes_) {
+    auto& tp = p.second;
+    tp.samples = tp.source ? tp.source(tp.estimator) : 0;
+    tp.estimator.curve(scratch_);
+    tp.estimator.decay(decay_);
+
+    std::lock_guard<std::mutex> lock(curves_mutex_);
+    auto& published = curves_.at(p.first);
+    std::copy(begin(scratch_), end(scratch_), begin(published.curve));
+    published.published = true;
+  }
+}
+
+void mrc_monitor::add_process(pid_t pid) {
+  LOG(boost::format("Adding process %1%") % pid);
+  if (!sampling_)
+    return;
+
+  auto res = processes_.emplace(
+      pid, tracked_process{util::shards{shards_config_}, nullptr, 0});
+
+#ifdef __linux__
+  try {
+    auto sampler = std::make_shared<perf::address_sampler>(
+        pid, sample_event_, sample_period_);
+    res.first->second.source = [sampler](util::shards& estimator) {
+      return sampler->drain([&](uint64_t address) {
+        estimator.access(address);
+      });
+    };
+  } catch (const std::exception& e) {
+    LOG(boost::format("Error sampling the accesses of process %1%: %2%")
+        % pid % e.what());
+  }
+#endif
+
+  std::lock_guard<std::mutex> lock(curves_mutex_);
+  curves_.emplace(
+      pid, published_curve{std::vector<double>(shards_config_.bins, 1), false});
+}
+
+void mrc_monitor::remove_process(pid_t pid) {
+  auto it = processes_.find(pid);
+  if (it == end(processes_))
+    return;
+
+  LOG(boost::format("Removing process %1%") % pid);
+  {
+  std::lock_guard<std::mutex> lock(curves_mutex_);
+  auto curve_it = curves_.find(pid);
+  auto& curve = curve_it->second.curve;
+  // The curve is logged at cache sizes that double from a bin.
+  for (size_t bins = 1; bins <= curve.size(); bins *= 2) {
+    LOGI(boost::format("Miss ratio for process %1% with %2% KB: %3%")
+        % pid % (bins * bin_size() / 1024) % curve[bins - 1]);
+  }
+  curves_.erase(curve_it);
+  }
+  processes_.erase(it);
+}
+
+} // namespace aser
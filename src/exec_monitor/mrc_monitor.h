@@ -0,0 +1,124 @@
+#ifndef EXEC_MONITOR_MRC_MONITOR_H_
+#define EXEC_MONITOR_MRC_MONITOR_H_
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <core/exec_monitor.h>
+#include <util/shards.h>
+
+namespace aser {
+
+/** Execution monitor that estimates the miss ratio curve of every process.
+ *
+ * The data addresses accessed by every process are sampled (see
+ * perf::address_sampler) with the raw precise memory event in
+ * exec_monitor.sample_event, one sample every exec_monitor.sample_period
+ * events (1000 by default). Without a precise event, page faults are
+ * sampled instead, which only gives a coarse curve.
+ *
+ * The addresses are fed to a SHARDS estimator (see util::shards) that
+ * tracks up to exec_monitor.mrc_lines lines (8192 by default) of
+ * exec_monitor.mrc_line_size bytes (64 by default), starting at a
+ * sampling rate of exec_monitor.mrc_rate (one by default). The curve has
+ * exec_monitor.mrc_bins points (256 by default), one every
+ * exec_monitor.mrc_bin_size KB (64 by default).
+ *
+ * Every exec_monitor.sampling_length milliseconds, the curve of every
+ * process is published (see curve()), and the counts are multiplied by
+ * exec_monitor.mrc_decay (0.5 by default), so that the curve follows the
+ * phases of the program. Since addresses are sampled in time too, reuse
+ * distances are those among the sampled accesses.
+ */
+class mrc_monitor : public exec_monitor {
+public:
+  mrc_monitor(
+      exec_manager& exec_manager,
+      const boost::property_tree::ptree& properties);
+
+  /** Returns the latest miss ratio curve published for a process.
+   *
+   * This method can be safely called from any thread.
+   *
+   * @param pid The process identifier.
+   * @param curve Where to store the miss ratio for every cache size (see
+   *     util::shards::curve()).
+   * @return True if there is a curve for the process; false otherwise.
+   */
+  bool curve(pid_t pid, std::vector<double>& curve) const;
+
+  /** Returns the cache size between points of the curves (bytes). */
+  size_t bin_size() const noexcept {
+    return shards_config_.bin_lines * shards_config_.line_size;
+  }
+
+protected:
+  /** Collects the sampled addresses, and publishes and decays the curves.
+   */
+  void update_curves();
+
+  /** Sleeps for an interval and updates the curves. */
+  void loop_impl() override;
+
+  /** Returns the number of accesses of a process sampled on the latest
+   * interval (zero if unknown). */
+  size_t samples(pid_t pid) const;
+
+  /** Stops sampling the accesses of the processes added afterwards, for
+   * policies that do not need the curves. */
+  void disable_sampling() {
+    sampling_ = false;
+  }
+
+  std::chrono::milliseconds sampling_interval_;
+
+private:
+  /** Adds the addresses sampled since the previous call to an estimator,
+   * returning the number of samples. */
+  typedef std::function<size_t(util::shards&)> sample_source;
+
+  struct tracked_process {
+    util::shards estimator;
+    sample_source source;
+
+    /** Accesses sampled on the latest interval. */
+    size_t samples;
+  };
+
+  struct published_curve {
+    std::vector<double> curve;
+    bool published;
+  };
+
+  util::shards::config shards_config_;
+  uint64_t sample_event_;
+  uint64_t sample_period_;
+  double decay_;
+
+  /** Whether the accesses of new processes are sampled. */
+  bool sampling_ { true };
+
+  std::map<pid_t, tracked_process> processes_;
+
+  /** Latest curves (entries are created when processes are added, so that
+   * publishing does not allocate, and erased when they are removed). */
+  std::map<pid_t, published_curve> curves_;
+
+  /** Mutex protecting curves_. */
+  mutable std::mutex curves_mutex_;
+
+  /** Curve being computed (reused across intervals). */
+  std::vector<double> scratch_;
+
+  void add_process(pid_t pid);
+  void remove_process(pid_t pid);
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_MRC_MONITOR_H_
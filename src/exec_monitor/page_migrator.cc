@@ -0,0 +1,84 @@
+#include "page_migrator.h"
+
+#include <algorithm>
+
+#include <util/log.h>
+#include <util/os.h>
+
+namespace aser {
+
+page_migrator::page_migrator(
+    pid_t pid,
+    config cfg,
+    sample_source source,
+    page_mover mover)
+  : pid_{pid}
+  , config_(cfg)
+  , source_{std::move(source)}
+  , mover_{mover ? std::move(mover) : page_mover(util::move_pages)}
+  , hotness_{cfg.hot_pages, static_cast<size_t>(sysconf(_SC_PAGESIZE))}
+{
+  hot_.reserve(cfg.hot_pages);
+  pages_.reserve(cfg.hot_pages);
+  status_.reserve(cfg.hot_pages);
+}
+
+void page_migrator::set_target(int node) {
+  target_ = node;
+}
+
+void page_migrator::step(std::chrono::nanoseconds elapsed) {
+  stats_.samples += source_(hotness_);
+
+  hotness_.hottest(config_.hot_pages, hot_);
+  pages_.clear();
+  for (auto& p : hot_)
+    pages_.push_back(p.page);
+  mover_(pid_, pages_, -1, status_);
+
+  // Only the pages that are present count towards the ratio.
+  double accesses = 0, remote = 0;
+  for (size_t i = 0; i < hot_.size(); ++i) {
+    if (status_[i] < 0)
+      continue;
+    accesses += hot_[i].count;
+    if (target_ >= 0 && status_[i] != target_)
+      remote += hot_[i].count;
+  }
+  stats_.remote_ratio = accesses > 0 ? remote / accesses : 0;
+
+  auto batch_bytes = static_cast<double>(
+      config_.batch_pages * hotness_.page_size());
+  budget_ = std::min(
+      batch_bytes,
+      budget_ + config_.max_rate
+        * std::chrono::duration<double>(elapsed).count());
+
+  if (target_ >= 0) {
+    // Hottest pages first.
+    auto budget_pages = static_cast<size_t>(budget_ / hotness_.page_size());
+    pages_.clear();
+    for (size_t i = 0; i < hot_.size() && pages_.size() < budget_pages; ++i) {
+      if (status_[i] >= 0 && status_[i] != target_)
+        pages_.push_back(hot_[i].page);
+    }
+
+    if (!pages_.empty()) {
+      try {
+        mover_(pid_, pages_, target_, status_);
+        auto moved = static_cast<uint64_t>(
+            std::count(begin(status_), end(status_), target_));
+        stats_.moved_pages += moved;
+        stats_.moved_bytes += moved * hotness_.page_size();
+      } catch (const std::exception& e) {
+        LOG(boost::format("Error moving pages of process %1%: %2%")
+            % pid_ % e.what());
+      }
+      budget_ -= pages_.size() * hotness_.page_size();
+    }
+  }
+
+  hotness_.decay();
+}
+
+} // namespace aser
@@ -0,0 +1,111 @@
+#ifndef EXEC_MONITOR_PAGE_MIGRATOR_H_
+#define EXEC_MONITOR_PAGE_MIGRATOR_H_
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <util/page_hotness.h>
+
+namespace aser {
+
+/** Results of the migration of the pages of a process. */
+struct page_migration_stats {
+  /** Accesses sampled. */
+  uint64_t samples;
+
+  uint64_t moved_pages;
+  uint64_t moved_bytes;
+
+  /** Fraction of the sampled accesses that went to pages outside the
+   * target node, on the latest step. */
+  double remote_ratio;
+};
+
+/** Moves the hottest pages of a process to the node it runs on.
+ *
+ * On every step, the sampled accesses are added to a bounded hotness map
+ * (whose counts are then halved, so that the map follows the recent
+ * accesses), and up to a batch of the hottest pages outside the target
+ * node are moved to it. Moves are rate-limited: the budget grows with the
+ * time between steps, up to a batch.
+ */
+class page_migrator {
+public:
+  /** Adds the accesses sampled since the previous call to a hotness map,
+   * returning the number of samples. */
+  typedef std::function<size_t(util::page_hotness&)> sample_source;
+
+  /** Moves pages to a node or finds out where they are (see
+   * util::move_pages()). */
+  typedef std::function<void(
+      pid_t, const std::vector<uintptr_t>&, int, std::vector<int>&)>
+    page_mover;
+
+  struct config {
+    /** Maximum number of pages in the hotness map. */
+    size_t hot_pages;
+
+    /** Maximum number of pages moved on every step. */
+    size_t batch_pages;
+
+    /** Maximum number of bytes moved per second. */
+    double max_rate;
+  };
+
+  /** Constructor.
+   *
+   * @param pid The process identifier.
+   * @param cfg The configuration.
+   * @param source Source of the sampled accesses.
+   * @param mover Function to move pages (util::move_pages() by default).
+   */
+  page_migrator(
+      pid_t pid,
+      config cfg,
+      sample_source source,
+      page_mover mover = nullptr);
+
+  /** Sets the node the pages should be moved to (negative for none). */
+  void set_target(int node);
+
+  int target() const noexcept {
+    return target_;
+  }
+
+  /** Collects the sampled accesses and moves the hottest pages.
+   *
+   * @param elapsed Time since the previous step.
+   */
+  void step(std::chrono::nanoseconds elapsed);
+
+  const page_migration_stats& stats() const noexcept {
+    return stats_;
+  }
+
+private:
+  pid_t pid_;
+  config config_;
+  sample_source source_;
+  page_mover mover_;
+
+  util::page_hotness hotness_;
+  int target_ { -1 };
+
+  /** Bytes that can be moved. */
+  double budget_ { 0 };
+
+  page_migration_stats stats_ { 0, 0, 0, 0 };
+
+  /** Scratch space, reused across steps. */
+  std::vector<util::hot_page> hot_;
+  std::vector<uintptr_t> pages_;
+  std::vector<int> status_;
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_PAGE_MIGRATOR_H_
@@ -0,0 +1,239 @@
+#include "phase_detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace aser {
+
+constexpr unsigned phase_detector::none;
+constexpr unsigned phase_detector::nil;
+
+/** Count at which the transitions from a slot are halved, so that the
+ * predictor follows changes in the behavior. */
+static constexpr uint32_t max_transitions = 1 << 16;
+
+phase_predictor parse_phase_predictor(const std::string& name) {
+  if (name == "markov")
+    return phase_predictor::MARKOV;
+  if (name == "run-length")
+    return phase_predictor::RUN_LENGTH;
+  throw std::invalid_argument("Invalid phase predictor: " + name);
+}
+
+phase_detector::phase_detector(config cfg)
+  : config_(std::move(cfg))
+{
+  if (config_.max_phases < 2 || config_.max_phases > 1024)
+    throw std::invalid_argument(
+        "The number of phases must be between 2 and 1024");
+  if (config_.threshold < 0)
+    throw std::invalid_argument("The threshold must not be negative");
+  if (config_.histogram_weight < 0 || config_.histogram_weight > 1)
+    throw std::invalid_argument("The histogram weight must be in [0, 1]");
+  if (config_.memory == 0)
+    throw std::invalid_argument("The memory must be positive");
+  if (config_.min_run == 0)
+    throw std::invalid_argument("The minimum run must be positive");
+  if (config_.max_run_length == 0)
+    throw std::invalid_argument("The maximum run length must be positive");
+
+  slots_.reserve(config_.max_phases);
+  transitions_.assign(config_.max_phases * config_.max_phases, 0);
+  if (config_.predictor == phase_predictor::RUN_LENGTH)
+    run_successors_.assign(config_.max_phases * config_.max_run_length, 0);
+}
+
+unsigned phase_detector::phase() const noexcept {
+  return current_ == nil ? none : slots_[current_].id;
+}
+
+double phase_detector::distance(
+    const signature& a,
+    const signature& b,
+    double histogram_weight) {
+  double counters = 0;
+  for (size_t i = 0; i < a.counters.size(); ++i) {
+    // Values below one are compared by their absolute difference, so that
+    // small rates do not dominate the distance.
+    auto scale = std::max(
+        {std::abs(a.counters[i]), std::abs(b.counters[i]), 1.0});
+    counters += std::min(1.0, std::abs(a.counters[i] - b.counters[i]) / scale);
+  }
+  if (!a.counters.empty())
+    counters /= a.counters.size();
+
+  if (a.histogram.empty())
+    return counters;
+
+  double sum_a = 0;
+  double sum_b = 0;
+  for (size_t i = 0; i < a.histogram.size(); ++i) {
+    sum_a += a.histogram[i];
+    sum_b += b.histogram[i];
+  }
+  double histogram = 0;
+  if (sum_a > 0 && sum_b > 0) {
+    for (size_t i = 0; i < a.histogram.size(); ++i)
+      histogram += std::abs(a.histogram[i] / sum_a - b.histogram[i] / sum_b);
+    histogram /= 2;
+  } else if (sum_a > 0 || sum_b > 0) {
+    histogram = 1;
+  }
+
+  if (a.counters.empty())
+    return histogram;
+  return (1 - histogram_weight) * counters + histogram_weight * histogram;
+}
+
+unsigned phase_detector::classify(const signature& s) {
+  if (!slots_.empty()) {
+    auto& centroid = slots_.front().centroid;
+    if (s.counters.size() != centroid.counters.size()
+        || s.histogram.size() != centroid.histogram.size())
+      throw std::invalid_argument("The dimensions of the signature changed");
+  }
+
+  ++intervals_;
+  auto n = find_slot(s);
+  auto& sl = slots_[n];
+  update(sl, s);
+  sl.last_seen = intervals_;
+
+  if (current_ == nil) {
+    current_ = n;
+    run_ = 1;
+    return sl.id;
+  }
+
+  if (n == current_) {
+    candidate_ = nil;
+    candidate_run_ = 0;
+    transition(current_);
+    ++run_;
+    return sl.id;
+  }
+
+  if (n == candidate_) {
+    ++candidate_run_;
+  } else {
+    candidate_ = n;
+    candidate_run_ = 1;
+  }
+
+  if (candidate_run_ < config_.min_run) {
+    transition(current_);
+    ++run_;
+    return slots_[current_].id;
+  }
+
+  // The intervals of the candidate already counted in the run belong to
+  // the new phase.
+  run_ -= candidate_run_ - 1;
+  transition(candidate_);
+  previous_ = slots_[current_].id;
+  current_ = candidate_;
+  run_ = candidate_run_;
+  candidate_ = nil;
+  candidate_run_ = 0;
+  return sl.id;
+}
+
+unsigned phase_detector::predict() const {
+  if (current_ == nil)
+    return none;
+
+  auto next = current_;
+  if (config_.predictor == phase_predictor::MARKOV) {
+    auto row = &transitions_[current_ * config_.max_phases];
+    for (unsigned to = 0; to < slots_.size(); ++to) {
+      if (row[to] > row[next])
+        next = to;
+    }
+  } else {
+    auto length = std::min(run_, config_.max_run_length);
+    auto successor =
+      run_successors_[current_ * config_.max_run_length + length - 1];
+    if (successor > 0)
+      next = successor - 1;
+  }
+  return slots_[next].id;
+}
+
+unsigned phase_detector::find_slot(const signature& s) {
+  auto best = nil;
+  auto best_distance = std::numeric_limits<double>::infinity();
+  for (unsigned n = 0; n < slots_.size(); ++n) {
+    auto d = distance(s, slots_[n].centroid, config_.histogram_weight);
+    if (d < best_distance) {
+      best = n;
+      best_distance = d;
+    }
+  }
+  if (best != nil && best_distance <= config_.threshold)
+    return best;
+
+  if (slots_.size() < config_.max_phases) {
+    slots_.push_back({next_id_++, s, 0, 0});
+    return slots_.size() - 1;
+  }
+
+  // The least recently seen phase is replaced (never the current one).
+  auto victim = nil;
+  for (unsigned n = 0; n < slots_.size(); ++n) {
+    if (n != current_
+        && (victim == nil || slots_[n].last_seen < slots_[victim].last_seen))
+      victim = n;
+  }
+
+  forget(victim);
+  if (victim == candidate_) {
+    candidate_ = nil;
+    candidate_run_ = 0;
+  }
+  auto& sl = slots_[victim];
+  sl.id = next_id_++;
+  sl.count = 0;
+  return victim;
+}
+
+void phase_detector::update(slot& sl, const signature& s) {
+  ++sl.count;
+  auto weight = 1.0 / std::min<uint64_t>(sl.count, config_.memory);
+  auto& c = sl.centroid;
+  for (size_t i = 0; i < c.counters.size(); ++i)
+    c.counters[i] += weight * (s.counters[i] - c.counters[i]);
+  for (size_t i = 0; i < c.histogram.size(); ++i)
+    c.histogram[i] += weight * (s.histogram[i] - c.histogram[i]);
+}
+
+void phase_detector::forget(unsigned n) {
+  auto phases = config_.max_phases;
+  for (unsigned i = 0; i < phases; ++i) {
+    transitions_[n * phases + i] = 0;
+    transitions_[i * phases + n] = 0;
+  }
+
+  if (run_successors_.empty())
+    return;
+  auto lengths = config_.max_run_length;
+  std::fill_n(begin(run_successors_) + n * lengths, lengths, 0);
+  std::replace(begin(run_successors_), end(run_successors_), n + 1, 0u);
+}
+
+void phase_detector::transition(unsigned to) {
+  auto phases = config_.max_phases;
+  auto row = &transitions_[current_ * phases];
+  if (++row[to] >= max_transitions) {
+    for (unsigned i = 0; i < phases; ++i)
+      row[i] /= 2;
+  }
+
+  if (to != current_ && !run_successors_.empty()) {
+    auto length = std::min(run_, config_.max_run_length);
+    run_successors_[current_ * config_.max_run_length + length - 1] = to + 1;
+  }
+}
+
+} // namespace aser
@@ -0,0 +1,197 @@
+#ifndef EXEC_MONITOR_PHASE_DETECTOR_H_
+#define EXEC_MONITOR_PHASE_DETECTOR_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aser {
+
+/** Predictors of the next phase.
+ *
+ * MARKOV: the next phase is the most frequent successor of the current
+ * phase (staying in the phase included), so changes are predicted once
+ * they become more likely than staying.
+ *
+ * RUN_LENGTH: the state is the current phase and the length of its run so
+ * far. The next phase is the one that followed the last run of the same
+ * phase that ended with the same length, or the current phase if there is
+ * none. Suited to phases with regular durations.
+ */
+enum class phase_predictor { MARKOV, RUN_LENGTH };
+
+/** Parses the name of a phase predictor ("markov" or "run-length").
+ *
+ * @throw std::invalid_argument If the name is not valid.
+ */
+phase_predictor parse_phase_predictor(const std::string& name);
+
+/** Online detection and prediction of execution phases.
+ *
+ * On every interval, the detector gets the signature of the interval, and
+ * it classifies the interval into a phase. Phases are clustered
+ * incrementally: the interval joins the phase with the nearest centroid if
+ * it is within threshold, and it starts a new phase otherwise. The
+ * centroid of a phase moves towards the intervals it classifies. The phase
+ * table is bounded: once it is full, the least recently seen phase is
+ * replaced.
+ *
+ * A signature has a vector of counter rates (e.g., cycles and cache misses
+ * per instruction) and, optionally, a histogram (e.g., of sampled
+ * instruction pointers). Counters are compared dimension by dimension with
+ * their relative difference, and histograms with half of the Manhattan
+ * distance between their normalized vectors, so both distances are between
+ * zero and one.
+ *
+ * To filter out transients, the current phase only changes after min_run
+ * consecutive intervals are classified into another phase. Phase
+ * identifiers start at one and are never reused.
+ *
+ * Once the table is full, classifying an interval does not allocate
+ * memory.
+ */
+class phase_detector {
+public:
+  /** Phase identifier that marks no phase. */
+  static constexpr unsigned none = 0;
+
+  struct config {
+    /** Maximum number of phases kept. */
+    unsigned max_phases;
+
+    /** Maximum distance from the centroid of a phase to join it. */
+    double threshold;
+
+    /** Weight of the histogram in the distance, from zero to one (only if
+     * signatures have one). */
+    double histogram_weight;
+
+    /** Number of intervals averaged for every centroid (the weight of a
+     * new interval is at least 1 / memory). */
+    unsigned memory;
+
+    /** Consecutive intervals needed to change the current phase. */
+    unsigned min_run;
+
+    phase_predictor predictor;
+
+    /** Longest run length distinguished by the run-length predictor
+     * (longer runs count as this length). */
+    unsigned max_run_length;
+  };
+
+  /** Signature of an interval. */
+  struct signature {
+    std::vector<double> counters;
+    std::vector<double> histogram;
+  };
+
+  /** Constructor.
+   *
+   * @param cfg Configuration of the detector.
+   * @throw std::invalid_argument If the configuration is not valid.
+   */
+  explicit phase_detector(config cfg);
+
+  /** Classifies an interval.
+   *
+   * Every signature must have the same dimensions.
+   *
+   * @param s The signature of the interval.
+   * @return The current phase.
+   * @throw std::invalid_argument If the dimensions of the signature change.
+   */
+  unsigned classify(const signature& s);
+
+  /** Returns the current phase (none before the first interval). */
+  unsigned phase() const noexcept;
+
+  /** Returns the phase the current one replaced (none if there is none).
+   */
+  unsigned previous() const noexcept {
+    return previous_;
+  }
+
+  /** Returns the number of intervals the current phase has lasted. */
+  unsigned run_length() const noexcept {
+    return run_;
+  }
+
+  /** Returns the predicted phase of the next interval (none before the
+   * first interval). */
+  unsigned predict() const;
+
+  /** Returns the number of phases in the table. */
+  size_t size() const noexcept {
+    return slots_.size();
+  }
+
+  /** Returns the distance between two signatures, between zero and one.
+   *
+   * @param histogram_weight Weight of the histogram.
+   */
+  static double distance(
+      const signature& a,
+      const signature& b,
+      double histogram_weight);
+
+private:
+  /** Index that marks no slot. */
+  static constexpr unsigned nil = static_cast<unsigned>(-1);
+
+  /** A phase in the table. */
+  struct slot {
+    unsigned id;
+    signature centroid;
+
+    /** Intervals classified into the phase. */
+    uint64_t count;
+
+    /** Interval at which the phase was seen last. */
+    uint64_t last_seen;
+  };
+
+  config config_;
+
+  std::vector<slot> slots_;
+
+  /** Slot of the current phase. */
+  unsigned current_ { nil };
+
+  unsigned previous_ { none };
+
+  /** Intervals in the current run. */
+  unsigned run_ { 0 };
+
+  /** Slot that intervals were classified into instead of the current one,
+   * and the number of consecutive intervals. */
+  unsigned candidate_ { nil };
+  unsigned candidate_run_ { 0 };
+
+  uint64_t intervals_ { 0 };
+  unsigned next_id_ { 1 };
+
+  /** Transitions between slots (from * max_phases + to), including the
+   * intervals that stay in a phase. */
+  std::vector<uint32_t> transitions_;
+
+  /** Slot that followed a run (slot * max_run_length + length - 1), plus
+   * one (zero if there is none). */
+  std::vector<unsigned> run_successors_;
+
+  /** Returns the slot for a signature, replacing a phase if needed. */
+  unsigned find_slot(const signature& s);
+
+  /** Moves the centroid of a slot towards a signature. */
+  void update(slot& sl, const signature& s);
+
+  /** Forgets the transitions from and to a slot. */
+  void forget(unsigned n);
+
+  /** Records that the current phase moves to another slot (or stays). */
+  void transition(unsigned to);
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_PHASE_DETECTOR_H_
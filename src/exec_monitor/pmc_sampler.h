@@ -2,16 +2,67 @@
 #define EXEC_MONITOR_PMC_SAMPLER_H_
 
 #include <chrono>
+#include <exception>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <core/application.h>
 #include <core/exec_monitor.h>
 #include <perf/event.h>
+#include <perf/scale.h>
+#include <util/cpu_mapper.h>
+#include <util/thread.h>
 
 namespace aser {
 
+/** Execution monitor that periodically samples performance counters
+ * (cycles, instructions and last-level cache misses) for every application,
+ * and publishes the resulting IPC and memory bandwidth.
+ *
+ * Counters are inherited by the processes and threads created after they
+ * are attached, so every application starts with a single set of counters
+ * for its root process. Processes that join the application without
+ * descending from a counted process (e.g., processes that existed before
+ * the application was added or that joined its control group) get their own
+ * counters. The samples for all the counters in an application are
+ * aggregated, and the metrics are published for the root process.
+ *
+ * Counters can be read in parallel by a set of collection threads
+ * (exec_monitor.collection_threads; zero reads them on the monitor thread).
+ * The threads are bound to the NUMA nodes in round-robin order, and every
+ * application is assigned to a thread on the node where its root process
+ * was running when it was added. The threads write the samples into
+ * per-application buffers, and they meet at a barrier before the metrics
+ * are published, so that every tick yields a single snapshot.
+ *
+ * By default (exec_monitor.snapshot_reads), every thread reads all its
+ * counters back to back before scaling any of them, which minimizes the
+ * time spread across processes, and it scales the counts of all its
+ * applications in a single batch, so that vector instructions process
+ * several applications at once (otherwise, every application is scaled in
+ * its own batch). The counts of every process are normalized to the
+ * sampling interval using the time window of each sample.
+ *
+ * A history of the metrics for every application can be kept with
+ * exec_monitor.history_length (see exec_monitor::history()).
+ *
+ * The membership of the applications is refreshed every
+ * exec_monitor.refresh_period milliseconds (1000 by default), between
+ * ticks. A value that is not positive only refreshes it when a process
+ * forks, which is the default if process events are enabled. Every buffer
+ * is allocated when an application is added or changes, so sampling does
+ * not allocate memory.
+ *
+ * If exec_monitor.placement is set, every application is bound to its own
+ * CPU, chosen with that placement strategy (see util::placement).
+ */
 template<typename EventManager>
 class pmc_sampler : public exec_monitor {
 public:
@@ -19,25 +70,226 @@ public:
       exec_manager& exec_manager,
       const boost::property_tree::ptree& properties);
 
+  ~pmc_sampler();
+
+  /** Timing of a collection of counters. */
+  struct collection_stats {
+    /** Time from the first read until the last one finishes (seconds). */
+    double duration;
+
+    /** Time between reading the first and the last application
+     * (seconds). */
+    double skew;
+
+    /** Number of shards that read any application. */
+    unsigned shards;
+
+    /** Number of events scaled with vector instructions. */
+    size_t vectorized;
+  };
+
+  /** Returns the timing of the latest collection.
+   *
+   * This method can be safely called from any thread.
+   */
+  collection_stats last_collection() const;
+
 private:
   using event_manager = EventManager;
 
+  /** Position of each event in events_. */
+  enum event_index { CYCLES = 0, INSTRUCTIONS, CACHE_MISSES };
+
+  /** Bytes transferred on every last-level cache miss. */
+  static constexpr double cache_line_size = 64;
+
   /** Interval between samples. */
   std::chrono::milliseconds sampling_interval_;
 
   /** Events to measure. */
   std::vector<perf::event_info> events_;
 
-  /** PMCs event managers. */
-  std::map<pid_t, event_manager> event_managers_;
+  /** Counters for an application. */
+  struct application_counters {
+    application app;
+
+    /** Event managers for the processes whose counters are not inherited
+     * from another counted process. */
+    std::map<pid_t, event_manager> event_managers;
+
+    /** Processes that inherit the counters from an ancestor. They are
+     * remembered because they still inherit the counters after being
+     * reparented (e.g., once their parent finishes). */
+    std::set<pid_t> inheriting;
+
+    /** Aggregated samples for the latest tick. */
+    typename event_manager::sample_list samples;
+
+    /** Shard that reads the counters. */
+    unsigned shard;
+
+    /** CPU the application is bound to (-1 if it is not bound). */
+    int cpu;
+  };
+
+  using clock = std::chrono::steady_clock;
+
+  /** A set of applications whose counters are read by the same thread. */
+  struct shard {
+    /** CPUs the collection thread is bound to. */
+    std::vector<unsigned> cpus;
+
+    /** Number of applications assigned to the shard. */
+    size_t load { 0 };
+
+    /** Applications to read on the current tick (the storage is reused
+     * across ticks). */
+    std::vector<application_counters*> work;
+
+    /** Time at which the first and the last applications were read, and
+     * at which reading finished. */
+    clock::time_point first_read;
+    clock::time_point last_read;
+    clock::time_point finished;
+
+    /** Counts and samples of the events scaled in a batch (the storage is
+     * reused across ticks). */
+    perf::count_buffer counts;
+    perf::count_buffer prev_counts;
+    perf::sample_buffer batch_samples;
+
+    /** Events scaled with vector instructions on the current tick. */
+    size_t vectorized { 0 };
+
+    /** Error raised while reading the counters. */
+    std::exception_ptr error;
+
+    std::thread thread;
+  };
+
+  /** Directory containing the per-application control groups. */
+  std::string cgroup_root_;
+
+  /** Counters for each application (indexed by the root process). */
+  std::map<pid_t, application_counters> applications_;
+
+  /** CPUs to bind the applications to (null if they are not bound). */
+  std::unique_ptr<util::cpu_mapper> cpus_;
+
+  /** Number of collection threads. */
+  unsigned collection_threads_;
+
+  /** Whether all the counters in a shard are read before scaling them. */
+  bool snapshot_reads_;
+
+  /** Interval between refreshes of the application membership (not
+   * positive to refresh only on process events). */
+  std::chrono::milliseconds refresh_period_;
+
+  /** Shards (a single one without a collection thread if
+   * collection_threads_ is zero). */
+  std::vector<shard> shards_;
+
+  /** Barriers where the monitor thread and the collection threads meet
+   * before and after reading the counters. */
+  util::barrier start_barrier_;
+  util::barrier done_barrier_;
 
+  /** Whether the collection threads must finish. */
+  bool stopping_ { false };
+
+  collection_stats last_collection_ { 0, 0, 0, 0 };
+
+  /** Mutex protecting last_collection_. */
+  mutable std::mutex stats_mutex_;
+
+  void initialize_impl() final;
+  void finalize_impl() final;
   void loop_impl() final;
 
+  /** Refreshes the membership of an application, attaching counters to
+   * its new processes. */
+  void refresh(application_counters& counters);
+
+  /** Schedules the next periodic refresh of every application. */
+  void schedule_refresh();
+
+  /** Body of a collection thread. */
+  void collection_thread(shard& s);
+
+  /** Stops the collection threads. */
+  void stop_collection_threads();
+
+  /** Reads the counters for all the applications in a shard. */
+  void collect(shard& s);
+
+  /** Reads the counters for an application, without scaling them. */
+  void read_counters(application_counters& counters);
+
+  /** Scales the counters read for the applications [first, last) in a
+   * shard in a single batch, and aggregates them into their samples. */
+  void scale_samples(shard& s, size_t first, size_t last);
+
+  /** Aggregates the samples of an application from a scaled batch.
+   *
+   * @param counters The counters for the application.
+   * @param s The shard that scaled the batch.
+   * @param offset Position of the first event of the application in the
+   *     batch; it is advanced past its events.
+   * @param scaled Number of events in the batch that were scaled.
+   */
+  void aggregate_samples(
+      application_counters& counters,
+      const shard& s,
+      size_t& offset,
+      size_t scaled);
+
+  /** Updates the timing of the latest collection. */
+  void update_collection_stats();
+
+  /** Chooses the shard for a new application.
+   *
+   * @param pid The pid of the root process.
+   * @return The index of the shard.
+   */
+  unsigned assign_shard(pid_t pid);
+
+  /** Attaches counters to the processes in an application that are not
+   * covered yet.
+   *
+   * @param counters The counters for the application.
+   */
+  void attach_uncovered(application_counters& counters);
+
+  /** Checks whether a process inherits the counters from one of its
+   * ancestors in an application.
+   *
+   * @param counters The counters for the application.
+   * @param pid The pid of the process.
+   */
+  bool is_covered(const application_counters& counters, pid_t pid) const;
+
+  /** Binds all the threads in an application to a CPU.
+   *
+   * @param counters The counters for the application.
+   */
+  void bind_application(const application_counters& counters);
+
   /** Adds a new process.
    *
    * @param pid The pid of the process.
    */
   void add_process(pid_t pid);
+
+  /** Releases the counters for a finished process.
+   *
+   * If the process is the benchmark process, the counters for the whole
+   * application are released. Counts since the last sample are discarded.
+   *
+   * @param root The benchmark process of the application.
+   * @param pid The pid of the process.
+   */
+  void remove_process(pid_t root, pid_t pid);
 };
 
 } // namespace aser
@@ -0,0 +1,60 @@
+#include "search_objective.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <util/factory.h>
+
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+util::registar<search_objective, weighted_speedup_objective, const pt::ptree&>
+  weighted_speedup_objective_registar("weighted-speedup");
+
+util::registar<search_objective, weighted_speedup_objective, const pt::ptree&>
+  stp_objective_registar("stp");
+
+util::registar<search_objective, fairness_objective, const pt::ptree&>
+  fairness_objective_registar("fairness");
+
+util::registar<search_objective, energy_objective, const pt::ptree&>
+  energy_objective_registar("energy");
+
+/** Returns the progress of an application relative to running alone. */
+static double progress(const search_objective::sample& s, size_t i) {
+  return s.reference_rate[i] > 0 ? s.rate[i] / s.reference_rate[i] : 0;
+}
+
+double weighted_speedup_objective::evaluate(const sample& s) const {
+  double speedup = 0;
+  for (size_t i = 0; i < s.rate.size(); ++i)
+    speedup += progress(s, i);
+  return speedup;
+}
+
+double fairness_objective::evaluate(const sample& s) const {
+  if (s.rate.empty())
+    return 0;
+
+  auto slowest = progress(s, 0);
+  auto fastest = slowest;
+  for (size_t i = 1; i < s.rate.size(); ++i) {
+    slowest = std::min(slowest, progress(s, i));
+    fastest = std::max(fastest, progress(s, i));
+  }
+  return fastest > 0 ? slowest / fastest : 0;
+}
+
+energy_objective::energy_objective(const pt::ptree& properties)
+  : delay_weight_{properties.get<double>("delay_weight", 0)}
+{}
+
+double energy_objective::evaluate(const sample& s) const {
+  if (s.energy <= 0)
+    return std::numeric_limits<double>::quiet_NaN();
+  return s.instructions / s.energy * std::pow(s.instructions, delay_weight_);
+}
+
+} // namespace aser
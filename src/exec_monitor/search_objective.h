@@ -0,0 +1,86 @@
+#ifndef EXEC_MONITOR_SEARCH_OBJECTIVE_H_
+#define EXEC_MONITOR_SEARCH_OBJECTIVE_H_
+
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace aser {
+
+/** Base class for the objectives that an online configuration search
+ * maximizes (see config_searcher).
+ *
+ * Objectives are created through util::create<search_objective>(), passing
+ * the objective configuration properties.
+ */
+class search_objective {
+public:
+  /** Measurements of the applications during an interval. */
+  struct sample {
+    /** Instructions per second of every application. Unlike IPC, the rate
+     * accounts for the CPUs and the frequency an application gets. */
+    std::vector<double> rate;
+
+    /** Rate of every application running alone (in practice, the best rate
+     * it has reached). */
+    std::vector<double> reference_rate;
+
+    /** Instructions retired by all the applications. */
+    double instructions;
+
+    /** Energy consumed during the interval (joules; negative if unknown).
+     */
+    double energy;
+  };
+
+  virtual ~search_objective() = default;
+
+  /** Returns the value of an interval (higher is better), or NaN if the
+   * interval cannot be evaluated (e.g., the energy is unknown). */
+  virtual double evaluate(const sample& s) const = 0;
+
+  /** Returns whether the objective needs the energy. */
+  virtual bool needs_energy() const {
+    return false;
+  }
+};
+
+/** Weighted speedup, or system throughput (STP): the sum of the progress
+ * of every application relative to running alone. */
+class weighted_speedup_objective : public search_objective {
+public:
+  weighted_speedup_objective(const boost::property_tree::ptree&) {}
+
+  double evaluate(const sample& s) const final;
+};
+
+/** Fairness: the progress of the slowest application relative to the
+ * fastest one (one if every application progresses at the same rate). */
+class fairness_objective : public search_objective {
+public:
+  fairness_objective(const boost::property_tree::ptree&) {}
+
+  double evaluate(const sample& s) const final;
+};
+
+/** Energy efficiency: instructions per joule, multiplied by the
+ * instructions per interval to the power of delay_weight (e.g., a weight
+ * of one minimizes the energy-delay product). Intervals without energy
+ * cannot be evaluated. */
+class energy_objective : public search_objective {
+public:
+  energy_objective(const boost::property_tree::ptree& properties);
+
+  double evaluate(const sample& s) const final;
+
+  bool needs_energy() const final {
+    return true;
+  }
+
+private:
+  double delay_weight_;
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_SEARCH_OBJECTIVE_H_
@@ -0,0 +1,111 @@
+#include "slo_controller.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace aser {
+
+slo_algorithm parse_slo_algorithm(const std::string& name) {
+  if (name == "pid")
+    return slo_algorithm::PID;
+  if (name == "heracles")
+    return slo_algorithm::STATE_MACHINE;
+  throw std::invalid_argument("Invalid SLO algorithm: " + name);
+}
+
+slo_controller::slo_controller(config cfg)
+  : config_(cfg)
+{
+  if (config_.max_rate <= 0)
+    throw std::invalid_argument("The rate limit must be positive");
+  if (config_.low_slack > config_.high_slack)
+    throw std::invalid_argument(
+        "The low slack must not be above the high slack");
+  if (config_.kp < 0 || config_.ki < 0 || config_.kd < 0)
+    throw std::invalid_argument("Gains must not be negative");
+}
+
+void slo_controller::fall_back() {
+  share_ = 0;
+  state_ = state::FALLBACK;
+  fallback_left_ = config_.fallback_ticks;
+  integral_ = 0;
+  has_error_ = false;
+}
+
+void slo_controller::move_to(double share) {
+  share = std::min(1.0, std::max(0.0, share));
+  auto next = std::min(share_ + config_.max_rate,
+      std::max(share_ - config_.max_rate, share));
+  state_ = next > share_ ? state::GROW
+    : next < share_ ? state::SHRINK
+    : state::HOLD;
+  share_ = next;
+}
+
+double slo_controller::step(double slack) {
+  missing_ = 0;
+  if (slack < config_.fallback_slack) {
+    fall_back();
+    return share_;
+  }
+  if (fallback_left_ > 0) {
+    --fallback_left_;
+    return share_;
+  }
+
+  if (config_.algorithm == slo_algorithm::PID)
+    move_to(pid(slack));
+  else
+    move_to(state_machine(slack));
+  return share_;
+}
+
+double slo_controller::step_missing() {
+  if (fallback_left_ > 0) {
+    --fallback_left_;
+    return share_;
+  }
+
+  ++missing_;
+  if (config_.missing_ticks > 0 && missing_ >= config_.missing_ticks) {
+    fall_back();
+    missing_ = 0;
+  } else if (state_ != state::FALLBACK) {
+    state_ = state::HOLD;
+  }
+  return share_;
+}
+
+double slo_controller::pid(double slack) {
+  auto error = slack - config_.target_slack;
+  auto derivative = has_error_ ? error - previous_error_ : 0;
+  previous_error_ = error;
+  has_error_ = true;
+
+  integral_ += error;
+  auto output = config_.kp * error + config_.ki * integral_
+    + config_.kd * derivative;
+
+  // Back-calculation: the integral matches the share that will actually be
+  // applied, so that it does not wind up beyond what the rate limit and
+  // the bounds allow.
+  auto applied = std::min(1.0, std::max(0.0, output));
+  applied = std::min(share_ + config_.max_rate,
+      std::max(share_ - config_.max_rate, applied));
+  if (applied != output && config_.ki > 0) {
+    integral_ = (applied - config_.kp * error - config_.kd * derivative)
+      / config_.ki;
+  }
+  return applied;
+}
+
+double slo_controller::state_machine(double slack) {
+  if (slack < config_.low_slack)
+    return share_ - config_.step;
+  if (slack > config_.high_slack)
+    return share_ + config_.step;
+  return share_;
+}
+
+} // namespace aser
@@ -0,0 +1,151 @@
+#ifndef EXEC_MONITOR_SLO_CONTROLLER_H_
+#define EXEC_MONITOR_SLO_CONTROLLER_H_
+
+#include <string>
+
+namespace aser {
+
+/** Algorithms to hold a service level objective (SLO).
+ *
+ * PID: the share of the batch jobs follows a PID controller on the error
+ * between the slack and a target slack. The integral tracks the share
+ * applied (back-calculation), so it does not wind up while the share is
+ * saturated or rate-limited.
+ *
+ * STATE_MACHINE: Heracles-style controller. The share of the batch jobs
+ * grows by a step while the slack is above high_slack, it shrinks by a
+ * step while it is below low_slack, and it holds in between.
+ */
+enum class slo_algorithm { PID, STATE_MACHINE };
+
+/** Parses the name of an SLO algorithm ("pid" or "heracles").
+ *
+ * @throw std::invalid_argument If the name is not valid.
+ */
+slo_algorithm parse_slo_algorithm(const std::string& name);
+
+/** Feedback controller that decides the share of the resources given to
+ * batch jobs co-located with a latency-critical process.
+ *
+ * On every tick, the controller gets the slack of the latency-critical
+ * process (its relative distance to the SLO; negative if the SLO is
+ * violated), and it returns the share of the batch jobs, between zero
+ * (the minimum resources) and one (the maximum resources). The share
+ * changes by at most max_rate per tick.
+ *
+ * The controller falls back to a safe state (share zero) if the slack
+ * drops below fallback_slack, or if the signal is missing for
+ * missing_ticks ticks. It stays there for fallback_ticks ticks, and then it
+ * grows the share again from zero.
+ *
+ * Ticks take constant time and do not allocate memory.
+ */
+class slo_controller {
+public:
+  enum class state {
+    /** The share grew on the last tick. */
+    GROW,
+
+    /** The share did not change on the last tick. */
+    HOLD,
+
+    /** The share shrank on the last tick. */
+    SHRINK,
+
+    /** The batch jobs get the minimum resources. */
+    FALLBACK
+  };
+
+  struct config {
+    slo_algorithm algorithm;
+
+    /** Slack the PID controller aims at. */
+    double target_slack;
+
+    /** Gains of the PID controller (share per unit of error). */
+    double kp;
+    double ki;
+    double kd;
+
+    /** Thresholds of the state machine. */
+    double low_slack;
+    double high_slack;
+
+    /** Change of the share on every step of the state machine. */
+    double step;
+
+    /** Maximum change of the share per tick. */
+    double max_rate;
+
+    /** Slack below which the controller falls back to the safe state. */
+    double fallback_slack;
+
+    /** Ticks spent in the safe state. */
+    unsigned fallback_ticks;
+
+    /** Ticks without signal before falling back to the safe state (zero to
+     * hold the share instead). */
+    unsigned missing_ticks;
+  };
+
+  /** Constructor.
+   *
+   * @param cfg Configuration of the controller.
+   * @throw std::invalid_argument If the configuration is not valid.
+   */
+  explicit slo_controller(config cfg);
+
+  /** Advances the controller by one tick.
+   *
+   * @param slack Slack of the latency-critical process.
+   * @return The share of the batch jobs.
+   */
+  double step(double slack);
+
+  /** Advances the controller by one tick without signal (e.g., the
+   * latency-critical process did not report anything).
+   *
+   * @return The share of the batch jobs.
+   */
+  double step_missing();
+
+  /** Returns the share of the batch jobs. */
+  double share() const noexcept {
+    return share_;
+  }
+
+  /** Returns the state after the last tick. */
+  state current_state() const noexcept {
+    return state_;
+  }
+
+private:
+  config config_;
+
+  double share_ { 0 };
+  state state_ { state::HOLD };
+
+  double integral_ { 0 };
+  double previous_error_ { 0 };
+
+  /** Whether previous_error_ holds an error (for the derivative). */
+  bool has_error_ { false };
+
+  /** Ticks left in the safe state. */
+  unsigned fallback_left_ { 0 };
+
+  /** Consecutive ticks without signal. */
+  unsigned missing_ { 0 };
+
+  void fall_back();
+
+  /** Moves the share towards a value, within the rate limit. */
+  void move_to(double share);
+
+  double pid(double slack);
+  double state_machine(double slack);
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_SLO_CONTROLLER_H_
@@ -0,0 +1,450 @@
+#include "slo_guard.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <thread>
+
+#include <core/exec_manager.h>
+#include <perf/event_dummy.h>
+#include <perf/event_linux.h>
+#include <perf/event_manager.h>
+#include <util/factory.h>
+#include <util/kill.h>
+#include <util/log.h>
+#include <util/numa.h>
+#include <util/os.h>
+#include <util/resctrl.h>
+
+namespace chrono = std::chrono;
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+util::registar<exec_monitor, slo_guard,
+    exec_manager&, const pt::ptree&>
+  slo_guard_registar("slo-guard");
+
+template<typename Impl>
+slo_guard::counter_factory slo_guard::make_counter_factory(
+    std::vector<perf::event_info> events) {
+  return [events](pid_t pid) {
+    // Readers must be copyable, so the manager is shared.
+    auto manager = std::make_shared<perf::event_manager<perf::event<Impl>>>(
+        events, pid, true);
+    return [manager] {
+      auto& samples = manager->read_events(perf::event_read_mode::RELATIVE);
+      return ipc_counts{samples[0].value, samples[1].value};
+    };
+  };
+}
+
+slo_controller::config slo_guard::controller_config(
+    const pt::ptree& properties) {
+  auto algorithm = parse_slo_algorithm(
+      properties.get<std::string>("exec_monitor.controller", "pid"));
+  return {
+    algorithm,
+    properties.get<double>("exec_monitor.target_slack", 0.1),
+    properties.get<double>("exec_monitor.kp", 0.5),
+    properties.get<double>("exec_monitor.ki", 0.2),
+    properties.get<double>("exec_monitor.kd", 0),
+    properties.get<double>("exec_monitor.low_slack", 0.05),
+    properties.get<double>("exec_monitor.high_slack", 0.1),
+    properties.get<double>("exec_monitor.step", 0.05),
+    properties.get<double>("exec_monitor.max_rate", 0.1),
+    properties.get<double>("exec_monitor.fallback_slack",
+        algorithm == slo_algorithm::PID ? -0.25 : 0),
+    properties.get<unsigned>("exec_monitor.fallback_ticks", 100),
+    properties.get<unsigned>("exec_monitor.missing_ticks", 50)};
+}
+
+void slo_guard::create_resources(const pt::ptree& properties) {
+  auto resctrl_root = properties.get<std::string>(
+      "exec_monitor.resctrl_root", "/sys/fs/resctrl");
+
+  std::istringstream names(
+      properties.get<std::string>("exec_monitor.resources", "cpus"));
+  std::string name;
+  while (names >> name) {
+    resource r{name, 0, 0, 0, nullptr};
+
+    if (name == "cpus") {
+      r.min = properties.get<unsigned>("exec_monitor.min_batch_cpus", 1);
+      r.max = cpus_.size() - 1;
+      r.apply = [this](unsigned cpus) {
+        batch_cpus_ = cpus;
+        if (critical_app_)
+          bind_application(*critical_app_, true);
+        for (auto& b : batch_)
+          bind_application(b.second, false);
+      };
+    } else if (name == "cache") {
+      auto info = util::read_l3_allocation_info(resctrl_root);
+      r.min = info.min_ways;
+      r.max = info.ways - info.min_ways;
+      r.apply = [this, info](unsigned ways) {
+        util::set_l3_ways(batch_group_, info.domains, 0, ways);
+        util::set_l3_ways(critical_group_, info.domains, ways,
+            info.ways - ways);
+      };
+    } else if (name == "bandwidth") {
+      auto info = util::read_mb_allocation_info(resctrl_root);
+      r.min = info.min_bandwidth;
+      r.max = 100;
+      r.apply = [this, info](unsigned bandwidth) {
+        util::set_mb_throttle(batch_group_, info.domains, bandwidth);
+      };
+    } else {
+      throw std::invalid_argument("Invalid resource: " + name);
+    }
+
+    if (r.min > r.max)
+      throw std::invalid_argument("Not enough " + name + " to share");
+    if ((name == "cache" || name == "bandwidth") && batch_group_.empty()) {
+      critical_group_ = resctrl_root + "/aser-critical";
+      batch_group_ = resctrl_root + "/aser-batch";
+      util::create_resctrl_group(critical_group_);
+      util::create_resctrl_group(batch_group_);
+    }
+    resources_.push_back(std::move(r));
+  }
+}
+
+slo_guard::slo_guard(
+    exec_manager& exec_manager,
+    const pt::ptree& properties)
+  : exec_monitor(exec_manager)
+  , tick_{static_cast<long>(1000 * properties.get<double>(
+        "exec_monitor.sampling_length"))}
+  , cgroup_root_{application::cgroup_root(properties)}
+  , protected_{properties.get<unsigned>("exec_monitor.protected", 0)}
+  , target_{properties.get<double>("exec_monitor.slo_target")}
+  , alpha_{properties.get<double>("exec_monitor.signal_alpha", 0.3)}
+  , controller_{controller_config(properties)}
+  , pause_batch_{properties.get<bool>("exec_monitor.pause_batch", true)}
+  , refresh_{!properties.get<bool>("exec_manager.process_events", false)}
+{
+  if (tick_.count() <= 0)
+    throw std::invalid_argument("The tick must be positive");
+  if (target_ <= 0)
+    throw std::invalid_argument("The SLO target must be positive");
+  if (alpha_ <= 0 || alpha_ > 1)
+    throw std::invalid_argument("The signal alpha must be in (0, 1]");
+
+  auto signal = properties.get<std::string>("exec_monitor.slo_signal", "ipc");
+  if (signal == "ipc") {
+    source_ = signal_type::IPC;
+  } else if (signal == "heartbeat" || signal == "latency") {
+    source_ = signal == "heartbeat"
+      ? signal_type::HEARTBEAT
+      : signal_type::LATENCY;
+    file_ = std::make_unique<util::value_file>(
+        properties.get<std::string>("exec_monitor.slo_file"));
+  } else {
+    throw std::invalid_argument("Invalid SLO signal: " + signal);
+  }
+
+  auto list = properties.get<std::string>("exec_monitor.cpus", "");
+  cpus_ = list.empty() ? util::allowed_cpus() : util::parse_cpu_list(list);
+  std::sort(begin(cpus_), end(cpus_));
+  if (cpus_.empty())
+    throw std::invalid_argument("No CPUs available");
+  batch_cpus_ = cpus_.size();
+
+  create_resources(properties);
+
+  // The batch jobs start with the minimum resources.
+  for (auto& r : resources_) {
+    r.applied = r.min;
+    try {
+      r.apply(r.min);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error applying %1%: %2%") % r.name % e.what());
+    }
+  }
+
+  using namespace perf;
+  auto name = properties.get<std::string>("exec_monitor.event", "linux");
+  auto generic = create_generic_events(name);
+  std::vector<event_info> events = {
+    {event_type::HARDWARE, generic.cycles, event_modifiers::EXCLUDE_NONE},
+    {event_type::HARDWARE, generic.instructions,
+      event_modifiers::EXCLUDE_NONE}
+  };
+  if (name == "dummy")
+    counter_factory_ = make_counter_factory<event_dummy_impl>(events);
+#ifdef __linux__
+  else
+    counter_factory_ = make_counter_factory<event_linux_impl>(events);
+#endif
+
+  register_event_handler(
+      exec_event::event_type::PROCESS_CREATED,
+      [&](const exec_event& event) {
+        add_process(event.pid);
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_EXITED,
+      [&](const exec_event& event) {
+        if (event.pid == event.root) {
+          remove_process(event.pid);
+        } else if (event.root == critical_) {
+          critical_app_->remove_process(event.pid);
+        } else {
+          auto it = batch_.find(event.root);
+          if (it != end(batch_))
+            it->second.remove_process(event.pid);
+        }
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_FORKED,
+      [&](const exec_event& event) {
+        add_task(event.root, event.pid, true);
+      });
+  register_event_handler(
+      exec_event::event_type::THREAD_CREATED,
+      [&](const exec_event& event) {
+        add_task(event.root, event.payload.thread.tid, false);
+      });
+  register_event_handler(
+      exec_event::event_type::THREAD_EXITED,
+      [&](const exec_event& event) {
+        if (event.root == critical_) {
+          critical_app_->remove_thread(event.payload.thread.tid);
+        } else {
+          auto it = batch_.find(event.root);
+          if (it != end(batch_))
+            it->second.remove_thread(event.payload.thread.tid);
+        }
+      });
+
+  set_warmup_ticks(properties.get<uint64_t>("exec_monitor.warmup_ticks", 10));
+}
+
+slo_guard::~slo_guard() {
+  pause(false);
+  for (auto& group : {critical_group_, batch_group_}) {
+    if (group.empty())
+      continue;
+    try {
+      util::remove_resctrl_group(group);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error removing the resctrl group: %1%") % e.what());
+    }
+  }
+}
+
+bool slo_guard::read_signal(double& signal) {
+  switch (source_) {
+  case signal_type::IPC: {
+    if (!counters_)
+      return false;
+    auto counts = counters_();
+    if (counts.cycles == 0)
+      return false;
+    signal = counts.instructions / counts.cycles;
+    return true;
+  }
+  case signal_type::HEARTBEAT: {
+    double count;
+    if (!file_->read(count))
+      return false;
+    auto now = chrono::steady_clock::now();
+    auto previous = heartbeat_;
+    auto elapsed = chrono::duration<double>(now - heartbeat_time_).count();
+    heartbeat_ = count;
+    heartbeat_time_ = now;
+    if (previous < 0 || count < previous)
+      return false;
+    signal = (count - previous) / elapsed;
+    return true;
+  }
+  case signal_type::LATENCY:
+    return file_->read(signal);
+  }
+  return false;
+}
+
+void slo_guard::loop_impl() {
+  std::this_thread::sleep_for(tick_);
+  if (critical_ == -1)
+    return;
+
+  double signal;
+  double share;
+  if (read_signal(signal)) {
+    signal_ = signal_ < 0 ? signal : alpha_ * signal + (1 - alpha_) * signal_;
+    auto slack = source_ == signal_type::LATENCY
+      ? (target_ - signal_) / target_
+      : (signal_ - target_) / target_;
+    share = controller_.step(slack);
+  } else {
+    share = controller_.step_missing();
+  }
+
+  auto state = controller_.current_state();
+  if (state != state_) {
+    if (state == slo_controller::state::FALLBACK
+        || state_ == slo_controller::state::FALLBACK) {
+      LOG(boost::format("SLO controller %1% the safe state (signal %2%)")
+          % (state == slo_controller::state::FALLBACK ? "entered" : "left")
+          % signal_);
+    }
+    state_ = state;
+  }
+
+  apply(share);
+  if (pause_batch_)
+    pause(state_ == slo_controller::state::FALLBACK);
+}
+
+void slo_guard::apply(double share) {
+  for (auto& r : resources_) {
+    auto amount = r.min
+      + static_cast<unsigned>(std::lround(share * (r.max - r.min)));
+    if (amount == r.applied)
+      continue;
+    r.applied = amount;
+    try {
+      r.apply(amount);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error applying %1%: %2%") % r.name % e.what());
+    }
+  }
+}
+
+void slo_guard::pause(bool paused) {
+  if (paused == paused_)
+    return;
+  paused_ = paused;
+  for (auto& b : batch_) {
+    for (auto pid : b.second.processes()) {
+      try {
+        if (paused)
+          util::suspend(pid);
+        else
+          util::resume(pid);
+      } catch (const std::exception& e) {
+        LOG(boost::format("Error %1% process %2%: %3%")
+            % (paused ? "suspending" : "resuming") % pid % e.what());
+      }
+    }
+  }
+}
+
+void slo_guard::release() {
+  pause(false);
+  apply(1);
+  for (auto& b : batch_)
+    bind_application(b.second, false);
+}
+
+void slo_guard::add_process(pid_t pid) {
+  auto critical = created_++ == protected_;
+  LOG(boost::format("Adding %1% process %2%")
+      % (critical ? "latency-critical" : "batch") % pid);
+
+  application* app;
+  std::string group;
+  if (critical) {
+    critical_ = pid;
+    critical_app_ = std::make_unique<application>(pid, cgroup_root_);
+    app = critical_app_.get();
+    group = critical_group_;
+    try {
+      counters_ = counter_factory_(pid);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error attaching counters to process %1%: %2%")
+          % pid % e.what());
+    }
+  } else {
+    app = &batch_.emplace(pid, application{pid, cgroup_root_}).first->second;
+    group = batch_group_;
+  }
+
+  if (!group.empty()) {
+    // Tasks created afterwards inherit the group.
+    for (auto tid : app->threads()) {
+      try {
+        util::add_to_resctrl_group(group, tid);
+      } catch (const std::exception& e) {
+        LOG(boost::format("Error adding thread %1% to the resctrl group: "
+              "%2%") % tid % e.what());
+      }
+    }
+  }
+  bind_application(*app, critical);
+
+  // Batch jobs created before the latency-critical process used every CPU.
+  if (critical) {
+    for (auto& b : batch_)
+      bind_application(b.second, false);
+  }
+
+  if (!critical && paused_) {
+    try {
+      util::suspend(pid);
+    } catch (const std::exception& e) {
+      LOG(boost::format("Error suspending process %1%: %2%") % pid % e.what());
+    }
+  }
+}
+
+void slo_guard::remove_process(pid_t pid) {
+  if (pid == critical_) {
+    LOG(boost::format("Removing latency-critical process %1%") % pid);
+    critical_ = -1;
+    critical_app_.reset();
+    counters_ = nullptr;
+    release();
+    return;
+  }
+
+  if (batch_.erase(pid) > 0)
+    LOG(boost::format("Removing batch process %1%") % pid);
+}
+
+void slo_guard::add_task(pid_t root, pid_t tid, bool process) {
+  application* app;
+  if (root == critical_) {
+    app = critical_app_.get();
+  } else {
+    auto it = batch_.find(root);
+    if (it == end(batch_))
+      return;
+    app = &it->second;
+  }
+
+  if (process) {
+    for (auto t : app->add_process(tid))
+      bind_thread(t, root == critical_);
+  } else if (app->add_thread(tid)) {
+    bind_thread(tid, root == critical_);
+  }
+}
+
+void slo_guard::bind_application(application& app, bool critical) {
+  if (refresh_)
+    app.refresh();
+  for (auto tid : app.threads())
+    bind_thread(tid, critical);
+}
+
+void slo_guard::bind_thread(pid_t tid, bool critical) {
+  // Without a latency-critical process, batch jobs use every CPU.
+  auto first = critical_ == -1 ? 0 : cpus_.size() - batch_cpus_;
+  std::vector<unsigned> cpus = critical
+    ? std::vector<unsigned>(begin(cpus_), begin(cpus_) + first)
+    : std::vector<unsigned>(begin(cpus_) + first, end(cpus_));
+  if (cpus.empty())
+    return;
+
+  try {
+    util::bind_process(tid, cpus);
+  } catch (const std::exception& e) {
+    LOG(boost::format("Error binding thread %1%: %2%") % tid % e.what());
+  }
+}
+
+} // namespace aser
@@ -0,0 +1,195 @@
+#ifndef EXEC_MONITOR_SLO_GUARD_H_
+#define EXEC_MONITOR_SLO_GUARD_H_
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <core/application.h>
+#include <core/exec_monitor.h>
+#include <exec_monitor/slo_controller.h>
+#include <perf/event.h>
+#include <util/value_file.h>
+
+namespace aser {
+
+/** Execution monitor that holds the service level objective (SLO) of a
+ * latency-critical process co-located with batch jobs.
+ *
+ * The latency-critical process is the benchmark created in position
+ * exec_monitor.protected (zero, the first one, by default), and the rest
+ * are batch jobs. On every tick (exec_monitor.sampling_length
+ * milliseconds, which may be fractional), the performance signal of the
+ * latency-critical process is compared with exec_monitor.slo_target, and a
+ * controller (see slo_controller) decides the share of the resources in
+ * exec_monitor.resources (a list; "cpus" by default) given to the batch
+ * jobs:
+ *  - "cpus": the batch jobs run on the last CPUs of exec_monitor.cpus (a
+ *    CPU list; the CPUs the monitor is allowed to run on by default), from
+ *    exec_monitor.min_batch_cpus (one by default) to all but one; the
+ *    latency-critical process runs on the rest.
+ *  - "cache": the batch jobs get the first ways of the last-level cache,
+ *    and the latency-critical process the rest.
+ *  - "bandwidth": the memory bandwidth of the batch jobs is throttled.
+ * Cache and bandwidth are controlled through resctrl groups under
+ * exec_monitor.resctrl_root (/sys/fs/resctrl by default).
+ *
+ * The signal is given by exec_monitor.slo_signal:
+ *  - "ipc" (default): the IPC of the process (exec_monitor.event selects
+ *    the implementation).
+ *  - "heartbeat": the rate at which the counter in exec_monitor.slo_file
+ *    grows (e.g., requests served per second).
+ *  - "latency": the latency in exec_monitor.slo_file (lower is better).
+ * Signals are smoothed with an exponentially weighted moving average
+ * (exec_monitor.signal_alpha; 0.3 by default).
+ *
+ * exec_monitor.controller selects the algorithm ("pid", the default, or
+ * "heracles"). Other options (with their defaults) are target_slack
+ * (0.1), kp (0.5), ki (0.2), kd (0), low_slack (0.05), high_slack (0.1),
+ * step (0.05), max_rate (0.1), fallback_slack (-0.25 for "pid", 0 for
+ * "heracles"), fallback_ticks (100) and missing_ticks (50), all under
+ * exec_monitor. In the safe state, the batch jobs get the minimum
+ * resources, and they are also suspended if exec_monitor.pause_batch is
+ * true (the default).
+ */
+class slo_guard : public exec_monitor {
+public:
+  slo_guard(
+      exec_manager& exec_manager,
+      const boost::property_tree::ptree& properties);
+
+  ~slo_guard();
+
+private:
+  /** Counts of the latency-critical process since the previous read. */
+  struct ipc_counts {
+    double cycles;
+    double instructions;
+  };
+
+  /** Reads the counters of a process since the previous read. */
+  typedef std::function<ipc_counts()> counter_reader;
+
+  /** Creates the counters for a process. */
+  typedef std::function<counter_reader(pid_t)> counter_factory;
+
+  enum class signal_type { IPC, HEARTBEAT, LATENCY };
+
+  /** A resource shared between the latency-critical process and the batch
+   * jobs. */
+  struct resource {
+    std::string name;
+
+    /** Amount given to the batch jobs with a share of zero and one. */
+    unsigned min;
+    unsigned max;
+
+    /** Amount applied. */
+    unsigned applied;
+
+    /** Applies an amount to the batch jobs. */
+    std::function<void(unsigned)> apply;
+  };
+
+  std::chrono::microseconds tick_;
+
+  std::string cgroup_root_;
+
+  /** Position of the latency-critical process in the order of creation. */
+  unsigned protected_;
+
+  /** Number of processes created. */
+  unsigned created_ { 0 };
+
+  /** Latency-critical process (-1 if not running). */
+  pid_t critical_ { -1 };
+
+  std::unique_ptr<application> critical_app_;
+
+  /** Batch jobs, indexed by the benchmark process. */
+  std::map<pid_t, application> batch_;
+
+  signal_type source_;
+  double target_;
+  double alpha_;
+
+  /** Smoothed signal (negative if there are no measurements yet). */
+  double signal_ { -1 };
+
+  std::unique_ptr<util::value_file> file_;
+
+  /** Previous value of the heartbeat counter (negative if unknown), and
+   * time at which it was read. */
+  double heartbeat_ { -1 };
+  std::chrono::steady_clock::time_point heartbeat_time_;
+
+  counter_factory counter_factory_;
+  counter_reader counters_;
+
+  slo_controller controller_;
+  slo_controller::state state_ { slo_controller::state::HOLD };
+
+  std::vector<resource> resources_;
+
+  /** CPUs available (sorted), and CPUs given to the batch jobs. */
+  std::vector<unsigned> cpus_;
+  unsigned batch_cpus_;
+
+  /** Resource control groups (empty if unused). */
+  std::string critical_group_;
+  std::string batch_group_;
+
+  bool pause_batch_;
+  bool paused_ { false };
+
+  /** Whether the threads are discovered again when binding. */
+  bool refresh_;
+
+  void loop_impl() final;
+
+  void add_process(pid_t pid);
+  void remove_process(pid_t pid);
+
+  /** Adds a new task to an application and binds its threads. */
+  void add_task(pid_t root, pid_t tid, bool process);
+
+  /** Reads the signal, returning false if there is no new measurement. */
+  bool read_signal(double& signal);
+
+  /** Applies a share of the resources to the batch jobs. */
+  void apply(double share);
+
+  /** Suspends or resumes the batch jobs. */
+  void pause(bool paused);
+
+  /** Gives the batch jobs every resource (once the latency-critical
+   * process finishes). */
+  void release();
+
+  /** Binds all the threads of an application to its CPUs. */
+  void bind_application(application& app, bool critical);
+
+  /** Binds a thread to the CPUs of the latency-critical process or the
+   * batch jobs. */
+  void bind_thread(pid_t tid, bool critical);
+
+  /** Creates the resources in exec_monitor.resources. */
+  void create_resources(const boost::property_tree::ptree& properties);
+
+  /** Reads the configuration of the controller. */
+  static slo_controller::config controller_config(
+      const boost::property_tree::ptree& properties);
+
+  template<typename Impl>
+  static counter_factory make_counter_factory(
+      std::vector<perf::event_info> events);
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_SLO_GUARD_H_
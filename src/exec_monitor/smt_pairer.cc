@@ -0,0 +1,255 @@
+#include "smt_pairer.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include <core/exec_manager.h>
+#include <perf/event_dummy.h>
+#include <perf/event_linux.h>
+#include <perf/event_manager.h>
+#include <util/factory.h>
+#include <util/log.h>
+#include <util/numa.h>
+#include <util/os.h>
+#include <util/topology.h>
+
+namespace chrono = std::chrono;
+namespace pt = boost::property_tree;
+
+namespace aser {
+
+util::registar<exec_monitor, smt_pairer,
+    exec_manager&, const pt::ptree&>
+  smt_pairer_registar("smt-pairer");
+
+template<typename Impl>
+smt_pairer::counter_factory smt_pairer::make_counter_factory(
+    std::vector<perf::event_info> events) {
+  return [events](pid_t pid, bool& pressure) {
+    typedef perf::event_manager<perf::event<Impl>> manager_type;
+    std::shared_ptr<manager_type> manager;
+    pressure = events.size() > 2;
+    if (pressure) {
+      try {
+        manager = std::make_shared<manager_type>(events, pid, true);
+      } catch (const std::exception& e) {
+        LOG(boost::format("Pressure event not supported for process "
+              "%1%: %2%") % pid % e.what());
+        pressure = false;
+      }
+    }
+    if (!manager) {
+      manager = std::make_shared<manager_type>(
+          std::vector<perf::event_info>(begin(events), begin(events) + 2),
+          pid, true);
+    }
+
+    return [manager] {
+      auto& samples = manager->read_events(perf::event_read_mode::RELATIVE);
+      return pairing_counts{
+        samples[0].value,
+        samples[1].value,
+        samples.size() > 2 ? samples[2].value : 0.0};
+    };
+  };
+}
+
+std::vector<unsigned> smt_pairer::find_slots(const pt::ptree& properties) {
+  auto topo = util::topology::read(
+      properties.get<std::string>("exec_monitor.sysfs_root", "/sys"));
+  auto list = properties.get<std::string>("exec_monitor.cpus", "");
+  auto cpus = list.empty() ? util::allowed_cpus() : util::parse_cpu_list(list);
+  std::sort(begin(cpus), end(cpus));
+
+  std::vector<unsigned> slots;
+  for (unsigned core = 0; core < topo.num_cores(); ++core) {
+    std::vector<unsigned> siblings;
+    for (auto cpu : topo.core_cpus(core)) {
+      if (std::binary_search(begin(cpus), end(cpus), cpu))
+        siblings.push_back(cpu);
+    }
+    if (siblings.size() < 2)
+      continue;
+    slots.push_back(siblings[0]);
+    slots.push_back(siblings[1]);
+  }
+
+  if (slots.empty())
+    throw std::invalid_argument("No SMT cores available");
+  return slots;
+}
+
+smt_pairer::smt_pairer(
+    exec_manager& exec_manager,
+    const pt::ptree& properties)
+  : exec_monitor(exec_manager)
+  , sampling_interval_{
+        chrono::milliseconds(properties.get<unsigned>(
+            "exec_monitor.sampling_length"))}
+  , cgroup_root_{application::cgroup_root(properties)}
+  , slot_cpus_{find_slots(properties)}
+  , pairing_{
+        static_cast<unsigned>(slot_cpus_.size() / 2),
+        smt_pairing::config{
+          properties.get<unsigned>("exec_monitor.max_swaps", 1),
+          properties.get<double>("exec_monitor.min_gain", 0.02),
+          properties.get<double>("exec_monitor.min_relative_ipc", 0)}}
+  , refresh_{!properties.get<bool>("exec_manager.process_events", false)}
+  , ipc_(slot_cpus_.size(), 0)
+  , pressure_(slot_cpus_.size(), 0)
+{
+  using namespace perf;
+  auto name = properties.get<std::string>("exec_monitor.event", "linux");
+  auto generic = create_generic_events(name);
+  std::vector<event_info> events = {
+    {event_type::HARDWARE, generic.cycles, event_modifiers::EXCLUDE_NONE},
+    {event_type::HARDWARE, generic.instructions,
+      event_modifiers::EXCLUDE_NONE}
+  };
+
+  auto pressure = properties.get<std::string>(
+      "exec_monitor.pressure_event", "backend");
+  if (pressure == "backend") {
+    events.push_back({event_type::HARDWARE, generic.backend_stalls,
+        event_modifiers::EXCLUDE_NONE});
+  } else if (pressure != "none") {
+    events.push_back({event_type::RAW, std::stoull(pressure, nullptr, 0),
+        event_modifiers::EXCLUDE_NONE});
+  }
+
+  if (name == "dummy")
+    counter_factory_ = make_counter_factory<event_dummy_impl>(events);
+#ifdef __linux__
+  else
+    counter_factory_ = make_counter_factory<event_linux_impl>(events);
+#endif
+
+  register_event_handler(
+      exec_event::event_type::PROCESS_CREATED,
+      [&](const exec_event& event) {
+        add_process(event.pid);
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_EXITED,
+      [&](const exec_event& event) {
+        if (event.pid == event.root)
+          remove_process(event.pid);
+        else if (apps_.count(event.root) > 0)
+          apps_.at(event.root).app.remove_process(event.pid);
+      });
+  register_event_handler(
+      exec_event::event_type::PROCESS_FORKED,
+      [&](const exec_event& event) {
+        add_task(event.root, event.pid, true);
+      });
+  register_event_handler(
+      exec_event::event_type::THREAD_CREATED,
+      [&](const exec_event& event) {
+        add_task(event.root, event.payload.thread.tid, false);
+      });
+  register_event_handler(
+      exec_event::event_type::THREAD_EXITED,
+      [&](const exec_event& event) {
+        if (apps_.count(event.root) > 0)
+          apps_.at(event.root).app.remove_thread(event.payload.thread.tid);
+      });
+}
+
+void smt_pairer::loop_impl() {
+  std::this_thread::sleep_for(sampling_interval_);
+
+  auto pressure = !apps_.empty();
+  std::fill(begin(ipc_), end(ipc_), 0);
+  std::fill(begin(pressure_), end(pressure_), 0);
+  for (auto& a : apps_) {
+    auto& pa = a.second;
+    pressure = pressure && pa.pressure;
+    if (!pa.counters)
+      continue;
+    auto counts = pa.counters();
+    if (counts.cycles == 0)
+      continue;
+    ipc_[pa.slot] = counts.instructions / counts.cycles;
+    pressure_[pa.slot] = counts.pressure / counts.cycles;
+
+    process_metrics metrics;
+    metrics.ipc = ipc_[pa.slot];
+    publish_metrics(a.first, metrics);
+  }
+
+  static const std::vector<double> no_pressure;
+  auto swaps = pairing_.step(ipc_, pressure ? pressure_ : no_pressure);
+
+  auto& slots = pairing_.slots();
+  for (auto& s : swaps) {
+    LOG(boost::format("Swapping slots %1% (CPU %2%) and %3% (CPU %4%)")
+        % s.first % slot_cpus_[s.first] % s.second % slot_cpus_[s.second]);
+    for (auto slot : {s.first, s.second}) {
+      if (slots[slot] == smt_pairing::empty)
+        continue;
+      auto& pa = apps_.at(slots[slot]);
+      pa.slot = slot;
+      bind_application(pa);
+    }
+  }
+}
+
+void smt_pairer::add_process(pid_t pid) {
+  LOG(boost::format("Adding process %1%") % pid);
+  auto slot = pairing_.place(pid);
+  auto res = apps_.emplace(
+      pid,
+      paired_application{application{pid, cgroup_root_}, slot, nullptr,
+        false});
+
+  auto& pa = res.first->second;
+  try {
+    pa.counters = counter_factory_(pid, pa.pressure);
+  } catch (const std::exception& e) {
+    LOG(boost::format("Error attaching counters to process %1%: %2%")
+        % pid % e.what());
+  }
+  bind_application(pa);
+}
+
+void smt_pairer::remove_process(pid_t pid) {
+  auto it = apps_.find(pid);
+  if (it == end(apps_))
+    return;
+
+  LOG(boost::format("Removing process %1%") % pid);
+  pairing_.remove(pid);
+  apps_.erase(it);
+}
+
+void smt_pairer::add_task(pid_t root, pid_t tid, bool process) {
+  auto it = apps_.find(root);
+  if (it == end(apps_))
+    return;
+
+  auto& pa = it->second;
+  if (process) {
+    for (auto t : pa.app.add_process(tid))
+      bind_thread(pa, t);
+  } else if (pa.app.add_thread(tid)) {
+    bind_thread(pa, tid);
+  }
+}
+
+void smt_pairer::bind_application(paired_application& pa) {
+  if (refresh_)
+    pa.app.refresh();
+  for (auto tid : pa.app.threads())
+    bind_thread(pa, tid);
+}
+
+void smt_pairer::bind_thread(const paired_application& pa, pid_t tid) {
+  try {
+    util::bind_process(tid, slot_cpus_[pa.slot]);
+  } catch (const std::exception& e) {
+    LOG(boost::format("Error binding thread %1%: %2%") % tid % e.what());
+  }
+}
+
+} // namespace aser
@@ -0,0 +1,127 @@
+#ifndef EXEC_MONITOR_SMT_PAIRER_H_
+#define EXEC_MONITOR_SMT_PAIRER_H_
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <core/application.h>
+#include <core/exec_monitor.h>
+#include <exec_monitor/smt_pairing.h>
+#include <perf/event.h>
+
+namespace aser {
+
+/** Execution monitor that chooses which applications share SMT cores.
+ *
+ * Every application is bound to one SMT sibling of a core (all its
+ * threads), so that at most two applications share a core. The cores are
+ * those whose siblings are in exec_monitor.cpus (a CPU list; the CPUs the
+ * monitor is allowed to run on by default), using the topology read from
+ * exec_monitor.sysfs_root. Only the first two siblings of every core are
+ * used.
+ *
+ * Every exec_monitor.sampling_length milliseconds, the IPC of every
+ * application and the pressure on the backend of its core are read
+ * (exec_monitor.event selects the implementation), and the pairing search
+ * (see smt_pairing) tries alternative pairings, up to
+ * exec_monitor.max_swaps swaps per interval (one by default). A swap is
+ * kept if the total IPC of its cores improves by exec_monitor.min_gain
+ * (0.02 by default), and no application runs below
+ * exec_monitor.min_relative_ipc of its best IPC (zero, i.e. no fairness
+ * constraint, by default).
+ *
+ * The pressure is given by exec_monitor.pressure_event: "backend" (cycles
+ * stalled in the backend; default), a raw event code (e.g., micro-ops
+ * dispatched to the execution ports) or "none". Pressure is used when it
+ * can be read for every application.
+ */
+class smt_pairer : public exec_monitor {
+public:
+  smt_pairer(
+      exec_manager& exec_manager,
+      const boost::property_tree::ptree& properties);
+
+private:
+  /** Counts for an application since the previous read. */
+  struct pairing_counts {
+    double cycles;
+    double instructions;
+    double pressure;
+  };
+
+  /** Reads the counters of an application since the previous read. */
+  typedef std::function<pairing_counts()> counter_reader;
+
+  /** Creates the counters for an application.
+   *
+   * If the pressure event is not supported, the counters measure IPC only.
+   */
+  typedef std::function<counter_reader(pid_t, bool&)> counter_factory;
+
+  struct paired_application {
+    application app;
+
+    /** Slot (SMT sibling) the application is bound to. */
+    unsigned slot;
+
+    counter_reader counters;
+
+    /** Whether the pressure is measured. */
+    bool pressure;
+  };
+
+  std::chrono::milliseconds sampling_interval_;
+
+  std::string cgroup_root_;
+
+  /** CPU of every slot (two consecutive slots per core). */
+  std::vector<unsigned> slot_cpus_;
+
+  smt_pairing pairing_;
+
+  /** Applications, indexed by the benchmark process. */
+  std::map<pid_t, paired_application> apps_;
+
+  /** Whether the threads are discovered again on every swap. */
+  bool refresh_;
+
+  counter_factory counter_factory_;
+
+  /** Measurements for every slot, reused across intervals. */
+  std::vector<double> ipc_;
+  std::vector<double> pressure_;
+
+  void loop_impl() final;
+
+  void add_process(pid_t pid);
+  void remove_process(pid_t pid);
+
+  /** Adds a new task to an application and binds its threads. */
+  void add_task(pid_t root, pid_t tid, bool process);
+
+  /** Binds all the threads of an application to its slot. */
+  void bind_application(paired_application& pa);
+
+  /** Binds a thread to the slot of its application. */
+  void bind_thread(const paired_application& pa, pid_t tid);
+
+  /** Returns the CPU of the first two siblings of every core. */
+  static std::vector<unsigned> find_slots(
+      const boost::property_tree::ptree& properties);
+
+  /** Creates a counter factory for an event implementation.
+   *
+   * @param events Cycles, instructions and (optionally) the pressure event.
+   */
+  template<typename Impl>
+  static counter_factory make_counter_factory(
+      std::vector<perf::event_info> events);
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_SMT_PAIRER_H_
@@ -0,0 +1,163 @@
+#include "smt_pairing.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace aser {
+
+constexpr pid_t smt_pairing::empty;
+
+smt_pairing::smt_pairing(unsigned cores, config cfg)
+  : config_(cfg)
+  , slots_(2 * cores, empty)
+{
+  if (cores == 0)
+    throw std::invalid_argument("No SMT cores");
+}
+
+unsigned smt_pairing::place(pid_t app) {
+  trials_.clear();
+
+  auto best = slots_.size();
+  for (unsigned slot = 0; slot < slots_.size(); ++slot) {
+    if (slots_[slot] != empty)
+      continue;
+    if (slots_[slot ^ 1] == empty) {
+      best = slot;
+      break;
+    }
+    if (best == slots_.size())
+      best = slot;
+  }
+  if (best == slots_.size())
+    throw std::runtime_error("Too many processes");
+
+  slots_[best] = app;
+  return best;
+}
+
+void smt_pairing::remove(pid_t app) {
+  // Reverting is not needed: the swaps being tried are simply kept.
+  trials_.clear();
+  std::replace(begin(slots_), end(slots_), app, empty);
+  best_ipc_.erase(app);
+}
+
+void smt_pairing::apply(const swap& s) {
+  std::swap(slots_[s.first], slots_[s.second]);
+}
+
+std::pair<double, double> smt_pairing::objective(
+    unsigned a,
+    unsigned b,
+    const std::vector<double>& ipc) const {
+  double total = 0;
+  double worst = std::numeric_limits<double>::max();
+  for (auto core : {a, b}) {
+    for (auto slot : {2 * core, 2 * core + 1}) {
+      if (slots_[slot] == empty)
+        continue;
+      total += ipc[slot];
+      auto it = best_ipc_.find(slots_[slot]);
+      if (it != end(best_ipc_) && it->second > 0)
+        worst = std::min(worst, ipc[slot] / it->second);
+    }
+  }
+  return {total, worst};
+}
+
+std::vector<smt_pairing::swap> smt_pairing::step(
+    const std::vector<double>& ipc,
+    const std::vector<double>& pressure) {
+  if (ipc.size() != slots_.size()
+      || (!pressure.empty() && pressure.size() != slots_.size()))
+    throw std::invalid_argument("Wrong number of slots");
+
+  for (unsigned slot = 0; slot < slots_.size(); ++slot) {
+    if (slots_[slot] == empty)
+      continue;
+    auto& best = best_ipc_[slots_[slot]];
+    best = std::max(best, ipc[slot]);
+  }
+
+  if (trials_.empty())
+    return propose(ipc, pressure);
+
+  std::vector<swap> reverts;
+  for (auto& t : trials_) {
+    auto result = objective(t.s.first / 2, t.s.second / 2, ipc);
+    auto fair = result.second >= config_.min_relative_ipc;
+    auto was_fair = t.worst >= config_.min_relative_ipc;
+    auto keep = fair
+      ? result.first > t.throughput * (1 + config_.min_gain)
+        || !was_fair
+      : result.second > t.worst;
+    if (!keep) {
+      apply(t.s);
+      reverts.push_back(t.s);
+    }
+  }
+  trials_.clear();
+  return reverts;
+}
+
+std::vector<smt_pairing::swap> smt_pairing::propose(
+    const std::vector<double>& ipc,
+    const std::vector<double>& pressure) {
+  std::vector<swap> swaps;
+  auto cores = static_cast<unsigned>(slots_.size() / 2);
+  auto pairs = cores * (cores - 1) / 2;
+  if (pairs == 0)
+    return swaps;
+
+  std::vector<bool> busy(cores, false);
+  auto alternatives = pressure.empty() ? 2 * pairs : pairs;
+  for (unsigned n = 0;
+      n < alternatives && swaps.size() < config_.max_swaps; ++n) {
+    // The number of alternatives changes with the pressure being known.
+    auto index = cursor_ % alternatives;
+    cursor_ = (index + 1) % alternatives;
+
+    // Decodes the index into a pair of cores (a < b) and an alternative.
+    auto variant = pressure.empty() ? index % 2 : 0;
+    auto pair = pressure.empty() ? index / 2 : index;
+    unsigned a = 0;
+    while (pair >= cores - 1 - a) {
+      pair -= cores - 1 - a;
+      ++a;
+    }
+    auto b = a + 1 + pair;
+    if (busy[a] || busy[b])
+      continue;
+
+    unsigned from = 2 * a + 1;
+    unsigned to = 2 * b + variant;
+    if (!pressure.empty()) {
+      // Swapping the applications with the least pressure pairs the one
+      // with the most pressure in every core with the one with the least
+      // pressure in the other.
+      auto least = [&](unsigned core) {
+        auto s0 = 2 * core, s1 = 2 * core + 1;
+        if (slots_[s0] == empty || slots_[s1] == empty)
+          return slots_[s0] == empty ? s0 : s1;
+        return pressure[s0] <= pressure[s1] ? s0 : s1;
+      };
+      from = least(a);
+      to = least(b);
+    }
+    if (slots_[from] == empty && slots_[to] == empty)
+      continue;
+
+    // The current pairing of the cores is the baseline for the swap.
+    auto before = objective(a, b, ipc);
+    trials_.push_back({{from, to}, before.first, before.second});
+    apply(trials_.back().s);
+    busy[a] = busy[b] = true;
+    swaps.emplace_back(from, to);
+  }
+
+  return swaps;
+}
+
+} // namespace aser
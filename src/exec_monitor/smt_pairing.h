@@ -0,0 +1,137 @@
+#ifndef EXEC_MONITOR_SMT_PAIRING_H_
+#define EXEC_MONITOR_SMT_PAIRING_H_
+
+#include <unistd.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace aser {
+
+/** Incremental search for the pairing of applications on SMT cores.
+ *
+ * Every core has two slots (one per SMT sibling), and every application
+ * runs on a slot. On every interval, the search gets the IPC of every
+ * slot. It alternates between measuring the current pairing and trying
+ * alternative pairings: a trial swaps applications between up to
+ * max_swaps disjoint pairs of cores for one interval, and every swap is
+ * kept only if it improves the objective for its two cores; otherwise it
+ * is reverted.
+ *
+ * The objective is the total IPC of the cores. If min_relative_ipc is
+ * positive, no application should run below that fraction of the best IPC
+ * it has reached: a swap that breaks the constraint is reverted, and a swap
+ * that improves the worst application is kept while the constraint is not
+ * met.
+ *
+ * Alternatives are visited in round-robin order. If the pressure on the
+ * backend of every application is known, the swap pairs the application
+ * with the highest pressure in one core with the one with the lowest
+ * pressure in the other.
+ */
+class smt_pairing {
+public:
+  /** Value of an empty slot. */
+  static constexpr pid_t empty = -1;
+
+  struct config {
+    /** Maximum number of swaps tried on every interval. */
+    unsigned max_swaps;
+
+    /** Minimum relative improvement to keep a swap. */
+    double min_gain;
+
+    /** Minimum IPC of every application, relative to its best IPC. */
+    double min_relative_ipc;
+  };
+
+  /** A swap of the applications in two slots. */
+  typedef std::pair<unsigned, unsigned> swap;
+
+  /** Constructor.
+   *
+   * @param cores Number of SMT cores.
+   * @param cfg Configuration of the search.
+   */
+  smt_pairing(unsigned cores, config cfg);
+
+  /** Places a new application.
+   *
+   * Empty cores are used first, so that applications only share a core
+   * when needed.
+   *
+   * @param app The application.
+   * @return The slot.
+   * @throw std::runtime_error If there are no free slots.
+   */
+  unsigned place(pid_t app);
+
+  /** Removes an application.
+   *
+   * Pending trials are discarded.
+   */
+  void remove(pid_t app);
+
+  /** Advances the search by one interval.
+   *
+   * @param ipc IPC in every slot during the interval.
+   * @param pressure Backend pressure in every slot (e.g., stalled cycles
+   *     per cycle), or empty if unknown.
+   * @return The swaps to apply before the next interval (either reverting
+   *     or trying swaps). The slots are already updated.
+   */
+  std::vector<swap> step(
+      const std::vector<double>& ipc,
+      const std::vector<double>& pressure);
+
+  /** Returns the application in every slot (two consecutive slots per
+   * core). */
+  const std::vector<pid_t>& slots() const noexcept {
+    return slots_;
+  }
+
+  /** Returns whether swaps are being tried. */
+  bool trying() const noexcept {
+    return !trials_.empty();
+  }
+
+private:
+  /** A swap being tried. */
+  struct trial {
+    swap s;
+
+    /** Objective of the two cores before the swap. */
+    double throughput;
+    double worst;
+  };
+
+  config config_;
+  std::vector<pid_t> slots_;
+
+  /** Best IPC reached by every application. */
+  std::map<pid_t, double> best_ipc_;
+
+  std::vector<trial> trials_;
+
+  /** Next pair of cores to try (and alternative, without pressure). */
+  unsigned cursor_ { 0 };
+
+  /** Applies a swap to the slots. */
+  void apply(const swap& s);
+
+  /** Returns the total and the worst relative IPC of two cores. */
+  std::pair<double, double> objective(
+      unsigned a,
+      unsigned b,
+      const std::vector<double>& ipc) const;
+
+  /** Chooses up to max_swaps swaps between disjoint pairs of cores. */
+  std::vector<swap> propose(
+      const std::vector<double>& ipc,
+      const std::vector<double>& pressure);
+};
+
+} // namespace aser
+
+#endif // EXEC_MONITOR_SMT_PAIRING_H_
@@ -0,0 +1,112 @@
+#ifndef PERF_ADDRESS_SAMPLER_H_
+#define PERF_ADDRESS_SAMPLER_H_
+
+#ifdef __linux__
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aser {
+namespace perf {
+
+/** Source of the addresses sampled by an address_sampler. */
+enum class address_source {
+  /** Precise memory event (e.g., loads or stores) with the data address. */
+  PRECISE,
+
+  /** Page faults, including the NUMA hinting faults raised by automatic
+   * NUMA balancing (if enabled). */
+  PAGE_FAULTS
+};
+
+/** Samples the data addresses accessed by a process.
+ *
+ * Samples are written by the kernel to ring buffers shared with the
+ * process, and they are collected by drain(). The event is inherited by
+ * the tasks the process creates afterwards, which the kernel only allows
+ * for events bound to a CPU, so there is an event (and a buffer) per CPU.
+ *
+ * A precise memory event is used if given and supported; otherwise, page
+ * faults are sampled instead.
+ */
+class address_sampler {
+public:
+  /** Constructor.
+   *
+   * @param pid The process identifier.
+   * @param event Raw code of a precise memory event (zero to sample page
+   *     faults).
+   * @param period Number of memory events between samples.
+   * @param fault_period Number of page faults between samples.
+   * @param buffer_pages Number of pages of every ring buffer (a power of
+   *     two).
+   */
+  address_sampler(
+      pid_t pid,
+      uint64_t event,
+      uint64_t period,
+      uint64_t fault_period = 1,
+      size_t buffer_pages = 64);
+
+  ~address_sampler();
+
+  /** Collects the addresses sampled since the previous call.
+   *
+   * @param sink Function called with every address.
+   * @return The number of samples.
+   */
+  template<typename Sink>
+  size_t drain(Sink sink);
+
+  address_source source() const noexcept {
+    return source_;
+  }
+
+  /** Returns the number of samples lost because the buffer was full. */
+  uint64_t lost() const noexcept {
+    return lost_;
+  }
+
+private:
+  /** The event on a CPU and its ring buffer. */
+  struct ring {
+    int fd;
+
+    /** Mapping of the control page and the buffer. */
+    void* buffer;
+  };
+
+  address_source source_;
+  std::vector<ring> rings_;
+  size_t page_size_;
+  size_t data_size_;
+
+  uint64_t lost_ { 0 };
+
+  /** Opens the event on every CPU.
+   *
+   * @return False if the event is not supported.
+   */
+  bool open(pid_t pid, uint32_t type, uint64_t config, uint64_t period);
+
+  /** Closes the events and unmaps the buffers. */
+  void close() noexcept;
+
+  /** Copies data from a ring buffer, which may wrap around. */
+  void copy(const ring& r, void* dst, uint64_t offset, size_t size) const;
+
+  address_sampler(const address_sampler&) = delete;
+  address_sampler& operator=(const address_sampler&) = delete;
+};
+
+} // namespace perf
+} // namespace aser
+
+#include <perf/impl/address_sampler.h>
+
+#endif // __linux__
+
+#endif // PERF_ADDRESS_SAMPLER_H_
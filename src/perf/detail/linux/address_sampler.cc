@@ -0,0 +1,119 @@
+#include <perf/address_sampler.h>
+
+#ifndef __linux__
+#error This file must only be included in linux builds.
+#endif
+
+#include <asm/unistd.h>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <util/libc_wrapper.h>
+#include <util/log.h>
+
+namespace aser {
+namespace perf {
+
+address_sampler::address_sampler(
+    pid_t pid,
+    uint64_t event,
+    uint64_t period,
+    uint64_t fault_period,
+    size_t buffer_pages)
+  : source_{address_source::PRECISE}
+  , page_size_{static_cast<size_t>(sysconf(_SC_PAGESIZE))}
+  , data_size_{buffer_pages * page_size_}
+{
+  if (buffer_pages == 0 || (buffer_pages & (buffer_pages - 1)) != 0)
+    throw std::invalid_argument("Buffer pages must be a power of two");
+  if (period == 0 || fault_period == 0)
+    throw std::invalid_argument("Sampling period must be positive");
+
+  if (event != 0 && open(pid, PERF_TYPE_RAW, event, period))
+    return;
+
+  if (event != 0) {
+    LOG(boost::format("Precise memory event not supported for process "
+          "%1%; sampling page faults") % pid);
+  }
+  source_ = address_source::PAGE_FAULTS;
+  if (!open(pid, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, fault_period))
+    util::libc_error("Error opening the sampling event");
+}
+
+address_sampler::~address_sampler() {
+  close();
+}
+
+bool address_sampler::open(
+    pid_t pid,
+    uint32_t type,
+    uint64_t config,
+    uint64_t period) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = type;
+  attr.config = config;
+  attr.sample_period = period;
+  attr.sample_type = PERF_SAMPLE_ADDR;
+  // Data addresses of memory events are only exact without skid.
+  attr.precise_ip = type == PERF_TYPE_RAW ? 2 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.inherit = 1;
+  attr.size = sizeof(attr);
+
+  auto cpus = sysconf(_SC_NPROCESSORS_CONF);
+  for (long cpu = 0; cpu < cpus; ++cpu) {
+    int fd = syscall(__NR_perf_event_open, &attr, pid, cpu, -1, 0);
+    if (fd == -1) {
+      // Offline CPUs are skipped.
+      if (errno == ENODEV)
+        continue;
+      auto error = errno;
+      close();
+      errno = error;
+      return false;
+    }
+
+    // The first page holds the control information.
+    auto buffer = mmap(nullptr, page_size_ + data_size_,
+        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (buffer == MAP_FAILED) {
+      auto error = errno;
+      ::close(fd);
+      close();
+      util::libc_error(error, "Error mapping the sampling buffer");
+    }
+    rings_.push_back({fd, buffer});
+  }
+  return !rings_.empty();
+}
+
+void address_sampler::close() noexcept {
+  for (auto& r : rings_) {
+    munmap(r.buffer, page_size_ + data_size_);
+    ::close(r.fd);
+  }
+  rings_.clear();
+}
+
+void address_sampler::copy(
+    const ring& r,
+    void* dst,
+    uint64_t offset,
+    size_t size) const {
+  auto data = static_cast<const char*>(r.buffer) + page_size_;
+  auto start = offset & (data_size_ - 1);
+  auto first = std::min(size, data_size_ - start);
+  memcpy(dst, data + start, first);
+  memcpy(static_cast<char*>(dst) + first, data, size - first);
+}
+
+} // namespace perf
+} // namespace aser
@@ -16,8 +16,13 @@ using generic_events_map = std::map<std::string, generic_events>;
 const generic_events_map& get_generic_events_map() {
   static const generic_events_map events_map = {
     {"linux", {static_cast<uint64_t>(PERF_COUNT_HW_CPU_CYCLES),
-                static_cast<uint64_t>(PERF_COUNT_HW_INSTRUCTIONS)}},
-    {"dummy", {0, 0}}
+                static_cast<uint64_t>(PERF_COUNT_HW_INSTRUCTIONS),
+                static_cast<uint64_t>(PERF_COUNT_HW_CACHE_MISSES),
+                static_cast<uint64_t>(PERF_COUNT_HW_CACHE_L1D
+                  | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                  | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)),
+                static_cast<uint64_t>(PERF_COUNT_HW_STALLED_CYCLES_BACKEND)}},
+    {"dummy", {0, 0, 0, 0, 0}}
   };
   return events_map;
 };
@@ -0,0 +1,95 @@
+#include <perf/overflow_listener.h>
+
+#ifndef __linux__
+#error This file must only be included in linux builds.
+#endif
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+
+#include <cassert>
+
+#include <util/libc_wrapper.h>
+#include <util/log.h>
+
+namespace aser {
+namespace perf {
+
+overflow_listener::overflow_listener(callback_func callback)
+  : callback_{std::move(callback)}
+{}
+
+overflow_listener::~overflow_listener() {
+  if (thread_.joinable())
+    stop();
+}
+
+int overflow_listener::signal() const noexcept {
+  return SIGRTMIN + 1;
+}
+
+void overflow_listener::start() {
+  assert(!thread_.joinable());
+  stop_fd_ = util::error_if_equal(
+      eventfd(0, EFD_CLOEXEC),
+      -1,
+      "Error creating eventfd");
+  thread_ = std::thread(&overflow_listener::run, this);
+  ready_.wait();
+}
+
+void overflow_listener::stop() {
+  assert(thread_.joinable());
+  uint64_t value = 1;
+  util::error_if_not_equal(
+      ::write(stop_fd_, &value, sizeof(value)),
+      static_cast<ssize_t>(sizeof(value)),
+      "Error stopping the overflow listener");
+  thread_.join();
+  ::close(stop_fd_);
+  stop_fd_ = -1;
+}
+
+void overflow_listener::run() {
+  // The signal is only blocked in this thread. As the events are configured
+  // to target this thread alone, no other thread will ever receive it.
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, signal());
+  pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+  int signal_fd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+  assert(signal_fd != -1);
+  tid_ = syscall(SYS_gettid);
+  ready_.notify();
+
+  pollfd fds[2] = {
+    {signal_fd, POLLIN, 0},
+    {stop_fd_, POLLIN, 0}
+  };
+
+  while (true) {
+    if (::poll(fds, 2, -1) == -1)
+      continue;
+
+    if (fds[1].revents & POLLIN)
+      break;
+
+    signalfd_siginfo info;
+    while (::read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+      // The last overflow (the one that disables the event) is reported
+      // with POLL_HUP, and the others with POLL_IN.
+      LOG(boost::format("Overflow on fd %1% (last: %2%)")
+          % info.ssi_fd % (info.ssi_code == POLL_HUP));
+      callback_(info.ssi_fd);
+    }
+  }
+
+  ::close(signal_fd);
+}
+
+} // namespace perf
+} // namespace aser
@@ -9,7 +9,7 @@ using generic_events_map = std::map<std::string, generic_events>;
 
 extern const generic_events_map& __attribute__((weak)) get_generic_events_map() {
   static const generic_events_map events_map = {
-    {"dummy", {0, 0}}
+    {"dummy", {0, 0, 0, 0, 0}}
   };
   return events_map;
 };
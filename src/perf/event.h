@@ -4,6 +4,7 @@
 #include <unistd.h>
 
 #include <array>
+#include <chrono>
 #include <string>
 
 namespace aser {
@@ -12,9 +13,10 @@ namespace perf {
 /** Event type.
  *
  * HARDWARE: generic hardware event.
+ * HW_CACHE: generic hardware cache event.
  * RAW: raw event code.
  */
-enum class event_type { HARDWARE, RAW };
+enum class event_type { HARDWARE, HW_CACHE, RAW };
 
 /** Event modifiers.
  *
@@ -34,12 +36,25 @@ struct event_info {
   event_type type;
   uint64_t code;
   uint8_t modifiers;
+
+  /** Number of events between overflow notifications (zero for plain
+   * counting events). Overflowing events only count the task they are
+   * attached to, as the kernel does not allow inheriting them.
+   */
+  uint64_t period { 0 };
 };
 
 /** Generic hardware events. */
 struct generic_events {
   const uint64_t cycles;
   const uint64_t instructions;
+  const uint64_t cache_misses;
+
+  /** First-level data cache read misses (a HW_CACHE event). */
+  const uint64_t l1d_misses;
+
+  /** Cycles stalled in the backend (not supported by every processor). */
+  const uint64_t backend_stalls;
 };
 
 /** Returns the generic events for a given event implementation.
@@ -71,8 +86,22 @@ struct event_sample {
 
   /** True if the event was enabled at any time; false otherwise. */
   bool enabled;
+
+  /** Time at which the counter was read (steady clock, in nanoseconds). */
+  uint64_t timestamp;
+
+  /** Length of the time window covered by the sample (nanoseconds): the
+   * time since the previous read in relative mode, or since the event was
+   * opened in aggregated mode. */
+  uint64_t window;
 };
 
+/** Returns the current time as used in sample timestamps. */
+inline uint64_t sample_clock() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 /** A performance event.
  *
  * This class manages a single peformance event for a process.
@@ -80,6 +109,9 @@ struct event_sample {
 template<class Impl>
 class event {
 public:
+  /** Raw counter values: value, time enabled and time running. */
+  using count_type = std::array<uint64_t, 3>;
+
   /** Constructor.
    *
    * @param info Event information.
@@ -103,7 +135,12 @@ public:
    */
   void open(pid_t pid, bool attach);
 
-  /** Reads the event values into an internal buffer. */
+  /** Reads the event values into an internal buffer, along with the time
+   * of the read.
+   *
+   * Reading and scaling are separate steps, so that multiple events can be
+   * read back to back before spending any time in scaling them.
+   */
   void read();
 
   /** Scales the value read, and returns the latest sample.
@@ -113,6 +150,50 @@ public:
    */
   event_sample scale(event_read_mode mode);
 
+  /** Returns the raw values from the latest read(). */
+  const count_type& counts() const noexcept {
+    return count_;
+  }
+
+  /** Returns the time of the latest read(). */
+  uint64_t read_time() const noexcept {
+    return read_time_;
+  }
+
+  /** Returns the time at which the event was opened. */
+  uint64_t open_time() const noexcept {
+    return open_time_;
+  }
+
+  /** Returns the file descriptor for the event, or -1 if the
+   * implementation does not use one.
+   */
+  int fd() const noexcept;
+
+  /** Sends overflow notifications to the given thread.
+   *
+   * The event must have been opened with a non-zero period.
+   *
+   * @param signo Signal to deliver on overflow.
+   * @param tid Thread that will receive the signal.
+   */
+  void notify_overflow(int signo, pid_t tid);
+
+  /** Arms the event so that it raises an overflow notification every given
+   * number of events, and it disables itself on the last one.
+   *
+   * @param period Number of events until the overflow.
+   * @param overflows Number of overflows until the event disables itself.
+   */
+  void rearm(uint64_t period, unsigned overflows = 1);
+
+  /** Changes the number of events until the next overflow, counting from
+   * now. The event stays enabled, and the overflows left do not change.
+   *
+   * @param period Number of events until the overflow.
+   */
+  void set_period(uint64_t period);
+
 private:
   enum count_field {
     RAW_VALUE = 0,
@@ -120,8 +201,6 @@ private:
     TIME_RUNNING
   };
 
-  using count_type = std::array<uint64_t, 3>;
-
   /** Event information. */
   event_info info_;
 
@@ -134,6 +213,13 @@ private:
   /** Previous counter values. */
   count_type prev_ {{0, 0, 0}};
 
+  /** Time at which the event was opened. */
+  uint64_t open_time_ { 0 };
+
+  /** Time of the current and the previous reads. */
+  uint64_t read_time_ { 0 };
+  uint64_t prev_time_ { 0 };
+
   static bool valid_modifiers(uint8_t modifiers);
 };
 
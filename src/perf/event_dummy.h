@@ -18,6 +18,14 @@ public:
   count_type read() {
     return {0, 0, 0};
   }
+
+  int fd() const noexcept {
+    return -1;
+  }
+
+  void notify_overflow(int signo, pid_t tid) {}
+  void rearm(uint64_t period, unsigned overflows) {}
+  void set_period(uint64_t period) {}
 };
 
 } // namespace perf
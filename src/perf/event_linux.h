@@ -21,6 +21,14 @@ public:
 
   count_type read();
 
+  int fd() const noexcept {
+    return fd_;
+  }
+
+  void notify_overflow(int signo, pid_t tid);
+  void rearm(uint64_t period, unsigned overflows);
+  void set_period(uint64_t period);
+
 private:
   /** File descriptor for the event. */
   int fd_ { 0 };
@@ -7,6 +7,8 @@
 #include <functional>
 #include <vector>
 
+#include <perf/scale.h>
+
 namespace aser {
 namespace perf {
 
@@ -36,12 +38,70 @@ public:
       );
 
   /** Returns the latest sample list.
+   *
+   * This is equivalent to calling read() followed by scale().
    *
    * @param mode Read mode (relative or aggregated).
    * @return The list of most recent samples.
    */
   const sample_list& read_events(event_read_mode mode);
 
+  /** Reads all the events back to back, without scaling them. */
+  void read();
+
+  /** Scales the values from the latest read().
+   *
+   * @param mode Read mode (relative or aggregated).
+   * @return The list of most recent samples.
+   */
+  const sample_list& scale(event_read_mode mode);
+
+  /** Scales the values from the latest read() in a single batch.
+   *
+   * The samples are bit-identical to those from scale(), and errors are
+   * reported in the same way, but events are processed with vector
+   * instructions when the CPU supports them. The batched path keeps its
+   * own previous counts, so it must not be mixed with scale() on the same
+   * manager when using relative mode.
+   *
+   * @param mode Read mode (relative or aggregated).
+   * @return The list of most recent samples.
+   */
+  const sample_list& scale_batched(event_read_mode mode);
+
+  /** Returns the number of events. */
+  size_t size() const noexcept {
+    return events_.size();
+  }
+
+  /** Copies the values from the latest read() into a batch, so that the
+   * events of several managers are scaled with a single call to
+   * scale_counts(). The batch shares the previous counts of the batched
+   * path (see scale_batched()).
+   *
+   * @param current Where the counts are stored.
+   * @param previous Where the counts from the previous read are stored.
+   * @param offset Position of the first event in the batch.
+   */
+  void gather(count_buffer& current, count_buffer& previous, size_t offset);
+
+  /** Takes the samples of the events of a batch from gather().
+   *
+   * @param previous Previous counts, as updated by scale_counts().
+   * @param samples Samples of the batch.
+   * @param offset Position of the first event in the batch.
+   * @param scaled Number of events in the batch that were scaled (the
+   *     samples of the events from there on are left untouched).
+   * @param mode Read mode the batch was scaled with.
+   * @return The list of most recent samples.
+   */
+  const sample_list& scatter(
+      const count_buffer& previous,
+      const sample_buffer& samples,
+      size_t offset,
+      size_t scaled,
+      event_read_mode mode);
+
 private:
   /** The events. */
   event_list events_;
@@ -49,6 +109,14 @@ private:
   /** The latest samples for each event. */
   sample_list latest_samples_;
 
+  /** Counts for the batched path. */
+  count_buffer counts_;
+  count_buffer prev_counts_;
+  sample_buffer batch_samples_;
+
+  /** Time of the previous read for each event in the batched path. */
+  std::vector<uint64_t> prev_times_;
+
   /** Default event factory. */
   static Event default_event_factory(const event_info& info);
 };
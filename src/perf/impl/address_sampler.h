@@ -0,0 +1,41 @@
+#include <linux/perf_event.h>
+
+namespace aser {
+namespace perf {
+
+template<typename Sink>
+size_t address_sampler::drain(Sink sink) {
+  size_t samples = 0;
+  for (auto& r : rings_) {
+    auto control = static_cast<perf_event_mmap_page*>(r.buffer);
+    auto head = __atomic_load_n(&control->data_head, __ATOMIC_ACQUIRE);
+    auto tail = control->data_tail;
+
+    while (tail < head) {
+      perf_event_header header;
+      copy(r, &header, tail, sizeof(header));
+      if (header.size == 0)
+        break;
+
+      if (header.type == PERF_RECORD_SAMPLE) {
+        uint64_t address;
+        copy(r, &address, tail + sizeof(header), sizeof(address));
+        sink(address);
+        ++samples;
+      } else if (header.type == PERF_RECORD_LOST) {
+        // The record holds an identifier and the number of lost samples.
+        uint64_t lost;
+        copy(r, &lost, tail + sizeof(header) + sizeof(uint64_t),
+            sizeof(lost));
+        lost_ += lost;
+      }
+      tail += header.size;
+    }
+
+    __atomic_store_n(&control->data_tail, head, __ATOMIC_RELEASE);
+  }
+  return samples;
+}
+
+} // namespace perf
+} // namespace aser
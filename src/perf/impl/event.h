@@ -14,11 +14,13 @@ event<Impl>::event(event_info info, Impl impl)
 template<typename Impl>
 void event<Impl>::open(pid_t pid, bool attach) {
   impl_.open(info_, pid, attach);
+  open_time_ = prev_time_ = sample_clock();
 }
 
 template<typename Impl>
 void event<Impl>::read() {
   count_ = impl_.read();
+  read_time_ = sample_clock();
 }
 
 template<typename Impl>
@@ -27,8 +29,8 @@ event_sample event<Impl>::scale(event_read_mode mode) {
   auto enabled = count_[count_field::TIME_ENABLED];
   auto running = count_[count_field::TIME_RUNNING];
 
-  LOG(boost::format("value: %1%, enabled: %2%, running: %3%")
-      % value % enabled % running);
+  LOG_ASYNC("value: %1%, enabled: %2%, running: %3%",
+      value, enabled, running);
 
   if (running > enabled)
     throw std::runtime_error("Event ran for longer than it was enabled");
@@ -37,18 +39,44 @@ event_sample event<Impl>::scale(event_read_mode mode) {
       && value != prev_[count_field::RAW_VALUE])
     throw std::runtime_error("Unexpected event value");
 
+  auto window = read_time_ - open_time_;
   if (mode == event_read_mode::RELATIVE) {
     value -= prev_[count_field::RAW_VALUE];
     enabled -= prev_[count_field::TIME_ENABLED];
     running -= prev_[count_field::TIME_RUNNING];
     prev_ = count_;
+    window = read_time_ - prev_time_;
+    prev_time_ = read_time_;
   }
 
   if (running == 0)
-    return {0, 0, enabled > 0};
+    return {0, 0, enabled > 0, read_time_, window};
 
   auto scaling = static_cast<double>(running) / enabled;
-  return {value / scaling, scaling, true};
+  return {value / scaling, scaling, true, read_time_, window};
+}
+
+template<typename Impl>
+int event<Impl>::fd() const noexcept {
+  return impl_.fd();
+}
+
+template<typename Impl>
+void event<Impl>::notify_overflow(int signo, pid_t tid) {
+  assert(info_.period > 0);
+  impl_.notify_overflow(signo, tid);
+}
+
+template<typename Impl>
+void event<Impl>::rearm(uint64_t period, unsigned overflows) {
+  assert(info_.period > 0 && period > 0 && overflows > 0);
+  impl_.rearm(period, overflows);
+}
+
+template<typename Impl>
+void event<Impl>::set_period(uint64_t period) {
+  assert(info_.period > 0 && period > 0);
+  impl_.set_period(period);
 }
 
 template<typename Impl>
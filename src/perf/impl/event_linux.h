@@ -1,5 +1,7 @@
 #include <asm/unistd.h>
+#include <fcntl.h>
 #include <linux/perf_event.h>
+#include <sys/ioctl.h>
 
 #include <cstring>
 
@@ -8,18 +10,23 @@
 namespace aser {
 namespace perf {
 
-event_linux_impl::~event_linux_impl() {
+inline event_linux_impl::~event_linux_impl() {
   if (fd_ != 0)
     close();
 }
 
-void event_linux_impl::open(const event_info& info, pid_t pid, bool attach) {
+inline void event_linux_impl::open(
+    const event_info& info,
+    pid_t pid,
+    bool attach) {
   perf_event_attr attr;
   memset(&attr, 0, sizeof(attr));
   attr.config = info.code;
 
   if (info.type == event_type::HARDWARE)
     attr.type = PERF_TYPE_HARDWARE;
+  else if (info.type == event_type::HW_CACHE)
+    attr.type = PERF_TYPE_HW_CACHE;
   else if (info.type == event_type::RAW)
     attr.type = PERF_TYPE_RAW;
   else
@@ -31,7 +38,10 @@ void event_linux_impl::open(const event_info& info, pid_t pid, bool attach) {
   attr.exclude_user = info.modifiers & event_modifiers::EXCLUDE_USER;
   attr.exclude_kernel = info.modifiers & event_modifiers::EXCLUDE_KERNEL;
   attr.exclude_hv = info.modifiers & event_modifiers::EXCLUDE_HV;
-  attr.inherit = 1;
+  // The kernel refuses to refresh inherited events, so overflowing events
+  // only count the task they are attached to.
+  attr.inherit = info.period == 0;
+  attr.sample_period = info.period;
   attr.disabled = !attach;
   attr.enable_on_exec = !attach;
   attr.size = sizeof(attr);
@@ -42,7 +52,7 @@ void event_linux_impl::open(const event_info& info, pid_t pid, bool attach) {
       "Error opening the event");
 }
 
-void event_linux_impl::close() noexcept {
+inline void event_linux_impl::close() noexcept {
   try {
     util::error_if_not_equal(
         ::close(fd_),
@@ -53,7 +63,7 @@ void event_linux_impl::close() noexcept {
   }
 }
 
-event_linux_impl::count_type event_linux_impl::read() {
+inline event_linux_impl::count_type event_linux_impl::read() {
   count_type count;
   util::error_if_not_equal(
       ::read(fd_, count.data(), sizeof(count)),
@@ -62,6 +72,40 @@ event_linux_impl::count_type event_linux_impl::read() {
   return count;
 }
 
+inline void event_linux_impl::notify_overflow(int signo, pid_t tid) {
+  f_owner_ex owner;
+  owner.type = F_OWNER_TID;
+  owner.pid = tid;
+  util::error_if_equal(
+      fcntl(fd_, F_SETOWN_EX, &owner),
+      -1,
+      "Error setting the event owner");
+  util::error_if_equal(
+      fcntl(fd_, F_SETSIG, signo),
+      -1,
+      "Error setting the overflow signal");
+  util::error_if_equal(
+      fcntl(fd_, F_SETFL, O_ASYNC | O_NONBLOCK),
+      -1,
+      "Error enabling overflow notifications");
+}
+
+inline void event_linux_impl::rearm(uint64_t period, unsigned overflows) {
+  set_period(period);
+  util::error_if_equal(
+      ioctl(fd_, PERF_EVENT_IOC_REFRESH, overflows),
+      -1,
+      "Error arming the event");
+}
+
+inline void event_linux_impl::set_period(uint64_t period) {
+  // The kernel restarts the period of an active event.
+  util::error_if_equal(
+      ioctl(fd_, PERF_EVENT_IOC_PERIOD, &period),
+      -1,
+      "Error setting the event period");
+}
+
 } // namespace perf
 } // namespace aser
 
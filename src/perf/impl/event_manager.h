@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <util/log.h>
 
 namespace aser {
@@ -10,8 +12,12 @@ event_manager<Event>::event_manager(
     bool attach,
     event_factory factory)
   : latest_samples_(events.size())
+  , counts_(events.size())
+  , prev_counts_(events.size())
+  , batch_samples_(events.size())
 {
   events_.reserve(events.size());
+  prev_times_.reserve(events.size());
   std::transform(begin(events), end(events),
       std::back_inserter(events_),
       [&](const event_info& info) { return factory(info); });
@@ -23,9 +29,19 @@ event_manager<Event>::event_manager(
 template<typename Event>
 const typename event_manager<Event>::sample_list&
 event_manager<Event>::read_events(event_read_mode mode) {
+  read();
+  return scale(mode);
+}
+
+template<typename Event>
+void event_manager<Event>::read() {
   for (auto& e : events_)
     e.read();
+}
 
+template<typename Event>
+const typename event_manager<Event>::sample_list&
+event_manager<Event>::scale(event_read_mode mode) {
   std::transform(begin(events_), end(events_),
       begin(latest_samples_),
       [&](Event& event) { return event.scale(mode); });
@@ -33,6 +49,74 @@ event_manager<Event>::read_events(event_read_mode mode) {
   return latest_samples_;
 }
 
+template<typename Event>
+const typename event_manager<Event>::sample_list&
+event_manager<Event>::scale_batched(event_read_mode mode) {
+  gather(counts_, prev_counts_, 0);
+  auto result = scale_counts(counts_, prev_counts_, mode, batch_samples_);
+  scatter(prev_counts_, batch_samples_, 0, result.count, mode);
+
+  if (result.error != scale_error::NONE)
+    throw_scale_error(result.error);
+
+  return latest_samples_;
+}
+
+template<typename Event>
+void event_manager<Event>::gather(
+    count_buffer& current,
+    count_buffer& previous,
+    size_t offset) {
+  // Initialized here, so that only the batched path requires events to
+  // provide open_time(). The storage is reserved on construction, so that
+  // no allocation takes place while sampling.
+  if (prev_times_.empty()) {
+    for (auto& e : events_)
+      prev_times_.push_back(e.open_time());
+  }
+
+  for (size_t i = 0; i < events_.size(); ++i) {
+    auto& count = events_[i].counts();
+    current.value[offset + i] = count[0];
+    current.enabled[offset + i] = count[1];
+    current.running[offset + i] = count[2];
+    previous.value[offset + i] = prev_counts_.value[i];
+    previous.enabled[offset + i] = prev_counts_.enabled[i];
+    previous.running[offset + i] = prev_counts_.running[i];
+  }
+}
+
+template<typename Event>
+const typename event_manager<Event>::sample_list&
+event_manager<Event>::scatter(
+    const count_buffer& previous,
+    const sample_buffer& samples,
+    size_t offset,
+    size_t scaled,
+    event_read_mode mode) {
+  auto count = scaled > offset ? std::min(scaled - offset, events_.size()) : 0;
+  for (size_t i = 0; i < count; ++i) {
+    prev_counts_.value[i] = previous.value[offset + i];
+    prev_counts_.enabled[i] = previous.enabled[offset + i];
+    prev_counts_.running[i] = previous.running[offset + i];
+
+    auto time = events_[i].read_time();
+    auto& sample = latest_samples_[i];
+    sample.value = samples.value[offset + i];
+    sample.scaling = samples.scaling[offset + i];
+    sample.enabled = samples.enabled[offset + i];
+    sample.timestamp = time;
+    if (mode == event_read_mode::RELATIVE) {
+      sample.window = time - prev_times_[i];
+      prev_times_[i] = time;
+    } else {
+      sample.window = time - events_[i].open_time();
+    }
+  }
+
+  return latest_samples_;
+}
+
 template<typename Event>
 Event event_manager<Event>::default_event_factory(const event_info& info) {
   return Event{info};
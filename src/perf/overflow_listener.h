@@ -0,0 +1,80 @@
+#ifndef PERF_OVERFLOW_LISTENER_H_
+#define PERF_OVERFLOW_LISTENER_H_
+
+#include <unistd.h>
+
+#include <functional>
+#include <thread>
+
+#include <util/thread.h>
+
+namespace aser {
+namespace perf {
+
+/** Overflow listener.
+ *
+ * This class runs a thread that waits for the signals raised by events
+ * armed with event::rearm(). Events must be configured to notify the
+ * listener thread (see signal() and thread_id()). Every time one of these
+ * events overflows, the callback is invoked from the listener thread with
+ * the file descriptor of the event.
+ */
+class overflow_listener {
+public:
+  using callback_func = std::function<void(int)>;
+
+  /** Constructor.
+   *
+   * @param callback Function to call when an event overflows.
+   */
+  overflow_listener(callback_func callback);
+
+  /** Destructor.
+   *
+   * The listener thread is stopped if it is still running.
+   */
+  ~overflow_listener();
+
+  /** Starts the listener thread.
+   *
+   * When this method returns the listener is ready to receive signals.
+   */
+  void start();
+
+  /** Stops the listener thread. */
+  void stop();
+
+  /** Returns the signal used for overflow notifications. */
+  int signal() const noexcept;
+
+  /** Returns the thread identifier of the listener thread. */
+  pid_t thread_id() const noexcept {
+    return tid_;
+  }
+
+private:
+  /** Function to call on every overflow. */
+  callback_func callback_;
+
+  /** File descriptor used to wake up the listener when stopping. */
+  int stop_fd_ { -1 };
+
+  /** Thread identifier of the listener thread. */
+  pid_t tid_ { -1 };
+
+  /** Condition signaled once the listener thread is ready. */
+  util::condition ready_;
+
+  /** Listener thread. */
+  std::thread thread_;
+
+  void run();
+
+  overflow_listener(const overflow_listener&) = delete;
+  overflow_listener& operator=(const overflow_listener&) = delete;
+};
+
+} // namespace perf
+} // namespace aser
+
+#endif // PERF_OVERFLOW_LISTENER_H_
@@ -0,0 +1,273 @@
+#include "scale.h"
+
+#include <cassert>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ASER_SCALE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace aser {
+namespace perf {
+
+/** Scales events [first, size) one at a time, as event::scale() does. */
+static scale_result scale_scalar(
+    const count_buffer& current,
+    count_buffer& previous,
+    event_read_mode mode,
+    sample_buffer& samples,
+    size_t first) {
+  for (auto i = first; i < current.size(); ++i) {
+    auto value = current.value[i];
+    auto enabled = current.enabled[i];
+    auto running = current.running[i];
+
+    if (running > enabled)
+      return {i, scale_error::RUNNING_EXCEEDS_ENABLED, 0};
+
+    if (running == 0 && value != previous.value[i])
+      return {i, scale_error::UNEXPECTED_VALUE, 0};
+
+    if (mode == event_read_mode::RELATIVE) {
+      value -= previous.value[i];
+      enabled -= previous.enabled[i];
+      running -= previous.running[i];
+      previous.value[i] = current.value[i];
+      previous.enabled[i] = current.enabled[i];
+      previous.running[i] = current.running[i];
+    }
+
+    if (running == 0) {
+      samples.value[i] = 0;
+      samples.scaling[i] = 0;
+      samples.enabled[i] = enabled > 0;
+      continue;
+    }
+
+    auto scaling = static_cast<double>(running) / enabled;
+    samples.value[i] = value / scaling;
+    samples.scaling[i] = scaling;
+    samples.enabled[i] = true;
+  }
+  return {current.size(), scale_error::NONE, 0};
+}
+
+#ifdef ASER_SCALE_X86
+
+/** Converts unsigned 64-bit integers to doubles, rounding to nearest as a
+ * scalar conversion does. The high half is converted exactly by placing it
+ * in the mantissa of 2^84, and the low half in the mantissa of 2^52, so
+ * that the only rounding happens in the final addition. */
+__attribute__((target("avx2")))
+static inline __m256d u64_to_double(__m256i x) {
+  auto high = _mm256_or_si256(
+      _mm256_srli_epi64(x, 32),
+      _mm256_castpd_si256(_mm256_set1_pd(19342813113834066795298816.)));
+  auto low = _mm256_blend_epi16(
+      x,
+      _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.)),
+      0xcc);
+  auto f = _mm256_sub_pd(
+      _mm256_castsi256_pd(high),
+      _mm256_set1_pd(19342813118337666422669312.));
+  return _mm256_add_pd(f, _mm256_castsi256_pd(low));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i load(const std::vector<uint64_t>& v, size_t i) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&v[i]));
+}
+
+__attribute__((target("avx2")))
+static inline void store(std::vector<uint64_t>& v, size_t i, __m256i x) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(&v[i]), x);
+}
+
+__attribute__((target("avx2")))
+static scale_result scale_avx2(
+    const count_buffer& current,
+    count_buffer& previous,
+    event_read_mode mode,
+    sample_buffer& samples) {
+  constexpr size_t lanes = 4;
+  auto n = current.size();
+  auto relative = mode == event_read_mode::RELATIVE;
+  auto zero = _mm256_setzero_si256();
+  // Unsigned comparisons are done as signed ones with the sign flipped.
+  auto sign = _mm256_set1_epi64x(static_cast<int64_t>(1ULL << 63));
+
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto value = load(current.value, i);
+    auto enabled = load(current.enabled, i);
+    auto running = load(current.running, i);
+    auto prev_value = load(previous.value, i);
+
+    auto running_zero = _mm256_cmpeq_epi64(running, zero);
+    auto invalid = _mm256_or_si256(
+        _mm256_cmpgt_epi64(
+          _mm256_xor_si256(running, sign),
+          _mm256_xor_si256(enabled, sign)),
+        _mm256_andnot_si256(
+          _mm256_cmpeq_epi64(value, prev_value),
+          running_zero));
+    // Invalid events are left to the scalar path, which stops at the
+    // first one.
+    if (!_mm256_testz_si256(invalid, invalid))
+      break;
+
+    if (relative) {
+      auto prev_enabled = load(previous.enabled, i);
+      auto prev_running = load(previous.running, i);
+      store(previous.value, i, value);
+      store(previous.enabled, i, enabled);
+      store(previous.running, i, running);
+      value = _mm256_sub_epi64(value, prev_value);
+      enabled = _mm256_sub_epi64(enabled, prev_enabled);
+      running = _mm256_sub_epi64(running, prev_running);
+      running_zero = _mm256_cmpeq_epi64(running, zero);
+    }
+
+    auto scaling = _mm256_div_pd(
+        u64_to_double(running), u64_to_double(enabled));
+    auto scaled = _mm256_div_pd(u64_to_double(value), scaling);
+
+    auto keep = _mm256_castsi256_pd(running_zero);
+    auto zero_pd = _mm256_setzero_pd();
+    _mm256_storeu_pd(&samples.value[i],
+        _mm256_blendv_pd(scaled, zero_pd, keep));
+    _mm256_storeu_pd(&samples.scaling[i],
+        _mm256_blendv_pd(scaling, zero_pd, keep));
+
+    auto disabled = _mm256_movemask_pd(_mm256_castsi256_pd(
+          _mm256_cmpeq_epi64(_mm256_or_si256(running, enabled), zero)));
+    for (size_t l = 0; l < lanes; ++l)
+      samples.enabled[i + l] = !(disabled & (1 << l));
+  }
+
+  auto result = scale_scalar(current, previous, mode, samples, i);
+  result.vectorized = i;
+  return result;
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static scale_result scale_avx512(
+    const count_buffer& current,
+    count_buffer& previous,
+    event_read_mode mode,
+    sample_buffer& samples) {
+  constexpr size_t lanes = 8;
+  auto n = current.size();
+  auto relative = mode == event_read_mode::RELATIVE;
+  auto zero = _mm512_setzero_si512();
+
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto value = _mm512_loadu_si512(&current.value[i]);
+    auto enabled = _mm512_loadu_si512(&current.enabled[i]);
+    auto running = _mm512_loadu_si512(&current.running[i]);
+    auto prev_value = _mm512_loadu_si512(&previous.value[i]);
+
+    __mmask8 running_zero = _mm512_cmpeq_epu64_mask(running, zero);
+    __mmask8 invalid = _mm512_cmpgt_epu64_mask(running, enabled)
+      | (running_zero & _mm512_cmpneq_epu64_mask(value, prev_value));
+    // Invalid events are left to the scalar path, which stops at the
+    // first one.
+    if (invalid)
+      break;
+
+    if (relative) {
+      auto prev_enabled = _mm512_loadu_si512(&previous.enabled[i]);
+      auto prev_running = _mm512_loadu_si512(&previous.running[i]);
+      _mm512_storeu_si512(&previous.value[i], value);
+      _mm512_storeu_si512(&previous.enabled[i], enabled);
+      _mm512_storeu_si512(&previous.running[i], running);
+      value = _mm512_sub_epi64(value, prev_value);
+      enabled = _mm512_sub_epi64(enabled, prev_enabled);
+      running = _mm512_sub_epi64(running, prev_running);
+      running_zero = _mm512_cmpeq_epu64_mask(running, zero);
+    }
+
+    auto scaling = _mm512_div_pd(
+        _mm512_cvtepu64_pd(running), _mm512_cvtepu64_pd(enabled));
+    auto scaled = _mm512_div_pd(_mm512_cvtepu64_pd(value), scaling);
+
+    auto zero_pd = _mm512_setzero_pd();
+    _mm512_storeu_pd(&samples.value[i],
+        _mm512_mask_blend_pd(running_zero, scaled, zero_pd));
+    _mm512_storeu_pd(&samples.scaling[i],
+        _mm512_mask_blend_pd(running_zero, scaling, zero_pd));
+
+    __mmask8 disabled =
+      _mm512_cmpeq_epu64_mask(_mm512_or_si512(running, enabled), zero);
+    for (size_t l = 0; l < lanes; ++l)
+      samples.enabled[i + l] = !(disabled & (1 << l));
+  }
+
+  auto result = scale_scalar(current, previous, mode, samples, i);
+  result.vectorized = i;
+  return result;
+}
+
+#endif // ASER_SCALE_X86
+
+bool scale_isa_supported(scale_isa isa) {
+  switch (isa) {
+  case scale_isa::SCALAR:
+    return true;
+#ifdef ASER_SCALE_X86
+  case scale_isa::AVX2:
+    return __builtin_cpu_supports("avx2");
+  case scale_isa::AVX512:
+    return __builtin_cpu_supports("avx512f")
+      && __builtin_cpu_supports("avx512dq");
+#endif
+  default:
+    return false;
+  }
+}
+
+scale_isa best_scale_isa() {
+  static const scale_isa best =
+    scale_isa_supported(scale_isa::AVX512) ? scale_isa::AVX512
+    : scale_isa_supported(scale_isa::AVX2) ? scale_isa::AVX2
+    : scale_isa::SCALAR;
+  return best;
+}
+
+scale_result scale_counts(
+    const count_buffer& current,
+    count_buffer& previous,
+    event_read_mode mode,
+    sample_buffer& samples,
+    scale_isa isa) {
+  assert(previous.size() == current.size());
+  assert(samples.value.size() == current.size());
+  assert(scale_isa_supported(isa));
+
+  switch (isa) {
+#ifdef ASER_SCALE_X86
+  case scale_isa::AVX2:
+    return scale_avx2(current, previous, mode, samples);
+  case scale_isa::AVX512:
+    return scale_avx512(current, previous, mode, samples);
+#endif
+  default:
+    return scale_scalar(current, previous, mode, samples, 0);
+  }
+}
+
+void throw_scale_error(scale_error error) {
+  switch (error) {
+  case scale_error::RUNNING_EXCEEDS_ENABLED:
+    throw std::runtime_error("Event ran for longer than it was enabled");
+  case scale_error::UNEXPECTED_VALUE:
+    throw std::runtime_error("Unexpected event value");
+  default:
+    throw std::logic_error("No scaling error");
+  }
+}
+
+} // namespace perf
+} // namespace aser
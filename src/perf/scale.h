@@ -0,0 +1,108 @@
+#ifndef PERF_SCALE_H_
+#define PERF_SCALE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <perf/event.h>
+
+namespace aser {
+namespace perf {
+
+/** Raw counts for a set of events, stored as a structure of arrays. */
+struct count_buffer {
+  explicit count_buffer(size_t size = 0)
+    : value(size), enabled(size), running(size)
+  {}
+
+  size_t size() const noexcept {
+    return value.size();
+  }
+
+  /** Resizes the buffer (it only allocates beyond its capacity). */
+  void resize(size_t size) {
+    value.resize(size);
+    enabled.resize(size);
+    running.resize(size);
+  }
+
+  std::vector<uint64_t> value;
+  std::vector<uint64_t> enabled;
+  std::vector<uint64_t> running;
+};
+
+/** Scaled samples for a set of events, stored as a structure of arrays. */
+struct sample_buffer {
+  explicit sample_buffer(size_t size = 0)
+    : value(size), scaling(size), enabled(size)
+  {}
+
+  /** Resizes the buffer (it only allocates beyond its capacity). */
+  void resize(size_t size) {
+    value.resize(size);
+    scaling.resize(size);
+    enabled.resize(size);
+  }
+
+  std::vector<double> value;
+  std::vector<double> scaling;
+  std::vector<uint8_t> enabled;
+};
+
+/** Instruction set used to scale counts. */
+enum class scale_isa { SCALAR, AVX2, AVX512 };
+
+/** Validation errors raised when scaling counts. */
+enum class scale_error { NONE, RUNNING_EXCEEDS_ENABLED, UNEXPECTED_VALUE };
+
+/** Result of scaling a set of counts. */
+struct scale_result {
+  /** Number of events scaled. */
+  size_t count;
+
+  /** Error found in the first event that was not scaled (if any). */
+  scale_error error;
+
+  /** Number of events scaled with vector instructions (the rest are
+   * scaled one at a time). */
+  size_t vectorized;
+};
+
+/** Returns the fastest instruction set supported by the CPU. */
+scale_isa best_scale_isa();
+
+/** Checks whether the CPU supports an instruction set. */
+bool scale_isa_supported(scale_isa isa);
+
+/** Scales a set of counts.
+ *
+ * The results are bit-identical to calling event::scale() for every event,
+ * in order: events are validated in the same way, and scaling stops at the
+ * first invalid event, leaving the following events untouched.
+ *
+ * @param current Counts from the latest read.
+ * @param previous Counts from the previous read. In relative mode, they are
+ *     updated with the current counts of every event scaled.
+ * @param mode Read mode (relative or aggregated).
+ * @param samples Where the samples are stored.
+ * @param isa Instruction set to use.
+ * @return The number of events scaled, the error found (if any), and the
+ *     number of events scaled with vector instructions. Vector kernels
+ *     only process whole vectors, so batches with fewer events than lanes
+ *     are scaled one at a time.
+ */
+scale_result scale_counts(
+    const count_buffer& current,
+    count_buffer& previous,
+    event_read_mode mode,
+    sample_buffer& samples,
+    scale_isa isa = best_scale_isa());
+
+/** Throws the exception that event::scale() raises for an error. */
+[[noreturn]] void throw_scale_error(scale_error error);
+
+} // namespace perf
+} // namespace aser
+
+#endif // PERF_SCALE_H_
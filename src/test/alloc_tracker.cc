@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <new>
+#include <thread>
+
+#include <util/alloc_tracker.h>
+
+namespace {
+
+using aser::util::allocation_tracking_enabled;
+using aser::util::thread_allocations;
+
+TEST(alloc_tracker, counts_allocations) {
+  if (!allocation_tracking_enabled()) {
+    EXPECT_EQ(0u, thread_allocations());
+    return;
+  }
+
+  // The allocation functions are called explicitly, as the compiler may
+  // remove the allocations in new expressions.
+  auto before = thread_allocations();
+  auto value = ::operator new(sizeof(int));
+  auto array = ::operator new[](4 * sizeof(int));
+  EXPECT_EQ(before + 2, thread_allocations());
+  ::operator delete[](array);
+  ::operator delete(value);
+}
+
+TEST(alloc_tracker, per_thread) {
+  auto before = thread_allocations();
+  std::thread t([] {
+    ::operator delete(::operator new(sizeof(int)));
+  });
+  t.join();
+  // Starting the thread allocates its state in this thread, but the
+  // allocation in the thread itself is not counted here.
+  EXPECT_LE(thread_allocations() - before, 1u);
+}
+
+} // namespace
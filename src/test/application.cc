@@ -0,0 +1,107 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <core/application.h>
+#include <util/proc.h>
+#include <util/process.h>
+
+namespace {
+
+TEST(proc, threads_of_current_process) {
+  using namespace std::chrono_literals;
+  namespace util = aser::util;
+
+  std::thread t([] { std::this_thread::sleep_for(200ms); });
+  auto tids = util::threads(getpid());
+  t.join();
+
+  EXPECT_EQ(2u, tids.size());
+  EXPECT_NE(end(tids), std::find(begin(tids), end(tids), getpid()));
+}
+
+TEST(proc, parent) {
+  namespace util = aser::util;
+
+  EXPECT_EQ(getppid(), util::parent(getpid()));
+}
+
+TEST(proc, last_cpu) {
+  namespace util = aser::util;
+
+  auto cpu = util::last_cpu(getpid());
+  EXPECT_GE(cpu, 0);
+  EXPECT_LT(cpu, static_cast<int>(sysconf(_SC_NPROCESSORS_CONF)));
+}
+
+TEST(proc, missing_process) {
+  namespace util = aser::util;
+
+  // The maximum pid in Linux is 2^22.
+  pid_t pid = 1 << 23;
+  EXPECT_TRUE(util::threads(pid).empty());
+  EXPECT_EQ(-1, util::parent(pid));
+  EXPECT_EQ(-1, util::last_cpu(pid));
+  EXPECT_TRUE(util::process_tree(pid).empty());
+}
+
+TEST(application, process_tree) {
+  using namespace std::chrono_literals;
+  using aser::application;
+  using process = aser::util::process<aser::util::process_config>;
+
+  // The shell forks two children, so the application contains three
+  // processes while they are running.
+  process p("/bin/bash", "-c", "sleep 1 & sleep 1; wait");
+  p.start();
+  std::this_thread::sleep_for(200ms);
+
+  application app(p.pid());
+  EXPECT_EQ(p.pid(), app.root());
+  EXPECT_EQ(3u, app.processes().size());
+  EXPECT_TRUE(app.contains(p.pid()));
+  EXPECT_GE(app.threads().size(), 3u);
+  for (auto pid : app.processes())
+    EXPECT_TRUE(pid == p.pid() || aser::util::parent(pid) == p.pid());
+
+  p.wait();
+  EXPECT_TRUE(app.refresh());
+  EXPECT_TRUE(app.processes().empty());
+  EXPECT_FALSE(app.contains(p.pid()));
+}
+
+TEST(application, incremental_updates) {
+  using aser::application;
+  using process = aser::util::process<aser::util::process_config>;
+
+  process p("/bin/sleep", "1");
+  p.start();
+  application app(p.pid());
+
+  // The test process is added as if it had been forked by the benchmark.
+  auto added = app.add_process(getpid());
+  EXPECT_EQ(aser::util::threads(getpid()), added);
+  EXPECT_TRUE(app.contains(getpid()));
+  EXPECT_TRUE(app.add_process(getpid()).empty());
+
+  pid_t tid = 1 << 23;
+  EXPECT_TRUE(app.add_thread(tid));
+  EXPECT_FALSE(app.add_thread(tid));
+  EXPECT_TRUE(app.contains_thread(tid));
+  app.remove_thread(tid);
+  EXPECT_FALSE(app.contains_thread(tid));
+
+  app.remove_process(getpid());
+  EXPECT_FALSE(app.contains(getpid()));
+  EXPECT_FALSE(app.contains_thread(getpid()));
+  EXPECT_TRUE(app.contains(p.pid()));
+
+  p.wait();
+}
+
+} // namespace
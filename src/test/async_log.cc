@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <util/async_log.h>
+
+using aser::util::async_log;
+
+namespace {
+
+async_log::record make_record(const char* format) {
+  async_log::record r;
+  r.format = format;
+  r.num_args = 0;
+  return r;
+}
+
+TEST(async_log, format) {
+  auto r = make_record("%1% %2% %3% %4%");
+  r.num_args = 4;
+  r.types[0] = async_log::arg_type::SIGNED;
+  r.args[0] = static_cast<uint64_t>(-5);
+  r.types[1] = async_log::arg_type::UNSIGNED;
+  r.args[1] = 18446744073709551615ULL;
+  r.types[2] = async_log::arg_type::DOUBLE;
+  double value = 2.5;
+  std::memcpy(&r.args[2], &value, sizeof(value));
+  r.types[3] = async_log::arg_type::BOOL;
+  r.args[3] = 1;
+
+  EXPECT_EQ("-5 18446744073709551615 2.5 1", async_log::format(r));
+}
+
+TEST(async_log, invalid_format) {
+  auto r = make_record("%1% %2%");
+  EXPECT_EQ("Invalid log record: %1% %2%", async_log::format(r));
+}
+
+TEST(async_log, multiple_threads) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([t] {
+      for (int i = 0; i < 100; ++i)
+        async_log::write("thread: %1%, i: %2%, x: %3%", t, i, i * 0.5);
+    });
+  }
+  for (auto& t : threads)
+    t.join();
+
+  // The buffers of the finished threads are drained and released.
+  async_log::flush();
+  EXPECT_EQ(0u, async_log::dropped());
+}
+
+} // namespace
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <exec_manager/admission_policy.h>
+#include <exec_manager/batch.h>
+
+using aser::admission_policy;
+using aser::bandwidth_policy;
+using aser::batch_manager;
+using namespace std::literals::chrono_literals;
+namespace pt = boost::property_tree;
+
+namespace {
+
+TEST(batch_manager, fill_policy) {
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"slots\": 2,"
+      "    \"policy\": { \"type\": \"fill\" },"
+      "    \"benchmarks\": ["
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 0.2\","
+      "        \"name\": \"sleep\","
+      "        \"isolated_time\": 200"
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 0.2\","
+      "        \"name\": \"sleep\","
+      "        \"isolated_time\": 200"
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 0.2\","
+      "        \"name\": \"sleep\""
+      "      }"
+      "    ]"
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"simple\","
+      "    \"sampling_length\": 10"
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  batch_manager exec_mgr(properties);
+  exec_mgr.start();
+
+  EXPECT_GE(exec_mgr.makespan(), 400ms);
+  EXPECT_LT(exec_mgr.makespan(), 600ms);
+
+  auto& records = exec_mgr.records();
+  EXPECT_GE(records[2].start, std::min(records[0].end, records[1].end));
+  EXPECT_GE(exec_mgr.slowdown(0), 1.0);
+  EXPECT_DOUBLE_EQ(exec_mgr.slowdown(2), 0);
+}
+
+TEST(bandwidth_policy, select) {
+  pt::ptree properties;
+  properties.put("max_bandwidth", 10.0);
+  bandwidth_policy policy(properties);
+
+  std::vector<admission_policy::candidate> queue(2);
+  queue[0].job = 0;
+  queue[0].profile.bandwidth = 8;
+  queue[1].job = 1;
+  queue[1].profile.bandwidth = 2;
+
+  std::vector<admission_policy::co_runner> running;
+  EXPECT_EQ(policy.select(queue, running), 0);
+
+  running.resize(1);
+  running[0].metrics.bandwidth = 6;
+  EXPECT_EQ(policy.select(queue, running), 1);
+
+  running[0].metrics.bandwidth = 9;
+  EXPECT_EQ(policy.select(queue, running), -1);
+}
+
+TEST(bandwidth_policy, occupancy_and_ipc) {
+  pt::ptree properties;
+  properties.put("max_bandwidth", 10.0);
+  properties.put("max_llc_occupancy", 8.0);
+  properties.put("min_ipc", 0.5);
+  bandwidth_policy policy(properties);
+
+  std::vector<admission_policy::candidate> queue(2);
+  queue[0].job = 0;
+  queue[0].profile.llc_occupancy = 6;
+  queue[1].job = 1;
+  queue[1].profile.llc_occupancy = 2;
+
+  std::vector<admission_policy::co_runner> running(1);
+  running[0].metrics.llc_occupancy = 4;
+  EXPECT_EQ(policy.select(queue, running), 1);
+
+  running[0].metrics.ipc = 0.4;
+  EXPECT_EQ(policy.select(queue, running), -1);
+
+  // An unknown IPC does not count as slowed down.
+  running[0].metrics.ipc = 0;
+  EXPECT_EQ(policy.select(queue, running), 1);
+  running[0].metrics.llc_occupancy = 7;
+  EXPECT_EQ(policy.select(queue, running), -1);
+}
+
+} // namespace
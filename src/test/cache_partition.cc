@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <util/cache_partition.h>
+
+using namespace aser::util;
+
+namespace {
+
+/** Misses of a process that only fits with four ways (out of eight). */
+partition_request cliff(unsigned min_ways = 0, unsigned reserved_ways = 0) {
+  return {{100, 100, 100, 100, 0, 0, 0, 0, 0}, min_ways, reserved_ways};
+}
+
+/** Misses of a process that saves the same misses with every way. */
+partition_request linear(
+    double step,
+    unsigned min_ways = 0,
+    unsigned reserved_ways = 0) {
+  partition_request request{{}, min_ways, reserved_ways};
+  for (unsigned w = 0; w <= 8; ++w)
+    request.misses.push_back(step * (8 - w));
+  return request;
+}
+
+TEST(cache_partition, lookahead) {
+  // Allocating a way at a time would never give the first process a way.
+  partition_solver solver({8, partition_algorithm::LOOKAHEAD, 0});
+  std::vector<partition_request> requests {cliff(), linear(10)};
+  std::vector<unsigned> allocation;
+  EXPECT_TRUE(solver.solve(requests, allocation));
+  EXPECT_EQ((std::vector<unsigned>{4, 4}), allocation);
+  EXPECT_EQ(40, partition_solver::total_misses(requests, allocation));
+  EXPECT_FALSE(solver.solve(requests, allocation));
+}
+
+TEST(cache_partition, hull) {
+  partition_solver solver({8, partition_algorithm::HULL, 0});
+  std::vector<partition_request> requests {cliff(), linear(10)};
+  std::vector<unsigned> allocation;
+  EXPECT_TRUE(solver.solve(requests, allocation));
+  EXPECT_EQ((std::vector<unsigned>{4, 4}), allocation);
+
+  requests = {linear(1), linear(3), linear(2)};
+  EXPECT_TRUE(solver.solve(requests, allocation));
+  EXPECT_EQ((std::vector<unsigned>{0, 8, 0}), allocation);
+}
+
+TEST(cache_partition, min_and_reserved_ways) {
+  for (auto algorithm
+      : {partition_algorithm::LOOKAHEAD, partition_algorithm::HULL}) {
+    partition_solver solver({8, algorithm, 0});
+    std::vector<partition_request> requests {
+      linear(100, 0, 3), linear(10), linear(1, 2)};
+    std::vector<unsigned> allocation;
+    EXPECT_TRUE(solver.solve(requests, allocation));
+    EXPECT_EQ((std::vector<unsigned>{3, 3, 2}), allocation);
+  }
+}
+
+TEST(cache_partition, hysteresis) {
+  std::vector<partition_request> requests {linear(10), linear(9)};
+  std::vector<unsigned> allocation {4, 4};
+
+  // Moving every way to the first process saves 4 misses out of 76.
+  partition_solver solver({8, partition_algorithm::LOOKAHEAD, 0.1});
+  EXPECT_FALSE(solver.solve(requests, allocation));
+  EXPECT_EQ((std::vector<unsigned>{4, 4}), allocation);
+
+  partition_solver eager({8, partition_algorithm::LOOKAHEAD, 0.01});
+  EXPECT_TRUE(eager.solve(requests, allocation));
+  EXPECT_EQ((std::vector<unsigned>{8, 0}), allocation);
+
+  // Allocations that do not meet the requests are always replaced.
+  allocation = {4, 4};
+  requests[1].min_ways = 5;
+  EXPECT_TRUE(solver.solve(requests, allocation));
+  EXPECT_EQ((std::vector<unsigned>{3, 5}), allocation);
+}
+
+TEST(cache_partition, invalid) {
+  EXPECT_THROW(parse_partition_algorithm("best"), std::invalid_argument);
+  EXPECT_THROW(partition_solver({0, partition_algorithm::HULL, 0}),
+      std::invalid_argument);
+  EXPECT_THROW(partition_solver({8, partition_algorithm::HULL, -1}),
+      std::invalid_argument);
+
+  partition_solver solver({8, partition_algorithm::HULL, 0});
+  std::vector<unsigned> allocation;
+  std::vector<partition_request> requests {{{1, 0}, 0, 0}};
+  EXPECT_THROW(solver.solve(requests, allocation), std::invalid_argument);
+  requests = {linear(1, 5), linear(1, 0, 4)};
+  EXPECT_THROW(solver.solve(requests, allocation), std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <exec_manager/simple.h>
+
+using aser::simple_manager;
+namespace fs = boost::filesystem;
+namespace pt = boost::property_tree;
+
+namespace {
+
+void write_file(const fs::path& path, const std::string& contents) {
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path.string());
+  out << contents << "\n";
+}
+
+pt::ptree create_properties(const std::string& curve_source) {
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"benchmarks\": ["
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep\""
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep\""
+      "      }"
+      "    ]"
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"cache-partitioner\","
+      "    \"sampling_length\": 100,"
+      "    \"curve_source\": \"" + curve_source + "\","
+      "    \"event\": \"dummy\","
+      "    \"llc_size\": 1024,"
+      "    \"mrc_bins\": 16,"
+      "    \"probe_period\": 2,"
+      "    \"reserved_ways\": \"0 2\""
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  return properties;
+}
+
+TEST(cache_partitioner, mrc) {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  write_file(root / "info" / "L3" / "cbm_mask", "ff");
+  write_file(root / "schemata", "L3:0=ff");
+
+  auto properties = create_properties("mrc");
+  properties.put("exec_monitor.resctrl_root", root.string());
+  simple_manager exec_mgr(properties);
+  exec_mgr.start();
+  fs::remove_all(root);
+
+  // Without cache allocation, partitions are only logged.
+  EXPECT_THROW(simple_manager{properties}, std::runtime_error);
+  properties.put("exec_monitor.ways", 8);
+  simple_manager dry_mgr(properties);
+  dry_mgr.start();
+}
+
+TEST(cache_partitioner, probe) {
+  auto properties = create_properties("probe");
+  properties.put("exec_monitor.resctrl_root", "/nonexistent");
+  properties.put("exec_monitor.ways", 8);
+  simple_manager exec_mgr(properties);
+  exec_mgr.start();
+
+  properties.put("exec_monitor.curve_source", "oracle");
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+}
+
+} // namespace
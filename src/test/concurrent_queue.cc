@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <thread>
+#include <vector>
 
 #include <util/concurrent_queue.h>
 
@@ -48,5 +49,25 @@ TEST(concurrent_queue, timeout) {
   EXPECT_EQ(res.second, 1234);
 }
 
+TEST(concurrent_queue, pop_all) {
+  aser::util::concurrent_queue<int> queue;
+  constexpr int count = 10;
+
+  std::vector<int> values;
+  EXPECT_EQ(queue.pop_all(values), 0u);
+  EXPECT_TRUE(values.empty());
+
+  for (int i = 0; i < count; i++)
+    queue.push(i);
+
+  EXPECT_EQ(queue.pop_all(values), static_cast<size_t>(count));
+  ASSERT_EQ(values.size(), static_cast<size_t>(count));
+  for (int i = 0; i < count; i++)
+    EXPECT_EQ(values[i], i);
+
+  auto res = queue.pop(std::chrono::seconds(0));
+  EXPECT_FALSE(res.first);
+}
+
 } // namespace
 
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <exec_monitor/config_search.h>
+
+using aser::config_search;
+using aser::parse_search_strategy;
+using aser::search_strategy;
+
+namespace {
+
+config_search::config make_config(
+    std::vector<unsigned> levels,
+    search_strategy strategy,
+    double budget = 1) {
+  return {std::move(levels), strategy, budget, 0.02, 1, 8, 1};
+}
+
+/** Runs a search for a number of intervals. */
+template<typename Reward>
+void run(config_search& search, unsigned intervals, Reward reward) {
+  auto c = search.best();
+  for (unsigned i = 0; i < intervals; ++i)
+    c = search.step(reward(c));
+}
+
+TEST(config_search, parse_search_strategy) {
+  EXPECT_EQ(search_strategy::HILL_CLIMBING,
+      parse_search_strategy("hill-climbing"));
+  EXPECT_EQ(search_strategy::UCB, parse_search_strategy("ucb"));
+  EXPECT_EQ(search_strategy::THOMPSON, parse_search_strategy("thompson"));
+  EXPECT_THROW(parse_search_strategy("annealing"), std::invalid_argument);
+}
+
+TEST(config_search, invalid) {
+  auto hc = search_strategy::HILL_CLIMBING;
+  EXPECT_THROW(config_search(make_config({}, hc), {}),
+      std::invalid_argument);
+  EXPECT_THROW(config_search(make_config({4, 0}, hc), {0, 0}),
+      std::invalid_argument);
+  EXPECT_THROW(config_search(make_config({1 << 13, 1 << 13}, hc), {0, 0}),
+      std::invalid_argument);
+  EXPECT_THROW(config_search(make_config({4}, hc, 2), {0}),
+      std::invalid_argument);
+  EXPECT_THROW(config_search(make_config({4, 4}, hc), {0, 4}),
+      std::invalid_argument);
+  EXPECT_THROW(config_search(make_config({4, 4}, hc), {0}),
+      std::invalid_argument);
+}
+
+TEST(config_search, hill_climbing) {
+  config_search search(
+      make_config({8, 8}, search_strategy::HILL_CLIMBING), {7, 7});
+  EXPECT_EQ(64u, search.size());
+  run(search, 100, [](const config_search::configuration& c) {
+    return 100.0 - std::pow(c[0] - 5.0, 2) - std::pow(c[1] - 2.0, 2);
+  });
+  EXPECT_EQ((config_search::configuration{5, 2}), search.best());
+}
+
+TEST(config_search, random_restarts) {
+  // Climbing from the start reaches a local optimum at level 2.
+  config_search search(
+      make_config({10}, search_strategy::HILL_CLIMBING), {0});
+  static const double rewards[] = {3, 4, 5, 4, 3, 2, 6, 8, 10, 9};
+  run(search, 200, [](const config_search::configuration& c) {
+    return rewards[c[0]];
+  });
+  EXPECT_EQ(config_search::configuration{8}, search.best());
+}
+
+TEST(config_search, budget) {
+  config_search search(
+      make_config({8}, search_strategy::HILL_CLIMBING, 0.25), {7});
+  auto c = search.best();
+  unsigned explorations = 0;
+  for (unsigned i = 0; i < 100; ++i) {
+    c = search.step(c[0]);
+    explorations += search.exploring();
+  }
+  EXPECT_LE(explorations, 25u);
+  EXPECT_GT(explorations, 0u);
+  EXPECT_EQ(config_search::configuration{7}, search.best());
+
+  // Without budget, the search never leaves the best configuration.
+  config_search frozen(
+      make_config({8}, search_strategy::UCB, 0), {3});
+  run(frozen, 20, [](const config_search::configuration& c) {
+    return -static_cast<double>(c[0]);
+  });
+  EXPECT_EQ(config_search::configuration{3}, frozen.best());
+  EXPECT_FALSE(frozen.exploring());
+}
+
+TEST(config_search, bandits) {
+  for (auto strategy : {search_strategy::UCB, search_strategy::THOMPSON}) {
+    config_search search(make_config({5}, strategy, 0.5), {0});
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0, 0.5);
+    run(search, 400, [&](const config_search::configuration& c) {
+      return 10 + (c[0] == 3 ? 3 : c[0] * 0.5) + noise(gen);
+    });
+    EXPECT_EQ(config_search::configuration{3}, search.best());
+  }
+}
+
+TEST(config_search, phases) {
+  config_search search(
+      make_config({8}, search_strategy::HILL_CLIMBING), {0});
+  auto peak = [](unsigned level) {
+    return [level](const config_search::configuration& c) {
+      return 10 - std::abs(static_cast<double>(c[0]) - level);
+    };
+  };
+
+  search.set_phase(1);
+  run(search, 50, peak(5));
+  EXPECT_EQ(config_search::configuration{5}, search.best());
+
+  // A new phase starts from the best configuration of the previous one.
+  search.set_phase(2);
+  EXPECT_EQ(config_search::configuration{5}, search.best());
+  run(search, 50, peak(1));
+  EXPECT_EQ(config_search::configuration{1}, search.best());
+
+  search.set_phase(1);
+  EXPECT_EQ(config_search::configuration{5}, search.best());
+  EXPECT_EQ(3u, search.phases());
+
+  // The interval in progress when the phase changes is discarded.
+  search.set_phase(3);
+  search.step(100);
+  double reward;
+  EXPECT_FALSE(search.reward({5}, reward));
+  search.step(100);
+  EXPECT_TRUE(search.reward({5}, reward));
+  EXPECT_EQ(100, reward);
+}
+
+TEST(config_search, unmeasured) {
+  // Intervals without a reward are not recorded.
+  config_search search(make_config({4}, search_strategy::UCB), {3});
+  run(search, 10, [](const config_search::configuration&) {
+    return std::numeric_limits<double>::quiet_NaN();
+  });
+  double reward;
+  for (unsigned level = 0; level < 4; ++level)
+    EXPECT_FALSE(search.reward({level}, reward));
+
+  search.step(1);
+  EXPECT_TRUE(search.reward(search.best(), reward));
+}
+
+} // namespace
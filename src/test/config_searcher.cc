@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <exec_manager/simple.h>
+
+using aser::simple_manager;
+namespace fs = boost::filesystem;
+namespace pt = boost::property_tree;
+
+namespace {
+
+void write_file(const fs::path& path, const std::string& contents) {
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path.string());
+  out << contents << "\n";
+}
+
+std::string read_file(const fs::path& path) {
+  std::ifstream in(path.string());
+  std::string line;
+  std::getline(in, line);
+  return line;
+}
+
+pt::ptree create_properties(const std::string& search) {
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"benchmarks\": ["
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep\""
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep\""
+      "      }"
+      "    ]"
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"config-search\","
+      "    \"sampling_length\": 100,"
+      "    \"event\": \"dummy\","
+      "    \"search\": \"" + search + "\","
+      "    \"search_budget\": 0.5,"
+      "    \"search_seed\": 1"
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  return properties;
+}
+
+TEST(config_searcher, cpus) {
+  for (auto search : {"hill-climbing", "ucb", "thompson"}) {
+    auto properties = create_properties(search);
+    simple_manager exec_mgr(properties);
+    exec_mgr.start();
+  }
+}
+
+TEST(config_searcher, knobs) {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  auto resctrl = root / "resctrl";
+  write_file(resctrl / "info" / "L3" / "cbm_mask", "ff");
+  write_file(resctrl / "info" / "MB" / "min_bandwidth", "10");
+  write_file(resctrl / "schemata", "L3:0=ff\nMB:0=100");
+  auto cpufreq = root / "devices" / "system" / "cpu" / "cpu0" / "cpufreq";
+  write_file(cpufreq / "cpuinfo_min_freq", "1000000");
+  write_file(cpufreq / "cpuinfo_max_freq", "2000000");
+  write_file(cpufreq / "scaling_max_freq", "1500000");
+
+  auto properties = create_properties("hill-climbing");
+  properties.put("exec_monitor.knobs", "cpus cache bandwidth frequency");
+  properties.put("exec_monitor.cpus", "0");
+  properties.put("exec_monitor.resctrl_root", resctrl.string());
+  properties.put("exec_monitor.sysfs_root", root.string());
+  properties.put("exec_monitor.objective.type", "fairness");
+  {
+  simple_manager exec_mgr(properties);
+  exec_mgr.start();
+  }
+  EXPECT_TRUE(fs::exists(resctrl / "aser-search" / "schemata"));
+  // The limit is restored once the monitor is destroyed.
+  EXPECT_EQ("1500000", read_file(cpufreq / "scaling_max_freq"));
+
+  properties.put("exec_monitor.knobs", "cpus voltage");
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+  properties.put("exec_monitor.knobs", "cpus");
+  properties.put("exec_monitor.cpu_levels", "1 2");
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+  fs::remove_all(resctrl / "info");
+  properties.put("exec_monitor.knobs", "cache");
+  EXPECT_THROW(simple_manager{properties}, std::runtime_error);
+  fs::remove_all(root);
+}
+
+TEST(config_searcher, phase_detection) {
+  auto properties = create_properties("ucb");
+  properties.put("exec_monitor.phase_detection", "run-length");
+  {
+  simple_manager exec_mgr(properties);
+  exec_mgr.start();
+  }
+
+  properties.put("exec_monitor.phase_detection", "oracle");
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+  properties.put("exec_monitor.phase_detection", "markov");
+  properties.put("exec_monitor.phase_table_size", 1);
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+}
+
+} // namespace
@@ -1,36 +1,91 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <map>
 #include <sstream>
+#include <thread>
+
+#include <unistd.h>
 
 #include <boost/property_tree/json_parser.hpp>
 
 #include <exec_manager/simple.h>
+#include <exec_monitor/cpu_hopper.h>
+#include <util/os.h>
+#include <util/proc.h>
 
+using aser::cpu_hopper;
 using aser::simple_manager;
 namespace pt = boost::property_tree;
 
 namespace {
 
-TEST(cpu_hopper, basic) {
-  // TODO improve this test case by actually checking that processes
-  // are being hopped around.
+/** Creates the properties to run a number of sleep benchmarks.
+ *
+ * @param benchmarks Number of benchmarks.
+ * @param seconds Seconds every benchmark sleeps.
+ */
+pt::ptree create_properties(unsigned benchmarks = 1, unsigned seconds = 1) {
   pt::ptree properties;
   std::istringstream json_properties(
       "{"
       "  \"exec_manager\": {"
-      "    \"benchmarks\": ["
-      "      {"
-      "        \"cmd\": \"/usr/bin/env sleep 5\","
-      "        \"name\": \"sleep\""
-      "      }"
-      "    ]"
+      "    \"benchmarks\": []"
       "  },"
       "  \"exec_monitor\": {"
       "    \"type\": \"cpu-hopper\","
-      "    \"sampling_length\": 500"
+      "    \"sampling_length\": 100"
       "  }"
       "}");
   pt::read_json(json_properties, properties);
+
+  pt::ptree benchmark;
+  benchmark.put("cmd", "/usr/bin/env sleep " + std::to_string(seconds));
+  benchmark.put("name", "sleep");
+  auto& children = properties.get_child("exec_manager.benchmarks");
+  for (unsigned i = 0; i < benchmarks; ++i)
+    children.push_back({"", benchmark});
+  return properties;
+}
+
+const cpu_hopper& hopper(const simple_manager& exec_mgr) {
+  return dynamic_cast<const cpu_hopper&>(exec_mgr.monitor());
+}
+
+/** Runs a manager, and returns the CPUs every benchmark process is allowed
+ * to run on once they have all been bound.
+ *
+ * @param benchmarks Number of benchmarks the manager runs.
+ */
+std::map<pid_t, std::vector<unsigned>> run_and_observe_affinity(
+    simple_manager& exec_mgr,
+    unsigned benchmarks) {
+  std::thread runner([&] { exec_mgr.start(); });
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  auto pids = aser::util::children(getpid());
+  while (pids.size() < benchmarks
+      && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pids = aser::util::children(getpid());
+  }
+  // Processes are bound once the monitor handles their creation.
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+  std::map<pid_t, std::vector<unsigned>> affinity;
+  for (auto pid : pids)
+    affinity[pid] = aser::util::allowed_cpus(pid);
+
+  runner.join();
+  return affinity;
+}
+
+TEST(cpu_hopper, basic) {
+  // TODO improve this test case by actually checking that processes
+  // are being hopped around.
+  auto properties = create_properties(1, 5);
+  properties.put("exec_monitor.sampling_length", 500);
   simple_manager exec_mgr(properties);
 
 #ifdef __linux__
@@ -39,5 +94,97 @@ TEST(cpu_hopper, basic) {
 #endif
 }
 
-} // namespace
+TEST(cpu_hopper, oversubscription) {
+  // More processes than CPUs share the sets.
+  auto cpus = aser::util::allowed_cpus();
+  auto benchmarks = cpus.size() + 1;
+  auto properties = create_properties(benchmarks);
+  properties.put("exec_monitor.processes_per_set", 0);
+  simple_manager exec_mgr(properties);
+
+#ifdef __linux__
+  auto affinity = run_and_observe_affinity(exec_mgr, benchmarks);
+  EXPECT_EQ(benchmarks, affinity.size());
+  for (auto& a : affinity) {
+    ASSERT_EQ(1u, a.second.size());
+    EXPECT_NE(end(cpus), std::find(begin(cpus), end(cpus), a.second[0]));
+  }
+
+  // Homes are balanced across the sets.
+  auto finished = hopper(exec_mgr).finished();
+  EXPECT_EQ(benchmarks, finished.size());
+  std::vector<unsigned> load(cpus.size(), 0);
+  for (auto& f : finished)
+    ++load.at(f.second.home);
+  auto bounds = std::minmax_element(begin(load), end(load));
+  EXPECT_LE(*bounds.second - *bounds.first, 1u);
+#endif
+}
 
+TEST(cpu_hopper, pinned_threads) {
+  // Every thread gets its own CPU within a set spanning all the CPUs.
+  auto cpus = aser::util::allowed_cpus();
+  auto properties = create_properties();
+  properties.put("exec_monitor.thread_binding", "pinned");
+  properties.put("exec_monitor.cpus_per_process", cpus.size());
+  simple_manager exec_mgr(properties);
+
+#ifdef __linux__
+  auto affinity = run_and_observe_affinity(exec_mgr, 1);
+  ASSERT_EQ(1u, affinity.size());
+  auto& bound = begin(affinity)->second;
+  ASSERT_EQ(1u, bound.size());
+  EXPECT_NE(end(cpus), std::find(begin(cpus), end(cpus), bound[0]));
+#endif
+
+  properties.put("exec_monitor.thread_binding", "spread");
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+}
+
+TEST(cpu_hopper, migration_cost) {
+  auto properties = create_properties();
+  properties.put("exec_monitor.event", "dummy");
+  properties.put("exec_monitor.migration_windows", 3);
+  properties.put("exec_monitor.migration_window", 10);
+  simple_manager exec_mgr(properties);
+
+#ifdef __linux__
+  exec_mgr.start();
+  auto finished = hopper(exec_mgr).finished();
+  ASSERT_EQ(1u, finished.size());
+  auto& summary = begin(finished)->second;
+  EXPECT_TRUE(summary.measured);
+  EXPECT_FALSE(summary.pages_migrated);
+  // The application hops on every interval if there is another set.
+  if (aser::util::allowed_cpus().size() > 1) {
+    EXPECT_GT(summary.hops, 0u);
+  }
+#endif
+
+  properties.put("exec_monitor.migration_window", 50);
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+}
+
+TEST(cpu_hopper, page_migration) {
+  // Pages are sampled through page faults if there is no precise event.
+  auto properties = create_properties();
+  properties.put("exec_monitor.page_migration", true);
+  properties.put("exec_monitor.page_batch", 64);
+  simple_manager exec_mgr(properties);
+
+#ifdef __linux__
+  exec_mgr.start();
+  auto finished = hopper(exec_mgr).finished();
+  ASSERT_EQ(1u, finished.size());
+  auto& summary = begin(finished)->second;
+  EXPECT_FALSE(summary.measured);
+  if (summary.pages_migrated) {
+    EXPECT_EQ(summary.pages.moved_pages * sysconf(_SC_PAGESIZE),
+        summary.pages.moved_bytes);
+    EXPECT_GE(summary.pages.remote_ratio, 0);
+    EXPECT_LE(summary.pages.remote_ratio, 1);
+  }
+#endif
+}
+
+} // namespace
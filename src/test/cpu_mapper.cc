@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <util/cpu_mapper.h>
+
+using namespace aser::util;
+
+namespace {
+
+/** Two nodes, a cache domain per node, two cores per cache domain and two
+ * SMT siblings per core (CPUs n and n + 4). */
+topology create_topology() {
+  std::vector<cpu_info> cpus;
+  for (unsigned cpu = 0; cpu < 8; ++cpu) {
+    auto core = cpu % 4;
+    cpus.push_back({cpu, 0, core, core / 2, core / 2});
+  }
+  return topology{cpus};
+}
+
+std::vector<unsigned> all_cpus() {
+  return {0, 1, 2, 3, 4, 5, 6, 7};
+}
+
+TEST(cpu_mapper, strategies) {
+  auto topo = create_topology();
+  EXPECT_EQ((std::vector<unsigned>{0, 4, 1, 5, 2, 6, 3, 7}),
+      cpu_mapper(topo, placement::COMPACT, all_cpus()).order());
+  EXPECT_EQ((std::vector<unsigned>{0, 2, 1, 3, 4, 6, 5, 7}),
+      cpu_mapper(topo, placement::SCATTER, all_cpus()).order());
+  EXPECT_EQ((std::vector<unsigned>{0, 1, 2, 3, 4, 5, 6, 7}),
+      cpu_mapper(topo, placement::CORE, all_cpus()).order());
+  EXPECT_EQ((std::vector<unsigned>{0, 2, 1, 3, 4, 6, 5, 7}),
+      cpu_mapper(topo, placement::LLC, all_cpus()).order());
+}
+
+TEST(cpu_mapper, allocate_release) {
+  cpu_mapper mapper(create_topology(), placement::SCATTER, all_cpus());
+  EXPECT_EQ(0u, mapper.allocate());
+  EXPECT_EQ(2u, mapper.allocate());
+  EXPECT_EQ(1u, mapper.allocate());
+  EXPECT_EQ(5u, mapper.available());
+  EXPECT_TRUE(mapper.is_allocated(2));
+
+  mapper.release(2);
+  EXPECT_FALSE(mapper.is_allocated(2));
+  EXPECT_THROW(mapper.release(2), std::invalid_argument);
+  EXPECT_EQ(2u, mapper.allocate());
+  EXPECT_EQ(3u, mapper.allocate());
+
+  for (unsigned i = 0; i < 4; ++i)
+    mapper.allocate();
+  EXPECT_EQ(0u, mapper.available());
+  EXPECT_THROW(mapper.allocate(), std::runtime_error);
+}
+
+TEST(cpu_mapper, allowed_cpus) {
+  // CPUs outside the topology are ignored.
+  cpu_mapper mapper(create_topology(), placement::COMPACT, {7, 3, 6, 12});
+  EXPECT_EQ((std::vector<unsigned>{6, 3, 7}), mapper.order());
+  EXPECT_THROW(mapper.release(0), std::invalid_argument);
+}
+
+TEST(cpu_mapper, cpu_sets) {
+  cpu_mapper mapper(create_topology(), placement::COMPACT, all_cpus());
+  auto sets = mapper.cpu_sets(3);
+  ASSERT_EQ(2u, sets.size());
+  EXPECT_EQ((std::vector<unsigned>{0, 4, 1}), sets[0]);
+  EXPECT_EQ((std::vector<unsigned>{5, 2, 6}), sets[1]);
+  EXPECT_EQ(8u, mapper.cpu_sets(1).size());
+  EXPECT_THROW(mapper.cpu_sets(0), std::invalid_argument);
+}
+
+TEST(cpu_mapper, parse_placement) {
+  EXPECT_EQ(placement::SCATTER, parse_placement("scatter"));
+  EXPECT_EQ(placement::LLC, parse_placement("llc"));
+  EXPECT_THROW(parse_placement("random"), std::invalid_argument);
+}
+
+TEST(cpu_mapper, system) {
+  auto mapper = cpu_mapper::create(placement::COMPACT);
+  EXPECT_FALSE(mapper.order().empty());
+  EXPECT_EQ(mapper.order().size(), mapper.available());
+}
+
+} // namespace
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <core/exec_monitor.h>
+#include <exec_manager/simple.h>
+
+namespace pt = boost::property_tree;
+
+namespace {
+
+using aser::exec_event;
+using event_type = exec_event::event_type;
+
+class test_monitor : public aser::exec_monitor {
+public:
+  test_monitor(aser::exec_manager& exec_manager)
+    : exec_monitor(exec_manager)
+  {}
+
+  using exec_monitor::register_event_handler;
+  using exec_monitor::publish_metrics;
+  using exec_monitor::enable_history;
+  using exec_monitor::history;
+
+private:
+  void loop_impl() final {}
+};
+
+pt::ptree create_properties() {
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"benchmarks\": []"
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"simple\","
+      "    \"sampling_length\": 10"
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  return properties;
+}
+
+TEST(exec_monitor, multiple_handlers) {
+  aser::simple_manager exec_mgr(create_properties());
+  test_monitor monitor(exec_mgr);
+
+  std::vector<int> calls;
+  monitor.register_event_handler(
+      event_type::THREAD_CREATED,
+      [&](const exec_event& e) { calls.push_back(e.payload.thread.tid); });
+  monitor.register_event_handler(
+      event_type::THREAD_CREATED,
+      [&](const exec_event& e) { calls.push_back(-e.payload.thread.tid); });
+
+  exec_event event {event_type::THREAD_CREATED, 10, 10};
+  event.payload.thread.tid = 11;
+  monitor.event_handler(event);
+
+  ASSERT_EQ(2u, calls.size());
+  EXPECT_EQ(11, calls[0]);
+  EXPECT_EQ(-11, calls[1]);
+}
+
+TEST(exec_monitor, metrics_released_on_exit) {
+  aser::simple_manager exec_mgr(create_properties());
+  test_monitor monitor(exec_mgr);
+
+  aser::process_metrics metrics;
+  metrics.ipc = 1.5;
+  monitor.publish_metrics(10, metrics);
+  monitor.publish_metrics(20, metrics);
+
+  int exits = 0;
+  monitor.register_event_handler(
+      event_type::PROCESS_EXITED,
+      [&](const exec_event&) { ++exits; });
+
+  monitor.event_handler({event_type::PROCESS_EXITED, 10, 10});
+  EXPECT_EQ(1, exits);
+  EXPECT_FALSE(monitor.metrics(10, metrics));
+  EXPECT_TRUE(monitor.metrics(20, metrics));
+  EXPECT_EQ(1.5, metrics.ipc);
+}
+
+TEST(exec_monitor, metrics_history) {
+  aser::simple_manager exec_mgr(create_properties());
+  test_monitor monitor(exec_mgr);
+
+  aser::process_metrics metrics;
+  monitor.publish_metrics(10, metrics);
+  EXPECT_EQ(nullptr, monitor.history(10));
+
+  monitor.enable_history(4);
+  for (int i = 1; i <= 6; ++i) {
+    metrics.ipc = i;
+    monitor.publish_metrics(10, metrics);
+  }
+
+  auto history = monitor.history(10);
+  ASSERT_NE(nullptr, history);
+  EXPECT_EQ(4u, history->size());
+  EXPECT_EQ(6, history->value(test_monitor::IPC));
+  EXPECT_EQ(4.5, history->stats(test_monitor::IPC, 4).mean);
+  EXPECT_EQ(0, history->stats(test_monitor::BANDWIDTH, 4).max);
+
+  monitor.event_handler({event_type::PROCESS_EXITED, 10, 10});
+  EXPECT_EQ(nullptr, monitor.history(10));
+}
+
+TEST(exec_monitor, payload_is_cleared) {
+  exec_event event {event_type::PROCESS_EXITED, 10};
+  EXPECT_EQ(-1, event.root);
+  EXPECT_EQ(0, event.payload.exit.status);
+  EXPECT_FALSE(event.payload.exit.has_usage);
+  EXPECT_EQ(0, event.payload.exit.usage.ru_utime.tv_sec);
+}
+
+} // namespace
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <exec_manager/fixed_work.h>
+#include <perf/event_dummy.h>
+
+using namespace aser::perf;
+namespace pt = boost::property_tree;
+
+namespace {
+
+#ifdef __linux__
+
+using manager = aser::fixed_work_manager<event<event_dummy_impl>>;
+
+/** Event that retires the instructions of every period as soon as it is
+ * armed, and then a number of instructions more while it is enabled (as if
+ * the manager handled the overflows late).
+ *
+ * Overflows are notified by writing to a pipe whose reader is configured as
+ * the event (see event_linux_impl::notify_overflow()), so the kernel raises
+ * the same signals, with the file descriptor of the reader.
+ */
+class event_overflow_impl {
+public:
+  using count_type = std::array<uint64_t, 3>;
+
+  /** Instructions retired after an overflow that does not disable the
+   * event. */
+  static uint64_t late_instructions;
+
+  ~event_overflow_impl() {
+    if (fds_[0] >= 0)
+      close();
+  }
+
+  void open(const event_info& info, pid_t pid, bool attach) {
+    ASSERT_EQ(0, ::pipe2(fds_, O_CLOEXEC | O_NONBLOCK));
+  }
+
+  void close() noexcept {
+    ::close(fds_[0]);
+    ::close(fds_[1]);
+    fds_[0] = fds_[1] = -1;
+  }
+
+  count_type read() {
+    ++time_;
+    return {count_, time_, time_};
+  }
+
+  int fd() const noexcept {
+    return fds_[0];
+  }
+
+  void notify_overflow(int signo, pid_t tid) {
+    f_owner_ex owner {F_OWNER_TID, tid};
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETOWN_EX, &owner));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETSIG, signo));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, O_ASYNC | O_NONBLOCK));
+  }
+
+  void rearm(uint64_t period, unsigned overflows) {
+    overflows_ = overflows;
+    enabled_ = true;
+    set_period(period);
+  }
+
+  void set_period(uint64_t period) {
+    period_ = period;
+    if (!enabled_)
+      return;
+
+    count_ += period_;
+    overflow();
+    if (!enabled_)
+      return;
+
+    if (late_instructions < period_) {
+      count_ += late_instructions;
+    } else {
+      count_ += period_;
+      overflow();
+    }
+  }
+
+private:
+  int fds_[2] { -1, -1 };
+  uint64_t count_ { 0 };
+  uint64_t time_ { 0 };
+  uint64_t period_ { 0 };
+  unsigned overflows_ { 0 };
+  bool enabled_ { false };
+
+  void overflow() {
+    enabled_ = --overflows_ > 0;
+    char c = 0;
+    ASSERT_EQ(1, ::write(fds_[1], &c, 1));
+  }
+};
+
+uint64_t event_overflow_impl::late_instructions = 0;
+
+using overflow_manager = aser::fixed_work_manager<event<event_overflow_impl>>;
+
+pt::ptree fixed_work_properties(const std::string& on_budget) {
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"event\": \"dummy\","
+      "    \"instructions\": 1000000,"
+      "    \"fast_forward\": 1000,"
+      "    \"on_budget\": \"" + on_budget + "\","
+      "    \"benchmarks\": ["
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep1\""
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env true\","
+      "        \"name\": \"true\""
+      "      }"
+      "    ]"
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"simple\","
+      "    \"sampling_length\": 100"
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  return properties;
+}
+
+TEST(fixed_work_manager, waits_for_every_benchmark) {
+  // Dummy counters never overflow, so every benchmark runs to completion
+  // without retiring its budget.
+  manager exec_mgr(fixed_work_properties("continue"));
+
+  auto t0 = std::chrono::steady_clock::now();
+  exec_mgr.start();
+  EXPECT_GE(std::chrono::steady_clock::now() - t0, std::chrono::seconds(1));
+
+  auto& results = exec_mgr.results();
+  ASSERT_EQ(results.size(), 2);
+  for (auto& r : results) {
+    EXPECT_FALSE(r.completed);
+    EXPECT_DOUBLE_EQ(r.instructions, 0);
+  }
+}
+
+TEST(fixed_work_manager, retires_budget) {
+  // Late fast-forward notifications (shorter and longer than the
+  // fast-forward) must not change the length of the measurement.
+  for (auto late : {0, 100, 5000}) {
+    event_overflow_impl::late_instructions = late;
+    overflow_manager exec_mgr(fixed_work_properties("stop"));
+    exec_mgr.start();
+
+    auto& results = exec_mgr.results();
+    ASSERT_EQ(results.size(), 2);
+    for (auto& r : results) {
+      EXPECT_TRUE(r.completed);
+      EXPECT_DOUBLE_EQ(r.instructions, 1000000);
+    }
+  }
+}
+
+TEST(fixed_work_manager, invalid_budget_action) {
+  EXPECT_THROW(
+      manager exec_mgr(fixed_work_properties("foo")),
+      std::invalid_argument);
+}
+
+#endif
+
+} // namespace
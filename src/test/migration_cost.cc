@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <exec_monitor/migration_cost.h>
+
+using namespace aser;
+
+namespace {
+
+TEST(migration_cost, classify) {
+  // Two nodes with two cache domains each, two cores per cache domain and
+  // two SMT siblings per core (CPUs n and n + 8).
+  std::vector<util::cpu_info> cpus;
+  for (unsigned cpu = 0; cpu < 16; ++cpu) {
+    auto core = cpu % 8;
+    cpus.push_back({cpu, 0, core, core / 2, core / 4});
+  }
+  util::topology topo(cpus);
+
+  EXPECT_EQ(migration_distance::NONE, classify_migration(topo, 3, 3));
+  EXPECT_EQ(migration_distance::SMT, classify_migration(topo, 1, 9));
+  EXPECT_EQ(migration_distance::LLC, classify_migration(topo, 0, 9));
+  EXPECT_EQ(migration_distance::NODE, classify_migration(topo, 0, 2));
+  EXPECT_EQ(migration_distance::REMOTE, classify_migration(topo, 3, 12));
+  EXPECT_EQ("remote", to_string(migration_distance::REMOTE));
+}
+
+TEST(migration_cost, profile) {
+  migration_profile profile(2);
+  migration_counts before {1000, 2000, 10, 2};
+
+  profile.add(migration_distance::LLC, before, {
+    {1000, 1000, 20, 4},
+    {1000, 2000, 10, 2}
+  });
+  profile.add(migration_distance::LLC, before, {
+    {1000, 1500, 15, 3},
+    {0, 0, 0, 0}
+  });
+  // Migrations without counts before them are skipped.
+  profile.add(migration_distance::LLC, {0, 0, 0, 0}, {
+    {1000, 1000, 20, 4},
+    {1000, 1000, 20, 4}
+  });
+
+  auto curve = profile.curve(migration_distance::LLC);
+  ASSERT_EQ(2u, curve.size());
+  EXPECT_EQ(2u, curve[0].samples);
+  EXPECT_DOUBLE_EQ(0.625, curve[0].ipc_ratio);
+  EXPECT_DOUBLE_EQ(10, curve[0].l1d_mpki);
+  EXPECT_DOUBLE_EQ(2, curve[0].llc_mpki);
+  EXPECT_EQ(1u, curve[1].samples);
+  EXPECT_DOUBLE_EQ(1, curve[1].ipc_ratio);
+  EXPECT_DOUBLE_EQ(0, curve[1].l1d_mpki);
+
+  EXPECT_EQ(0u, profile.curve(migration_distance::SMT)[0].samples);
+}
+
+} // namespace
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <util/mpsc_queue.h>
+
+namespace {
+
+TEST(mpsc_queue, basic) {
+  aser::util::mpsc_queue<int> queue;
+  constexpr int count = 10;
+
+  for (int i = 0; i < count; i++)
+    queue.push(i);
+
+  for (int i = 0; i < count; i++)
+    EXPECT_EQ(queue.pop(), i);
+}
+
+TEST(mpsc_queue, capacity) {
+  aser::util::mpsc_queue<int> queue(5);
+  EXPECT_EQ(queue.capacity(), 8u);
+
+  for (int i = 0; i < 8; i++)
+    EXPECT_TRUE(queue.try_push(i));
+  EXPECT_FALSE(queue.try_push(8));
+
+  int value;
+  EXPECT_TRUE(queue.try_pop(value));
+  EXPECT_EQ(value, 0);
+  EXPECT_TRUE(queue.try_push(8));
+
+  for (int i = 1; i <= 8; i++) {
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(mpsc_queue, timeout) {
+  aser::util::mpsc_queue<int> queue;
+
+  auto res = queue.pop(std::chrono::milliseconds(100));
+  EXPECT_FALSE(res.first);
+
+  queue.push(1234);
+  res = queue.pop(std::chrono::seconds(1));
+  EXPECT_TRUE(res.first);
+  EXPECT_EQ(res.second, 1234);
+}
+
+TEST(mpsc_queue, pop_all) {
+  aser::util::mpsc_queue<int> queue;
+  constexpr int count = 10;
+
+  std::vector<int> values;
+  EXPECT_EQ(queue.pop_all(values), 0u);
+
+  for (int i = 0; i < count; i++)
+    queue.push(i);
+
+  EXPECT_EQ(queue.pop_all(values), static_cast<size_t>(count));
+  ASSERT_EQ(values.size(), static_cast<size_t>(count));
+  for (int i = 0; i < count; i++)
+    EXPECT_EQ(values[i], i);
+}
+
+TEST(mpsc_queue, multiple_producers) {
+  // A small queue makes producers wait for the consumer.
+  aser::util::mpsc_queue<std::pair<int, int>> queue(16);
+  constexpr int producers = 4;
+  constexpr int count = 10000;
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < count; i++)
+        queue.push({p, i});
+    });
+  }
+
+  // Values from each producer must arrive in order.
+  std::vector<int> next(producers, 0);
+  for (int i = 0; i < producers * count; i++) {
+    auto value = queue.pop();
+    EXPECT_EQ(value.second, next[value.first]);
+    next[value.first] = value.second + 1;
+  }
+
+  for (auto& t : threads)
+    t.join();
+
+  for (int p = 0; p < producers; p++)
+    EXPECT_EQ(next[p], count);
+}
+
+TEST(spsc_queue, mixed) {
+  aser::util::spsc_queue<int> queue(4);
+  constexpr int count = 10000;
+
+  std::thread producer([&] {
+    for (int i = 0; i < count; i++)
+      queue.push(i);
+  });
+
+  for (int i = 0; i < count; i++)
+    EXPECT_EQ(queue.pop(), i);
+
+  producer.join();
+}
+
+} // namespace
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <exec_manager/simple.h>
+
+using aser::simple_manager;
+namespace pt = boost::property_tree;
+
+namespace {
+
+TEST(mrc_monitor, basic) {
+  // Without a precise event, page faults are sampled.
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"benchmarks\": ["
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep\""
+      "      }"
+      "    ]"
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"mrc\","
+      "    \"sampling_length\": 100,"
+      "    \"mrc_bins\": 16"
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  simple_manager exec_mgr(properties);
+  exec_mgr.start();
+
+  properties.put("exec_monitor.mrc_decay", 2);
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+}
+
+} // namespace
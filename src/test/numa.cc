@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include <util/numa.h>
+
+namespace fs = boost::filesystem;
+using namespace aser::util;
+
+namespace {
+
+void write_file(const fs::path& path, const std::string& contents) {
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path.string());
+  out << contents << "\n";
+}
+
+TEST(numa, parse_cpu_list) {
+  EXPECT_EQ((std::vector<unsigned>{0}), parse_cpu_list("0"));
+  EXPECT_EQ((std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11}),
+      parse_cpu_list("0-3,8,10-11"));
+  EXPECT_TRUE(parse_cpu_list("").empty());
+  EXPECT_THROW(parse_cpu_list("3-1"), std::invalid_argument);
+}
+
+TEST(numa, nodes) {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  auto node_path = root / "devices" / "system" / "node";
+  write_file(node_path / "node0" / "cpulist", "0-1,4-5");
+  write_file(node_path / "node1" / "cpulist", "2-3,6-7");
+  // Memory-only nodes are skipped.
+  write_file(node_path / "node2" / "cpulist", "");
+  write_file(node_path / "possible", "0-2");
+
+  auto nodes = numa_nodes(root.string());
+  ASSERT_EQ(2u, nodes.size());
+  EXPECT_EQ((std::vector<unsigned>{0, 1, 4, 5}), nodes[0]);
+  EXPECT_EQ((std::vector<unsigned>{2, 3, 6, 7}), nodes[1]);
+
+  fs::remove_all(root);
+}
+
+TEST(numa, node_ids) {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  auto node_path = root / "devices" / "system" / "node";
+  write_file(node_path / "node0" / "cpulist", "0-1");
+  write_file(node_path / "node1" / "cpulist", "");
+  write_file(node_path / "node2" / "cpulist", "2-3");
+
+  EXPECT_EQ((std::vector<unsigned>{0, 2}), numa_node_ids(root.string()));
+
+  fs::remove_all(root);
+}
+
+TEST(numa, no_numa_information) {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  write_file(root / "devices" / "system" / "cpu" / "online", "0-3");
+
+  auto nodes = numa_nodes(root.string());
+  ASSERT_EQ(1u, nodes.size());
+  EXPECT_EQ((std::vector<unsigned>{0, 1, 2, 3}), nodes[0]);
+  EXPECT_EQ((std::vector<unsigned>{0}), numa_node_ids(root.string()));
+
+  fs::remove_all(root);
+}
+
+} // namespace
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <exec_manager/open_loop.h>
+
+using aser::open_loop_manager;
+using namespace std::literals::chrono_literals;
+namespace pt = boost::property_tree;
+
+namespace {
+
+pt::ptree open_loop_properties(
+    unsigned slots,
+    const std::string& arrivals) {
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"slots\": " + std::to_string(slots) + ","
+      "    \"benchmarks\": ["
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 0.2\","
+      "        \"name\": \"sleep\","
+      "        \"isolated_time\": 200"
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env true\","
+      "        \"name\": \"true\""
+      "      }"
+      "    ],"
+      "    \"arrivals\": " + arrivals +
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"simple\","
+      "    \"sampling_length\": 10"
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  return properties;
+}
+
+TEST(open_loop_manager, jobs_wait_for_a_free_slot) {
+  open_loop_manager exec_mgr(open_loop_properties(1,
+      "{"
+      "  \"type\": \"trace\","
+      "  \"jobs\": ["
+      "    { \"time\": 0, \"benchmark\": \"sleep\" },"
+      "    { \"time\": 50, \"benchmark\": \"sleep\" }"
+      "  ]"
+      "}"));
+  exec_mgr.start();
+
+  auto& records = exec_mgr.records();
+  ASSERT_EQ(records.size(), 2);
+  EXPECT_LT(records[0].queueing_delay(), 50ms);
+  EXPECT_GE(records[0].service_time(), 200ms);
+  EXPECT_GE(records[1].start, records[0].end);
+  EXPECT_GT(records[1].queueing_delay(), 100ms);
+  EXPECT_GT(exec_mgr.slowdown(records[1]), 1.5);
+}
+
+TEST(open_loop_manager, poisson_arrivals) {
+  open_loop_manager exec_mgr(open_loop_properties(4,
+      "{"
+      "  \"type\": \"poisson\","
+      "  \"rate\": 100,"
+      "  \"jobs\": 50,"
+      "  \"seed\": 1"
+      "}"));
+  exec_mgr.start();
+
+  auto& records = exec_mgr.records();
+  ASSERT_EQ(records.size(), 50);
+  for (size_t i = 1; i < records.size(); ++i)
+    EXPECT_GE(records[i].arrival, records[i - 1].arrival);
+  for (auto& r : records) {
+    EXPECT_GE(r.start, r.arrival);
+    EXPECT_GE(r.end, r.start);
+    EXPECT_GE(exec_mgr.slowdown(r), 1.0);
+  }
+}
+
+TEST(open_loop_manager, unknown_benchmark) {
+  EXPECT_THROW(
+      open_loop_manager exec_mgr(open_loop_properties(1,
+          "{"
+          "  \"type\": \"trace\","
+          "  \"jobs\": [ { \"time\": 0, \"benchmark\": \"foo\" } ]"
+          "}")),
+      std::invalid_argument);
+}
+
+TEST(open_loop_manager, no_benchmarks) {
+  auto properties = open_loop_properties(1,
+      "{"
+      "  \"type\": \"poisson\","
+      "  \"rate\": 100,"
+      "  \"jobs\": 1"
+      "}");
+  properties.put_child("exec_manager.benchmarks", pt::ptree());
+  EXPECT_THROW(
+      open_loop_manager exec_mgr(properties),
+      std::invalid_argument);
+}
+
+} // namespace
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
+#include <util/numa.h>
 #include <util/os.h>
 
 namespace {
@@ -22,5 +25,29 @@ TEST(pipe2_test, basic) {
   EXPECT_EQ(write_data, std::string(read_data));
 }
 
+#ifdef __linux__
+TEST(move_pages_test, query) {
+  using aser::util::move_pages;
+
+  auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  std::vector<char> data(4 * page_size, 1);
+  auto first = (reinterpret_cast<uintptr_t>(data.data()) + page_size - 1)
+    & ~(page_size - 1);
+  std::vector<uintptr_t> pages = {first, first + page_size};
+
+  // Touched pages are in a node with CPUs.
+  std::vector<int> status;
+  move_pages(0, pages, -1, status);
+  ASSERT_EQ(2u, status.size());
+  auto ids = aser::util::numa_node_ids();
+  for (auto node : status) {
+    EXPECT_NE(end(ids), std::find(begin(ids), end(ids), node));
+  }
+
+  move_pages(0, pages, status[0], status);
+  EXPECT_EQ(status[0], status[1]);
+}
+#endif
+
 } // namespace
 
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <util/page_hotness.h>
+
+using namespace aser::util;
+
+namespace {
+
+TEST(page_hotness, add) {
+  page_hotness hotness(4, 4096);
+  hotness.add(0x1000);
+  hotness.add(0x1fff);
+  hotness.add(0x2000);
+  // Address zero is never mapped.
+  hotness.add(0x10);
+
+  EXPECT_EQ(2u, hotness.size());
+  EXPECT_EQ(2u, hotness.count(0x1800));
+  EXPECT_EQ(1u, hotness.count(0x2000));
+  EXPECT_EQ(0u, hotness.count(0x3000));
+}
+
+TEST(page_hotness, decay) {
+  page_hotness hotness(4, 4096);
+  for (unsigned i = 0; i < 5; ++i)
+    hotness.add(0x1000);
+  hotness.add(0x2000);
+
+  hotness.decay();
+  EXPECT_EQ(1u, hotness.size());
+  EXPECT_EQ(2u, hotness.count(0x1000));
+  EXPECT_EQ(0u, hotness.count(0x2000));
+}
+
+TEST(page_hotness, bounded) {
+  page_hotness hotness(4, 4096);
+  for (unsigned i = 0; i < 3; ++i)
+    hotness.add(0x1000);
+  for (uintptr_t page = 2; page < 100; ++page)
+    hotness.add(page * 4096);
+
+  // Cold pages make room for new ones, but hot pages stay.
+  EXPECT_GE(4u, hotness.size());
+  EXPECT_EQ(3u, hotness.count(0x1000));
+  EXPECT_EQ(1u, hotness.count(99 * 4096));
+}
+
+TEST(page_hotness, hottest) {
+  page_hotness hotness(8, 4096);
+  for (uintptr_t page = 1; page <= 4; ++page) {
+    for (uintptr_t i = 0; i < page; ++i)
+      hotness.add(page * 4096);
+  }
+
+  std::vector<hot_page> pages;
+  hotness.hottest(2, pages);
+  ASSERT_EQ(2u, pages.size());
+  EXPECT_EQ(4u * 4096, pages[0].page);
+  EXPECT_EQ(4u, pages[0].count);
+  EXPECT_EQ(3u * 4096, pages[1].page);
+
+  hotness.hottest(10, pages);
+  EXPECT_EQ(4u, pages.size());
+}
+
+TEST(page_hotness, invalid) {
+  EXPECT_THROW(page_hotness(0), std::invalid_argument);
+  EXPECT_THROW(page_hotness(4, 1000), std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include <exec_monitor/page_migrator.h>
+
+using aser::page_migrator;
+using aser::util::page_hotness;
+
+namespace {
+
+/** Fake memory where every page is in a node. */
+class fake_memory {
+public:
+  std::map<uintptr_t, int> nodes;
+
+  void move(
+      pid_t pid,
+      const std::vector<uintptr_t>& pages,
+      int node,
+      std::vector<int>& status) {
+    status.clear();
+    for (auto page : pages) {
+      auto it = nodes.find(page);
+      if (it == end(nodes)) {
+        status.push_back(-EFAULT);
+        continue;
+      }
+      if (node >= 0)
+        it->second = node;
+      status.push_back(it->second);
+    }
+  }
+};
+
+class page_migrator_test : public ::testing::Test {
+protected:
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  fake_memory memory;
+
+  /** Page n is accessed n times on every step. */
+  page_migrator create_migrator(size_t batch_pages, double pages_per_second) {
+    for (uintptr_t n = 1; n <= 4; ++n)
+      memory.nodes[n * page_size] = 0;
+
+    auto size = page_size;
+    return page_migrator(
+        1,
+        {16, batch_pages, pages_per_second * page_size},
+        [size](page_hotness& hotness) {
+          for (uintptr_t n = 1; n <= 4; ++n) {
+            for (uintptr_t i = 0; i < n; ++i)
+              hotness.add(n * size);
+          }
+          return 10;
+        },
+        [this](pid_t pid, const std::vector<uintptr_t>& pages, int node,
+            std::vector<int>& status) {
+          memory.move(pid, pages, node, status);
+        });
+  }
+};
+
+TEST_F(page_migrator_test, no_target) {
+  auto migrator = create_migrator(4, 100);
+  migrator.step(std::chrono::seconds(1));
+
+  EXPECT_EQ(10u, migrator.stats().samples);
+  EXPECT_EQ(0u, migrator.stats().moved_pages);
+  EXPECT_EQ(0, migrator.stats().remote_ratio);
+}
+
+TEST_F(page_migrator_test, hottest_first) {
+  auto migrator = create_migrator(2, 100);
+  migrator.set_target(1);
+
+  // A batch of the hottest pages moves on every step.
+  migrator.step(std::chrono::seconds(1));
+  EXPECT_EQ(1, migrator.stats().remote_ratio);
+  EXPECT_EQ(2u, migrator.stats().moved_pages);
+  EXPECT_EQ(2 * page_size, migrator.stats().moved_bytes);
+  EXPECT_EQ(1, memory.nodes[4 * page_size]);
+  EXPECT_EQ(1, memory.nodes[3 * page_size]);
+  EXPECT_EQ(0, memory.nodes[2 * page_size]);
+
+  migrator.step(std::chrono::seconds(1));
+  EXPECT_LT(0, migrator.stats().remote_ratio);
+  EXPECT_GT(0.5, migrator.stats().remote_ratio);
+  EXPECT_EQ(4u, migrator.stats().moved_pages);
+
+  migrator.step(std::chrono::seconds(1));
+  EXPECT_EQ(0, migrator.stats().remote_ratio);
+  EXPECT_EQ(4u, migrator.stats().moved_pages);
+}
+
+TEST_F(page_migrator_test, rate_limit) {
+  // One page per second.
+  auto migrator = create_migrator(4, 1);
+  migrator.set_target(1);
+
+  migrator.step(std::chrono::milliseconds(500));
+  EXPECT_EQ(0u, migrator.stats().moved_pages);
+
+  migrator.step(std::chrono::milliseconds(500));
+  EXPECT_EQ(1u, migrator.stats().moved_pages);
+  EXPECT_EQ(1, memory.nodes[4 * page_size]);
+
+  // The budget does not grow beyond a batch.
+  migrator.step(std::chrono::seconds(100));
+  EXPECT_EQ(4u, migrator.stats().moved_pages);
+}
+
+} // namespace
@@ -151,6 +151,69 @@ TEST_F(event_N_reads_test, relative) {
   }
 }
 
+/** Event implementation that returns a fixed increment on every read. */
+class fake_event_impl {
+public:
+  using count_type = std::array<uint64_t, 3>;
+
+  void open(const event_info&, pid_t, bool) {}
+  void close() {}
+
+  count_type read() {
+    count_[0] += 1000;
+    count_[1] += 100;
+    count_[2] += 100;
+    return count_;
+  }
+
+private:
+  count_type count_ {{0, 0, 0}};
+};
+
+TEST(event_test, sample_windows) {
+  event_info info = {event_type::HARDWARE, 0, event_modifiers::EXCLUDE_NONE};
+  event<fake_event_impl> event{info};
+
+  auto before_open = sample_clock();
+  event.open(1000, true);
+
+  event.read();
+  auto first = event.scale(event_read_mode::RELATIVE);
+  EXPECT_GE(first.timestamp, before_open);
+  EXPECT_LE(first.window, first.timestamp - before_open);
+
+  event.read();
+  auto second = event.scale(event_read_mode::RELATIVE);
+  EXPECT_GE(second.timestamp, first.timestamp);
+  EXPECT_EQ(second.timestamp - first.timestamp, second.window);
+  EXPECT_DOUBLE_EQ(1000, second.value);
+
+  event.read();
+  auto aggregated = event.scale(event_read_mode::AGGREGATED);
+  EXPECT_EQ(first.window + second.window + (aggregated.timestamp
+        - second.timestamp), aggregated.window);
+  EXPECT_DOUBLE_EQ(3000, aggregated.value);
+}
+
+TEST(event_manager_test, snapshot) {
+  std::vector<event_info> events = {
+    {event_type::HARDWARE, 0, event_modifiers::EXCLUDE_NONE},
+    {event_type::HARDWARE, 1, event_modifiers::EXCLUDE_NONE}
+  };
+  event_manager<event<fake_event_impl>> manager(events, 1000, true);
+
+  manager.read();
+  auto before_scale = sample_clock();
+  auto& samples = manager.scale(event_read_mode::RELATIVE);
+
+  // Both events were read before scaling started.
+  ASSERT_EQ(2u, samples.size());
+  for (auto& s : samples) {
+    EXPECT_LE(s.timestamp, before_scale);
+    EXPECT_DOUBLE_EQ(1000, s.value);
+  }
+}
+
 class mock_event {
 public:
   mock_event(event_info info) {}
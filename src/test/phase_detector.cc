@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <exec_monitor/phase_detector.h>
+
+using aser::parse_phase_predictor;
+using aser::phase_detector;
+using aser::phase_predictor;
+
+namespace {
+
+phase_detector::config make_config(
+    phase_predictor predictor = phase_predictor::MARKOV,
+    unsigned min_run = 1,
+    unsigned max_phases = 4) {
+  return {max_phases, 0.15, 0.5, 8, min_run, predictor, 16};
+}
+
+phase_detector::signature counters(double cpi, double mpki) {
+  return {{cpi, mpki}, {}};
+}
+
+TEST(phase_detector, parse_phase_predictor) {
+  EXPECT_EQ(phase_predictor::MARKOV, parse_phase_predictor("markov"));
+  EXPECT_EQ(phase_predictor::RUN_LENGTH, parse_phase_predictor("run-length"));
+  EXPECT_THROW(parse_phase_predictor("last-value"), std::invalid_argument);
+}
+
+TEST(phase_detector, invalid) {
+  auto c = make_config();
+  c.max_phases = 1;
+  EXPECT_THROW(phase_detector{c}, std::invalid_argument);
+  c = make_config();
+  c.histogram_weight = 2;
+  EXPECT_THROW(phase_detector{c}, std::invalid_argument);
+  c = make_config();
+  c.min_run = 0;
+  EXPECT_THROW(phase_detector{c}, std::invalid_argument);
+
+  phase_detector detector(make_config());
+  detector.classify(counters(1, 2));
+  EXPECT_THROW(detector.classify({{1}, {}}), std::invalid_argument);
+}
+
+TEST(phase_detector, distance) {
+  auto w = 0.5;
+  EXPECT_DOUBLE_EQ(0, phase_detector::distance(
+        counters(2, 10), counters(2, 10), w));
+  // Relative differences, except below one.
+  EXPECT_DOUBLE_EQ(0.25, phase_detector::distance(
+        counters(2, 10), counters(2, 5), w));
+  EXPECT_DOUBLE_EQ(0.05, phase_detector::distance(
+        counters(2, 0.1), counters(2, 0.2), w));
+
+  // Histograms are normalized.
+  phase_detector::signature a{{}, {1, 1, 0, 0}};
+  phase_detector::signature b{{}, {2, 2, 0, 0}};
+  phase_detector::signature c{{}, {0, 0, 3, 3}};
+  EXPECT_DOUBLE_EQ(0, phase_detector::distance(a, b, w));
+  EXPECT_DOUBLE_EQ(1, phase_detector::distance(a, c, w));
+
+  a.counters = {2, 10};
+  c.counters = {2, 5};
+  EXPECT_DOUBLE_EQ(0.625, phase_detector::distance(a, c, w));
+}
+
+TEST(phase_detector, clusters) {
+  phase_detector detector(make_config());
+  EXPECT_EQ(phase_detector::none, detector.phase());
+  EXPECT_EQ(phase_detector::none, detector.predict());
+
+  auto a = detector.classify(counters(1, 10));
+  EXPECT_EQ(a, detector.classify(counters(1.05, 10.5)));
+  auto b = detector.classify(counters(3, 40));
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, detector.previous());
+  EXPECT_EQ(a, detector.classify(counters(1, 10)));
+  EXPECT_EQ(b, detector.previous());
+  EXPECT_EQ(2u, detector.size());
+}
+
+TEST(phase_detector, bounded_table) {
+  phase_detector detector(make_config(phase_predictor::MARKOV, 1, 2));
+  auto a = detector.classify(counters(1, 10));
+  auto b = detector.classify(counters(3, 40));
+  detector.classify(counters(1, 10));
+
+  // The least recently seen phase is replaced, and identifiers are not
+  // reused.
+  auto c = detector.classify(counters(8, 100));
+  EXPECT_NE(a, c);
+  EXPECT_NE(b, c);
+  EXPECT_EQ(2u, detector.size());
+  EXPECT_EQ(a, detector.classify(counters(1, 10)));
+  auto d = detector.classify(counters(3, 40));
+  EXPECT_NE(b, d);
+}
+
+TEST(phase_detector, transients) {
+  phase_detector detector(make_config(phase_predictor::MARKOV, 2));
+  auto a = detector.classify(counters(1, 10));
+  EXPECT_EQ(a, detector.classify(counters(3, 40)));
+  EXPECT_EQ(a, detector.classify(counters(1, 10)));
+
+  EXPECT_EQ(a, detector.classify(counters(3, 40)));
+  auto b = detector.classify(counters(3, 40));
+  EXPECT_NE(a, b);
+  EXPECT_EQ(2u, detector.run_length());
+}
+
+/** Runs a pattern of three intervals in a phase and two in another, and
+ * returns the fraction of the intervals predicted correctly. */
+double predict_pattern(phase_predictor predictor) {
+  phase_detector detector(make_config(predictor));
+  std::vector<phase_detector::signature> pattern = {
+    counters(1, 10), counters(1, 10), counters(1, 10),
+    counters(3, 40), counters(3, 40)
+  };
+
+  unsigned correct = 0;
+  unsigned total = 0;
+  unsigned predicted = phase_detector::none;
+  for (unsigned i = 0; i < 100; ++i) {
+    auto phase = detector.classify(pattern[i % pattern.size()]);
+    if (i >= 50) {
+      correct += phase == predicted;
+      ++total;
+    }
+    predicted = detector.predict();
+  }
+  return static_cast<double>(correct) / total;
+}
+
+TEST(phase_detector, predictors) {
+  // Markov predicts staying in the phase, so it misses every change.
+  EXPECT_DOUBLE_EQ(0.6, predict_pattern(phase_predictor::MARKOV));
+  EXPECT_DOUBLE_EQ(1, predict_pattern(phase_predictor::RUN_LENGTH));
+}
+
+TEST(phase_detector, markov) {
+  // A short phase that is always followed by another one.
+  phase_detector detector(make_config());
+  std::vector<phase_detector::signature> pattern = {
+    counters(1, 10), counters(3, 40), counters(8, 100)
+  };
+  for (unsigned i = 0; i < 30; ++i)
+    detector.classify(pattern[i % pattern.size()]);
+
+  auto a = detector.classify(pattern[0]);
+  auto b = detector.predict();
+  EXPECT_NE(a, b);
+  EXPECT_EQ(b, detector.classify(pattern[1]));
+}
+
+} // namespace
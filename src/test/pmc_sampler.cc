@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <core/exec_monitor.h>
+#include <exec_manager/simple.h>
+#include <exec_monitor/pmc_sampler.h>
+#include <perf/event_dummy.h>
+#include <perf/event_manager.h>
+#include <perf/scale.h>
+#include <util/alloc_tracker.h>
+#include <util/proc.h>
+
+using aser::simple_manager;
+using namespace aser::perf;
+namespace pt = boost::property_tree;
+
+using dummy_sampler = aser::pmc_sampler<event_manager<event<event_dummy_impl>>>;
+
+namespace {
+
+pt::ptree create_properties(unsigned collection_threads) {
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"benchmarks\": ["
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep1\""
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 0.5\","
+      "        \"name\": \"sleep05\""
+      "      }"
+      "    ]"
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"pmc-sampler[dummy]\","
+      "    \"event\": \"dummy\","
+      "    \"sampling_length\": 10"
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  properties.put("exec_monitor.collection_threads", collection_threads);
+  return properties;
+}
+
+/** Result of watching a sampler while it runs. */
+struct observation {
+  /** Whether metrics were published for any benchmark process. */
+  bool published;
+
+  /** Largest number of shards used in a collection. */
+  unsigned shards;
+
+  /** Largest number of events scaled with vector instructions in a
+   * collection. */
+  size_t vectorized;
+};
+
+/** Runs a manager, watching the sampler while the benchmarks run. */
+observation run_and_observe(simple_manager& exec_mgr) {
+  auto& monitor = exec_mgr.monitor();
+  auto& sampler = dynamic_cast<const dummy_sampler&>(monitor);
+  std::thread runner([&] { exec_mgr.start(); });
+
+  // Metrics are released once the processes finish, so they are checked
+  // while the shortest benchmark runs.
+  observation o { false, 0, 0 };
+  auto deadline = std::chrono::steady_clock::now()
+    + std::chrono::milliseconds(400);
+  while (std::chrono::steady_clock::now() < deadline
+      && (!o.published || o.shards < 2)) {
+    for (auto pid : aser::util::children(getpid())) {
+      aser::process_metrics metrics;
+      o.published |= monitor.metrics(pid, metrics);
+    }
+    auto stats = sampler.last_collection();
+    o.shards = std::max(o.shards, stats.shards);
+    o.vectorized = std::max(o.vectorized, stats.vectorized);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  runner.join();
+  return o;
+}
+
+TEST(pmc_sampler, serial_collection) {
+  simple_manager exec_mgr(create_properties(0));
+  auto o = run_and_observe(exec_mgr);
+  EXPECT_TRUE(o.published);
+  EXPECT_EQ(1u, o.shards);
+}
+
+TEST(pmc_sampler, vectorized_scaling) {
+  // The events of every application in a shard are scaled in a single
+  // batch, so three applications fill a vector of eight events.
+  auto properties = create_properties(0);
+  pt::ptree benchmark;
+  benchmark.put("cmd", "/usr/bin/env sleep 0.5");
+  benchmark.put("name", "sleep05");
+  properties.get_child("exec_manager.benchmarks").push_back({"", benchmark});
+  simple_manager exec_mgr(properties);
+  auto o = run_and_observe(exec_mgr);
+  EXPECT_TRUE(o.published);
+  if (best_scale_isa() != scale_isa::SCALAR) {
+    EXPECT_GT(o.vectorized, 0u);
+  }
+}
+
+TEST(pmc_sampler, sharded_collection) {
+  simple_manager exec_mgr(create_properties(3));
+  auto o = run_and_observe(exec_mgr);
+  EXPECT_TRUE(o.published);
+  EXPECT_EQ(2u, o.shards);
+}
+
+TEST(pmc_sampler, allocation_free_sampling) {
+  auto properties = create_properties(0);
+  properties.put("exec_monitor.warmup_ticks", 5);
+  simple_manager exec_mgr(properties);
+  exec_mgr.start();
+
+  auto stats = exec_mgr.monitor().stats();
+  EXPECT_GT(stats.ticks, 5u);
+  if (aser::util::allocation_tracking_enabled()) {
+    EXPECT_EQ(0u, stats.steady_allocations);
+  }
+}
+
+} // namespace
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include <util/power.h>
+
+namespace fs = boost::filesystem;
+using namespace aser::util;
+
+namespace {
+
+void write_file(const fs::path& path, const std::string& contents) {
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path.string());
+  out << contents << "\n";
+}
+
+std::string read_file(const fs::path& path) {
+  std::ifstream in(path.string());
+  std::string line;
+  std::getline(in, line);
+  return line;
+}
+
+TEST(power, cpu_frequencies) {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  auto cpu_path = root / "devices" / "system" / "cpu";
+  write_file(cpu_path / "cpu0" / "cpufreq" / "scaling_available_frequencies",
+      "2400000 1800000 1200000 ");
+  write_file(cpu_path / "cpu1" / "cpufreq" / "cpuinfo_min_freq", "800000");
+  write_file(cpu_path / "cpu1" / "cpufreq" / "cpuinfo_max_freq", "3000000");
+
+  EXPECT_EQ((std::vector<unsigned>{1200000, 1800000, 2400000}),
+      cpu_frequencies(root.string(), 0));
+  EXPECT_EQ((std::vector<unsigned>{800000, 3000000}),
+      cpu_frequencies(root.string(), 1));
+  EXPECT_TRUE(cpu_frequencies(root.string(), 2).empty());
+
+  EXPECT_EQ(0u, max_frequency(root.string(), 1));
+  set_max_frequency(root.string(), 1, 1500000);
+  EXPECT_EQ("1500000",
+      read_file(cpu_path / "cpu1" / "cpufreq" / "scaling_max_freq"));
+  EXPECT_EQ(1500000u, max_frequency(root.string(), 1));
+  EXPECT_THROW(set_max_frequency(root.string(), 2, 1500000),
+      std::runtime_error);
+  fs::remove_all(root);
+}
+
+TEST(power, package_energy) {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  EXPECT_GT(0, package_energy(root.string()));
+
+  auto powercap = root / "class" / "powercap";
+  write_file(powercap / "intel-rapl:0" / "energy_uj", "1500000");
+  write_file(powercap / "intel-rapl:0:0" / "energy_uj", "1000000");
+  write_file(powercap / "intel-rapl:1" / "energy_uj", "500000");
+  EXPECT_DOUBLE_EQ(2, package_energy(root.string()));
+  fs::remove_all(root);
+}
+
+} // namespace
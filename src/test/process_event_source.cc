@@ -0,0 +1,79 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <core/process_event_source.h>
+#include <util/process.h>
+
+namespace {
+
+TEST(process_event_source, descendants) {
+  using namespace std::chrono_literals;
+  using aser::exec_event;
+  using event_type = exec_event::event_type;
+  using aser::util::sync_process;
+
+  std::vector<exec_event> events;
+  std::mutex mutex;
+  aser::process_event_source source([&](const exec_event& e) {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push_back(e);
+  });
+  source.start();
+
+  // An unrelated process, whose events must be discarded.
+  sync_process other("/bin/true");
+  other.prepare();
+  other.start();
+
+  sync_process p("/bin/bash", "-c", "/bin/sleep 0.1 & wait");
+  p.prepare();
+  source.track(p.pid());
+  p.start();
+  p.wait();
+  other.wait();
+
+  // Events are delivered asynchronously.
+  std::this_thread::sleep_for(200ms);
+  source.stop();
+
+  auto find = [&](event_type type, pid_t pid) {
+    return std::find_if(begin(events), end(events),
+        [&](const exec_event& e) { return e.type == type && e.pid == pid; });
+  };
+
+  for (auto& e : events)
+    EXPECT_EQ(p.pid(), e.root);
+
+  // The shell runs (exec) and forks the child, which runs sleep (exec).
+  auto fork = std::find_if(begin(events), end(events),
+      [](const exec_event& e) {
+        return e.type == event_type::PROCESS_FORKED;
+      });
+  ASSERT_NE(end(events), fork);
+  EXPECT_EQ(p.pid(), fork->payload.fork.parent);
+  auto child = fork->pid;
+
+  EXPECT_NE(end(events), find(event_type::PROCESS_EXEC, p.pid()));
+  EXPECT_NE(end(events), find(event_type::PROCESS_EXEC, child));
+  EXPECT_LT(fork, find(event_type::PROCESS_EXEC, child));
+
+  auto exit = find(event_type::PROCESS_EXITED, child);
+  ASSERT_NE(end(events), exit);
+  EXPECT_TRUE(WIFEXITED(exit->payload.exit.status));
+  EXPECT_EQ(0, WEXITSTATUS(exit->payload.exit.status));
+  EXPECT_FALSE(exit->payload.exit.has_usage);
+  // The termination of the benchmark process is reported by the manager.
+  EXPECT_EQ(end(events), find(event_type::PROCESS_EXITED, p.pid()));
+
+  EXPECT_EQ(0u, source.size());
+}
+
+} // namespace
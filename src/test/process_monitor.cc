@@ -31,10 +31,12 @@ TEST(process_monitor, basic) {
   p2->prepare();
   pm.add_process(p1);
   pm.add_process(p2);
+  // The processes must not finish earlier than one and two seconds after
+  // t0, so it is taken before starting them.
+  auto t0 = chrono::system_clock::now();
   p1->start();
   p2->start();
 
-  auto t0 = chrono::system_clock::now();
   auto res = pm.wait_for_any();
   auto t = chrono::system_clock::now();
   EXPECT_EQ(res.first, p1->pid());
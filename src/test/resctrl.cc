@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <fstream>
+#include <system_error>
+
+#include <boost/filesystem.hpp>
+
+#include <util/resctrl.h>
+
+namespace fs = boost::filesystem;
+using namespace aser::util;
+
+namespace {
+
+void write_file(const fs::path& path, const std::string& contents) {
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path.string());
+  out << contents << "\n";
+}
+
+std::string read_file(const fs::path& path) {
+  std::ifstream in(path.string());
+  std::string line;
+  std::getline(in, line);
+  return line;
+}
+
+/** Creates a fake resctrl filesystem with a 20-way cache per socket on two
+ * sockets, and memory bandwidth throttling. */
+fs::path create_resctrl() {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  write_file(root / "info" / "L3" / "cbm_mask", "fffff");
+  write_file(root / "info" / "L3" / "min_cbm_bits", "2");
+  write_file(root / "info" / "MB" / "min_bandwidth", "10");
+  write_file(root / "info" / "MB" / "bandwidth_gran", "10");
+  write_file(root / "schemata", "    L3:0=fffff;1=fffff\n    MB:0=100;1=100");
+  return root;
+}
+
+TEST(resctrl, read_l3_allocation_info) {
+  auto root = create_resctrl();
+  auto info = read_l3_allocation_info(root.string());
+  EXPECT_EQ(20u, info.ways);
+  EXPECT_EQ(2u, info.min_ways);
+  EXPECT_EQ((std::vector<unsigned>{0, 1}), info.domains);
+  fs::remove_all(root);
+
+  EXPECT_THROW(read_l3_allocation_info(root.string()), std::runtime_error);
+}
+
+TEST(resctrl, read_mb_allocation_info) {
+  auto root = create_resctrl();
+  auto info = read_mb_allocation_info(root.string());
+  EXPECT_EQ(10u, info.min_bandwidth);
+  EXPECT_EQ(10u, info.granularity);
+  EXPECT_EQ((std::vector<unsigned>{0, 1}), info.domains);
+
+  fs::remove(root / "info" / "MB" / "min_bandwidth");
+  EXPECT_THROW(read_mb_allocation_info(root.string()), std::runtime_error);
+  fs::remove_all(root);
+}
+
+TEST(resctrl, group) {
+  auto root = create_resctrl();
+  auto group = (root / "group").string();
+  create_resctrl_group(group);
+  EXPECT_TRUE(fs::is_directory(group));
+
+  add_to_resctrl_group(group, ::getpid());
+  EXPECT_EQ(std::to_string(::getpid()), read_file(fs::path(group) / "tasks"));
+
+  set_l3_ways(group, {0, 1}, 4, 2);
+  EXPECT_EQ("L3:0=30;1=30", read_file(fs::path(group) / "schemata"));
+  EXPECT_THROW(set_l3_ways(group, {0}, 4, 0), std::invalid_argument);
+
+  set_mb_throttle(group, {0, 1}, 50);
+  EXPECT_EQ("MB:0=50;1=50", read_file(fs::path(group) / "schemata"));
+  EXPECT_THROW(set_mb_throttle(group, {0}, 101), std::invalid_argument);
+
+  fs::remove_all(group);
+  EXPECT_THROW(remove_resctrl_group(group), std::system_error);
+  fs::create_directory(fs::path(group));
+  remove_resctrl_group(group);
+  EXPECT_FALSE(fs::exists(group));
+  fs::remove_all(root);
+}
+
+} // namespace
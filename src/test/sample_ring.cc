@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <util/sample_ring.h>
+
+using aser::util::sample_ring;
+
+namespace {
+
+TEST(sample_ring, wraps_around) {
+  sample_ring ring(2, 4);
+  EXPECT_TRUE(ring.empty());
+
+  for (int i = 0; i < 6; ++i)
+    ring.push(i, {static_cast<double>(i), static_cast<double>(-i)});
+
+  EXPECT_EQ(4u, ring.size());
+  EXPECT_EQ(4u, ring.capacity());
+  for (size_t age = 0; age < ring.size(); ++age) {
+    EXPECT_DOUBLE_EQ(5.0 - age, ring.value(0, age));
+    EXPECT_DOUBLE_EQ(age - 5.0, ring.value(1, age));
+    EXPECT_DOUBLE_EQ(5.0 - age, ring.time(age));
+  }
+}
+
+TEST(sample_ring, stats) {
+  sample_ring ring(1, 8);
+  EXPECT_EQ(0u, ring.stats(0, 4).count);
+
+  for (double v : {100.0, 2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0})
+    ring.push(0, {v});
+
+  // The first value was overwritten.
+  auto all = ring.stats(0, 100);
+  EXPECT_EQ(8u, all.count);
+  EXPECT_DOUBLE_EQ(2, all.min);
+  EXPECT_DOUBLE_EQ(9, all.max);
+  EXPECT_DOUBLE_EQ(5, all.mean);
+  EXPECT_DOUBLE_EQ(4, all.variance);
+
+  auto last = ring.stats(0, 2);
+  EXPECT_EQ(2u, last.count);
+  EXPECT_DOUBLE_EQ(7, last.min);
+  EXPECT_DOUBLE_EQ(9, last.max);
+  EXPECT_DOUBLE_EQ(8, last.mean);
+  EXPECT_DOUBLE_EQ(1, last.variance);
+}
+
+TEST(sample_ring, slope) {
+  sample_ring ring(1, 16);
+  ring.push(0, {1});
+  EXPECT_DOUBLE_EQ(0, ring.slope(0, 10));
+
+  for (int i = 1; i < 20; ++i)
+    ring.push(1000 + 0.5 * i, {3.0 * i});
+  EXPECT_NEAR(6, ring.slope(0, 10), 1e-9);
+  EXPECT_NEAR(6, ring.slope(0, 100), 1e-9);
+}
+
+TEST(sample_ring, ewma) {
+  sample_ring ring(1, 2, 0.5);
+  ring.push(0, {8});
+  EXPECT_DOUBLE_EQ(8, ring.ewma(0));
+  ring.push(1, {0});
+  ring.push(2, {0});
+  // The average covers samples that are no longer kept.
+  EXPECT_DOUBLE_EQ(2, ring.ewma(0));
+}
+
+TEST(sample_ring, invalid_arguments) {
+  EXPECT_THROW(sample_ring(1, 0), std::invalid_argument);
+  EXPECT_THROW(sample_ring(1, 4, 0), std::invalid_argument);
+}
+
+} // namespace
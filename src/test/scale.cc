@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <perf/event.h>
+#include <perf/event_manager.h>
+#include <perf/scale.h>
+
+using namespace aser::perf;
+
+namespace {
+
+const std::vector<scale_isa> all_isas = {
+  scale_isa::SCALAR, scale_isa::AVX2, scale_isa::AVX512
+};
+
+/** Event implementation that returns counts from a script. */
+class scripted_event_impl {
+public:
+  using count_type = std::array<uint64_t, 3>;
+
+  explicit scripted_event_impl(std::vector<count_type> script = {})
+    : script_(std::move(script))
+  {}
+
+  void open(const event_info&, pid_t, bool) {}
+  void close() {}
+
+  count_type read() {
+    return script_.at(next_++);
+  }
+
+private:
+  std::vector<count_type> script_;
+  size_t next_ { 0 };
+};
+
+using scripted_event = event<scripted_event_impl>;
+
+bool same_bits(double a, double b) {
+  return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+/** Generates increasing counts, including values that doubles cannot
+ * represent exactly and events that did not run. */
+std::vector<std::vector<scripted_event_impl::count_type>> generate_scripts(
+    size_t num_events, size_t num_reads, unsigned seed) {
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<uint64_t> step(0, 1ULL << 40);
+  std::uniform_int_distribution<uint64_t> start(0, ~0ULL >> 2);
+  std::uniform_int_distribution<int> kind(0, 9);
+
+  std::vector<std::vector<scripted_event_impl::count_type>> scripts(
+      num_events);
+  for (auto& script : scripts) {
+    scripted_event_impl::count_type count = {0, 0, 0};
+    for (size_t r = 0; r < num_reads; ++r) {
+      auto k = kind(gen);
+      auto enabled = step(gen) + 1;
+      // Some events do not run (or run all the time) within a read.
+      auto running = k == 1 ? 0 : k == 2 ? enabled : enabled / (k + 1);
+      // Counts cannot change until the event runs for the first time.
+      if (count[2] == 0 && running > 0)
+        count[0] = start(gen);
+      if (count[2] + running > 0)
+        count[0] += step(gen) * (k == 3 ? 1ULL << 20 : 1);
+      count[1] += enabled;
+      count[2] += running;
+      script.push_back(count);
+    }
+  }
+  return scripts;
+}
+
+void check_isa_matches_events(scale_isa isa, event_read_mode mode) {
+  if (!scale_isa_supported(isa))
+    return;
+
+  constexpr size_t num_events = 37;
+  constexpr size_t num_reads = 8;
+  auto scripts = generate_scripts(num_events, num_reads, 42);
+
+  event_info info = {event_type::HARDWARE, 0, event_modifiers::EXCLUDE_NONE};
+  std::vector<scripted_event> events;
+  for (auto& script : scripts) {
+    events.emplace_back(info, scripted_event_impl(script));
+    events.back().open(0, true);
+  }
+
+  count_buffer current(num_events);
+  count_buffer previous(num_events);
+  sample_buffer samples(num_events);
+  for (size_t r = 0; r < num_reads; ++r) {
+    for (size_t i = 0; i < num_events; ++i) {
+      events[i].read();
+      current.value[i] = events[i].counts()[0];
+      current.enabled[i] = events[i].counts()[1];
+      current.running[i] = events[i].counts()[2];
+    }
+
+    auto result = scale_counts(current, previous, mode, samples, isa);
+    ASSERT_EQ(num_events, result.count);
+    ASSERT_EQ(scale_error::NONE, result.error);
+
+    for (size_t i = 0; i < num_events; ++i) {
+      auto expected = events[i].scale(mode);
+      EXPECT_TRUE(same_bits(expected.value, samples.value[i]))
+        << "event: " << i << ", read: " << r;
+      EXPECT_TRUE(same_bits(expected.scaling, samples.scaling[i]))
+        << "event: " << i << ", read: " << r;
+      EXPECT_EQ(expected.enabled, static_cast<bool>(samples.enabled[i]));
+    }
+  }
+}
+
+TEST(scale_counts, relative_matches_events) {
+  for (auto isa : all_isas)
+    check_isa_matches_events(isa, event_read_mode::RELATIVE);
+}
+
+TEST(scale_counts, aggregated_matches_events) {
+  for (auto isa : all_isas)
+    check_isa_matches_events(isa, event_read_mode::AGGREGATED);
+}
+
+TEST(scale_counts, conversion_is_exact) {
+  // Values close to 2^64 and values with more than 53 significant bits are
+  // rounded as a scalar conversion does.
+  std::vector<uint64_t> values = {
+    ~0ULL, ~0ULL - 1, (1ULL << 53) + 1, (1ULL << 63) + 1025,
+    (1ULL << 60) + 3, 12345678901234567ULL, 1, 0
+  };
+
+  for (auto isa : all_isas) {
+    if (!scale_isa_supported(isa))
+      continue;
+
+    count_buffer current(values.size());
+    count_buffer previous(values.size());
+    sample_buffer samples(values.size());
+    current.value = values;
+    for (size_t i = 0; i < values.size(); ++i)
+      current.enabled[i] = current.running[i] = 7;
+
+    scale_counts(current, previous, event_read_mode::AGGREGATED, samples, isa);
+    for (size_t i = 0; i < values.size(); ++i) {
+      EXPECT_TRUE(same_bits(static_cast<double>(values[i]), samples.value[i]))
+        << "value: " << values[i];
+    }
+  }
+}
+
+TEST(scale_counts, stops_at_first_error) {
+  for (auto isa : all_isas) {
+    if (!scale_isa_supported(isa))
+      continue;
+
+    for (size_t bad = 0; bad < 20; ++bad) {
+      count_buffer current(20);
+      count_buffer previous(20);
+      sample_buffer samples(20);
+      for (size_t i = 0; i < 20; ++i) {
+        current.value[i] = 100;
+        current.enabled[i] = 10;
+        current.running[i] = 5;
+      }
+      // The event after the bad one has an error of a different kind.
+      current.running[bad] = 11;
+      if (bad + 1 < 20)
+        current.running[bad + 1] = 0;
+
+      auto result = scale_counts(
+          current, previous, event_read_mode::RELATIVE, samples, isa);
+      EXPECT_EQ(bad, result.count);
+      EXPECT_EQ(scale_error::RUNNING_EXCEEDS_ENABLED, result.error);
+      for (size_t i = 0; i < 20; ++i) {
+        EXPECT_EQ(i < bad ? 100u : 0u, previous.value[i]);
+        EXPECT_EQ(i < bad ? 200.0 : 0.0, samples.value[i]);
+      }
+
+      // Not running while the value changes.
+      current.running[bad] = 0;
+      result = scale_counts(
+          current, previous, event_read_mode::RELATIVE, samples, isa);
+      EXPECT_EQ(bad, result.count);
+      EXPECT_EQ(scale_error::UNEXPECTED_VALUE, result.error);
+    }
+  }
+}
+
+TEST(scale_counts, errors_match_events) {
+  EXPECT_THROW(
+      throw_scale_error(scale_error::RUNNING_EXCEEDS_ENABLED),
+      std::runtime_error);
+  EXPECT_THROW(
+      throw_scale_error(scale_error::UNEXPECTED_VALUE),
+      std::runtime_error);
+}
+
+TEST(scale_counts, vectorized) {
+  // Vector kernels only process whole vectors.
+  for (size_t n : {3, 9}) {
+    count_buffer current(n);
+    for (size_t i = 0; i < n; ++i) {
+      current.value[i] = 100 + i;
+      current.enabled[i] = 10;
+      current.running[i] = 5;
+    }
+    for (auto isa : all_isas) {
+      if (!scale_isa_supported(isa))
+        continue;
+      count_buffer previous(n);
+      sample_buffer samples(n);
+      auto result = scale_counts(
+          current, previous, event_read_mode::RELATIVE, samples, isa);
+      size_t lanes = isa == scale_isa::AVX512 ? 8
+        : isa == scale_isa::AVX2 ? 4 : n + 1;
+      EXPECT_EQ(n, result.count);
+      EXPECT_EQ(n / lanes * lanes, result.vectorized);
+    }
+  }
+}
+
+TEST(event_manager, scale_batched) {
+  auto scripts = generate_scripts(2, 5, 7);
+  std::vector<event_info> infos = {
+    {event_type::HARDWARE, 0, event_modifiers::EXCLUDE_NONE},
+    {event_type::HARDWARE, 1, event_modifiers::EXCLUDE_NONE}
+  };
+
+  auto factory = [&](const event_info& info) {
+    return scripted_event(info, scripted_event_impl(scripts[info.code]));
+  };
+  event_manager<scripted_event> scalar(infos, 0, true, factory);
+  event_manager<scripted_event> batched(infos, 0, true, factory);
+
+  for (int r = 0; r < 5; ++r) {
+    auto expected = scalar.read_events(event_read_mode::RELATIVE);
+    batched.read();
+    auto& samples = batched.scale_batched(event_read_mode::RELATIVE);
+    ASSERT_EQ(expected.size(), samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+      EXPECT_TRUE(same_bits(expected[i].value, samples[i].value));
+      EXPECT_TRUE(same_bits(expected[i].scaling, samples[i].scaling));
+      EXPECT_EQ(expected[i].enabled, samples[i].enabled);
+      EXPECT_GT(samples[i].window, 0u);
+    }
+  }
+}
+
+TEST(event_manager, gather_scatter) {
+  // The events of two managers scaled in a single batch give the same
+  // samples as scaling every manager on its own.
+  auto scripts = generate_scripts(6, 5, 11);
+  std::vector<std::vector<event_info>> infos(2);
+  for (unsigned code = 0; code < scripts.size(); ++code) {
+    infos[code / 3].push_back(
+        {event_type::HARDWARE, code, event_modifiers::EXCLUDE_NONE});
+  }
+
+  auto factory = [&](const event_info& info) {
+    return scripted_event(info, scripted_event_impl(scripts[info.code]));
+  };
+  std::vector<event_manager<scripted_event>> separate;
+  std::vector<event_manager<scripted_event>> batched;
+  for (auto& i : infos) {
+    separate.emplace_back(i, 0, true, factory);
+    batched.emplace_back(i, 0, true, factory);
+  }
+
+  count_buffer current(scripts.size());
+  count_buffer previous(scripts.size());
+  sample_buffer samples(scripts.size());
+  for (int r = 0; r < 5; ++r) {
+    for (size_t m = 0; m < 2; ++m) {
+      batched[m].read();
+      batched[m].gather(current, previous, m * 3);
+    }
+    auto result = scale_counts(
+        current, previous, event_read_mode::RELATIVE, samples);
+    ASSERT_EQ(scripts.size(), result.count);
+
+    for (size_t m = 0; m < 2; ++m) {
+      separate[m].read();
+      auto expected = separate[m].scale_batched(event_read_mode::RELATIVE);
+      auto& actual = batched[m].scatter(
+          previous, samples, m * 3, result.count, event_read_mode::RELATIVE);
+      for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_TRUE(same_bits(expected[i].value, actual[i].value));
+        EXPECT_TRUE(same_bits(expected[i].scaling, actual[i].scaling));
+        EXPECT_EQ(expected[i].enabled, actual[i].enabled);
+      }
+    }
+  }
+}
+
+TEST(event_manager, scale_batched_error) {
+  std::vector<event_info> infos = {
+    {event_type::HARDWARE, 0, event_modifiers::EXCLUDE_NONE}
+  };
+  std::vector<scripted_event_impl::count_type> script = {{{10, 5, 6}}};
+  auto factory = [&](const event_info& info) {
+    return scripted_event(info, scripted_event_impl(script));
+  };
+  event_manager<scripted_event> manager(infos, 0, true, factory);
+  manager.read();
+  EXPECT_THROW(
+      manager.scale_batched(event_read_mode::RELATIVE),
+      std::runtime_error);
+}
+
+} // namespace
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <exec_monitor/search_objective.h>
+#include <util/factory.h>
+
+using aser::search_objective;
+namespace pt = boost::property_tree;
+
+namespace {
+
+std::unique_ptr<search_objective> create(
+    const std::string& type,
+    const pt::ptree& properties = pt::ptree()) {
+  return aser::util::create<search_objective>(type, properties);
+}
+
+TEST(search_objective, evaluate) {
+  search_objective::sample s{{1, 3}, {2, 4}, 4e9, 2};
+  EXPECT_DOUBLE_EQ(1.25, create("weighted-speedup")->evaluate(s));
+  EXPECT_DOUBLE_EQ(1.25, create("stp")->evaluate(s));
+  EXPECT_DOUBLE_EQ(0.5 / 0.75, create("fairness")->evaluate(s));
+
+  auto energy = create("energy");
+  EXPECT_TRUE(energy->needs_energy());
+  EXPECT_DOUBLE_EQ(2e9, energy->evaluate(s));
+  pt::ptree properties;
+  properties.put("delay_weight", 1);
+  EXPECT_DOUBLE_EQ(8e18, create("energy", properties)->evaluate(s));
+
+  s.energy = -1;
+  EXPECT_TRUE(std::isnan(energy->evaluate(s)));
+  EXPECT_EQ(0, create("fairness")->evaluate({{}, {}, 0, 0}));
+  EXPECT_THROW(create("latency"), std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <util/shards.h>
+
+using namespace aser::util;
+
+namespace {
+
+/** Accesses lines cyclically.
+ *
+ * @param lines Number of distinct lines.
+ * @param rounds Number of times every line is accessed.
+ * @param offset First line.
+ */
+void cyclic(shards& s, uint64_t lines, unsigned rounds, uint64_t offset = 0) {
+  for (unsigned r = 0; r < rounds; ++r) {
+    for (uint64_t line = 0; line < lines; ++line)
+      s.access((offset + line) * 64 + r % 64);
+  }
+}
+
+TEST(shards, empty) {
+  shards s({1024, 1, 64, 16, 8});
+  std::vector<double> curve;
+  s.curve(curve);
+  EXPECT_EQ(std::vector<double>(8, 1), curve);
+  EXPECT_EQ(1024u, s.bin_size());
+}
+
+TEST(shards, exact) {
+  // Every line is sampled, so the curve is exact: 64 lines fit in 4 bins.
+  shards s({1024, 1, 64, 16, 16});
+  cyclic(s, 64, 10);
+
+  std::vector<double> curve;
+  s.curve(curve);
+  ASSERT_EQ(16u, curve.size());
+  for (unsigned bin = 0; bin < 3; ++bin)
+    EXPECT_DOUBLE_EQ(1, curve[bin]);
+  for (unsigned bin = 3; bin < 16; ++bin)
+    EXPECT_DOUBLE_EQ(0.1, curve[bin]);
+}
+
+TEST(shards, bounded) {
+  // Only 256 of the 4096 lines fit, so the sampling rate drops.
+  shards s({256, 1, 64, 64, 128});
+  cyclic(s, 4096, 20);
+  EXPECT_GE(256u, s.size());
+  EXPECT_GT(0.1, s.rate());
+
+  // The working set fills 64 bins.
+  std::vector<double> curve;
+  s.curve(curve);
+  EXPECT_LT(0.85, curve[40]);
+  EXPECT_GT(0.15, curve[100]);
+}
+
+TEST(shards, decay) {
+  shards s({4096, 1, 64, 16, 16});
+  cyclic(s, 64, 20);
+
+  // Without decay, the first phase would dominate the curve.
+  s.decay(0);
+  cyclic(s, 512, 4, 1 << 20);
+
+  std::vector<double> curve;
+  s.curve(curve);
+  EXPECT_LT(0.9, curve[15]);
+}
+
+TEST(shards, invalid) {
+  EXPECT_THROW(shards({0, 1, 64, 16, 16}), std::invalid_argument);
+  EXPECT_THROW(shards({64, 0, 64, 16, 16}), std::invalid_argument);
+  EXPECT_THROW(shards({64, 1, 48, 16, 16}), std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <exec_monitor/slo_controller.h>
+
+using aser::parse_slo_algorithm;
+using aser::slo_algorithm;
+using aser::slo_controller;
+
+namespace {
+
+slo_controller::config make_config(slo_algorithm algorithm) {
+  return {algorithm, 0.1, 0.5, 0.2, 0, 0.05, 0.1, 0.05, 0.1, -0.25, 10, 5};
+}
+
+TEST(slo_controller, parse_slo_algorithm) {
+  EXPECT_EQ(slo_algorithm::PID, parse_slo_algorithm("pid"));
+  EXPECT_EQ(slo_algorithm::STATE_MACHINE, parse_slo_algorithm("heracles"));
+  EXPECT_THROW(parse_slo_algorithm("bang-bang"), std::invalid_argument);
+}
+
+TEST(slo_controller, invalid) {
+  auto cfg = make_config(slo_algorithm::PID);
+  cfg.max_rate = 0;
+  EXPECT_THROW(slo_controller{cfg}, std::invalid_argument);
+  cfg = make_config(slo_algorithm::PID);
+  cfg.low_slack = 0.2;
+  EXPECT_THROW(slo_controller{cfg}, std::invalid_argument);
+  cfg = make_config(slo_algorithm::PID);
+  cfg.ki = -1;
+  EXPECT_THROW(slo_controller{cfg}, std::invalid_argument);
+}
+
+TEST(slo_controller, pid) {
+  // The slack drops as the batch jobs get more resources, so the target
+  // slack is reached with a share of 0.4.
+  slo_controller controller(make_config(slo_algorithm::PID));
+  auto share = controller.share();
+  for (unsigned i = 0; i < 200; ++i) {
+    auto next = controller.step(0.5 - share);
+    EXPECT_LE(std::abs(next - share), 0.1 + 1e-9);
+    share = next;
+  }
+  EXPECT_NEAR(0.4, share, 0.01);
+}
+
+TEST(slo_controller, anti_windup) {
+  slo_controller controller(make_config(slo_algorithm::PID));
+  for (unsigned i = 0; i < 100; ++i)
+    controller.step(1);
+  EXPECT_EQ(1, controller.share());
+
+  // The share shrinks as soon as the slack is below the target.
+  controller.step(0);
+  EXPECT_LT(controller.share(), 1);
+  EXPECT_EQ(slo_controller::state::SHRINK, controller.current_state());
+}
+
+TEST(slo_controller, fallback) {
+  slo_controller controller(make_config(slo_algorithm::PID));
+  for (unsigned i = 0; i < 20; ++i)
+    controller.step(1);
+  EXPECT_EQ(1, controller.share());
+
+  controller.step(-0.5);
+  EXPECT_EQ(0, controller.share());
+  EXPECT_EQ(slo_controller::state::FALLBACK, controller.current_state());
+  for (unsigned i = 0; i < 10; ++i) {
+    controller.step(1);
+    EXPECT_EQ(slo_controller::state::FALLBACK, controller.current_state());
+  }
+  controller.step(1);
+  EXPECT_EQ(slo_controller::state::GROW, controller.current_state());
+  EXPECT_DOUBLE_EQ(0.1, controller.share());
+
+  // Missing signals hold the share for a while.
+  for (unsigned i = 0; i < 4; ++i) {
+    controller.step_missing();
+    EXPECT_EQ(slo_controller::state::HOLD, controller.current_state());
+    EXPECT_DOUBLE_EQ(0.1, controller.share());
+  }
+  controller.step_missing();
+  EXPECT_EQ(slo_controller::state::FALLBACK, controller.current_state());
+  EXPECT_EQ(0, controller.share());
+}
+
+TEST(slo_controller, state_machine) {
+  auto cfg = make_config(slo_algorithm::STATE_MACHINE);
+  cfg.fallback_slack = 0;
+  slo_controller controller(cfg);
+
+  controller.step(0.2);
+  EXPECT_EQ(slo_controller::state::GROW, controller.current_state());
+  controller.step(0.2);
+  EXPECT_DOUBLE_EQ(0.1, controller.share());
+
+  controller.step(0.07);
+  EXPECT_EQ(slo_controller::state::HOLD, controller.current_state());
+  EXPECT_DOUBLE_EQ(0.1, controller.share());
+
+  controller.step(0.01);
+  EXPECT_EQ(slo_controller::state::SHRINK, controller.current_state());
+  EXPECT_DOUBLE_EQ(0.05, controller.share());
+
+  controller.step(-0.01);
+  EXPECT_EQ(slo_controller::state::FALLBACK, controller.current_state());
+  EXPECT_EQ(0, controller.share());
+}
+
+} // namespace
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <core/exec_monitor.h>
+#include <exec_manager/simple.h>
+#include <util/alloc_tracker.h>
+#include <util/os.h>
+#include <util/proc.h>
+
+using aser::simple_manager;
+namespace fs = boost::filesystem;
+namespace pt = boost::property_tree;
+
+namespace {
+
+void write_file(const fs::path& path, const std::string& contents) {
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path.string());
+  out << contents << "\n";
+}
+
+pt::ptree create_properties() {
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"benchmarks\": ["
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 0.5\","
+      "        \"name\": \"service\""
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 0.5\","
+      "        \"name\": \"batch\""
+      "      }"
+      "    ]"
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"slo-guard\","
+      "    \"sampling_length\": 1,"
+      "    \"event\": \"dummy\","
+      "    \"cpus\": \"0-1\","
+      "    \"slo_target\": 1"
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  return properties;
+}
+
+TEST(slo_guard, latency) {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  write_file(root / "info" / "L3" / "cbm_mask", "ff");
+  write_file(root / "info" / "MB" / "min_bandwidth", "10");
+  write_file(root / "schemata", "L3:0=ff\nMB:0=100");
+  write_file(root / "latency", "0.5");
+
+  auto properties = create_properties();
+  properties.put("exec_monitor.slo_signal", "latency");
+  properties.put("exec_monitor.slo_file", (root / "latency").string());
+  properties.put("exec_monitor.resources", "cpus cache bandwidth");
+  properties.put("exec_monitor.resctrl_root", root.string());
+  for (auto controller : {"pid", "heracles"}) {
+    properties.put("exec_monitor.controller", controller);
+    simple_manager exec_mgr(properties);
+    exec_mgr.start();
+    EXPECT_TRUE(fs::exists(root / "aser-batch" / "schemata"));
+    EXPECT_TRUE(fs::exists(root / "aser-critical" / "schemata"));
+  }
+
+  // Batch jobs suspended while the SLO is violated resume once the
+  // latency-critical process finishes.
+  write_file(root / "latency", "2");
+  simple_manager exec_mgr(properties);
+  exec_mgr.start();
+  fs::remove_all(root);
+}
+
+TEST(slo_guard, allocation_free_ticks) {
+  // Dummy counters give no IPC, so the controller falls back.
+  auto properties = create_properties();
+  properties.put("exec_monitor.missing_ticks", 5);
+  properties.put("exec_monitor.warmup_ticks", 20);
+  simple_manager exec_mgr(properties);
+  exec_mgr.start();
+
+  auto stats = exec_mgr.monitor().stats();
+  EXPECT_GT(stats.ticks, 20u);
+  if (aser::util::allocation_tracking_enabled()) {
+    EXPECT_EQ(0u, stats.steady_allocations);
+  }
+}
+
+TEST(slo_guard, protected_process) {
+  // The second benchmark is the latency-critical process, so the first
+  // batch job is created while there is none.
+  auto cpus = aser::util::allowed_cpus();
+  auto properties = create_properties();
+  properties.put("exec_monitor.protected", 1);
+  if (cpus.size() > 1) {
+    properties.put("exec_monitor.cpus",
+        std::to_string(cpus[0]) + "," + std::to_string(cpus[1]));
+  }
+  simple_manager exec_mgr(properties);
+  std::thread runner([&] { exec_mgr.start(); });
+
+  auto deadline = std::chrono::steady_clock::now()
+    + std::chrono::milliseconds(300);
+  auto pids = aser::util::children(getpid());
+  while (pids.size() < 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pids = aser::util::children(getpid());
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::vector<std::vector<unsigned>> affinity;
+  for (auto pid : pids)
+    affinity.push_back(aser::util::allowed_cpus(pid));
+  runner.join();
+
+  // Each process gets one of the CPUs (binding to a CPU that is not
+  // allowed fails, so it can only be checked with two CPUs).
+  if (cpus.size() > 1) {
+    std::sort(begin(affinity), end(affinity));
+    EXPECT_EQ((std::vector<std::vector<unsigned>>{{cpus[0]}, {cpus[1]}}),
+        affinity);
+  }
+}
+
+TEST(slo_guard, invalid) {
+  auto properties = create_properties();
+  properties.put("exec_monitor.slo_signal", "throughput");
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+  properties.put("exec_monitor.slo_signal", "ipc");
+  properties.put("exec_monitor.resources", "cpus disk");
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+  properties.put("exec_monitor.resources", "cpus");
+  properties.put("exec_monitor.cpus", "0");
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+}
+
+} // namespace
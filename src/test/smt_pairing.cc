@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <exec_manager/simple.h>
+#include <exec_monitor/smt_pairing.h>
+
+using aser::simple_manager;
+using aser::smt_pairing;
+namespace fs = boost::filesystem;
+namespace pt = boost::property_tree;
+
+namespace {
+
+typedef std::vector<smt_pairing::swap> swaps;
+
+const std::vector<double> no_pressure;
+
+/** Creates a search over two cores with applications 10 to 13 (the first
+ * two in different cores). */
+smt_pairing create_pairing(smt_pairing::config cfg) {
+  smt_pairing pairing(2, cfg);
+  for (pid_t app = 10; app < 14; ++app)
+    pairing.place(app);
+  return pairing;
+}
+
+TEST(smt_pairing, place) {
+  smt_pairing pairing(2, {1, 0.02, 0});
+  EXPECT_EQ(0u, pairing.place(10));
+  EXPECT_EQ(2u, pairing.place(11));
+  EXPECT_EQ(1u, pairing.place(12));
+  EXPECT_EQ(3u, pairing.place(13));
+  EXPECT_THROW(pairing.place(14), std::runtime_error);
+
+  pairing.remove(12);
+  EXPECT_EQ(1u, pairing.place(14));
+  EXPECT_EQ((std::vector<pid_t>{10, 14, 11, 13}), pairing.slots());
+}
+
+TEST(smt_pairing, keep_swap) {
+  auto pairing = create_pairing({1, 0.02, 0});
+  EXPECT_EQ((std::vector<pid_t>{10, 12, 11, 13}), pairing.slots());
+
+  EXPECT_EQ((swaps{{1, 2}}), pairing.step({1, 1, 1, 1}, no_pressure));
+  EXPECT_TRUE(pairing.trying());
+  EXPECT_EQ((std::vector<pid_t>{10, 11, 12, 13}), pairing.slots());
+
+  EXPECT_EQ(swaps{}, pairing.step({1.5, 1.5, 1.5, 1.5}, no_pressure));
+  EXPECT_FALSE(pairing.trying());
+  EXPECT_EQ((std::vector<pid_t>{10, 11, 12, 13}), pairing.slots());
+}
+
+TEST(smt_pairing, revert_swap) {
+  auto pairing = create_pairing({1, 0.02, 0});
+  pairing.step({1, 1, 1, 1}, no_pressure);
+
+  // Not enough gain.
+  EXPECT_EQ((swaps{{1, 2}}), pairing.step({1, 1, 1, 1.03}, no_pressure));
+  EXPECT_EQ((std::vector<pid_t>{10, 12, 11, 13}), pairing.slots());
+
+  // The other alternative is tried next.
+  EXPECT_EQ((swaps{{1, 3}}), pairing.step({1, 1, 1, 1}, no_pressure));
+  EXPECT_EQ((std::vector<pid_t>{10, 13, 11, 12}), pairing.slots());
+}
+
+TEST(smt_pairing, fairness) {
+  auto pairing = create_pairing({1, 0.02, 0.8});
+  pairing.step({1, 1, 1, 1}, no_pressure);
+
+  // Higher throughput, but the application in slot 3 is below 80% of its
+  // best IPC.
+  EXPECT_EQ((swaps{{1, 2}}), pairing.step({2, 2, 2, 0.5}, no_pressure));
+}
+
+TEST(smt_pairing, bounded_swaps) {
+  for (unsigned max_swaps = 1; max_swaps <= 3; ++max_swaps) {
+    smt_pairing pairing(4, {max_swaps, 0.02, 0});
+    for (pid_t app = 10; app < 18; ++app)
+      pairing.place(app);
+
+    // Swaps involve disjoint pairs of cores.
+    auto s = pairing.step(std::vector<double>(8, 1), no_pressure);
+    EXPECT_EQ(std::min(max_swaps, 2u), s.size());
+  }
+}
+
+TEST(smt_pairing, pressure) {
+  auto pairing = create_pairing({1, 0.02, 0});
+
+  // Applications with high pressure (10 and 12) share a core, so the
+  // swap pairs each of them with an application with low pressure.
+  EXPECT_EQ((swaps{{1, 2}}),
+      pairing.step({1, 1, 1, 1}, {0.9, 0.8, 0.1, 0.2}));
+  EXPECT_EQ((std::vector<pid_t>{10, 11, 12, 13}), pairing.slots());
+}
+
+void write_file(const fs::path& path, const std::string& contents) {
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path.string());
+  out << contents << "\n";
+}
+
+/** Creates a fake sysfs with two cores and two SMT siblings per core
+ * (CPUs n and n + 2). */
+fs::path create_sysfs() {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  auto system_path = root / "devices" / "system";
+  write_file(system_path / "node" / "node0" / "cpulist", "0-3");
+  write_file(system_path / "cpu" / "online", "0-3");
+  for (unsigned cpu = 0; cpu < 4; ++cpu) {
+    write_file(
+        system_path / "cpu" / ("cpu" + std::to_string(cpu)) / "topology"
+          / "thread_siblings_list",
+        std::to_string(cpu % 2) + "," + std::to_string(cpu % 2 + 2));
+  }
+  return root;
+}
+
+TEST(smt_pairer, basic) {
+  auto root = create_sysfs();
+  pt::ptree properties;
+  std::istringstream json_properties(
+      "{"
+      "  \"exec_manager\": {"
+      "    \"benchmarks\": ["
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep\""
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep\""
+      "      },"
+      "      {"
+      "        \"cmd\": \"/usr/bin/env sleep 1\","
+      "        \"name\": \"sleep\""
+      "      }"
+      "    ]"
+      "  },"
+      "  \"exec_monitor\": {"
+      "    \"type\": \"smt-pairer\","
+      "    \"event\": \"dummy\","
+      "    \"sampling_length\": 100,"
+      "    \"cpus\": \"0-3\""
+      "  }"
+      "}");
+  pt::read_json(json_properties, properties);
+  properties.put("exec_monitor.sysfs_root", root.string());
+  simple_manager exec_mgr(properties);
+
+#ifdef __linux__
+  // XXX binding a process to a CPU is only supported in Linux.
+  exec_mgr.start();
+#endif
+  fs::remove_all(root);
+}
+
+TEST(smt_pairer, no_smt_cores) {
+  auto root = create_sysfs();
+  pt::ptree properties;
+  properties.put("exec_manager.benchmarks", "");
+  properties.put("exec_monitor.type", "smt-pairer");
+  properties.put("exec_monitor.event", "dummy");
+  properties.put("exec_monitor.sampling_length", 100);
+  properties.put("exec_monitor.sysfs_root", root.string());
+  properties.put("exec_monitor.cpus", "0-1");
+  EXPECT_THROW(simple_manager{properties}, std::invalid_argument);
+  fs::remove_all(root);
+}
+
+} // namespace
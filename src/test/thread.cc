@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <atomic>
 #include <thread>
+#include <vector>
 
 #include <util/thread.h>
 
@@ -31,6 +33,30 @@ TEST(condition, basic) {
   t2.join();
 }
 
+TEST(barrier, rounds) {
+  constexpr unsigned num_threads = 4;
+  constexpr int rounds = 100;
+  aser::util::barrier barrier(num_threads);
+  std::atomic<int> arrived { 0 };
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&] {
+      for (int r = 0; r < rounds; ++r) {
+        ++arrived;
+        barrier.arrive_and_wait();
+        // Nobody can start the next round before everybody finishes this one.
+        EXPECT_GE(arrived, static_cast<int>((r + 1) * num_threads));
+        barrier.arrive_and_wait();
+      }
+    });
+  }
+
+  for (auto& t : threads)
+    t.join();
+  EXPECT_EQ(static_cast<int>(rounds * num_threads), arrived);
+}
+
 TEST(is_ready, basic) {
   auto f = std::async(
       std::launch::async,
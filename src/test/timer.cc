@@ -1,8 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <util/timer.h>
+#include <util/timer_service.h>
 
 using aser::util::callback_timer;
+using aser::util::timer_service;
 namespace chrono = std::chrono;
 
 namespace {
@@ -39,5 +46,56 @@ TEST(callback_timer, cancelation) {
   EXPECT_FALSE(callback_called);
 }
 
-} // namespace
+TEST(timer_service, many_timers) {
+  timer_service service;
+  constexpr int count = 5000;
+  std::atomic<int> fired { 0 };
+
+  for (int i = 0; i < count; i++)
+    service.schedule(chrono::milliseconds(i % 100), [&] { ++fired; });
+
+  std::this_thread::sleep_for(chrono::milliseconds(300));
+  EXPECT_EQ(count, fired);
+  EXPECT_EQ(0u, service.size());
+}
+
+TEST(timer_service, cancel) {
+  timer_service service;
+  std::atomic<int> fired { 0 };
+  int owner;
+
+  auto id = service.schedule(chrono::milliseconds(50), [&] { ++fired; });
+  for (int i = 0; i < 10; i++)
+    service.schedule(chrono::milliseconds(50), [&] { ++fired; }, &owner);
+  service.schedule(chrono::milliseconds(50), [&] { ++fired; });
+
+  EXPECT_TRUE(service.cancel(id));
+  EXPECT_FALSE(service.cancel(id));
+  service.cancel_all(&owner);
 
+  std::this_thread::sleep_for(chrono::milliseconds(150));
+  EXPECT_EQ(1, fired);
+}
+
+TEST(timer_service, dispatcher) {
+  std::vector<timer_service::callback_func> dispatched;
+  std::mutex mutex;
+  timer_service service(
+      chrono::milliseconds(1),
+      [&](timer_service::callback_func f) {
+        std::lock_guard<std::mutex> lock(mutex);
+        dispatched.push_back(std::move(f));
+      });
+
+  bool called = false;
+  service.schedule(chrono::milliseconds(10), [&] { called = true; });
+  std::this_thread::sleep_for(chrono::milliseconds(100));
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(1u, dispatched.size());
+  EXPECT_FALSE(called);
+  dispatched[0]();
+  EXPECT_TRUE(called);
+}
+
+} // namespace
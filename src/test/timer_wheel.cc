@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <util/timer_wheel.h>
+
+using aser::util::timer_wheel;
+
+namespace {
+
+TEST(timer_wheel, expiration_order) {
+  timer_wheel wheel;
+  std::vector<int> fired;
+  std::vector<timer_wheel::callback_func> expired;
+
+  wheel.add(5, [&] { fired.push_back(5); });
+  wheel.add(1, [&] { fired.push_back(1); });
+  wheel.add(300, [&] { fired.push_back(300); });
+  wheel.add(70000, [&] { fired.push_back(70000); });
+  EXPECT_EQ(4u, wheel.size());
+  EXPECT_EQ(1u, wheel.next_expiry());
+
+  wheel.advance(4, expired);
+  ASSERT_EQ(1u, expired.size());
+  expired[0]();
+  expired.clear();
+
+  wheel.advance(299, expired);
+  ASSERT_EQ(1u, expired.size());
+  expired[0]();
+  expired.clear();
+
+  wheel.advance(300, expired);
+  ASSERT_EQ(1u, expired.size());
+  expired[0]();
+  expired.clear();
+
+  wheel.advance(69999, expired);
+  EXPECT_TRUE(expired.empty());
+  wheel.advance(70000, expired);
+  ASSERT_EQ(1u, expired.size());
+  expired[0]();
+
+  EXPECT_EQ((std::vector<int>{1, 5, 300, 70000}), fired);
+  EXPECT_EQ(0u, wheel.size());
+  EXPECT_EQ(timer_wheel::never, wheel.next_expiry());
+}
+
+TEST(timer_wheel, exact_tick) {
+  // Timers at every level must expire exactly at their tick, regardless
+  // of the tick at which they were added.
+  for (uint64_t start : {0u, 200u, 255u, 256u, 65535u}) {
+    for (uint64_t delay : {0u, 1u, 255u, 256u, 257u, 65535u, 65536u, 70001u}) {
+      timer_wheel wheel(start);
+      bool fired = false;
+      std::vector<timer_wheel::callback_func> expired;
+      wheel.add(start + delay, [&] { fired = true; });
+
+      // Advancing one tick at a time, as the service does when it follows
+      // next_expiry().
+      uint64_t now = start;
+      while (expired.empty()) {
+        now = std::max(now, wheel.next_expiry());
+        wheel.advance(now, expired);
+      }
+      EXPECT_EQ(start + delay, now) << "start: " << start
+                                    << ", delay: " << delay;
+    }
+  }
+}
+
+TEST(timer_wheel, cancel) {
+  timer_wheel wheel;
+  std::vector<timer_wheel::callback_func> expired;
+
+  auto a = wheel.add(10, [] {});
+  auto b = wheel.add(1000, [] {});
+  EXPECT_TRUE(wheel.pending(a));
+  EXPECT_TRUE(wheel.cancel(a));
+  EXPECT_FALSE(wheel.pending(a));
+  EXPECT_FALSE(wheel.cancel(a));
+  EXPECT_EQ(1u, wheel.size());
+
+  // The node is reused, but the identifier is not.
+  auto c = wheel.add(20, [] {});
+  EXPECT_NE(a, c);
+  EXPECT_FALSE(wheel.cancel(a));
+
+  wheel.advance(2000, expired);
+  EXPECT_EQ(2u, expired.size());
+  EXPECT_FALSE(wheel.pending(b));
+  EXPECT_FALSE(wheel.cancel(c));
+}
+
+TEST(timer_wheel, cancel_all) {
+  timer_wheel wheel;
+  int owner1, owner2;
+  for (int i = 0; i < 100; ++i) {
+    wheel.add(i * 1000, [] {}, &owner1);
+    wheel.add(i * 1000, [] {}, &owner2);
+  }
+
+  EXPECT_EQ(100u, wheel.cancel_all(&owner1));
+  EXPECT_EQ(100u, wheel.size());
+
+  std::vector<timer_wheel::callback_func> expired;
+  wheel.advance(1000000, expired);
+  EXPECT_EQ(100u, expired.size());
+}
+
+TEST(timer_wheel, expired_timers) {
+  timer_wheel wheel(100);
+  std::vector<timer_wheel::callback_func> expired;
+
+  wheel.add(50, [] {});
+  EXPECT_EQ(100u, wheel.next_expiry());
+  wheel.advance(100, expired);
+  EXPECT_EQ(1u, expired.size());
+}
+
+} // namespace
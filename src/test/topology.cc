@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include <util/topology.h>
+
+namespace fs = boost::filesystem;
+using namespace aser::util;
+
+namespace {
+
+void write_file(const fs::path& path, const std::string& contents) {
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path.string());
+  out << contents << "\n";
+}
+
+/** Creates a fake sysfs with two nodes, a cache domain per node, two cores
+ * per cache domain and two SMT siblings per core (CPUs n and n + 4). CPU 8
+ * is offline. */
+fs::path create_sysfs() {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  auto system_path = root / "devices" / "system";
+  write_file(system_path / "node" / "node0" / "cpulist", "0-1,4-5");
+  write_file(system_path / "node" / "node1" / "cpulist", "2-3,6-8");
+  write_file(system_path / "cpu" / "online", "0-7");
+
+  for (unsigned cpu = 0; cpu < 8; ++cpu) {
+    auto path = system_path / "cpu" / ("cpu" + std::to_string(cpu));
+    auto core = cpu % 4;
+    write_file(path / "topology" / "thread_siblings_list",
+        std::to_string(core) + "," + std::to_string(core + 4));
+    write_file(path / "cache" / "index0" / "level", "1");
+    write_file(path / "cache" / "index0" / "type", "Data");
+    write_file(path / "cache" / "index0" / "shared_cpu_list",
+        std::to_string(core) + "," + std::to_string(core + 4));
+    write_file(path / "cache" / "index1" / "level", "3");
+    write_file(path / "cache" / "index1" / "type", "Unified");
+    write_file(path / "cache" / "index1" / "shared_cpu_list",
+        core < 2 ? "0-1,4-5" : "2-3,6-7");
+    write_file(path / "cache" / "index0" / "size", "32K");
+    write_file(path / "cache" / "index1" / "size", "16384K");
+  }
+
+  return root;
+}
+
+TEST(topology, read) {
+  auto root = create_sysfs();
+  auto topo = topology::read(root.string());
+  fs::remove_all(root);
+
+  ASSERT_EQ(8u, topo.cpus().size());
+  EXPECT_EQ(4u, topo.num_cores());
+  EXPECT_EQ(2u, topo.num_llcs());
+  EXPECT_EQ(2u, topo.num_nodes());
+  EXPECT_FALSE(topo.contains(8));
+
+  auto& cpu5 = topo.find(5);
+  EXPECT_EQ(1u, cpu5.core);
+  EXPECT_EQ(1u, cpu5.thread);
+  EXPECT_EQ(0u, cpu5.llc);
+  EXPECT_EQ(0u, cpu5.node);
+
+  EXPECT_EQ((std::vector<unsigned>{1, 5}), topo.core_cpus(1));
+  EXPECT_EQ((std::vector<unsigned>{2, 3, 6, 7}), topo.llc_cpus(1));
+  EXPECT_EQ((std::vector<unsigned>{2, 3, 6, 7}), topo.node_cpus(1));
+}
+
+TEST(topology, llc_size) {
+  auto root = create_sysfs();
+  EXPECT_EQ(16u * 1024 * 1024, llc_size(root.string(), 5));
+  EXPECT_EQ(0u, llc_size(root.string(), 8));
+  fs::remove_all(root);
+}
+
+TEST(topology, missing_information) {
+  auto root = fs::temp_directory_path() / fs::unique_path();
+  write_file(root / "devices" / "system" / "cpu" / "online", "0-3");
+  auto topo = topology::read(root.string());
+  fs::remove_all(root);
+
+  // Every CPU is on its own core and cache domain.
+  ASSERT_EQ(4u, topo.cpus().size());
+  EXPECT_EQ(4u, topo.num_cores());
+  EXPECT_EQ(4u, topo.num_llcs());
+  EXPECT_EQ(1u, topo.num_nodes());
+}
+
+TEST(topology, system) {
+  auto topo = topology::read();
+  EXPECT_FALSE(topo.cpus().empty());
+  EXPECT_LE(topo.num_cores(), topo.cpus().size());
+  EXPECT_LE(topo.num_llcs(), topo.num_cores());
+}
+
+} // namespace
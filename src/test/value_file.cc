@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include <util/value_file.h>
+
+namespace fs = boost::filesystem;
+using aser::util::value_file;
+
+namespace {
+
+void write_file(const fs::path& path, const std::string& contents) {
+  std::ofstream out(path.string());
+  out << contents;
+}
+
+TEST(value_file, read) {
+  auto path = fs::temp_directory_path() / fs::unique_path();
+  value_file file(path.string());
+  double value;
+  EXPECT_FALSE(file.read(value));
+
+  write_file(path, "12.5\n");
+  EXPECT_TRUE(file.read(value));
+  EXPECT_EQ(12.5, value);
+
+  write_file(path, "13");
+  EXPECT_TRUE(file.read(value));
+  EXPECT_EQ(13, value);
+
+  write_file(path, "");
+  EXPECT_FALSE(file.read(value));
+
+  // Files replaced by renaming are opened again.
+  auto next = fs::temp_directory_path() / fs::unique_path();
+  write_file(next, "42");
+  fs::rename(next, path);
+  EXPECT_TRUE(file.read(value));
+  EXPECT_EQ(42, value);
+
+  fs::remove(path);
+  EXPECT_FALSE(file.read(value));
+}
+
+} // namespace
@@ -0,0 +1,112 @@
+#include "alloc_tracker.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace aser {
+namespace util {
+
+#ifdef ASER_TRACK_ALLOCATIONS
+
+namespace {
+
+/** Allocations made by each thread. A plain integer does not need dynamic
+ * initialization, so it can be used before any thread-local constructor
+ * runs. */
+thread_local uint64_t allocations = 0;
+
+} // namespace
+
+namespace detail {
+
+void* tracked_allocate(size_t size) {
+  ++allocations;
+  if (size == 0)
+    size = 1;
+  while (true) {
+    auto ptr = std::malloc(size);
+    if (ptr != nullptr)
+      return ptr;
+    auto handler = std::get_new_handler();
+    if (handler == nullptr)
+      throw std::bad_alloc();
+    handler();
+  }
+}
+
+} // namespace detail
+
+uint64_t thread_allocations() noexcept {
+  return allocations;
+}
+
+bool allocation_tracking_enabled() noexcept {
+  return true;
+}
+
+#else
+
+uint64_t thread_allocations() noexcept {
+  return 0;
+}
+
+bool allocation_tracking_enabled() noexcept {
+  return false;
+}
+
+#endif
+
+} // namespace util
+} // namespace aser
+
+#ifdef ASER_TRACK_ALLOCATIONS
+
+void* operator new(size_t size) {
+  return aser::util::detail::tracked_allocate(size);
+}
+
+void* operator new[](size_t size) {
+  return aser::util::detail::tracked_allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return aser::util::detail::tracked_allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return aser::util::detail::tracked_allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+#endif
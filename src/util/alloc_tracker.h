@@ -0,0 +1,24 @@
+#ifndef UTIL_ALLOC_TRACKER_H_
+#define UTIL_ALLOC_TRACKER_H_
+
+#include <cstdint>
+
+namespace aser {
+namespace util {
+
+/** Returns the number of heap allocations made by the calling thread.
+ *
+ * Allocations are only counted in builds with ASER_TRACK_ALLOCATIONS
+ * defined (e.g., test builds), which replace the global operator new.
+ * Otherwise, this function always returns zero. Memory obtained directly
+ * from malloc is not counted.
+ */
+uint64_t thread_allocations() noexcept;
+
+/** Returns whether heap allocations are counted in this build. */
+bool allocation_tracking_enabled() noexcept;
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_ALLOC_TRACKER_H_
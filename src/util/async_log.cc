@@ -0,0 +1,152 @@
+#include "async_log.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <util/log.h>
+
+namespace aser {
+namespace util {
+
+constexpr unsigned async_log::max_args;
+constexpr size_t async_log::buffer_capacity;
+
+/** Time between two drains of the buffers. */
+static constexpr std::chrono::milliseconds drain_interval(10);
+
+async_log::async_log()
+  : thread_{&async_log::run, this}
+{}
+
+async_log::~async_log() {
+  {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stopping_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+async_log& async_log::instance() {
+  static async_log log;
+  return log;
+}
+
+async_log::buffer_owner::~buffer_owner() {
+  if (buffer)
+    buffer->orphaned.store(true, std::memory_order_release);
+}
+
+async_log::thread_buffer& async_log::local_buffer() {
+  thread_local buffer_owner owner;
+  if (!owner.buffer) {
+    // The log is created before the first buffer, so that it is destroyed
+    // after the buffers of every thread are orphaned.
+    auto& log = instance();
+    owner.buffer = std::make_shared<thread_buffer>();
+    std::lock_guard<std::mutex> lock(log.mutex_);
+    log.buffers_.push_back(owner.buffer);
+  }
+  return *owner.buffer;
+}
+
+void async_log::flush() {
+  auto& log = instance();
+  std::unique_lock<std::mutex> lock(log.mutex_);
+  // A drain in progress may have already passed the buffer of this thread,
+  // so the one after it is waited for.
+  auto target = log.drains_ + (log.draining_ ? 2 : 1);
+  log.flush_requested_ = true;
+  log.cv_.notify_all();
+  log.cv_.wait(lock, [&] { return log.drains_ >= target; });
+}
+
+uint64_t async_log::dropped() {
+  return instance().dropped_.load(std::memory_order_relaxed);
+}
+
+std::string async_log::format(const record& r) {
+  try {
+    boost::format f(r.format);
+    for (unsigned i = 0; i < r.num_args; ++i) {
+      switch (r.types[i]) {
+      case arg_type::SIGNED:
+        f % static_cast<int64_t>(r.args[i]);
+        break;
+      case arg_type::UNSIGNED:
+        f % r.args[i];
+        break;
+      case arg_type::DOUBLE: {
+        double value;
+        std::memcpy(&value, &r.args[i], sizeof(value));
+        f % value;
+        break;
+      }
+      case arg_type::BOOL:
+        f % (r.args[i] != 0);
+        break;
+      }
+    }
+    return f.str();
+  } catch (const boost::io::format_error& e) {
+    return std::string("Invalid log record: ") + r.format;
+  }
+}
+
+void async_log::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait_for(lock, drain_interval,
+        [&] { return flush_requested_ || stopping_; });
+    flush_requested_ = false;
+    drain(lock);
+    ++drains_;
+    cv_.notify_all();
+    if (stopping_)
+      break;
+  }
+}
+
+void async_log::drain(std::unique_lock<std::mutex>& lock) {
+  // The buffers are taken out while the records are formatted, so that new
+  // threads can still register theirs.
+  draining_ = true;
+  draining_buffers_.swap(buffers_);
+  lock.unlock();
+
+  auto& logger = boost::log::trivial::logger::get();
+  record r;
+  for (auto& buffer : draining_buffers_) {
+    // The flag is read first, so that every record written by an orphaned
+    // thread is emitted before releasing its buffer.
+    auto orphaned = buffer->orphaned.load(std::memory_order_acquire);
+    while (buffer->queue.try_pop(r)) {
+      // Records are only formatted if debug messages pass the filter.
+      auto rec = logger.open_record(
+          boost::log::keywords::severity = boost::log::trivial::debug);
+      if (rec) {
+        boost::log::record_ostream stream(rec);
+        stream << format(r);
+        stream.flush();
+        logger.push_record(std::move(rec));
+      }
+    }
+    if (orphaned)
+      buffer = nullptr;
+  }
+
+  draining_buffers_.erase(
+      std::remove(begin(draining_buffers_), end(draining_buffers_), nullptr),
+      end(draining_buffers_));
+
+  lock.lock();
+  // Buffers registered during the drain go after the others.
+  draining_buffers_.insert(
+      end(draining_buffers_), begin(buffers_), end(buffers_));
+  buffers_.swap(draining_buffers_);
+  draining_buffers_.clear();
+  draining_ = false;
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,180 @@
+#ifndef UTIL_ASYNC_LOG_H_
+#define UTIL_ASYNC_LOG_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <util/mpsc_queue.h>
+
+namespace aser {
+namespace util {
+
+/** Asynchronous binary log.
+ *
+ * Writing a record copies a pointer to the format string and the raw
+ * arguments into a buffer owned by the calling thread, without locking or
+ * allocating. A background thread periodically drains the buffers, formats
+ * the records (using Boost.Format syntax) and emits them as debug messages.
+ * Records that the logging filter would discard are not formatted. Records
+ * are dropped if a buffer is full, so writers never block.
+ *
+ * Format strings must outlive the log (i.e., they should be literals), and
+ * arguments must be arithmetic values.
+ */
+class async_log {
+public:
+  /** Maximum number of arguments in a record. */
+  static constexpr unsigned max_args = 6;
+
+  /** Number of records each thread can have pending. */
+  static constexpr size_t buffer_capacity = 1024;
+
+  /** Writes a record.
+   *
+   * @param format The format string.
+   * @param args The arguments.
+   */
+  template<typename... Args>
+  static void write(const char* format, const Args&... args);
+
+  /** Waits until every record written so far has been emitted. */
+  static void flush();
+
+  /** Returns the number of records dropped because a buffer was full. */
+  static uint64_t dropped();
+
+  /** Type of a record argument. */
+  enum class arg_type : uint8_t { SIGNED, UNSIGNED, DOUBLE, BOOL };
+
+  /** A record, as stored in the buffers (one cache line). */
+  struct record {
+    const char* format;
+    uint64_t args[max_args];
+    arg_type types[max_args];
+    uint8_t num_args;
+  };
+
+  /** Formats a record.
+   *
+   * @param r The record.
+   * @return The formatted message.
+   */
+  static std::string format(const record& r);
+
+  ~async_log();
+
+private:
+  /** Records pending for a thread. */
+  struct thread_buffer {
+    spsc_queue<record> queue { buffer_capacity };
+
+    /** Set once the thread finishes; the buffer is released once empty. */
+    std::atomic<bool> orphaned { false };
+  };
+
+  /** Releases the buffer of a thread when the thread finishes. */
+  struct buffer_owner {
+    std::shared_ptr<thread_buffer> buffer;
+    ~buffer_owner();
+  };
+
+  std::vector<std::shared_ptr<thread_buffer>> buffers_;
+
+  /** Buffers being drained (only used by the background thread). */
+  std::vector<std::shared_ptr<thread_buffer>> draining_buffers_;
+
+  std::atomic<uint64_t> dropped_ { 0 };
+
+  /** Number of times the buffers have been drained (see flush()). */
+  uint64_t drains_ { 0 };
+  bool draining_ { false };
+  bool flush_requested_ { false };
+  bool stopping_ { false };
+
+  /** Mutex protecting buffers_ and the drain state. */
+  std::mutex mutex_;
+  std::condition_variable cv_;
+
+  std::thread thread_;
+
+  async_log();
+
+  static async_log& instance();
+
+  /** Returns the buffer for the calling thread. */
+  static thread_buffer& local_buffer();
+
+  void run();
+
+  /** Emits all the pending records.
+   *
+   * @param lock The lock on mutex_, released while the records are
+   * formatted.
+   */
+  void drain(std::unique_lock<std::mutex>& lock);
+
+  static void encode(record& r, unsigned i, bool value) {
+    r.types[i] = arg_type::BOOL;
+    r.args[i] = value;
+  }
+
+  static void encode(record& r, unsigned i, double value) {
+    r.types[i] = arg_type::DOUBLE;
+    static_assert(sizeof(double) == sizeof(uint64_t), "Unexpected size");
+    std::memcpy(&r.args[i], &value, sizeof(value));
+  }
+
+  template<typename T>
+  static typename std::enable_if<std::is_integral<T>::value>::type
+  encode(record& r, unsigned i, T value) {
+    if (std::is_signed<T>::value) {
+      r.types[i] = arg_type::SIGNED;
+      r.args[i] = static_cast<uint64_t>(static_cast<int64_t>(value));
+    } else {
+      r.types[i] = arg_type::UNSIGNED;
+      r.args[i] = static_cast<uint64_t>(value);
+    }
+  }
+
+  static void encode(record& r, unsigned i, float value) {
+    encode(r, i, static_cast<double>(value));
+  }
+
+  static void encode_all(record&, unsigned) {}
+
+  template<typename T, typename... Rest>
+  static void encode_all(record& r, unsigned i, const T& value,
+      const Rest&... rest) {
+    static_assert(std::is_arithmetic<T>::value,
+        "Only arithmetic values can be logged asynchronously");
+    encode(r, i, value);
+    encode_all(r, i + 1, rest...);
+  }
+
+  async_log(const async_log&) = delete;
+  async_log& operator=(const async_log&) = delete;
+};
+
+template<typename... Args>
+void async_log::write(const char* format, const Args&... args) {
+  static_assert(sizeof...(Args) <= max_args, "Too many arguments");
+  record r;
+  r.format = format;
+  r.num_args = sizeof...(Args);
+  encode_all(r, 0, args...);
+  if (!local_buffer().queue.try_push(r))
+    instance().dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_ASYNC_LOG_H_
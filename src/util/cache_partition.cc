@@ -0,0 +1,187 @@
+#include "cache_partition.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace aser {
+namespace util {
+
+partition_algorithm parse_partition_algorithm(const std::string& name) {
+  if (name == "lookahead")
+    return partition_algorithm::LOOKAHEAD;
+  if (name == "hull")
+    return partition_algorithm::HULL;
+  throw std::invalid_argument("Invalid partition algorithm: " + name);
+}
+
+partition_solver::partition_solver(config cfg)
+  : config_(cfg)
+{
+  if (config_.ways == 0)
+    throw std::invalid_argument("The cache must have ways");
+  if (config_.hysteresis < 0)
+    throw std::invalid_argument("Hysteresis must not be negative");
+}
+
+double partition_solver::total_misses(
+    const std::vector<partition_request>& requests,
+    const std::vector<unsigned>& allocation) {
+  double total = 0;
+  for (size_t i = 0; i < requests.size(); ++i)
+    total += requests[i].misses[allocation[i]];
+  return total;
+}
+
+unsigned partition_solver::initial_allocation(
+    const std::vector<partition_request>& requests,
+    std::vector<unsigned>& allocation) const {
+  allocation.clear();
+  unsigned used = 0;
+  for (auto& r : requests) {
+    if (r.misses.size() != config_.ways + 1)
+      throw std::invalid_argument("Curves need a point for every way");
+    auto ways = r.reserved_ways > 0 ? r.reserved_ways : r.min_ways;
+    allocation.push_back(ways);
+    used += ways;
+  }
+  if (used > config_.ways)
+    throw std::invalid_argument("Minimum and reserved ways exceed the cache");
+  return config_.ways - used;
+}
+
+bool partition_solver::valid(
+    const std::vector<partition_request>& requests,
+    const std::vector<unsigned>& allocation) const {
+  if (allocation.size() != requests.size())
+    return false;
+
+  unsigned used = 0;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    auto& r = requests[i];
+    if (r.reserved_ways > 0 ? allocation[i] != r.reserved_ways
+        : allocation[i] < r.min_ways)
+      return false;
+    used += allocation[i];
+  }
+  return used <= config_.ways;
+}
+
+void partition_solver::lookahead(
+    const std::vector<partition_request>& requests,
+    unsigned balance,
+    std::vector<unsigned>& allocation) const {
+  while (balance > 0) {
+    size_t best = requests.size();
+    unsigned best_ways = 0;
+    auto best_utility = -std::numeric_limits<double>::infinity();
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+      if (requests[i].reserved_ways > 0)
+        continue;
+      auto& misses = requests[i].misses;
+      auto current = allocation[i];
+      auto max_ways = std::min(balance, config_.ways - current);
+      for (unsigned ways = 1; ways <= max_ways; ++ways) {
+        auto utility = (misses[current] - misses[current + ways]) / ways;
+        if (utility > best_utility) {
+          best = i;
+          best_ways = ways;
+          best_utility = utility;
+        }
+      }
+    }
+
+    if (best == requests.size())
+      break;
+    allocation[best] += best_ways;
+    balance -= best_ways;
+  }
+}
+
+void partition_solver::hull(
+    const std::vector<partition_request>& requests,
+    unsigned balance,
+    std::vector<unsigned>& allocation) {
+  segments_.clear();
+  for (unsigned i = 0; i < requests.size(); ++i) {
+    if (requests[i].reserved_ways > 0)
+      continue;
+
+    // Lower convex hull of the points from the current allocation on
+    // (monotone chain).
+    auto& misses = requests[i].misses;
+    hull_.clear();
+    for (auto w = allocation[i]; w <= config_.ways; ++w) {
+      while (hull_.size() >= 2) {
+        auto a = hull_[hull_.size() - 2], b = hull_.back();
+        // Drops b if it is not below the line from a to w.
+        auto cross = (misses[b] - misses[a]) * (w - a)
+          - (misses[w] - misses[a]) * (b - a);
+        if (cross < 0)
+          break;
+        hull_.pop_back();
+      }
+      hull_.push_back(w);
+    }
+
+    for (size_t s = 1; s < hull_.size(); ++s) {
+      auto start = hull_[s - 1], ways = hull_[s] - hull_[s - 1];
+      segments_.push_back(
+          {i, start, ways, (misses[start] - misses[hull_[s]]) / ways});
+    }
+  }
+
+  // Segments of a process have decreasing utility, so the segments are
+  // taken in order by merging the hulls of all the processes.
+  auto lower = [this](size_t a, size_t b) {
+    return segments_[a].utility < segments_[b].utility;
+  };
+  heads_.clear();
+  for (size_t s = 0; s < segments_.size(); ++s) {
+    if (s == 0 || segments_[s].process != segments_[s - 1].process)
+      heads_.push_back(s);
+  }
+  std::make_heap(begin(heads_), end(heads_), lower);
+
+  while (balance > 0 && !heads_.empty()) {
+    std::pop_heap(begin(heads_), end(heads_), lower);
+    auto s = heads_.back();
+    heads_.pop_back();
+
+    auto& seg = segments_[s];
+    auto ways = std::min(balance, seg.ways);
+    allocation[seg.process] += ways;
+    balance -= ways;
+
+    if (s + 1 < segments_.size() && segments_[s + 1].process == seg.process) {
+      heads_.push_back(s + 1);
+      std::push_heap(begin(heads_), end(heads_), lower);
+    }
+  }
+}
+
+bool partition_solver::solve(
+    const std::vector<partition_request>& requests,
+    std::vector<unsigned>& allocation) {
+  auto balance = initial_allocation(requests, candidate_);
+  if (config_.algorithm == partition_algorithm::LOOKAHEAD)
+    lookahead(requests, balance, candidate_);
+  else
+    hull(requests, balance, candidate_);
+
+  if (valid(requests, allocation)) {
+    if (allocation == candidate_)
+      return false;
+    auto current = total_misses(requests, allocation);
+    auto proposed = total_misses(requests, candidate_);
+    if (current - proposed <= config_.hysteresis * current)
+      return false;
+  }
+
+  allocation = candidate_;
+  return true;
+}
+
+} // namespace util
+} // namespace aser
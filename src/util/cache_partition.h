@@ -0,0 +1,133 @@
+#ifndef UTIL_CACHE_PARTITION_H_
+#define UTIL_CACHE_PARTITION_H_
+
+#include <string>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** What a process needs from a partitioned cache. */
+struct partition_request {
+  /** Misses (or any other cost to minimize) of the process with every
+   * number of ways, from zero to the number of ways in the cache. */
+  std::vector<double> misses;
+
+  /** Minimum number of ways. */
+  unsigned min_ways;
+
+  /** Ways reserved for the process (QoS). If positive, the process gets
+   * exactly these ways, regardless of its misses. */
+  unsigned reserved_ways;
+};
+
+/** Algorithms to partition a cache.
+ *
+ * LOOKAHEAD: utility-based cache partitioning (UCP). Ways are allocated
+ * in steps: every step gives the process with the highest marginal utility
+ * (misses saved per way, looking ahead over any number of ways) the ways
+ * that achieve it. Handles any curve.
+ *
+ * HULL: every curve is replaced by its lower convex hull, whose segments
+ * have decreasing marginal utility, and the segments of all the processes
+ * are taken greedily in order of utility (merging the hulls with a heap).
+ * Optimal for convex curves. Curves are scanned once, so it takes time
+ * linear in the number of ways, whereas LOOKAHEAD takes quadratic time
+ * when every step allocates a single way.
+ */
+enum class partition_algorithm { LOOKAHEAD, HULL };
+
+/** Parses the name of a partitioning algorithm ("lookahead" or "hull").
+ *
+ * @throw std::invalid_argument If the name is not valid.
+ */
+partition_algorithm parse_partition_algorithm(const std::string& name);
+
+/** Partitions the ways of a cache among processes. */
+class partition_solver {
+public:
+  struct config {
+    /** Number of ways in the cache. */
+    unsigned ways;
+
+    partition_algorithm algorithm;
+
+    /** Minimum relative reduction of the total misses (with respect to
+     * the current allocation) to change the allocation, so that it does not
+     * change back and forth with small variations of the curves. */
+    double hysteresis;
+  };
+
+  explicit partition_solver(config cfg);
+
+  /** Computes the ways of every process.
+   *
+   * @param requests The request of every process.
+   * @param allocation The current allocation (one number of ways per
+   *     request; ignored if it does not match the requests), replaced with
+   *     the new one.
+   * @return True if the allocation changed.
+   * @throw std::invalid_argument If a curve does not have a point for
+   *     every number of ways, or the minimum or reserved ways exceed the
+   *     cache.
+   */
+  bool solve(
+      const std::vector<partition_request>& requests,
+      std::vector<unsigned>& allocation);
+
+  /** Returns the total misses with an allocation. */
+  static double total_misses(
+      const std::vector<partition_request>& requests,
+      const std::vector<unsigned>& allocation);
+
+private:
+  /** A segment of the convex hull of a curve. */
+  struct segment {
+    unsigned process;
+
+    /** Number of ways at the start of the segment, and its length. */
+    unsigned start;
+    unsigned ways;
+
+    /** Misses saved per way. */
+    double utility;
+  };
+
+  config config_;
+
+  /** Scratch space, reused across calls. */
+  std::vector<unsigned> candidate_;
+  std::vector<segment> segments_;
+  std::vector<unsigned> hull_;
+
+  /** Heap with the next segment of every process. */
+  std::vector<size_t> heads_;
+
+  /** Gives every process its minimum or reserved ways.
+   *
+   * @return The ways left.
+   */
+  unsigned initial_allocation(
+      const std::vector<partition_request>& requests,
+      std::vector<unsigned>& allocation) const;
+
+  /** Checks whether an allocation meets the requests. */
+  bool valid(
+      const std::vector<partition_request>& requests,
+      const std::vector<unsigned>& allocation) const;
+
+  void lookahead(
+      const std::vector<partition_request>& requests,
+      unsigned balance,
+      std::vector<unsigned>& allocation) const;
+
+  void hull(
+      const std::vector<partition_request>& requests,
+      unsigned balance,
+      std::vector<unsigned>& allocation);
+};
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_CACHE_PARTITION_H_
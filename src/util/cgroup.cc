@@ -0,0 +1,46 @@
+#include "cgroup.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+
+#include "libc_wrapper.h"
+
+namespace aser {
+namespace util {
+
+void create_cgroup(const std::string& path) {
+  if (::mkdir(path.c_str(), 0755) == -1 && errno != EEXIST)
+    libc_error(boost::str(
+        boost::format("Error creating cgroup %1%") % path));
+}
+
+void remove_cgroup(const std::string& path) {
+  error_if_equal(
+      ::rmdir(path.c_str()),
+      -1,
+      boost::str(boost::format("Error removing cgroup %1%") % path));
+}
+
+void add_to_cgroup(const std::string& path, pid_t pid) {
+  std::ofstream out(path + "/cgroup.procs");
+  out << pid << std::endl;
+  if (!out)
+    throw std::runtime_error(boost::str(
+        boost::format("Error adding process %1% to cgroup %2%") % pid % path));
+}
+
+std::vector<pid_t> cgroup_processes(const std::string& path) {
+  std::ifstream in(path + "/cgroup.procs");
+  std::vector<pid_t> pids;
+  pid_t pid;
+  while (in >> pid)
+    pids.push_back(pid);
+  std::sort(begin(pids), end(pids));
+  return pids;
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,45 @@
+#ifndef UTIL_CGROUP_H_
+#define UTIL_CGROUP_H_
+
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** Creates a control group.
+ *
+ * @param path The path of the control group (within a mounted hierarchy).
+ */
+void create_cgroup(const std::string& path);
+
+/** Removes a control group.
+ *
+ * The control group must not contain any process.
+ *
+ * @param path The path of the control group.
+ */
+void remove_cgroup(const std::string& path);
+
+/** Moves a process into a control group.
+ *
+ * Threads and children created afterwards will also belong to the group.
+ *
+ * @param path The path of the control group.
+ * @param pid The process identifier.
+ */
+void add_to_cgroup(const std::string& path, pid_t pid);
+
+/** Returns the processes that belong to a control group.
+ *
+ * @param path The path of the control group.
+ * @return The process identifiers (empty if the group does not exist).
+ */
+std::vector<pid_t> cgroup_processes(const std::string& path);
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_CGROUP_H_
@@ -4,6 +4,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 namespace aser {
 namespace util {
@@ -33,7 +34,7 @@ public:
   void push(value_type&& value) {
     {
     std::lock_guard<std::mutex> lock(mutex_);
-    queue_.push(value);
+    queue_.push(std::move(value));
     }
     cv_.notify_one();
   }
@@ -77,6 +78,23 @@ public:
     return result;
   }
 
+  /** Pops all the values in the queue without blocking.
+   *
+   * The whole batch is taken with a single lock acquisition.
+   *
+   * @param values Vector where the values are appended (in queue order).
+   * @return The number of values popped.
+   */
+  size_t pop_all(std::vector<value_type>& values) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto n = queue_.size();
+    while (!queue_.empty()) {
+      values.push_back(std::move(queue_.front()));
+      queue_.pop();
+    }
+    return n;
+  }
+
 private:
   std::queue<T> queue_;
   std::mutex mutex_;
@@ -0,0 +1,136 @@
+#include "cpu_mapper.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+#include <util/os.h>
+
+namespace aser {
+namespace util {
+
+constexpr unsigned cpu_mapper::max_cpus;
+constexpr unsigned cpu_mapper::word_bits;
+constexpr unsigned cpu_mapper::nil;
+
+placement parse_placement(const std::string& name) {
+  static const std::map<std::string, placement> placements = {
+    {"compact", placement::COMPACT},
+    {"scatter", placement::SCATTER},
+    {"core", placement::CORE},
+    {"llc", placement::LLC}
+  };
+  auto it = placements.find(name);
+  if (it == end(placements))
+    throw std::invalid_argument("Invalid placement: " + name);
+  return it->second;
+}
+
+/** Sort key of a CPU for a placement strategy. */
+typedef std::tuple<unsigned, unsigned, unsigned, unsigned, unsigned>
+  placement_key;
+
+cpu_mapper::cpu_mapper(
+    const topology& topo,
+    placement strategy,
+    const std::vector<unsigned>& allowed)
+{
+  rank_.fill(nil);
+
+  // Position of every core in its cache domain, and of every cache domain
+  // in its node, so that strategies can round-robin over them.
+  std::map<unsigned, unsigned> core_rank, llc_rank;
+  std::map<unsigned, unsigned> llc_cores, node_llcs;
+  for (auto& info : topo.cpus()) {
+    if (core_rank.count(info.core) == 0)
+      core_rank[info.core] = llc_cores[info.llc]++;
+    if (llc_rank.count(info.llc) == 0)
+      llc_rank[info.llc] = node_llcs[info.node]++;
+  }
+
+  std::vector<std::pair<placement_key, unsigned>> cpus;
+  for (auto cpu : allowed) {
+    if (cpu >= max_cpus || !topo.contains(cpu))
+      continue;
+    auto& info = topo.find(cpu);
+    auto in_llc = core_rank[info.core];
+    auto in_node = llc_rank[info.llc];
+    placement_key key;
+    switch (strategy) {
+    case placement::COMPACT:
+      key = std::make_tuple(info.node, info.llc, info.core, info.thread, 0);
+      break;
+    case placement::SCATTER:
+      key = std::make_tuple(info.thread, in_llc, in_node, info.node, 0);
+      break;
+    case placement::CORE:
+      key = std::make_tuple(info.thread, info.node, info.llc, info.core, 0);
+      break;
+    case placement::LLC:
+      key = std::make_tuple(info.thread, in_llc, info.llc, 0, 0);
+      break;
+    }
+    cpus.emplace_back(key, cpu);
+  }
+  std::sort(begin(cpus), end(cpus));
+  cpus.erase(std::unique(begin(cpus), end(cpus)), end(cpus));
+
+  for (auto& elem : cpus) {
+    rank_[elem.second] = order_.size();
+    order_.push_back(elem.second);
+  }
+  for (unsigned rank = 0; rank < order_.size(); ++rank)
+    free_[rank / word_bits] |= uint64_t(1) << (rank % word_bits);
+  available_ = order_.size();
+}
+
+cpu_mapper cpu_mapper::create(
+    placement strategy,
+    const std::string& sysfs_root) {
+  return cpu_mapper{topology::read(sysfs_root), strategy, allowed_cpus()};
+}
+
+unsigned cpu_mapper::allocate() {
+  for (unsigned w = 0; w < free_.size(); ++w) {
+    if (free_[w] == 0)
+      continue;
+    auto rank = w * word_bits + __builtin_ctzll(free_[w]);
+    free_[w] &= free_[w] - 1;
+    --available_;
+    return order_[rank];
+  }
+  throw std::runtime_error("No available CPUs");
+}
+
+void cpu_mapper::release(unsigned cpu) {
+  if (cpu >= max_cpus || rank_[cpu] == nil)
+    throw std::invalid_argument("CPU not managed by the mapper");
+  auto rank = rank_[cpu];
+  auto bit = uint64_t(1) << (rank % word_bits);
+  if (free_[rank / word_bits] & bit)
+    throw std::invalid_argument("CPU is not allocated");
+  free_[rank / word_bits] |= bit;
+  ++available_;
+}
+
+std::vector<std::vector<unsigned>> cpu_mapper::cpu_sets(
+    unsigned width) const {
+  if (width == 0)
+    throw std::invalid_argument("CPU sets must not be empty");
+
+  std::vector<std::vector<unsigned>> sets;
+  for (size_t i = 0; i + width <= order_.size(); i += width)
+    sets.emplace_back(begin(order_) + i, begin(order_) + i + width);
+  return sets;
+}
+
+bool cpu_mapper::is_allocated(unsigned cpu) const {
+  if (cpu >= max_cpus || rank_[cpu] == nil)
+    return false;
+  auto rank = rank_[cpu];
+  return (free_[rank / word_bits] & (uint64_t(1) << (rank % word_bits))) == 0;
+}
+
+} // namespace util
+} // namespace aser
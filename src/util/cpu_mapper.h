@@ -0,0 +1,124 @@
+#ifndef UTIL_CPU_MAPPER_H_
+#define UTIL_CPU_MAPPER_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <util/topology.h>
+
+namespace aser {
+namespace util {
+
+/** Strategy to place tasks on CPUs.
+ *
+ * COMPACT: fills every core (all its SMT siblings), cache domain and node
+ *     before moving to the next one.
+ * SCATTER: spreads tasks across NUMA nodes, then across the cache domains
+ *     in every node, then across cores, using SMT siblings last.
+ * CORE: uses a single CPU in every core (in compact order) before using
+ *     SMT siblings.
+ * LLC: spreads tasks across last-level cache domains (regardless of their
+ *     node), using SMT siblings last.
+ */
+enum class placement { COMPACT, SCATTER, CORE, LLC };
+
+/** Parses a placement strategy ("compact", "scatter", "core" or "llc").
+ *
+ * @throw std::invalid_argument If the name is not valid.
+ */
+placement parse_placement(const std::string& name);
+
+/** Allocates CPUs to tasks following a placement strategy.
+ *
+ * The CPUs are ranked once according to the strategy, and every
+ * allocation returns the free CPU with the lowest rank. The free CPUs are
+ * kept in a bitmap indexed by rank, so that allocating and releasing a CPU
+ * take constant time (a scan of at most max_cpus / 64 words).
+ *
+ * This class is not thread-safe.
+ */
+class cpu_mapper {
+public:
+  /** Maximum number of CPUs. */
+  static constexpr unsigned max_cpus = 1024;
+
+  /** Constructor.
+   *
+   * @param topo The CPU topology.
+   * @param strategy The placement strategy.
+   * @param allowed CPUs that can be allocated (e.g., the affinity of the
+   *     process). CPUs outside the topology are ignored.
+   */
+  cpu_mapper(
+      const topology& topo,
+      placement strategy,
+      const std::vector<unsigned>& allowed);
+
+  /** Creates a mapper for the CPUs the calling process is allowed to run
+   * on.
+   *
+   * @param strategy The placement strategy.
+   * @param sysfs_root Mount point of sysfs.
+   */
+  static cpu_mapper create(
+      placement strategy,
+      const std::string& sysfs_root = "/sys");
+
+  /** Allocates a CPU.
+   *
+   * @return The CPU number.
+   * @throw std::runtime_error If there are no available CPUs.
+   */
+  unsigned allocate();
+
+  /** Releases an allocated CPU.
+   *
+   * @param cpu The CPU number.
+   */
+  void release(unsigned cpu);
+
+  /** Checks whether a CPU is allocated. */
+  bool is_allocated(unsigned cpu) const;
+
+  /** Returns the number of CPUs available for allocation. */
+  size_t available() const noexcept {
+    return available_;
+  }
+
+  /** Splits the CPUs managed by the mapper into sets of consecutive CPUs
+   * in order of allocation (e.g., SMT siblings and cores sharing a cache
+   * with compact placement). CPUs that do not fill a whole set are left
+   * out.
+   *
+   * @param width Number of CPUs in every set.
+   * @return The sets.
+   */
+  std::vector<std::vector<unsigned>> cpu_sets(unsigned width) const;
+
+  /** Returns the CPUs managed by the mapper, in order of allocation. */
+  const std::vector<unsigned>& order() const noexcept {
+    return order_;
+  }
+
+private:
+  static constexpr unsigned word_bits = 64;
+  static constexpr unsigned nil = ~0u;
+
+  /** CPU for every rank. */
+  std::vector<unsigned> order_;
+
+  /** Rank of every CPU (nil if the CPU is not managed). */
+  std::array<unsigned, max_cpus> rank_;
+
+  /** Bitmap of the free ranks. */
+  std::array<uint64_t, max_cpus / word_bits> free_ {};
+
+  size_t available_ { 0 };
+};
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_CPU_MAPPER_H_
@@ -0,0 +1,50 @@
+#include <util/futex.h>
+
+#ifndef __linux__
+#error This file must only be included in linux builds.
+#endif
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+
+#include <util/libc_wrapper.h>
+
+namespace aser {
+namespace util {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+    "Futex words must be 32-bit integers");
+
+void futex_wait(
+    std::atomic<uint32_t>& word,
+    uint32_t expected,
+    std::chrono::nanoseconds timeout) {
+  timespec ts;
+  timespec* tsp = nullptr;
+  if (timeout.count() >= 0) {
+    ts.tv_sec = timeout.count() / 1000000000;
+    ts.tv_nsec = timeout.count() % 1000000000;
+    tsp = &ts;
+  }
+
+  auto res = syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+      FUTEX_WAIT_PRIVATE, expected, tsp, nullptr, 0);
+  if (res == -1 && errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT)
+    libc_error("Error waiting on futex");
+}
+
+void futex_wake(std::atomic<uint32_t>& word) {
+  error_if_equal(
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+          FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0),
+      -1L,
+      "Error waking futex waiters");
+}
+
+} // namespace util
+} // namespace aser
@@ -1,5 +1,7 @@
 #include <util/os.h>
 
+#include <sys/syscall.h>
+
 #include <util/libc_wrapper.h>
 
 #ifndef __linux__
@@ -25,6 +27,69 @@ void bind_process(pid_t pid, unsigned cpu) {
       -1,
       "Error binding process to CPU");
 }
+
+void bind_process(pid_t pid, const std::vector<unsigned>& cpus) {
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (auto cpu : cpus)
+    CPU_SET(cpu, &mask);
+  error_if_equal(
+      sched_setaffinity(pid, sizeof(mask), &mask),
+      -1,
+      "Error binding process to CPUs");
+}
+
+void bind_thread(const std::vector<unsigned>& cpus) {
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (auto cpu : cpus)
+    CPU_SET(cpu, &mask);
+  // A pid of zero refers to the calling thread.
+  error_if_equal(
+      sched_setaffinity(0, sizeof(mask), &mask),
+      -1,
+      "Error binding thread to CPUs");
+}
+
+std::vector<unsigned> allowed_cpus(pid_t pid) {
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  error_if_equal(
+      sched_getaffinity(pid, sizeof(mask), &mask),
+      -1,
+      "Error getting the CPU affinity");
+
+  std::vector<unsigned> cpus;
+  for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &mask))
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+void move_pages(
+    pid_t pid,
+    const std::vector<uintptr_t>& pages,
+    int node,
+    std::vector<int>& status) {
+  // Value of MPOL_MF_MOVE (numaif.h is part of libnuma).
+  constexpr int move_flag = 1 << 1;
+  static_assert(sizeof(uintptr_t) == sizeof(void*), "Unexpected pointer size");
+
+  status.assign(pages.size(), 0);
+  if (pages.empty())
+    return;
+
+  std::vector<int> nodes;
+  if (node >= 0)
+    nodes.assign(pages.size(), node);
+  error_if_equal(
+      syscall(SYS_move_pages, pid, pages.size(), pages.data(),
+        nodes.empty() ? nullptr : nodes.data(), status.data(), move_flag),
+      static_cast<long>(-1),
+      "Error moving pages");
+}
+
 } // namespace util
 } // namespace aser
 
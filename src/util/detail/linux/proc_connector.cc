@@ -0,0 +1,188 @@
+#include <util/proc_connector.h>
+
+#ifndef __linux__
+#error This file must only be included in linux builds.
+#endif
+
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <util/libc_wrapper.h>
+#include <util/log.h>
+
+namespace aser {
+namespace util {
+
+proc_connector::proc_connector(callback_func callback)
+  : callback_{std::move(callback)}
+{}
+
+proc_connector::~proc_connector() {
+  if (thread_.joinable())
+    stop();
+}
+
+void proc_connector::start() {
+  assert(!thread_.joinable());
+  socket_ = error_if_equal(
+      ::socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR),
+      -1,
+      "Error creating netlink socket");
+
+  sockaddr_nl addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = CN_IDX_PROC;
+  addr.nl_pid = 0;
+  error_if_equal(
+      ::bind(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)),
+      -1,
+      "Error binding netlink socket");
+
+  // Events are multicast once the subscription message is processed, so no
+  // event is lost after this point.
+  subscribe(true);
+
+  stop_fd_ = error_if_equal(
+      eventfd(0, EFD_CLOEXEC),
+      -1,
+      "Error creating eventfd");
+  thread_ = std::thread(&proc_connector::run, this);
+}
+
+void proc_connector::stop() {
+  assert(thread_.joinable());
+  uint64_t value = 1;
+  error_if_not_equal(
+      ::write(stop_fd_, &value, sizeof(value)),
+      static_cast<ssize_t>(sizeof(value)),
+      "Error stopping the process connector");
+  thread_.join();
+
+  try {
+    subscribe(false);
+  } catch (const std::exception& e) {
+    LOG(e.what());
+  }
+
+  ::close(stop_fd_);
+  stop_fd_ = -1;
+  ::close(socket_);
+  socket_ = -1;
+}
+
+void proc_connector::subscribe(bool enable) {
+  constexpr auto payload_size = sizeof(cn_msg) + sizeof(proc_cn_mcast_op);
+  alignas(nlmsghdr) char buf[NLMSG_SPACE(payload_size)];
+  std::memset(buf, 0, sizeof(buf));
+
+  auto header = reinterpret_cast<nlmsghdr*>(buf);
+  header->nlmsg_len = NLMSG_LENGTH(payload_size);
+  header->nlmsg_pid = getpid();
+  header->nlmsg_type = NLMSG_DONE;
+
+  auto msg = reinterpret_cast<cn_msg*>(NLMSG_DATA(header));
+  msg->id.idx = CN_IDX_PROC;
+  msg->id.val = CN_VAL_PROC;
+  msg->len = sizeof(proc_cn_mcast_op);
+
+  auto op = reinterpret_cast<proc_cn_mcast_op*>(msg->data);
+  *op = enable ? PROC_CN_MCAST_LISTEN : PROC_CN_MCAST_IGNORE;
+
+  error_if_equal(
+      ::send(socket_, buf, header->nlmsg_len, 0),
+      static_cast<ssize_t>(-1),
+      "Error subscribing to process events");
+}
+
+void proc_connector::run() {
+  pollfd fds[2] = {
+    {socket_, POLLIN, 0},
+    {stop_fd_, POLLIN, 0}
+  };
+
+  alignas(nlmsghdr) char buf[4096];
+
+  while (true) {
+    if (::poll(fds, 2, -1) == -1)
+      continue;
+
+    if (fds[1].revents & POLLIN)
+      break;
+
+    sockaddr_nl from;
+    socklen_t from_len = sizeof(from);
+    auto len = ::recvfrom(socket_, buf, sizeof(buf), MSG_DONTWAIT,
+        reinterpret_cast<sockaddr*>(&from), &from_len);
+    if (len == -1) {
+      // The socket buffer overflowed, so some events were dropped.
+      if (errno == ENOBUFS)
+        LOG("Process events lost");
+      continue;
+    }
+
+    // Only the kernel can send process events.
+    if (from.nl_pid != 0)
+      continue;
+
+    for (auto header = reinterpret_cast<nlmsghdr*>(buf);
+         NLMSG_OK(header, len);
+         header = NLMSG_NEXT(header, len)) {
+      if (header->nlmsg_type == NLMSG_NOOP
+          || header->nlmsg_type == NLMSG_ERROR)
+        continue;
+
+      auto msg = reinterpret_cast<cn_msg*>(NLMSG_DATA(header));
+      if (msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC)
+        continue;
+
+      auto ev = reinterpret_cast<proc_event*>(msg->data);
+      switch (ev->what) {
+      case proc_event::PROC_EVENT_FORK:
+        callback_({
+            event::event_type::FORK,
+            ev->event_data.fork.child_pid,
+            ev->event_data.fork.child_tgid,
+            ev->event_data.fork.parent_pid,
+            ev->event_data.fork.parent_tgid,
+            0});
+        break;
+      case proc_event::PROC_EVENT_EXEC:
+        callback_({
+            event::event_type::EXEC,
+            ev->event_data.exec.process_pid,
+            ev->event_data.exec.process_tgid,
+            -1, -1, 0});
+        break;
+      case proc_event::PROC_EVENT_EXIT:
+        callback_({
+            event::event_type::EXIT,
+            ev->event_data.exit.process_pid,
+            ev->event_data.exit.process_tgid,
+            -1, -1,
+            static_cast<int>(ev->event_data.exit.exit_code)});
+        break;
+      case proc_event::PROC_EVENT_COMM:
+        callback_({
+            event::event_type::COMM,
+            ev->event_data.comm.process_pid,
+            ev->event_data.comm.process_tgid,
+            -1, -1, 0});
+        break;
+      default:
+        break;
+      }
+    }
+  }
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,121 @@
+#include <util/timer_service.h>
+
+#ifndef __linux__
+#error This file must only be included in linux builds.
+#endif
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cassert>
+
+#include <util/libc_wrapper.h>
+#include <util/log.h>
+
+namespace aser {
+namespace util {
+
+timer_service::timer_service(
+    std::chrono::nanoseconds resolution,
+    dispatcher_func dispatcher)
+  : resolution_{resolution}
+  , dispatcher_{std::move(dispatcher)}
+  , start_{clock::now()}
+{
+  if (resolution_ <= std::chrono::nanoseconds(0))
+    throw std::invalid_argument("Timer resolution must be positive");
+
+  timer_fd_ = error_if_equal(
+      timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK),
+      -1,
+      "Error creating timerfd");
+  stop_fd_ = error_if_equal(
+      eventfd(0, EFD_CLOEXEC),
+      -1,
+      "Error creating eventfd");
+  thread_ = std::thread(&timer_service::run, this);
+}
+
+timer_service::~timer_service() {
+  uint64_t value = 1;
+  if (::write(stop_fd_, &value, sizeof(value)) != sizeof(value))
+    std::terminate();
+  thread_.join();
+  ::close(stop_fd_);
+  ::close(timer_fd_);
+}
+
+void timer_service::arm(bool force) {
+  auto next = wheel_.next_expiry();
+  if (!force && next >= armed_)
+    return;
+
+  itimerspec spec {};
+  if (next != timer_wheel::never) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        start_.time_since_epoch() + next * resolution_).count();
+    // A zero value would disarm the timer.
+    if (ns <= 0)
+      ns = 1;
+    spec.it_value.tv_sec = ns / 1000000000;
+    spec.it_value.tv_nsec = ns % 1000000000;
+  }
+
+  // The steady clock uses CLOCK_MONOTONIC, so absolute times match.
+  error_if_equal(
+      timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr),
+      -1,
+      "Error arming timerfd");
+  armed_ = next;
+}
+
+void timer_service::run() {
+  pollfd fds[2] = {
+    {timer_fd_, POLLIN, 0},
+    {stop_fd_, POLLIN, 0}
+  };
+
+  std::vector<callback_func> expired;
+
+  while (true) {
+    if (::poll(fds, 2, -1) == -1)
+      continue;
+
+    if (fds[1].revents & POLLIN)
+      break;
+
+    uint64_t expirations;
+    if (::read(timer_fd_, &expirations, sizeof(expirations)) == -1)
+      continue;
+
+    {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wheel_.advance(now(), expired);
+    arm(true);
+    dispatching_ = true;
+    }
+
+    for (auto& callback : expired) {
+      try {
+        if (dispatcher_)
+          dispatcher_(std::move(callback));
+        else
+          callback();
+      } catch (const std::exception& e) {
+        LOG(boost::format("Error running timer callback: %1%") % e.what());
+      }
+    }
+    expired.clear();
+
+    {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dispatching_ = false;
+    }
+    dispatched_.notify_all();
+  }
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,61 @@
+#include <util/futex.h>
+
+#ifndef __APPLE__
+#error This file must only be included in OS X builds.
+#endif
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace aser {
+namespace util {
+
+/** Words are hashed into a fixed set of buckets, each with a mutex and a
+ * condition variable. Waking up the threads on a word may also wake up
+ * the threads on other words in the same bucket, which is allowed, as
+ * waits may return spuriously.
+ */
+namespace {
+
+struct bucket {
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+constexpr size_t num_buckets = 64;
+
+bucket& bucket_for(const std::atomic<uint32_t>& word) {
+  static bucket buckets[num_buckets];
+  auto address = reinterpret_cast<uintptr_t>(&word);
+  return buckets[std::hash<uintptr_t>()(address / sizeof(word)) % num_buckets];
+}
+
+} // namespace
+
+void futex_wait(
+    std::atomic<uint32_t>& word,
+    uint32_t expected,
+    std::chrono::nanoseconds timeout) {
+  auto& b = bucket_for(word);
+  std::unique_lock<std::mutex> lock(b.mutex);
+  // Wakers take the mutex after changing the word, so a change is either
+  // seen here or followed by a notification.
+  if (word.load() != expected)
+    return;
+  if (timeout.count() >= 0)
+    b.cv.wait_for(lock, timeout);
+  else
+    b.cv.wait(lock);
+}
+
+void futex_wake(std::atomic<uint32_t>& word) {
+  auto& b = bucket_for(word);
+  {
+  std::lock_guard<std::mutex> lock(b.mutex);
+  }
+  b.cv.notify_all();
+}
+
+} // namespace util
+} // namespace aser
@@ -41,6 +41,26 @@ void bind_process(pid_t pid, unsigned cpu) {
   throw std::logic_error("bind_process() is not supported on this platform");
 }
 
+void bind_process(pid_t pid, const std::vector<unsigned>& cpus) {
+  throw std::logic_error("bind_process() is not supported on this platform");
+}
+
+void bind_thread(const std::vector<unsigned>& cpus) {
+  throw std::logic_error("bind_thread() is not supported on this platform");
+}
+
+std::vector<unsigned> allowed_cpus(pid_t pid) {
+  throw std::logic_error("allowed_cpus() is not supported on this platform");
+}
+
+void move_pages(
+    pid_t pid,
+    const std::vector<uintptr_t>& pages,
+    int node,
+    std::vector<int>& status) {
+  throw std::logic_error("move_pages() is not supported on this platform");
+}
+
 } // namespace util
 } // namespace aser
 
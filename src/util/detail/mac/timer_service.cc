@@ -0,0 +1,82 @@
+#include <util/timer_service.h>
+
+#ifndef __APPLE__
+#error This file must only be included in OS X builds.
+#endif
+
+#include <util/log.h>
+
+namespace aser {
+namespace util {
+
+timer_service::timer_service(
+    std::chrono::nanoseconds resolution,
+    dispatcher_func dispatcher)
+  : resolution_{resolution}
+  , dispatcher_{std::move(dispatcher)}
+  , start_{clock::now()}
+{
+  if (resolution_ <= std::chrono::nanoseconds(0))
+    throw std::invalid_argument("Timer resolution must be positive");
+
+  thread_ = std::thread(&timer_service::run, this);
+}
+
+timer_service::~timer_service() {
+  {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stopping_ = true;
+  }
+  wakeup_.notify_one();
+  thread_.join();
+}
+
+void timer_service::arm(bool force) {
+  auto next = wheel_.next_expiry();
+  if (!force && next >= armed_)
+    return;
+
+  armed_ = next;
+  wakeup_.notify_one();
+}
+
+void timer_service::run() {
+  std::vector<callback_func> expired;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    armed_ = wheel_.next_expiry();
+    if (armed_ == timer_wheel::never) {
+      wakeup_.wait(lock);
+    } else {
+      // The wheel only needs to be advanced once the tick has started.
+      wakeup_.wait_until(lock, start_ + armed_ * resolution_);
+    }
+    if (stopping_)
+      break;
+
+    wheel_.advance(now(), expired);
+    if (expired.empty())
+      continue;
+
+    dispatching_ = true;
+    lock.unlock();
+    for (auto& callback : expired) {
+      try {
+        if (dispatcher_)
+          dispatcher_(std::move(callback));
+        else
+          callback();
+      } catch (const std::exception& e) {
+        LOG(boost::format("Error running timer callback: %1%") % e.what());
+      }
+    }
+    expired.clear();
+    lock.lock();
+    dispatching_ = false;
+    dispatched_.notify_all();
+  }
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,37 @@
+#ifndef UTIL_FUTEX_H_
+#define UTIL_FUTEX_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace aser {
+namespace util {
+
+/** Blocks the caller while a word keeps a given value.
+ *
+ * On Linux, this is a private futex wait. Elsewhere, waiters block on
+ * condition variables shared by the words hashed into the same bucket.
+ *
+ * The call may return spuriously, so callers must check the condition they
+ * are waiting for again.
+ *
+ * @param word The word.
+ * @param expected The value the word must have for the caller to block.
+ * @param timeout Maximum time to block (negative to block indefinitely).
+ */
+void futex_wait(
+    std::atomic<uint32_t>& word,
+    uint32_t expected,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+
+/** Wakes up the threads blocked on a word.
+ *
+ * @param word The word.
+ */
+void futex_wake(std::atomic<uint32_t>& word);
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_FUTEX_H_
@@ -0,0 +1,156 @@
+#include <thread>
+
+#include <util/futex.h>
+
+namespace aser {
+namespace util {
+
+template<typename T, producers Producers>
+mpsc_queue<T, Producers>::mpsc_queue(size_t capacity) {
+  size_t size = 2;
+  while (size < capacity)
+    size <<= 1;
+  mask_ = size - 1;
+
+  cells_.reset(new cell[size]);
+  for (size_t i = 0; i < size; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template<typename T, producers Producers>
+typename mpsc_queue<T, Producers>::cell* mpsc_queue<T, Producers>::claim() {
+  auto pos = tail_.load(std::memory_order_relaxed);
+
+  if (Producers == producers::SINGLE) {
+    auto& c = cells_[pos & mask_];
+    if (c.sequence.load(std::memory_order_acquire) != pos)
+      return nullptr;
+    tail_.store(pos + 1, std::memory_order_relaxed);
+    return &c;
+  }
+
+  while (true) {
+    auto& c = cells_[pos & mask_];
+    auto seq = c.sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (tail_.compare_exchange_weak(pos, pos + 1,
+            std::memory_order_relaxed))
+        return &c;
+    } else if (diff < 0) {
+      // The consumer has not freed the cell yet.
+      return nullptr;
+    } else {
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template<typename T, producers Producers>
+void mpsc_queue<T, Producers>::publish(cell* c, value_type&& value) {
+  c->value = std::move(value);
+  auto pos = c->sequence.load(std::memory_order_relaxed);
+  c->sequence.store(pos + 1, std::memory_order_release);
+  notify();
+}
+
+template<typename T, producers Producers>
+bool mpsc_queue<T, Producers>::try_push(value_type value) {
+  auto c = claim();
+  if (!c)
+    return false;
+  publish(c, std::move(value));
+  return true;
+}
+
+template<typename T, producers Producers>
+void mpsc_queue<T, Producers>::push(value_type value) {
+  cell* c;
+  while (!(c = claim()))
+    std::this_thread::yield();
+  publish(c, std::move(value));
+}
+
+template<typename T, producers Producers>
+void mpsc_queue<T, Producers>::notify() {
+  // Pairs with the fence in wait(): either the consumer sees the new value
+  // or this thread sees the consumer is waiting.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting_.load(std::memory_order_relaxed)) {
+    epoch_.fetch_add(1, std::memory_order_release);
+    futex_wake(epoch_);
+  }
+}
+
+template<typename T, producers Producers>
+bool mpsc_queue<T, Producers>::try_pop(value_type& value) {
+  auto& c = cells_[head_ & mask_];
+  if (c.sequence.load(std::memory_order_acquire) != head_ + 1)
+    return false;
+
+  value = std::move(c.value);
+  c.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+  ++head_;
+  return true;
+}
+
+template<typename T, producers Producers>
+bool mpsc_queue<T, Producers>::wait(std::chrono::nanoseconds timeout) {
+  auto epoch = epoch_.load(std::memory_order_acquire);
+  waiting_.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  auto& c = cells_[head_ & mask_];
+  bool ready = c.sequence.load(std::memory_order_acquire) == head_ + 1;
+  if (!ready)
+    futex_wait(epoch_, epoch, timeout);
+
+  waiting_.store(0, std::memory_order_relaxed);
+  return ready;
+}
+
+template<typename T, producers Producers>
+typename mpsc_queue<T, Producers>::value_type
+mpsc_queue<T, Producers>::pop() {
+  value_type value;
+  while (!try_pop(value))
+    wait(std::chrono::nanoseconds(-1));
+  return value;
+}
+
+template<typename T, producers Producers>
+template<class Rep, class Period>
+std::pair<bool, typename mpsc_queue<T, Producers>::value_type>
+mpsc_queue<T, Producers>::pop(
+    const std::chrono::duration<Rep, Period>& timeout) {
+  using clock = std::chrono::steady_clock;
+  auto deadline = clock::now() + timeout;
+
+  std::pair<bool, value_type> result{};
+  while (!try_pop(result.second)) {
+    auto remaining = deadline - clock::now();
+    if (remaining <= clock::duration::zero())
+      return result;
+    wait(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+  }
+  result.first = true;
+  return result;
+}
+
+template<typename T, producers Producers>
+size_t mpsc_queue<T, Producers>::pop_all(std::vector<value_type>& values) {
+  size_t n = 0;
+  while (true) {
+    auto& c = cells_[head_ & mask_];
+    if (c.sequence.load(std::memory_order_acquire) != head_ + 1)
+      break;
+    values.push_back(std::move(c.value));
+    c.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+    ++head_;
+    ++n;
+  }
+  return n;
+}
+
+} // namespace util
+} // namespace aser
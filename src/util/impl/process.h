@@ -63,7 +63,7 @@ void process<Config>::wait() {
   assert(!terminated());
 
   error_if_equal(
-      ::waitpid(pid_, &termination_status_, 0),
+      ::wait4(pid_, &termination_status_, 0, &resource_usage_),
       -1,
       "Error waiting for process");
 
@@ -84,6 +84,12 @@ int process<Config>::termination_status() const noexcept {
   return termination_status_;
 }
 
+template<typename Config>
+const rusage& process<Config>::resource_usage() const noexcept {
+  assert(terminated());
+  return resource_usage_;
+}
+
 template<typename Config>
 bool process<Config>::started() const noexcept {
   return pid_ != -1;
@@ -17,6 +17,14 @@ void kill_group(pid_t pid) {
   error_if_equal(::kill(-gid, SIGKILL), -1, "Error killing a process group");
 }
 
+void suspend(pid_t pid) {
+  error_if_equal(::kill(pid, SIGSTOP), -1, "Error suspending a process");
+}
+
+void resume(pid_t pid) {
+  error_if_equal(::kill(pid, SIGCONT), -1, "Error resuming a process");
+}
+
 } // namespace util
 } // namespace aser
 
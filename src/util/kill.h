@@ -23,6 +23,21 @@ void kill(pid_t pid);
  */
 void kill_group(pid_t pid);
 
+/** Suspends a process.
+ *
+ * The process is sent SIGSTOP, so it remains stopped until it receives
+ * SIGCONT or it is killed.
+ *
+ * @param pid The identifier of the process to suspend.
+ */
+void suspend(pid_t pid);
+
+/** Resumes a suspended process.
+ *
+ * @param pid The identifier of the process to resume.
+ */
+void resume(pid_t pid);
+
 } // namespace util
 } // namespace aser
 
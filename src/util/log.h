@@ -6,8 +6,31 @@
 #include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
 
+/** Log levels for ASER_LOG_LEVEL. Statements below the level are removed
+ * at compile time, and their arguments are not evaluated. */
+#define ASER_LOG_LEVEL_DEBUG 0
+#define ASER_LOG_LEVEL_INFO 1
+#define ASER_LOG_LEVEL_NONE 2
+
+#ifndef ASER_LOG_LEVEL
+#define ASER_LOG_LEVEL ASER_LOG_LEVEL_DEBUG
+#endif
+
+#if ASER_LOG_LEVEL <= ASER_LOG_LEVEL_DEBUG
+#include <util/async_log.h>
 #define LOG(x) BOOST_LOG_TRIVIAL(debug) << x
+/** Debug log for hot paths: the arguments are copied into a per-thread
+ * buffer, and they are formatted by a background thread (see async_log). */
+#define LOG_ASYNC(...) ::aser::util::async_log::write(__VA_ARGS__)
+#else
+#define LOG(x) static_cast<void>(0)
+#define LOG_ASYNC(...) static_cast<void>(0)
+#endif
+
+#if ASER_LOG_LEVEL <= ASER_LOG_LEVEL_INFO
 #define LOGI(x) BOOST_LOG_TRIVIAL(info) << x
+#else
+#define LOGI(x) static_cast<void>(0)
+#endif
 
 #endif // UTIL_LOG_H_
-
@@ -0,0 +1,166 @@
+#ifndef UTIL_MPSC_QUEUE_H_
+#define UTIL_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** Number of producers a queue supports. */
+enum class producers { SINGLE, MULTIPLE };
+
+/** Size of a cache line, used to keep hot fields apart. */
+constexpr size_t cache_line_size = 64;
+
+/** A bounded lock-free queue with a single consumer.
+ *
+ * The queue is a ring of cells, each with a sequence number that tells
+ * producers and the consumer whether the cell is free or holds a value.
+ * Producers and the consumer never take a lock. With a single producer,
+ * the producer does not need atomic read-modify-write operations either.
+ *
+ * The consumer only blocks (on a futex) when the queue is empty. Producers
+ * never block unless the queue is full, in which case they yield until the
+ * consumer makes room.
+ *
+ * @tparam T Value type (default constructible and move assignable).
+ * @tparam Producers Number of producers.
+ */
+template<typename T, producers Producers = producers::MULTIPLE>
+class mpsc_queue {
+public:
+  typedef T value_type;
+
+  /** Constructor.
+   *
+   * @param capacity Minimum number of values the queue can hold (it is
+   *     rounded up to a power of two).
+   */
+  explicit mpsc_queue(size_t capacity = 1024);
+
+  /** Pushes a value into the queue without blocking.
+   *
+   * @param value The value to push.
+   * @return True if the value was pushed; false if the queue is full.
+   */
+  bool try_push(value_type value);
+
+  /** Pushes a value into the queue.
+   *
+   * If the queue is full, the caller yields until there is room.
+   *
+   * @param value The value to push.
+   */
+  void push(value_type value);
+
+  /** Pops the value at the front of the queue without blocking.
+   *
+   * @param value Where to store the value.
+   * @return True if a value was popped; false if the queue is empty.
+   */
+  bool try_pop(value_type& value);
+
+  /** Pops the value at the front of the queue.
+   *
+   * If the queue is empty, the caller will block.
+   *
+   * @return The value at the front of the queue.
+   */
+  value_type pop();
+
+  /** Pops the value at the front of the queue.
+   *
+   * If the queue is empty, the caller will block until an element becomes
+   * available, or until the timeout expires.
+   *
+   * @param timeout Timeout to wait before the call fails.
+   * @return A pair consisting of a boolean indicating whether the call
+   *     succeeded (i.e., an element was found), and the element found (only
+   *     valid if the call succeeded).
+   */
+  template<class Rep, class Period>
+  std::pair<bool, value_type> pop(
+      const std::chrono::duration<Rep, Period>& timeout);
+
+  /** Pops all the values in the queue without blocking.
+   *
+   * @param values Vector where the values are appended (in queue order).
+   * @return The number of values popped.
+   */
+  size_t pop_all(std::vector<value_type>& values);
+
+  /** Returns the maximum number of values the queue can hold. */
+  size_t capacity() const noexcept {
+    return mask_ + 1;
+  }
+
+private:
+  struct cell {
+    std::atomic<size_t> sequence;
+    value_type value;
+  };
+
+  // Hot fields are padded so that no two of them share a cache line, even
+  // if the queue itself is not aligned to a cache line.
+
+  /** Next position producers will claim. */
+  std::atomic<size_t> tail_ { 0 };
+  char tail_padding_[cache_line_size];
+
+  /** Next position the consumer will read. */
+  size_t head_ { 0 };
+  char head_padding_[cache_line_size];
+
+  /** Whether the consumer is about to block (or blocked). */
+  std::atomic<uint32_t> waiting_ { 0 };
+
+  /** Futex word the consumer blocks on. Producers change it to wake the
+   * consumer up. */
+  std::atomic<uint32_t> epoch_ { 0 };
+  char wait_padding_[cache_line_size];
+
+  size_t mask_;
+  std::unique_ptr<cell[]> cells_;
+
+  /** Claims a free cell for a producer.
+   *
+   * @return The claimed cell, or null if the queue is full.
+   */
+  cell* claim();
+
+  /** Stores a value in a claimed cell and makes it visible to the consumer.
+   *
+   * @param c The cell.
+   * @param value The value.
+   */
+  void publish(cell* c, value_type&& value);
+
+  /** Wakes the consumer up if it is blocked. */
+  void notify();
+
+  /** Blocks the consumer until a value might be available.
+   *
+   * @param timeout Maximum time to block (negative to block indefinitely).
+   * @return True if the queue is not empty anymore.
+   */
+  bool wait(std::chrono::nanoseconds timeout);
+
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+};
+
+/** A bounded lock-free queue with a single producer and a single consumer. */
+template<typename T>
+using spsc_queue = mpsc_queue<T, producers::SINGLE>;
+
+} // namespace util
+} // namespace aser
+
+#include <util/impl/mpsc_queue.h>
+
+#endif // UTIL_MPSC_QUEUE_H_
@@ -0,0 +1,99 @@
+#include "numa.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace aser {
+namespace util {
+
+std::vector<unsigned> parse_cpu_list(const std::string& list) {
+  std::vector<unsigned> cpus;
+  std::istringstream in(list);
+  std::string range;
+  while (std::getline(in, range, ',')) {
+    range.erase(std::remove_if(begin(range), end(range), ::isspace),
+        end(range));
+    if (range.empty())
+      continue;
+
+    auto dash = range.find('-');
+    auto first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+    auto last = dash == std::string::npos
+      ? first
+      : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+    if (last < first)
+      throw std::invalid_argument("Invalid CPU list: " + list);
+    for (auto cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+/** Reads a CPU list from a file (empty if the file does not exist). */
+static std::vector<unsigned> read_cpu_list(const fs::path& path) {
+  std::ifstream in(path.string());
+  std::string list;
+  if (!std::getline(in, list))
+    return {};
+  return parse_cpu_list(list);
+}
+
+/** Returns the CPUs in each NUMA node with CPUs, indexed by node
+ * identifier. */
+static std::map<unsigned, std::vector<unsigned>> read_nodes(
+    const fs::path& system_path) {
+  std::map<unsigned, std::vector<unsigned>> nodes;
+  boost::system::error_code ec;
+  for (fs::directory_iterator it(system_path / "node", ec), last;
+      !ec && it != last; it.increment(ec)) {
+    auto name = it->path().filename().string();
+    if (name.size() <= 4
+        || name.compare(0, 4, "node") != 0
+        || !std::all_of(begin(name) + 4, end(name), ::isdigit))
+      continue;
+    auto cpus = read_cpu_list(it->path() / "cpulist");
+    if (!cpus.empty())
+      nodes.emplace(std::stoul(name.substr(4)), std::move(cpus));
+  }
+  return nodes;
+}
+
+std::vector<std::vector<unsigned>> numa_nodes(const std::string& sysfs_root) {
+  auto system_path = fs::path(sysfs_root) / "devices" / "system";
+
+  std::vector<std::vector<unsigned>> result;
+  for (auto& node : read_nodes(system_path))
+    result.push_back(std::move(node.second));
+
+  if (result.empty()) {
+    auto cpus = read_cpu_list(system_path / "cpu" / "online");
+    if (cpus.empty()) {
+      for (unsigned cpu = 0;
+          cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+        cpus.push_back(cpu);
+    }
+    result.push_back(std::move(cpus));
+  }
+
+  return result;
+}
+
+std::vector<unsigned> numa_node_ids(const std::string& sysfs_root) {
+  std::vector<unsigned> ids;
+  for (auto& node : read_nodes(fs::path(sysfs_root) / "devices" / "system"))
+    ids.push_back(node.first);
+  if (ids.empty())
+    ids.push_back(0);
+  return ids;
+}
+
+} // namespace util
+} // namespace aser
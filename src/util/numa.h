@@ -0,0 +1,38 @@
+#ifndef UTIL_NUMA_H_
+#define UTIL_NUMA_H_
+
+#include <string>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** Parses a CPU list as formatted by the kernel (e.g., "0-3,8,10-11").
+ *
+ * @param list The CPU list.
+ * @return The CPUs in the list.
+ */
+std::vector<unsigned> parse_cpu_list(const std::string& list);
+
+/** Returns the CPUs in each NUMA node.
+ *
+ * If the system does not expose NUMA information, all the online CPUs are
+ * returned as a single node.
+ *
+ * @param sysfs_root Mount point of sysfs.
+ * @return The CPUs for each node with CPUs (in order of node identifier).
+ */
+std::vector<std::vector<unsigned>> numa_nodes(
+    const std::string& sysfs_root = "/sys");
+
+/** Returns the identifier of each NUMA node with CPUs, in the same order
+ * as numa_nodes() (zero if the system does not expose NUMA information).
+ *
+ * @param sysfs_root Mount point of sysfs.
+ */
+std::vector<unsigned> numa_node_ids(const std::string& sysfs_root = "/sys");
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_NUMA_H_
@@ -3,6 +3,9 @@
 
 #include <unistd.h>
 
+#include <cstdint>
+#include <vector>
+
 namespace aser {
 namespace util {
 
@@ -15,6 +18,13 @@ void pipe2(int fd[2], int flags);
  */
 void bind_process(pid_t pid, unsigned cpu);
 
+/** Binds the process matching the given pid to a set of CPUs.
+ *
+ * @param pid The process identifier.
+ * @param cpus The virtual CPUs.
+ */
+void bind_process(pid_t pid, const std::vector<unsigned>& cpus);
+
 /** Binds the given process to the given CPU.
  *
  * @param pid The process.
@@ -25,6 +35,35 @@ void bind_process(const Process& p, unsigned cpu) {
   bind_process(p.pid(), cpu);
 }
 
+/** Binds the calling thread to a set of CPUs.
+ *
+ * @param cpus The virtual CPUs.
+ */
+void bind_thread(const std::vector<unsigned>& cpus);
+
+/** Returns the CPUs a process is allowed to run on.
+ *
+ * @param pid The process identifier (zero for the calling thread).
+ * @return The virtual CPUs (sorted).
+ */
+std::vector<unsigned> allowed_cpus(pid_t pid = 0);
+
+/** Moves pages of a process to a NUMA node, or finds out where they are.
+ *
+ * @param pid The process identifier.
+ * @param pages The addresses of the pages.
+ * @param node The node identifier, or a negative value to leave the pages
+ *     where they are.
+ * @param status Vector where the node of every page is stored afterwards
+ *     (a negative error number for pages that could not be moved or are
+ *     not present).
+ */
+void move_pages(
+    pid_t pid,
+    const std::vector<uintptr_t>& pages,
+    int node,
+    std::vector<int>& status);
+
 } // namespace util
 } // namespace aser
 
@@ -0,0 +1,101 @@
+#include "page_hotness.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace aser {
+namespace util {
+
+constexpr uintptr_t page_hotness::empty;
+
+page_hotness::page_hotness(size_t capacity, size_t page_size)
+  : capacity_{capacity}
+  , page_size_{page_size}
+{
+  if (capacity_ == 0)
+    throw std::invalid_argument("Page hotness capacity must be positive");
+  if (page_size_ == 0 || (page_size_ & (page_size_ - 1)) != 0)
+    throw std::invalid_argument("Page size must be a power of two");
+
+  size_t buckets = 1;
+  while (buckets < 2 * capacity_)
+    buckets *= 2;
+  table_.assign(buckets, hot_page{empty, 0});
+  scratch_.reserve(capacity_);
+}
+
+size_t page_hotness::find(uintptr_t page) const {
+  auto mask = table_.size() - 1;
+  // Fibonacci hashing spreads consecutive pages across the table.
+  auto i = static_cast<size_t>(
+      (page / page_size_) * UINT64_C(11400714819323198485)) & mask;
+  while (table_[i].page != empty && table_[i].page != page)
+    i = (i + 1) & mask;
+  return i;
+}
+
+void page_hotness::add(uintptr_t address) {
+  auto page = address & ~static_cast<uintptr_t>(page_size_ - 1);
+  if (page == empty)
+    return;
+
+  auto i = find(page);
+  if (table_[i].page == page) {
+    if (table_[i].count < UINT32_MAX)
+      ++table_[i].count;
+    return;
+  }
+
+  if (size_ == capacity_) {
+    auto coldest = UINT32_MAX;
+    for (auto& entry : table_) {
+      if (entry.page != empty)
+        coldest = std::min(coldest, entry.count);
+    }
+    rebuild(coldest, 1);
+    i = find(page);
+  }
+  table_[i] = {page, 1};
+  ++size_;
+}
+
+void page_hotness::decay() {
+  rebuild(1, 2);
+}
+
+void page_hotness::rebuild(uint32_t min_count, uint32_t divisor) {
+  scratch_.clear();
+  for (auto& entry : table_) {
+    if (entry.page != empty && entry.count > min_count)
+      scratch_.push_back({entry.page, entry.count / divisor});
+  }
+
+  std::fill(begin(table_), end(table_), hot_page{empty, 0});
+  for (auto& entry : scratch_)
+    table_[find(entry.page)] = entry;
+  size_ = scratch_.size();
+}
+
+void page_hotness::hottest(size_t n, std::vector<hot_page>& pages) const {
+  pages.clear();
+  for (auto& entry : table_) {
+    if (entry.page != empty)
+      pages.push_back(entry);
+  }
+
+  auto hotter = [](const hot_page& a, const hot_page& b) {
+    return a.count > b.count || (a.count == b.count && a.page < b.page);
+  };
+  n = std::min(n, pages.size());
+  std::partial_sort(begin(pages), begin(pages) + n, end(pages), hotter);
+  pages.resize(n);
+}
+
+uint32_t page_hotness::count(uintptr_t address) const {
+  auto page = address & ~static_cast<uintptr_t>(page_size_ - 1);
+  auto& entry = table_[find(page)];
+  return entry.page == page && page != empty ? entry.count : 0;
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,91 @@
+#ifndef UTIL_PAGE_HOTNESS_H_
+#define UTIL_PAGE_HOTNESS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** A page and the number of accesses sampled in it. */
+struct hot_page {
+  uintptr_t page;
+  uint32_t count;
+};
+
+/** Bounded map from pages to the number of accesses sampled in them.
+ *
+ * The map is an open-addressing hash table with room for a fixed number of
+ * pages, allocated on construction. When the table is full, the coldest
+ * pages are dropped to make room for new ones. Counts decay by halving
+ * them (see decay()), so that the map follows the recent accesses.
+ */
+class page_hotness {
+public:
+  /** Constructor.
+   *
+   * @param capacity Maximum number of pages.
+   * @param page_size Size of a page (a power of two).
+   */
+  explicit page_hotness(size_t capacity, size_t page_size = 4096);
+
+  /** Adds an access to an address. */
+  void add(uintptr_t address);
+
+  /** Halves every count, dropping the pages that reach zero. */
+  void decay();
+
+  /** Returns the hottest pages.
+   *
+   * @param n Maximum number of pages.
+   * @param pages Vector where the pages are stored, from hottest to
+   *     coldest (it is cleared first).
+   */
+  void hottest(size_t n, std::vector<hot_page>& pages) const;
+
+  /** Returns the count of a page (zero if not present). */
+  uint32_t count(uintptr_t address) const;
+
+  /** Returns the number of pages. */
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+  size_t page_size() const noexcept {
+    return page_size_;
+  }
+
+private:
+  /** Value of the page in an empty entry (address zero is never mapped). */
+  static constexpr uintptr_t empty = 0;
+
+  size_t capacity_;
+  size_t page_size_;
+  size_t size_ { 0 };
+
+  /** Hash table (twice the capacity, rounded up to a power of two). */
+  std::vector<hot_page> table_;
+
+  /** Scratch space to rebuild the table. */
+  std::vector<hot_page> scratch_;
+
+  /** Returns the entry for a page, or the empty entry where it belongs. */
+  size_t find(uintptr_t page) const;
+
+  /** Rebuilds the table, keeping the pages above a count.
+   *
+   * @param min_count Count of the pages dropped (and below).
+   * @param divisor Value every count is divided by.
+   */
+  void rebuild(uint32_t min_count, uint32_t divisor);
+};
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_PAGE_HOTNESS_H_
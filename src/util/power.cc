@@ -0,0 +1,93 @@
+#include "power.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace aser {
+namespace util {
+
+static fs::path cpufreq_path(const std::string& sysfs_root, unsigned cpu) {
+  return fs::path(sysfs_root) / "devices" / "system" / "cpu"
+    / ("cpu" + std::to_string(cpu)) / "cpufreq";
+}
+
+std::vector<unsigned> cpu_frequencies(
+    const std::string& sysfs_root,
+    unsigned cpu) {
+  auto path = cpufreq_path(sysfs_root, cpu);
+
+  std::vector<unsigned> frequencies;
+  std::ifstream available((path / "scaling_available_frequencies").string());
+  unsigned frequency;
+  while (available >> frequency)
+    frequencies.push_back(frequency);
+
+  if (frequencies.empty()) {
+    for (auto name : {"cpuinfo_min_freq", "cpuinfo_max_freq"}) {
+      std::ifstream in((path / name).string());
+      if (in >> frequency)
+        frequencies.push_back(frequency);
+    }
+  }
+
+  std::sort(begin(frequencies), end(frequencies));
+  frequencies.erase(
+      std::unique(begin(frequencies), end(frequencies)),
+      end(frequencies));
+  return frequencies;
+}
+
+unsigned max_frequency(const std::string& sysfs_root, unsigned cpu) {
+  std::ifstream in(
+      (cpufreq_path(sysfs_root, cpu) / "scaling_max_freq").string());
+  unsigned frequency;
+  return in >> frequency ? frequency : 0;
+}
+
+void set_max_frequency(
+    const std::string& sysfs_root,
+    unsigned cpu,
+    unsigned frequency) {
+  std::ofstream out(
+      (cpufreq_path(sysfs_root, cpu) / "scaling_max_freq").string());
+  out << frequency << std::endl;
+  if (!out)
+    throw std::runtime_error(boost::str(
+        boost::format("Error setting the frequency of CPU %1%") % cpu));
+}
+
+double package_energy(const std::string& sysfs_root) {
+  auto powercap = fs::path(sysfs_root) / "class" / "powercap";
+
+  // Packages are top-level domains (e.g., intel-rapl:0); their
+  // subdomains (e.g., intel-rapl:0:0) are already included.
+  double energy = 0;
+  bool found = false;
+  boost::system::error_code ec;
+  for (fs::directory_iterator it(powercap, ec), last;
+      !ec && it != last; it.increment(ec)) {
+    auto name = it->path().filename().string();
+    auto colon = name.find(':');
+    if (colon == std::string::npos
+        || name.find(':', colon + 1) != std::string::npos)
+      continue;
+
+    std::ifstream in((it->path() / "energy_uj").string());
+    double uj;
+    if (!(in >> uj))
+      continue;
+    energy += uj / 1e6;
+    found = true;
+  }
+  return found ? energy : -1;
+}
+
+} // namespace util
+} // namespace aser
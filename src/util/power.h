@@ -0,0 +1,57 @@
+#ifndef UTIL_POWER_H_
+#define UTIL_POWER_H_
+
+#include <string>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** Returns the frequencies a CPU can run at (kHz, in increasing order).
+ *
+ * The frequencies listed by the cpufreq driver are returned if available.
+ * Otherwise, the minimum and maximum frequencies are returned.
+ *
+ * @param sysfs_root Mount point of sysfs.
+ * @param cpu The CPU.
+ * @return The frequencies (empty if frequency scaling is not supported).
+ */
+std::vector<unsigned> cpu_frequencies(
+    const std::string& sysfs_root = "/sys",
+    unsigned cpu = 0);
+
+/** Returns the current frequency limit of a CPU.
+ *
+ * @param sysfs_root Mount point of sysfs.
+ * @param cpu The CPU.
+ * @return The maximum frequency (kHz), or zero if it cannot be read.
+ */
+unsigned max_frequency(const std::string& sysfs_root, unsigned cpu);
+
+/** Limits the frequency of a CPU.
+ *
+ * @param sysfs_root Mount point of sysfs.
+ * @param cpu The CPU.
+ * @param frequency Maximum frequency (kHz).
+ * @throw std::runtime_error If the limit cannot be set.
+ */
+void set_max_frequency(
+    const std::string& sysfs_root,
+    unsigned cpu,
+    unsigned frequency);
+
+/** Returns the energy consumed by all the packages (joules), as counted by
+ * the RAPL domains exposed through powercap.
+ *
+ * Counters wrap around, so only differences between close reads are
+ * meaningful (a negative difference means that a counter wrapped).
+ *
+ * @param sysfs_root Mount point of sysfs.
+ * @return The energy, or a negative value if it cannot be read.
+ */
+double package_energy(const std::string& sysfs_root = "/sys");
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_POWER_H_
@@ -0,0 +1,129 @@
+#include "proc.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace aser {
+namespace util {
+
+/** Returns the numeric entries of a directory (e.g., pids in /proc). */
+static std::vector<pid_t> numeric_entries(const fs::path& path) {
+  std::vector<pid_t> ids;
+  boost::system::error_code ec;
+  for (fs::directory_iterator it(path, ec), last; !ec && it != last;
+      it.increment(ec)) {
+    auto name = it->path().filename().string();
+    if (!name.empty()
+        && std::all_of(begin(name), end(name), ::isdigit))
+      ids.push_back(std::stoi(name));
+  }
+  std::sort(begin(ids), end(ids));
+  return ids;
+}
+
+std::vector<pid_t> threads(pid_t pid) {
+  return numeric_entries(fs::path("/proc") / std::to_string(pid) / "task");
+}
+
+std::vector<pid_t> children(pid_t pid) {
+  // Each thread keeps its own list of children. These lists are only
+  // available if the kernel was built with CONFIG_PROC_CHILDREN; otherwise,
+  // all the processes have to be scanned.
+  auto task_path = fs::path("/proc") / std::to_string(pid) / "task";
+  std::vector<pid_t> result;
+  bool children_available = true;
+  for (auto tid : threads(pid)) {
+    std::ifstream in((task_path / std::to_string(tid) / "children").string());
+    if (!in) {
+      children_available = false;
+      break;
+    }
+    pid_t child;
+    while (in >> child)
+      result.push_back(child);
+  }
+
+  if (!children_available) {
+    result.clear();
+    for (auto p : numeric_entries("/proc")) {
+      if (parent(p) == pid)
+        result.push_back(p);
+    }
+  }
+
+  std::sort(begin(result), end(result));
+  return result;
+}
+
+/** Returns the fields in /proc/<pid>/stat that follow the command name,
+ * starting with the state (field 3). */
+static std::vector<std::string> stat_fields(pid_t pid) {
+  std::ifstream in("/proc/" + std::to_string(pid) + "/stat");
+  std::string stat;
+  if (!std::getline(in, stat))
+    return {};
+
+  // The command name may contain spaces and parentheses, so parsing starts
+  // after the last closing parenthesis: ") <state> <ppid> ...".
+  auto pos = stat.rfind(')');
+  if (pos == std::string::npos)
+    return {};
+
+  std::istringstream fields_in(stat.substr(pos + 1));
+  std::vector<std::string> fields;
+  std::string field;
+  while (fields_in >> field)
+    fields.push_back(field);
+  return fields;
+}
+
+pid_t parent(pid_t pid) {
+  // This is called for every process when scanning /proc, so only the
+  // start of the line is parsed.
+  std::ifstream in("/proc/" + std::to_string(pid) + "/stat");
+  std::string stat;
+  if (!std::getline(in, stat))
+    return -1;
+
+  auto pos = stat.rfind(')');
+  if (pos == std::string::npos || pos + 4 >= stat.size())
+    return -1;
+  return std::stoi(stat.substr(pos + 4));
+}
+
+int last_cpu(pid_t pid) {
+  // The processor is field 39.
+  auto fields = stat_fields(pid);
+  if (fields.size() < 37)
+    return -1;
+  return std::stoi(fields[36]);
+}
+
+std::vector<pid_t> process_tree(pid_t root) {
+  if (parent(root) == -1)
+    return {};
+
+  // Scanning /proc once is cheaper than scanning it for every process in
+  // the tree when the children lists are not available.
+  std::multimap<pid_t, pid_t> parent_map;
+  for (auto p : numeric_entries("/proc"))
+    parent_map.emplace(parent(p), p);
+
+  std::vector<pid_t> tree = {root};
+  for (size_t i = 0; i < tree.size(); ++i) {
+    auto range = parent_map.equal_range(tree[i]);
+    for (auto it = range.first; it != range.second; ++it)
+      tree.push_back(it->second);
+  }
+  return tree;
+}
+
+} // namespace util
+} // namespace aser
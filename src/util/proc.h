@@ -0,0 +1,50 @@
+#ifndef UTIL_PROC_H_
+#define UTIL_PROC_H_
+
+#include <unistd.h>
+
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** Returns the threads of a process.
+ *
+ * @param pid The process identifier.
+ * @return The thread identifiers (empty if the process does not exist).
+ */
+std::vector<pid_t> threads(pid_t pid);
+
+/** Returns the children of a process.
+ *
+ * @param pid The process identifier.
+ * @return The identifiers of the child processes.
+ */
+std::vector<pid_t> children(pid_t pid);
+
+/** Returns the parent of a process.
+ *
+ * @param pid The process identifier.
+ * @return The parent process identifier, or -1 if the process does not
+ *         exist.
+ */
+pid_t parent(pid_t pid);
+
+/** Returns the CPU a process last ran on.
+ *
+ * @param pid The process identifier.
+ * @return The CPU, or -1 if the process does not exist.
+ */
+int last_cpu(pid_t pid);
+
+/** Returns the process tree rooted at a given process.
+ *
+ * @param root The identifier of the root process.
+ * @return The identifiers of the processes in the tree (root first).
+ */
+std::vector<pid_t> process_tree(pid_t root);
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_PROC_H_
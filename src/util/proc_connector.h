@@ -0,0 +1,94 @@
+#ifndef UTIL_PROC_CONNECTOR_H_
+#define UTIL_PROC_CONNECTOR_H_
+
+#include <unistd.h>
+
+#include <functional>
+#include <thread>
+
+namespace aser {
+namespace util {
+
+/** Process connector.
+ *
+ * This class subscribes to the process events the kernel multicasts for
+ * every process in the system (fork, exec, exit and comm changes), and runs
+ * a thread that invokes a callback for each of them. Subscribing requires
+ * the CAP_NET_ADMIN capability.
+ */
+class proc_connector {
+public:
+  /** A process event. */
+  struct event {
+    enum class event_type { FORK, EXEC, EXIT, COMM };
+
+    event_type type;
+
+    /** Thread identifier (the child thread for FORK events). */
+    pid_t pid;
+
+    /** Process identifier (the child process for FORK events). */
+    pid_t tgid;
+
+    /** Thread that called fork (only for FORK events). */
+    pid_t parent_pid;
+
+    /** Process that called fork (only for FORK events). */
+    pid_t parent_tgid;
+
+    /** Exit status, as returned by wait (only for EXIT events). */
+    int exit_code;
+  };
+
+  using callback_func = std::function<void(const event&)>;
+
+  /** Constructor.
+   *
+   * @param callback Function to call for every event.
+   */
+  proc_connector(callback_func callback);
+
+  /** Destructor.
+   *
+   * The listener thread is stopped if it is still running.
+   */
+  ~proc_connector();
+
+  /** Subscribes to the process events and starts the listener thread.
+   *
+   * When this method returns every event that takes place is reported.
+   */
+  void start();
+
+  /** Unsubscribes from the process events and stops the listener thread. */
+  void stop();
+
+private:
+  /** Function to call on every event. */
+  callback_func callback_;
+
+  /** Netlink socket. */
+  int socket_ { -1 };
+
+  /** File descriptor used to wake up the listener when stopping. */
+  int stop_fd_ { -1 };
+
+  /** Listener thread. */
+  std::thread thread_;
+
+  void run();
+
+  /** Enables or disables the multicast of process events.
+   *
+   * @param enable Whether to enable the events.
+   */
+  void subscribe(bool enable);
+
+  proc_connector(const proc_connector&) = delete;
+  proc_connector& operator=(const proc_connector&) = delete;
+};
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_PROC_CONNECTOR_H_
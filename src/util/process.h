@@ -2,6 +2,7 @@
 #define UTIL_PROCESS_H_
 
 #include <fcntl.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #include <array>
@@ -165,6 +166,9 @@ public:
   /** Returns the termination status. */
   int termination_status() const noexcept;
 
+  /** Returns the resources used by the process (once it has terminated). */
+  const rusage& resource_usage() const noexcept;
+
 private:
   /** Process configuration. */
   Config config_;
@@ -178,6 +182,9 @@ private:
   /** Termination status. */
   int termination_status_;
 
+  /** Resources used by the process. */
+  rusage resource_usage_ {};
+
   /** Whether the process is terminated. */
   bool terminated_ { false };
 };
@@ -238,6 +245,10 @@ public:
     return process_.termination_status();
   }
 
+  const rusage& resource_usage() const noexcept {
+    return process_.resource_usage();
+  }
+
 private:
   process<process_config> process_;
 
@@ -0,0 +1,140 @@
+#include "resctrl.h"
+
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "libc_wrapper.h"
+
+namespace aser {
+namespace util {
+
+/** Reads the domains of a resource from the schemata of the default group
+ * (e.g., "L3:0=fffff;1=fffff"). */
+static std::vector<unsigned> read_domains(
+    const std::string& root,
+    const std::string& resource) {
+  std::vector<unsigned> domains;
+  std::ifstream schemata(root + "/schemata");
+  std::string line;
+  auto prefix = resource + ":";
+  while (std::getline(schemata, line)) {
+    auto start = line.find_first_not_of(' ');
+    if (start == std::string::npos
+        || line.compare(start, prefix.size(), prefix) != 0)
+      continue;
+    std::istringstream in(line.substr(start + prefix.size()));
+    std::string domain;
+    while (std::getline(in, domain, ';'))
+      domains.push_back(std::stoul(domain));
+  }
+  if (domains.empty())
+    throw std::runtime_error(
+        "No " + resource + " domains in " + root + "/schemata");
+  return domains;
+}
+
+l3_allocation_info read_l3_allocation_info(const std::string& root) {
+  std::ifstream mask_in(root + "/info/L3/cbm_mask");
+  std::string mask;
+  if (!(mask_in >> mask))
+    throw std::runtime_error("Cache allocation is not supported");
+
+  l3_allocation_info info;
+  info.ways = 0;
+  for (auto bits = std::stoull(mask, nullptr, 16); bits != 0; bits >>= 1)
+    info.ways += bits & 1;
+
+  std::ifstream min_in(root + "/info/L3/min_cbm_bits");
+  if (!(min_in >> info.min_ways))
+    info.min_ways = 1;
+
+  info.domains = read_domains(root, "L3");
+  return info;
+}
+
+mb_allocation_info read_mb_allocation_info(const std::string& root) {
+  mb_allocation_info info;
+  std::ifstream min_in(root + "/info/MB/min_bandwidth");
+  if (!(min_in >> info.min_bandwidth))
+    throw std::runtime_error("Memory bandwidth allocation is not supported");
+
+  std::ifstream gran_in(root + "/info/MB/bandwidth_gran");
+  if (!(gran_in >> info.granularity) || info.granularity == 0)
+    info.granularity = 10;
+
+  info.domains = read_domains(root, "MB");
+  return info;
+}
+
+void create_resctrl_group(const std::string& path) {
+  if (::mkdir(path.c_str(), 0755) == -1 && errno != EEXIST)
+    libc_error(boost::str(
+        boost::format("Error creating resctrl group %1%") % path));
+}
+
+void remove_resctrl_group(const std::string& path) {
+  error_if_equal(
+      ::rmdir(path.c_str()),
+      -1,
+      boost::str(boost::format("Error removing resctrl group %1%") % path));
+}
+
+void add_to_resctrl_group(const std::string& path, pid_t tid) {
+  std::ofstream out(path + "/tasks");
+  out << tid << std::endl;
+  if (!out)
+    throw std::runtime_error(boost::str(
+        boost::format("Error adding task %1% to resctrl group %2%")
+        % tid % path));
+}
+
+void set_l3_ways(
+    const std::string& path,
+    const std::vector<unsigned>& domains,
+    unsigned first,
+    unsigned ways) {
+  if (ways == 0 || first + ways > 64)
+    throw std::invalid_argument("Invalid ways");
+  auto mask = ((ways == 64 ? 0 : uint64_t(1) << ways) - 1) << first;
+
+  std::ostringstream schemata;
+  schemata << "L3:";
+  for (size_t i = 0; i < domains.size(); ++i) {
+    schemata << (i > 0 ? ";" : "") << domains[i] << "=" << std::hex << mask
+      << std::dec;
+  }
+
+  std::ofstream out(path + "/schemata");
+  out << schemata.str() << std::endl;
+  if (!out)
+    throw std::runtime_error(boost::str(
+        boost::format("Error setting the cache ways of resctrl group %1%")
+        % path));
+}
+
+void set_mb_throttle(
+    const std::string& path,
+    const std::vector<unsigned>& domains,
+    unsigned bandwidth) {
+  if (bandwidth == 0 || bandwidth > 100)
+    throw std::invalid_argument("Invalid bandwidth");
+
+  std::ostringstream schemata;
+  schemata << "MB:";
+  for (size_t i = 0; i < domains.size(); ++i)
+    schemata << (i > 0 ? ";" : "") << domains[i] << "=" << bandwidth;
+
+  std::ofstream out(path + "/schemata");
+  out << schemata.str() << std::endl;
+  if (!out)
+    throw std::runtime_error(boost::str(
+        boost::format("Error setting the memory bandwidth of resctrl group "
+          "%1%") % path));
+}
+
+} // namespace util
+} // namespace aser
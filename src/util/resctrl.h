@@ -0,0 +1,104 @@
+#ifndef UTIL_RESCTRL_H_
+#define UTIL_RESCTRL_H_
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** Capabilities to allocate the last-level cache through resctrl. */
+struct l3_allocation_info {
+  /** Number of ways (bits in the capacity bitmask). */
+  unsigned ways;
+
+  /** Minimum number of ways in a bitmask. */
+  unsigned min_ways;
+
+  /** Cache domains (e.g., one per socket). */
+  std::vector<unsigned> domains;
+};
+
+/** Reads the capabilities to allocate the last-level cache.
+ *
+ * @param root Mount point of the resctrl filesystem.
+ * @throw std::runtime_error If cache allocation is not supported.
+ */
+l3_allocation_info read_l3_allocation_info(
+    const std::string& root = "/sys/fs/resctrl");
+
+/** Capabilities to throttle the memory bandwidth through resctrl. */
+struct mb_allocation_info {
+  /** Minimum bandwidth (percentage of the maximum). */
+  unsigned min_bandwidth;
+
+  /** Granularity of the bandwidth (percentage). */
+  unsigned granularity;
+
+  /** Memory bandwidth domains (e.g., one per socket). */
+  std::vector<unsigned> domains;
+};
+
+/** Reads the capabilities to throttle the memory bandwidth.
+ *
+ * @param root Mount point of the resctrl filesystem.
+ * @throw std::runtime_error If bandwidth allocation is not supported.
+ */
+mb_allocation_info read_mb_allocation_info(
+    const std::string& root = "/sys/fs/resctrl");
+
+/** Creates a resource control group.
+ *
+ * @param path The path of the group (within the resctrl filesystem).
+ */
+void create_resctrl_group(const std::string& path);
+
+/** Removes a resource control group. Its tasks go back to the default
+ * group.
+ *
+ * @param path The path of the group.
+ */
+void remove_resctrl_group(const std::string& path);
+
+/** Moves a task into a resource control group.
+ *
+ * Only the given task moves; tasks created afterwards belong to the group
+ * of their parent.
+ *
+ * @param path The path of the group.
+ * @param tid The task identifier.
+ */
+void add_to_resctrl_group(const std::string& path, pid_t tid);
+
+/** Sets the ways of the last-level cache a group can allocate in.
+ *
+ * @param path The path of the group.
+ * @param domains The cache domains.
+ * @param first First way.
+ * @param ways Number of ways (contiguous, as required by the hardware).
+ */
+void set_l3_ways(
+    const std::string& path,
+    const std::vector<unsigned>& domains,
+    unsigned first,
+    unsigned ways);
+
+/** Sets the memory bandwidth a group can use.
+ *
+ * @param path The path of the group.
+ * @param domains The memory bandwidth domains.
+ * @param bandwidth Percentage of the maximum bandwidth (the hardware rounds
+ *     it to its granularity).
+ */
+void set_mb_throttle(
+    const std::string& path,
+    const std::vector<unsigned>& domains,
+    unsigned bandwidth);
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_RESCTRL_H_
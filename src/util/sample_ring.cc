@@ -0,0 +1,111 @@
+#include "sample_ring.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace aser {
+namespace util {
+
+/** Number of values in a cache line. */
+static constexpr size_t line_values = 64 / sizeof(double);
+
+sample_ring::sample_ring(
+    unsigned columns,
+    size_t capacity,
+    double ewma_alpha)
+  : columns_{columns}
+  , capacity_{capacity}
+  , ewma_alpha_{ewma_alpha}
+  , stride_{(capacity + line_values - 1) / line_values * line_values}
+  , storage_{new double[(columns + 1) * stride_ + line_values]}
+  , ewma_{new double[std::max(columns, 1u)]()}
+{
+  if (capacity == 0)
+    throw std::invalid_argument("The capacity must be positive");
+  if (ewma_alpha <= 0 || ewma_alpha > 1)
+    throw std::invalid_argument("The EWMA weight must be in (0, 1]");
+
+  auto address = reinterpret_cast<uintptr_t>(storage_.get());
+  auto misalignment = address % 64;
+  data_ = storage_.get()
+    + (misalignment == 0 ? 0 : (64 - misalignment) / sizeof(double));
+}
+
+void sample_ring::push(double time, const double* values) {
+  for (unsigned c = 0; c < columns_; ++c) {
+    data_[c * stride_ + next_] = values[c];
+    ewma_[c] = size_ == 0
+      ? values[c]
+      : ewma_alpha_ * values[c] + (1 - ewma_alpha_) * ewma_[c];
+  }
+  data_[columns_ * stride_ + next_] = time;
+
+  next_ = advance(next_);
+  size_ = std::min(size_ + 1, capacity_);
+}
+
+window_stats sample_ring::stats(unsigned column, size_t n) const {
+  assert(column < columns_);
+  n = std::min(n, size_);
+
+  if (n == 0)
+    return {0, 0, 0, 0, 0};
+
+  window_stats result {
+    0,
+    std::numeric_limits<double>::infinity(),
+    -std::numeric_limits<double>::infinity(),
+    0,
+    0
+  };
+
+  // Welford's algorithm, which is numerically stable.
+  double m2 = 0;
+  auto values = data_ + column * stride_;
+  for (size_t i = 0, p = position(n - 1); i < n; ++i, p = advance(p)) {
+    auto v = values[p];
+    ++result.count;
+    result.min = std::min(result.min, v);
+    result.max = std::max(result.max, v);
+    auto delta = v - result.mean;
+    result.mean += delta / result.count;
+    m2 += delta * (v - result.mean);
+  }
+  result.variance = m2 / result.count;
+  return result;
+}
+
+double sample_ring::slope(unsigned column, size_t n) const {
+  assert(column < columns_);
+  n = std::min(n, size_);
+  if (n < 2)
+    return 0;
+
+  // Times are centered on the newest one to avoid losing precision.
+  auto values = data_ + column * stride_;
+  auto times = data_ + columns_ * stride_;
+  auto t0 = time(0);
+  auto first = position(n - 1);
+
+  double sum_t = 0, sum_v = 0;
+  for (size_t i = 0, p = first; i < n; ++i, p = advance(p)) {
+    sum_t += times[p] - t0;
+    sum_v += values[p];
+  }
+  auto mean_t = sum_t / n;
+  auto mean_v = sum_v / n;
+
+  double cov = 0, var = 0;
+  for (size_t i = 0, p = first; i < n; ++i, p = advance(p)) {
+    auto dt = times[p] - t0 - mean_t;
+    cov += dt * (values[p] - mean_v);
+    var += dt * dt;
+  }
+  return var > 0 ? cov / var : 0;
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,148 @@
+#ifndef UTIL_SAMPLE_RING_H_
+#define UTIL_SAMPLE_RING_H_
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+
+namespace aser {
+namespace util {
+
+/** Summary of the values of a column within a window of samples. */
+struct window_stats {
+  size_t count;
+  double min;
+  double max;
+  double mean;
+
+  /** Population variance. */
+  double variance;
+};
+
+/** Fixed-capacity history of timestamped samples.
+ *
+ * Every sample holds a value for each of a fixed number of columns (e.g.,
+ * one column per metric). Samples are stored as a structure of arrays: each
+ * column is a ring buffer of its own, starting at a cache line boundary, so
+ * that queries over a column scan contiguous memory. All the memory is
+ * allocated on construction; once full, new samples overwrite the oldest
+ * ones.
+ */
+class sample_ring {
+public:
+  /** Constructor.
+   *
+   * @param columns Number of values in every sample.
+   * @param capacity Maximum number of samples kept.
+   * @param ewma_alpha Weight of the newest sample in the exponentially
+   *     weighted moving averages (in (0, 1]).
+   */
+  sample_ring(unsigned columns, size_t capacity, double ewma_alpha = 0.1);
+
+  sample_ring(sample_ring&&) = default;
+  sample_ring& operator=(sample_ring&&) = default;
+
+  /** Appends a sample.
+   *
+   * @param time Time of the sample (seconds).
+   * @param values The value for each column.
+   */
+  void push(double time, const double* values);
+
+  void push(double time, std::initializer_list<double> values) {
+    push(time, values.begin());
+  }
+
+  /** Returns the value of a column in a sample.
+   *
+   * @param column The column.
+   * @param age Age of the sample (zero is the newest one).
+   */
+  double value(unsigned column, size_t age = 0) const {
+    return data_[column * stride_ + position(age)];
+  }
+
+  /** Returns the time of a sample.
+   *
+   * @param age Age of the sample (zero is the newest one).
+   */
+  double time(size_t age = 0) const {
+    return data_[columns_ * stride_ + position(age)];
+  }
+
+  /** Returns the exponentially weighted moving average of a column over
+   * all the samples appended so far. */
+  double ewma(unsigned column) const {
+    return ewma_[column];
+  }
+
+  /** Computes summary statistics for the newest samples of a column.
+   *
+   * @param column The column.
+   * @param n Number of samples (capped to the number of samples kept).
+   */
+  window_stats stats(unsigned column, size_t n) const;
+
+  /** Computes the slope of the least-squares line fitting the newest
+   * samples of a column over time.
+   *
+   * @param column The column.
+   * @param n Number of samples (capped to the number of samples kept).
+   * @return Change of the column value per second (zero if there are not
+   *     at least two samples at different times).
+   */
+  double slope(unsigned column, size_t n) const;
+
+  /** Returns the number of samples kept. */
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+  unsigned columns() const noexcept {
+    return columns_;
+  }
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+private:
+  unsigned columns_;
+  size_t capacity_;
+  double ewma_alpha_;
+
+  /** Distance between the start of two consecutive columns (in values). */
+  size_t stride_;
+
+  /** Storage for the columns, followed by the times. */
+  std::unique_ptr<double[]> storage_;
+
+  /** Start of the first column (aligned to a cache line). */
+  double* data_;
+
+  std::unique_ptr<double[]> ewma_;
+
+  /** Position where the next sample is stored. */
+  size_t next_ { 0 };
+
+  size_t size_ { 0 };
+
+  /** Returns the position of a sample in the columns. */
+  size_t position(size_t age) const {
+    return (next_ + capacity_ - 1 - age) % capacity_;
+  }
+
+  /** Returns the position following a given one. */
+  size_t advance(size_t p) const {
+    return p + 1 == capacity_ ? 0 : p + 1;
+  }
+};
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_SAMPLE_RING_H_
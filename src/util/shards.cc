@@ -0,0 +1,175 @@
+#include "shards.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace aser {
+namespace util {
+
+constexpr uint32_t shards::modulus;
+
+/** Mixes the bits of a value (finalizer of MurmurHash3). */
+static uint64_t mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= UINT64_C(0xff51afd7ed558ccd);
+  x ^= x >> 33;
+  x *= UINT64_C(0xc4ceb9fe1a85ec53);
+  x ^= x >> 33;
+  return x;
+}
+
+shards::shards(config cfg)
+  : config_(cfg)
+{
+  if (config_.max_lines == 0 || config_.bin_lines == 0 || config_.bins == 0)
+    throw std::invalid_argument("Invalid SHARDS configuration");
+  if (config_.rate <= 0 || config_.rate > 1)
+    throw std::invalid_argument("Sampling rate must be in (0, 1]");
+  if (config_.line_size == 0
+      || (config_.line_size & (config_.line_size - 1)) != 0)
+    throw std::invalid_argument("Line size must be a power of two");
+
+  while ((size_t(1) << line_bits_) < config_.line_size)
+    ++line_bits_;
+  threshold_ = static_cast<uint32_t>(std::ceil(config_.rate * modulus));
+
+  lines_.reserve(config_.max_lines + 1);
+  heap_.reserve(config_.max_lines + 1);
+  // Times are compacted once they reach the end of the tree.
+  tree_.assign(4 * (config_.max_lines + 1) + 1, 0);
+  histogram_.assign(config_.bins + 1, 0);
+}
+
+double shards::rate() const noexcept {
+  return static_cast<double>(threshold_) / modulus;
+}
+
+void shards::tree_add(uint32_t time, int32_t value) {
+  for (auto i = time + 1; i < tree_.size(); i += i & -i)
+    tree_[i] += value;
+}
+
+uint32_t shards::tree_prefix(uint32_t time) const {
+  int32_t sum = 0;
+  for (auto i = time; i > 0; i -= i & -i)
+    sum += tree_[i];
+  return sum;
+}
+
+void shards::compact() {
+  std::vector<std::pair<uint32_t, line_entry*>> order;
+  order.reserve(lines_.size());
+  for (auto& l : lines_)
+    order.emplace_back(l.second.time, &l.second);
+  std::sort(begin(order), end(order),
+      [](const std::pair<uint32_t, line_entry*>& a,
+        const std::pair<uint32_t, line_entry*>& b) {
+        return a.first < b.first;
+      });
+
+  std::fill(begin(tree_), end(tree_), 0);
+  now_ = 0;
+  for (auto& o : order) {
+    o.second->time = now_;
+    tree_add(now_++, 1);
+  }
+}
+
+void shards::evict() {
+  auto hotter = [](const std::pair<uint32_t, uint64_t>& a,
+      const std::pair<uint32_t, uint64_t>& b) {
+    return a.first < b.first;
+  };
+
+  auto old_rate = rate();
+  while (lines_.size() > config_.max_lines) {
+    std::pop_heap(begin(heap_), end(heap_), hotter);
+    auto victim = heap_.back();
+    heap_.pop_back();
+    threshold_ = victim.first;
+
+    auto it = lines_.find(victim.second);
+    tree_add(it->second.time, -1);
+    lines_.erase(it);
+  }
+  // Lines sharing the hash of the last victim are not sampled anymore.
+  while (!heap_.empty() && heap_.front().first >= threshold_) {
+    std::pop_heap(begin(heap_), end(heap_), hotter);
+    auto it = lines_.find(heap_.back().second);
+    tree_add(it->second.time, -1);
+    lines_.erase(it);
+    heap_.pop_back();
+  }
+
+  // Counts are kept at the scale of the current rate.
+  auto scale = rate() / old_rate;
+  for (auto& count : histogram_)
+    count *= scale;
+  cold_ *= scale;
+}
+
+void shards::access(uint64_t address) {
+  accesses_ += 1;
+
+  auto line = address >> line_bits_;
+  auto hash = static_cast<uint32_t>(mix(line) & (modulus - 1));
+  if (hash >= threshold_)
+    return;
+
+  if (now_ + 1 >= tree_.size())
+    compact();
+
+  auto it = lines_.find(line);
+  if (it == end(lines_)) {
+    cold_ += 1;
+    lines_.emplace(line, line_entry{now_, hash});
+    heap_.emplace_back(hash, line);
+    std::push_heap(begin(heap_), end(heap_),
+        [](const std::pair<uint32_t, uint64_t>& a,
+          const std::pair<uint32_t, uint64_t>& b) {
+          return a.first < b.first;
+        });
+    tree_add(now_++, 1);
+    if (lines_.size() > config_.max_lines)
+      evict();
+    return;
+  }
+
+  // Distinct lines accessed since the previous access to this one.
+  auto& entry = it->second;
+  auto distance = lines_.size() - tree_prefix(entry.time + 1);
+  auto bin = static_cast<size_t>(
+      distance / rate() / config_.bin_lines);
+  histogram_[std::min(bin, config_.bins)] += 1;
+
+  tree_add(entry.time, -1);
+  entry.time = now_;
+  tree_add(now_++, 1);
+}
+
+void shards::decay(double factor) {
+  for (auto& count : histogram_)
+    count *= factor;
+  cold_ *= factor;
+  accesses_ *= factor;
+}
+
+void shards::curve(std::vector<double>& curve) const {
+  curve.assign(config_.bins, 1);
+
+  // Accesses expected at the current rate; the difference with the
+  // samples counts as hits at the shortest distance (SHARDS-adj).
+  auto total = accesses_ * rate();
+  if (total <= 0)
+    return;
+
+  auto misses = cold_ + histogram_[config_.bins];
+  for (auto bin = config_.bins; bin-- > 0;) {
+    curve[bin] = std::min(1.0, std::max(0.0, misses / total));
+    misses += histogram_[bin];
+  }
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,134 @@
+#ifndef UTIL_SHARDS_H_
+#define UTIL_SHARDS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** Miss ratio curve estimation with spatially hashed sampling (SHARDS).
+ *
+ * Every access to a cache line is sampled if the hash of the line is
+ * below a threshold, so that either all or none of the accesses to a line
+ * are sampled. The reuse distance (number of distinct lines accessed since
+ * the previous access to the same line) of every sampled access is
+ * computed among the sampled lines and scaled by the sampling rate, and it
+ * is added to a histogram.
+ *
+ * Memory is bounded: at most max_lines lines are tracked. Once there are
+ * more, the line with the highest hash is dropped and the threshold is
+ * lowered to its hash (so the sampling rate drops, and the histogram is
+ * rescaled to the new rate). The difference between the expected and the
+ * actual number of samples is added to the first bin of the histogram, as
+ * in SHARDS-adj.
+ *
+ * Counts decay when decay() is called, so that the curve follows the
+ * phases of the program.
+ */
+class shards {
+public:
+  struct config {
+    /** Maximum number of lines tracked. */
+    size_t max_lines;
+
+    /** Initial sampling rate (in (0, 1]). */
+    double rate;
+
+    /** Size of a cache line (a power of two). */
+    size_t line_size;
+
+    /** Number of lines in every bin of the histogram. */
+    size_t bin_lines;
+
+    /** Number of bins of the histogram. */
+    size_t bins;
+  };
+
+  explicit shards(config cfg);
+
+  /** Adds an access to an address. */
+  void access(uint64_t address);
+
+  /** Multiplies every count by a factor (in [0, 1]). */
+  void decay(double factor);
+
+  /** Computes the miss ratio curve.
+   *
+   * @param curve Vector where the miss ratio of an LRU cache of (i + 1)
+   *     bins (see bin_size()) is stored for every bin i (all ones if there
+   *     are no accesses).
+   */
+  void curve(std::vector<double>& curve) const;
+
+  /** Returns the size of a bin (bytes). */
+  size_t bin_size() const noexcept {
+    return config_.bin_lines * config_.line_size;
+  }
+
+  /** Returns the current sampling rate. */
+  double rate() const noexcept;
+
+  /** Returns the number of lines tracked. */
+  size_t size() const noexcept {
+    return lines_.size();
+  }
+
+private:
+  /** Modulus of the hashes. */
+  static constexpr uint32_t modulus = 1 << 24;
+
+  struct line_entry {
+    /** Time of the latest access. */
+    uint32_t time;
+    uint32_t hash;
+  };
+
+  config config_;
+  unsigned line_bits_ { 0 };
+
+  /** Lines whose hash is below the threshold are sampled. */
+  uint32_t threshold_;
+
+  /** Tracked lines. */
+  std::unordered_map<uint64_t, line_entry> lines_;
+
+  /** Max-heap of the hashes of the tracked lines (with the line). */
+  std::vector<std::pair<uint32_t, uint64_t>> heap_;
+
+  /** Fenwick tree with a one for the time of the latest access to every
+   * tracked line. */
+  std::vector<int32_t> tree_;
+
+  /** Next time. */
+  uint32_t now_ { 0 };
+
+  /** Histogram of the scaled reuse distances (the last bin holds the
+   * distances beyond the histogram). */
+  std::vector<double> histogram_;
+
+  /** Accesses to lines not tracked before (cold misses). */
+  double cold_ { 0 };
+
+  /** Accesses, sampled or not. */
+  double accesses_ { 0 };
+
+  /** Adds a value to the count of a time. */
+  void tree_add(uint32_t time, int32_t value);
+
+  /** Returns the number of tracked lines accessed before a time. */
+  uint32_t tree_prefix(uint32_t time) const;
+
+  /** Renumbers the times of the tracked lines from zero. */
+  void compact();
+
+  /** Drops the lines with the highest hash until within budget. */
+  void evict();
+};
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_SHARDS_H_
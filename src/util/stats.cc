@@ -0,0 +1,32 @@
+#include "stats.h"
+
+#include <algorithm>
+
+namespace aser {
+namespace util {
+
+summary summarize(std::vector<double> values) {
+  if (values.empty())
+    return {0, 0, 0, 0, 0};
+
+  std::sort(begin(values), end(values));
+  auto percentile = [&](double p) {
+    auto idx = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[idx];
+  };
+
+  double sum = 0;
+  for (auto v : values)
+    sum += v;
+
+  return {
+    sum / values.size(),
+    percentile(0.5),
+    percentile(0.95),
+    percentile(0.99),
+    values.back()
+  };
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,28 @@
+#ifndef UTIL_STATS_H_
+#define UTIL_STATS_H_
+
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** Summary statistics for a set of values. */
+struct summary {
+  double mean;
+  double p50;
+  double p95;
+  double p99;
+  double max;
+};
+
+/** Computes summary statistics.
+ *
+ * @param values The values (all zeros are returned if empty).
+ * @return The summary statistics.
+ */
+summary summarize(std::vector<double> values);
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_STATS_H_
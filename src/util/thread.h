@@ -36,6 +36,45 @@ private:
   std::mutex mutex_;
 };
 
+/** Reusable thread barrier.
+ *
+ * A fixed number of threads meet at the barrier: each of them blocks until
+ * all the others arrive, and then the barrier resets for the next round.
+ */
+class barrier {
+public:
+  /** Constructor.
+   *
+   * @param count Number of threads that meet at the barrier.
+   */
+  explicit barrier(unsigned count)
+    : count_{count}
+  {}
+
+  /** Blocks until all the threads arrive at the barrier. */
+  void arrive_and_wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto generation = generation_;
+    if (++arrived_ == count_) {
+      arrived_ = 0;
+      ++generation_;
+      cv_.notify_all();
+      return;
+    }
+    cv_.wait(lock, [&] { return generation_ != generation; });
+  }
+
+private:
+  unsigned count_;
+  unsigned arrived_ { 0 };
+
+  /** Incremented every time all the threads arrive. */
+  unsigned long generation_ { 0 };
+
+  std::condition_variable cv_;
+  std::mutex mutex_;
+};
+
 /** Checks whether a future is ready without blocking.
  *
  * @param f The future.
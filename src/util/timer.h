@@ -3,9 +3,8 @@
 
 #include <functional>
 #include <chrono>
-#include <condition_variable>
-#include <mutex>
-#include <thread>
+
+#include <util/timer_wheel.h>
 
 namespace aser {
 namespace util {
@@ -15,8 +14,8 @@ namespace util {
  * If the timer object is destroyed, the timer is canceled and the callback
  * function will not be called.
  *
- * The timer uses a thread that blocks until either the timer expires or is
- * canceled.
+ * The timer runs on the process-wide timer service (see timer_service), and
+ * the callback is called from the service thread.
  */
 class callback_timer {
 public:
@@ -31,26 +30,21 @@ public:
       std::chrono::milliseconds duration,
       callback_func callback);
 
-  /** Destructor. */
+  /** Destructor.
+   *
+   * If the callback is running, the destructor waits until it finishes.
+   */
   ~callback_timer();
 
 private:
-  /** Timer duration. */
-  std::chrono::milliseconds duration_;
+  /** Timer identifier in the timer service. */
+  timer_id id_;
 
-  /** Callback function to call. */
-  callback_func callback_;
-
-  bool canceled_ { false };
-  std::mutex mutex_;
-  std::condition_variable cond_;
-  std::thread thread_;
-
-  void run();
+  callback_timer(const callback_timer&) = delete;
+  callback_timer& operator=(const callback_timer&) = delete;
 };
 
 } // namespace util
 } // namespace aser
 
 #endif // UTIL_TIMER_H_
-
@@ -0,0 +1,55 @@
+#include "timer_service.h"
+
+namespace aser {
+namespace util {
+
+timer_service& timer_service::instance() {
+  static timer_service service;
+  return service;
+}
+
+uint64_t timer_service::now() const {
+  return (clock::now() - start_) / resolution_;
+}
+
+timer_id timer_service::schedule(
+    std::chrono::nanoseconds delay,
+    callback_func callback,
+    const void* owner) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Round up, so that timers never expire early.
+  auto elapsed = clock::now() - start_ + delay;
+  auto ticks = (elapsed + resolution_ - std::chrono::nanoseconds(1))
+    / resolution_;
+  auto id = wheel_.add(ticks, std::move(callback), owner);
+  arm(false);
+  return id;
+}
+
+bool timer_service::cancel(timer_id id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (wheel_.cancel(id))
+    return true;
+  wait_for_dispatch(lock);
+  return false;
+}
+
+void timer_service::cancel_all(const void* owner) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  wheel_.cancel_all(owner);
+  wait_for_dispatch(lock);
+}
+
+size_t timer_service::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return wheel_.size();
+}
+
+void timer_service::wait_for_dispatch(std::unique_lock<std::mutex>& lock) {
+  if (std::this_thread::get_id() == thread_.get_id())
+    return;
+  dispatched_.wait(lock, [&] { return !dispatching_; });
+}
+
+} // namespace util
+} // namespace aser
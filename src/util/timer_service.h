@@ -0,0 +1,148 @@
+#ifndef UTIL_TIMER_SERVICE_H_
+#define UTIL_TIMER_SERVICE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <util/timer_wheel.h>
+
+namespace aser {
+namespace util {
+
+/** Timer service.
+ *
+ * This class runs every timer on a single thread, which sleeps until the
+ * next timer in a hierarchical timing wheel (see timer_wheel) expires: on
+ * a timer file descriptor on Linux, and on a condition variable elsewhere. Timers can be scheduled and canceled from any
+ * thread in constant time. Timer expiration is rounded up to the service
+ * resolution.
+ *
+ * By default callbacks run on the service thread, so they should be short.
+ * A dispatcher can be given to run them elsewhere instead (e.g., on an
+ * event loop or on a pool of worker threads).
+ */
+class timer_service {
+public:
+  typedef timer_wheel::callback_func callback_func;
+  typedef std::function<void(callback_func)> dispatcher_func;
+
+  /** Constructor.
+   *
+   * @param resolution Length of a tick of the timing wheel.
+   * @param dispatcher Function that runs the callbacks of expired timers.
+   *     If empty, callbacks run on the service thread.
+   */
+  explicit timer_service(
+      std::chrono::nanoseconds resolution = std::chrono::milliseconds(1),
+      dispatcher_func dispatcher = nullptr);
+
+  /** Destructor.
+   *
+   * Pending timers are canceled.
+   */
+  ~timer_service();
+
+  /** Schedules a timer.
+   *
+   * @param delay Time until the timer expires.
+   * @param callback Function to call once the timer expires.
+   * @param owner Opaque owner of the timer (see cancel_all()).
+   * @return The timer identifier.
+   */
+  timer_id schedule(
+      std::chrono::nanoseconds delay,
+      callback_func callback,
+      const void* owner = nullptr);
+
+  /** Cancels a timer.
+   *
+   * If the callback is running on the service thread, this method waits
+   * until it finishes (unless it is called from the callback itself).
+   *
+   * @param id The timer identifier.
+   * @return True if the timer was canceled before expiring; false otherwise.
+   */
+  bool cancel(timer_id id);
+
+  /** Cancels all the timers with a given owner.
+   *
+   * As cancel(), this method waits for callbacks running on the service
+   * thread.
+   *
+   * @param owner The owner.
+   */
+  void cancel_all(const void* owner);
+
+  /** Returns the number of pending timers. */
+  size_t size() const;
+
+  /** Returns the process-wide timer service. */
+  static timer_service& instance();
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  std::chrono::nanoseconds resolution_;
+  dispatcher_func dispatcher_;
+
+  /** Time at which the first tick started. */
+  clock::time_point start_;
+
+  timer_wheel wheel_;
+
+  /** Tick at which the timer file descriptor expires next. */
+  uint64_t armed_ { timer_wheel::never };
+
+  /** Whether the service thread is running callbacks. */
+  bool dispatching_ { false };
+
+  /** Mutex protecting the wheel and the dispatch state. */
+  mutable std::mutex mutex_;
+
+  /** Condition signaled once the service thread finishes a dispatch. */
+  std::condition_variable dispatched_;
+
+#ifdef __linux__
+  int timer_fd_ { -1 };
+
+  /** File descriptor used to wake up the service thread when stopping. */
+  int stop_fd_ { -1 };
+#else
+  /** Condition signaled when the next expiry moves earlier or the service
+   * is stopping. */
+  std::condition_variable wakeup_;
+
+  bool stopping_ { false };
+#endif
+
+  std::thread thread_;
+
+  void run();
+
+  /** Returns the current tick. */
+  uint64_t now() const;
+
+  /** Programs the service thread to wake up at the next tick the wheel
+   * needs to process (if it is earlier than the current one).
+   *
+   * Must be called with the mutex held.
+   */
+  void arm(bool force);
+
+  /** Waits until the service thread is not running callbacks, unless it
+   * is the caller.
+   */
+  void wait_for_dispatch(std::unique_lock<std::mutex>& lock);
+
+  timer_service(const timer_service&) = delete;
+  timer_service& operator=(const timer_service&) = delete;
+};
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_TIMER_SERVICE_H_
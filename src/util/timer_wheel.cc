@@ -0,0 +1,197 @@
+#include "timer_wheel.h"
+
+#include <cassert>
+
+namespace aser {
+namespace util {
+
+constexpr uint64_t timer_wheel::never;
+constexpr uint32_t timer_wheel::nil;
+
+timer_wheel::timer_wheel(uint64_t now)
+  : current_{now}
+{
+  heads_.fill(nil);
+}
+
+timer_id timer_wheel::add(
+    uint64_t expires,
+    callback_func callback,
+    const void* owner) {
+  uint32_t n;
+  if (free_ != nil) {
+    n = free_;
+    free_ = pool_[n].next;
+  } else {
+    assert(pool_.size() < nil);
+    n = pool_.size();
+    pool_.push_back({0, nullptr, nullptr, 0, nil, nil, nil});
+  }
+
+  auto& timer = pool_[n];
+  timer.expires = expires;
+  timer.callback = std::move(callback);
+  timer.owner = owner;
+  ++timer.generation;
+  insert(n);
+  ++size_;
+
+  return (static_cast<uint64_t>(timer.generation) << 32) | n;
+}
+
+bool timer_wheel::cancel(timer_id id) {
+  auto n = find(id);
+  if (n == nil)
+    return false;
+
+  unlink(n);
+  release(n);
+  --size_;
+  return true;
+}
+
+size_t timer_wheel::cancel_all(const void* owner) {
+  size_t count = 0;
+  for (uint32_t n = 0; n < pool_.size(); ++n) {
+    if (pool_[n].slot == nil || pool_[n].owner != owner)
+      continue;
+    unlink(n);
+    release(n);
+    ++count;
+  }
+  size_ -= count;
+  return count;
+}
+
+bool timer_wheel::pending(timer_id id) const {
+  return find(id) != nil;
+}
+
+uint32_t timer_wheel::find(timer_id id) const {
+  auto n = static_cast<uint32_t>(id);
+  auto generation = static_cast<uint32_t>(id >> 32);
+  if (n >= pool_.size()
+      || pool_[n].slot == nil
+      || pool_[n].generation != generation)
+    return nil;
+  return n;
+}
+
+void timer_wheel::insert(uint32_t n) {
+  auto& timer = pool_[n];
+
+  // Timers beyond the range of the wheel are placed in the last slot that
+  // can hold them, and they are cascaded back to that level until they get
+  // within range.
+  constexpr uint64_t range = (uint64_t(1) << (levels * slot_bits)) - 1;
+  auto expires = timer.expires;
+  if (expires > current_ && expires - current_ > range)
+    expires = current_ + range;
+
+  unsigned slot;
+  if (expires < current_) {
+    slot = current_ & slot_mask;
+  } else {
+    auto delta = expires - current_;
+    unsigned level = 0;
+    while (level < levels - 1
+        && delta >= (uint64_t(1) << (slot_bits * (level + 1))))
+      ++level;
+    slot = level * slots + ((expires >> (slot_bits * level)) & slot_mask);
+  }
+
+  timer.slot = slot;
+  timer.prev = nil;
+  timer.next = heads_[slot];
+  if (timer.next != nil)
+    pool_[timer.next].prev = n;
+  heads_[slot] = n;
+
+  if (slot < slots)
+    occupied_.set(slot);
+}
+
+void timer_wheel::unlink(uint32_t n) {
+  auto& timer = pool_[n];
+  if (timer.prev != nil)
+    pool_[timer.prev].next = timer.next;
+  else
+    heads_[timer.slot] = timer.next;
+  if (timer.next != nil)
+    pool_[timer.next].prev = timer.prev;
+
+  if (timer.slot < slots && heads_[timer.slot] == nil)
+    occupied_.reset(timer.slot);
+}
+
+void timer_wheel::release(uint32_t n) {
+  auto& timer = pool_[n];
+  timer.callback = nullptr;
+  timer.slot = nil;
+  timer.prev = nil;
+  timer.next = free_;
+  free_ = n;
+}
+
+unsigned timer_wheel::cascade(unsigned level, unsigned index) {
+  auto slot = level * slots + index;
+  auto n = heads_[slot];
+  heads_[slot] = nil;
+  while (n != nil) {
+    auto next = pool_[n].next;
+    insert(n);
+    n = next;
+  }
+  return index;
+}
+
+void timer_wheel::advance(
+    uint64_t now,
+    std::vector<callback_func>& expired) {
+  if (size_ == 0) {
+    if (now >= current_)
+      current_ = now + 1;
+    return;
+  }
+
+  while (current_ <= now) {
+    auto index = static_cast<unsigned>(current_ & slot_mask);
+    if (index == 0) {
+      for (unsigned level = 1; level < levels; ++level) {
+        auto i = (current_ >> (slot_bits * level)) & slot_mask;
+        if (cascade(level, i) != 0)
+          break;
+      }
+    }
+
+    // Timers in the slot expire at this tick, as cascading (and adding
+    // expired timers) happens relative to it.
+    auto n = heads_[index];
+    heads_[index] = nil;
+    occupied_.reset(index);
+    while (n != nil) {
+      auto next = pool_[n].next;
+      expired.push_back(std::move(pool_[n].callback));
+      release(n);
+      --size_;
+      n = next;
+    }
+
+    ++current_;
+  }
+}
+
+uint64_t timer_wheel::next_expiry() const {
+  if (size_ == 0)
+    return never;
+
+  auto index = static_cast<unsigned>(current_ & slot_mask);
+  for (auto i = index; i < slots; ++i) {
+    if (occupied_.test(i))
+      return current_ + (i - index);
+  }
+  return current_ + (slots - index);
+}
+
+} // namespace util
+} // namespace aser
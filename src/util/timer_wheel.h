@@ -0,0 +1,162 @@
+#ifndef UTIL_TIMER_WHEEL_H_
+#define UTIL_TIMER_WHEEL_H_
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** Identifier of a timer. Identifiers are never reused. */
+typedef uint64_t timer_id;
+
+/** Hierarchical timing wheel.
+ *
+ * Timers expire at a given tick. The wheel has four levels of 256 slots
+ * each: the first level holds the timers expiring in the next 256 ticks,
+ * and every other level covers 256 times the range of the previous one.
+ * When the first level wraps around, the timers in the next slot of the
+ * second level are moved down (cascaded), and so on. Adding and canceling a
+ * timer takes constant time, and timers are stored in a pool so that no
+ * allocation takes place once the pool has grown large enough.
+ *
+ * The wheel does not measure time: the owner advances it explicitly.
+ */
+class timer_wheel {
+public:
+  typedef std::function<void()> callback_func;
+
+  /** Value returned by next_expiry() when there are no timers. */
+  static constexpr uint64_t never = std::numeric_limits<uint64_t>::max();
+
+  /** Constructor.
+   *
+   * @param now The current tick.
+   */
+  explicit timer_wheel(uint64_t now = 0);
+
+  /** Adds a timer.
+   *
+   * @param expires Tick at which the timer expires. Timers that should have
+   *     expired already expire on the next call to advance().
+   * @param callback Function to call once the timer expires.
+   * @param owner Opaque owner of the timer (see cancel_all()).
+   * @return The timer identifier.
+   */
+  timer_id add(uint64_t expires, callback_func callback,
+      const void* owner = nullptr);
+
+  /** Cancels a timer.
+   *
+   * @param id The timer identifier.
+   * @return True if the timer was pending; false otherwise.
+   */
+  bool cancel(timer_id id);
+
+  /** Cancels all the timers with a given owner.
+   *
+   * This method takes time proportional to the size of the pool.
+   *
+   * @param owner The owner.
+   * @return The number of timers canceled.
+   */
+  size_t cancel_all(const void* owner);
+
+  /** Checks whether a timer is pending. */
+  bool pending(timer_id id) const;
+
+  /** Advances the wheel, collecting the callbacks of the expired timers.
+   *
+   * @param now The current tick.
+   * @param expired Vector where the callbacks are appended (in order of
+   *     expiration).
+   */
+  void advance(uint64_t now, std::vector<callback_func>& expired);
+
+  /** Returns the tick at which advance() should be called next: either the
+   * expiration of the next timer in the first level or the next cascade,
+   * whichever comes first. Returns never if there are no timers.
+   */
+  uint64_t next_expiry() const;
+
+  /** Returns the next tick to be processed. */
+  uint64_t current() const noexcept {
+    return current_;
+  }
+
+  /** Returns the number of pending timers. */
+  size_t size() const noexcept {
+    return size_;
+  }
+
+private:
+  static constexpr unsigned levels = 4;
+  static constexpr unsigned slot_bits = 8;
+  static constexpr unsigned slots = 1 << slot_bits;
+  static constexpr uint64_t slot_mask = slots - 1;
+
+  /** Marks the end of a list. */
+  static constexpr uint32_t nil = std::numeric_limits<uint32_t>::max();
+
+  /** A timer in the pool. */
+  struct node {
+    uint64_t expires;
+    callback_func callback;
+    const void* owner;
+
+    /** Incremented every time the node is reused. */
+    uint32_t generation;
+
+    /** Slot containing the node (nil if the node is free). */
+    uint32_t slot;
+
+    uint32_t prev;
+    uint32_t next;
+  };
+
+  /** Next tick to process. */
+  uint64_t current_;
+
+  size_t size_ { 0 };
+
+  std::vector<node> pool_;
+
+  /** Head of the list of free nodes. */
+  uint32_t free_ { nil };
+
+  /** Head of the list for every slot (level * slots + index). */
+  std::array<uint32_t, levels * slots> heads_;
+
+  /** Whether each slot in the first level holds any timer. */
+  std::bitset<slots> occupied_;
+
+  /** Places a node in the slot matching its expiration. */
+  void insert(uint32_t n);
+
+  /** Removes a node from its slot. */
+  void unlink(uint32_t n);
+
+  /** Returns a node to the pool. */
+  void release(uint32_t n);
+
+  /** Moves the timers in a slot to the lower levels.
+   *
+   * @param level The level.
+   * @param index The index of the slot in the level.
+   * @return The index of the slot.
+   */
+  unsigned cascade(unsigned level, unsigned index);
+
+  /** Returns the node for a timer identifier, or nil if the timer is not
+   * pending. */
+  uint32_t find(timer_id id) const;
+};
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_TIMER_WHEEL_H_
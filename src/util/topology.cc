@@ -0,0 +1,177 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include <util/numa.h>
+
+namespace fs = boost::filesystem;
+
+namespace aser {
+namespace util {
+
+topology::topology(std::vector<cpu_info> cpus)
+  : cpus_{std::move(cpus)}
+{
+  if (cpus_.empty())
+    throw std::invalid_argument("Topology without CPUs");
+
+  std::sort(begin(cpus_), end(cpus_),
+      [](const cpu_info& a, const cpu_info& b) { return a.cpu < b.cpu; });
+
+  // Identifiers are renumbered in order of their first CPU.
+  std::map<unsigned, unsigned> cores, llcs, nodes;
+  std::map<unsigned, unsigned> threads;
+  auto renumber = [](std::map<unsigned, unsigned>& ids, unsigned id) {
+    return ids.emplace(id, ids.size()).first->second;
+  };
+  for (auto& info : cpus_) {
+    info.thread = threads[info.core]++;
+    info.core = renumber(cores, info.core);
+    info.llc = renumber(llcs, info.llc);
+    info.node = renumber(nodes, info.node);
+  }
+  num_cores_ = cores.size();
+  num_llcs_ = llcs.size();
+  num_nodes_ = nodes.size();
+
+  index_.assign(cpus_.back().cpu + 1, -1);
+  for (size_t i = 0; i < cpus_.size(); ++i) {
+    if (i > 0 && cpus_[i].cpu == cpus_[i - 1].cpu)
+      throw std::invalid_argument("Duplicate CPU in topology");
+    index_[cpus_[i].cpu] = i;
+  }
+}
+
+const cpu_info& topology::find(unsigned cpu) const {
+  if (!contains(cpu))
+    throw std::out_of_range("CPU not in topology: " + std::to_string(cpu));
+  return cpus_[index_[cpu]];
+}
+
+bool topology::contains(unsigned cpu) const noexcept {
+  return cpu < index_.size() && index_[cpu] >= 0;
+}
+
+std::vector<unsigned> topology::core_cpus(unsigned core) const {
+  std::vector<unsigned> result;
+  for (auto& info : cpus_) {
+    if (info.core == core)
+      result.push_back(info.cpu);
+  }
+  return result;
+}
+
+std::vector<unsigned> topology::llc_cpus(unsigned llc) const {
+  std::vector<unsigned> result;
+  for (auto& info : cpus_) {
+    if (info.llc == llc)
+      result.push_back(info.cpu);
+  }
+  return result;
+}
+
+std::vector<unsigned> topology::node_cpus(unsigned node) const {
+  std::vector<unsigned> result;
+  for (auto& info : cpus_) {
+    if (info.node == node)
+      result.push_back(info.cpu);
+  }
+  return result;
+}
+
+/** Reads the first line in a file (empty if the file does not exist). */
+static std::string read_line(const fs::path& path) {
+  std::ifstream in(path.string());
+  std::string line;
+  std::getline(in, line);
+  return line;
+}
+
+/** Returns the first CPU in a CPU list file, or a default value if the
+ * file does not exist or is empty. */
+static unsigned first_cpu(const fs::path& path, unsigned default_cpu) {
+  auto cpus = parse_cpu_list(read_line(path));
+  return cpus.empty()
+    ? default_cpu
+    : *std::min_element(begin(cpus), end(cpus));
+}
+
+/** Returns the first CPU sharing the last-level cache with a CPU, or a
+ * default value if there is no cache information. */
+static unsigned llc_id(const fs::path& cpu_path, unsigned default_cpu) {
+  int best_level = -1;
+  auto id = default_cpu;
+  boost::system::error_code ec;
+  for (fs::directory_iterator it(cpu_path / "cache", ec), last;
+      !ec && it != last; it.increment(ec)) {
+    if (it->path().filename().string().compare(0, 5, "index") != 0)
+      continue;
+    if (read_line(it->path() / "type") == "Instruction")
+      continue;
+    auto level = read_line(it->path() / "level");
+    if (level.empty() || std::stoi(level) <= best_level)
+      continue;
+    best_level = std::stoi(level);
+    id = first_cpu(it->path() / "shared_cpu_list", default_cpu);
+  }
+  return id;
+}
+
+size_t llc_size(const std::string& sysfs_root, unsigned cpu) {
+  auto cpu_path = fs::path(sysfs_root) / "devices" / "system" / "cpu"
+    / ("cpu" + std::to_string(cpu));
+
+  int best_level = -1;
+  size_t size = 0;
+  boost::system::error_code ec;
+  for (fs::directory_iterator it(cpu_path / "cache", ec), last;
+      !ec && it != last; it.increment(ec)) {
+    if (it->path().filename().string().compare(0, 5, "index") != 0)
+      continue;
+    if (read_line(it->path() / "type") == "Instruction")
+      continue;
+    auto level = read_line(it->path() / "level");
+    if (level.empty() || std::stoi(level) <= best_level)
+      continue;
+    best_level = std::stoi(level);
+
+    // Sizes have a unit suffix (e.g., "32768K").
+    auto text = read_line(it->path() / "size");
+    size_t end = 0;
+    size = text.empty() ? 0 : std::stoul(text, &end);
+    if (end < text.size() && text[end] == 'K')
+      size *= 1024;
+    else if (end < text.size() && text[end] == 'M')
+      size *= 1024 * 1024;
+  }
+  return size;
+}
+
+topology topology::read(const std::string& sysfs_root) {
+  auto cpu_root = fs::path(sysfs_root) / "devices" / "system" / "cpu";
+  auto online = parse_cpu_list(read_line(cpu_root / "online"));
+
+  std::vector<cpu_info> cpus;
+  auto nodes = numa_nodes(sysfs_root);
+  for (unsigned node = 0; node < nodes.size(); ++node) {
+    for (auto cpu : nodes[node]) {
+      if (!online.empty()
+          && std::find(begin(online), end(online), cpu) == end(online))
+        continue;
+
+      auto path = cpu_root / ("cpu" + std::to_string(cpu));
+      auto core = first_cpu(path / "topology" / "thread_siblings_list", cpu);
+      cpus.push_back({cpu, 0, core, llc_id(path, core), node});
+    }
+  }
+
+  return topology{std::move(cpus)};
+}
+
+} // namespace util
+} // namespace aser
@@ -0,0 +1,111 @@
+#ifndef UTIL_TOPOLOGY_H_
+#define UTIL_TOPOLOGY_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace aser {
+namespace util {
+
+/** A logical CPU and its place in the topology. */
+struct cpu_info {
+  /** CPU number. */
+  unsigned cpu;
+
+  /** Position of the CPU among the SMT siblings in its core. */
+  unsigned thread;
+
+  /** Core, last-level cache domain and NUMA node containing the CPU. */
+  unsigned core;
+  unsigned llc;
+  unsigned node;
+};
+
+/** CPU topology of the system.
+ *
+ * The topology is a tree: NUMA nodes contain last-level cache domains,
+ * which contain cores, which contain logical CPUs (SMT siblings). Nodes,
+ * cache domains and cores are numbered consecutively from zero, in order
+ * of their first CPU. Only the CPUs that are online are part of the
+ * topology.
+ */
+class topology {
+public:
+  /** Constructor.
+   *
+   * @param cpus The CPUs. The core, cache domain and node of every CPU can
+   *     be any identifier (e.g., the first CPU in the core), and they are
+   *     renumbered. The thread field is ignored and computed again.
+   */
+  explicit topology(std::vector<cpu_info> cpus);
+
+  /** Reads the topology from sysfs.
+   *
+   * Missing information is filled in conservatively: CPUs without sibling
+   * information are considered to be on their own core, and cores without
+   * cache information on their own cache domain.
+   *
+   * @param sysfs_root Mount point of sysfs.
+   */
+  static topology read(const std::string& sysfs_root = "/sys");
+
+  /** Returns the CPUs (sorted by CPU number). */
+  const std::vector<cpu_info>& cpus() const noexcept {
+    return cpus_;
+  }
+
+  /** Returns the information for a CPU.
+   *
+   * @param cpu The CPU number.
+   * @throw std::out_of_range If the CPU is not part of the topology.
+   */
+  const cpu_info& find(unsigned cpu) const;
+
+  /** Checks whether a CPU is part of the topology. */
+  bool contains(unsigned cpu) const noexcept;
+
+  unsigned num_cores() const noexcept {
+    return num_cores_;
+  }
+
+  unsigned num_llcs() const noexcept {
+    return num_llcs_;
+  }
+
+  unsigned num_nodes() const noexcept {
+    return num_nodes_;
+  }
+
+  /** Returns the CPUs in a core (SMT siblings). */
+  std::vector<unsigned> core_cpus(unsigned core) const;
+
+  /** Returns the CPUs sharing a last-level cache domain. */
+  std::vector<unsigned> llc_cpus(unsigned llc) const;
+
+  /** Returns the CPUs in a NUMA node. */
+  std::vector<unsigned> node_cpus(unsigned node) const;
+
+private:
+  std::vector<cpu_info> cpus_;
+
+  /** Position of every CPU number in cpus_ (-1 if absent). */
+  std::vector<int> index_;
+
+  unsigned num_cores_ { 0 };
+  unsigned num_llcs_ { 0 };
+  unsigned num_nodes_ { 0 };
+};
+
+/** Returns the size of the last-level cache of a CPU.
+ *
+ * @param sysfs_root Mount point of sysfs.
+ * @param cpu The CPU.
+ * @return The size (bytes), or zero if there is no cache information.
+ */
+size_t llc_size(const std::string& sysfs_root = "/sys", unsigned cpu = 0);
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_TOPOLOGY_H_
@@ -0,0 +1,56 @@
+#include "value_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+
+namespace aser {
+namespace util {
+
+value_file::value_file(std::string path)
+  : path_{std::move(path)}
+{
+  open();
+}
+
+value_file::~value_file() {
+  if (fd_ != -1)
+    ::close(fd_);
+}
+
+void value_file::open() {
+  if (fd_ != -1) {
+    // A file replaced by another one has no links left.
+    struct stat st;
+    if (::fstat(fd_, &st) == 0 && st.st_nlink > 0)
+      return;
+    ::close(fd_);
+  }
+  fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+bool value_file::read(double& value) {
+  open();
+  if (fd_ == -1)
+    return false;
+
+  auto n = ::pread(fd_, buffer_, sizeof(buffer_) - 1, 0);
+  if (n <= 0)
+    return false;
+  buffer_[n] = '\0';
+
+  // Empty or partially written files do not hold a number.
+  char* end;
+  errno = 0;
+  auto v = std::strtod(buffer_, &end);
+  if (end == buffer_ || errno != 0)
+    return false;
+  value = v;
+  return true;
+}
+
+} // namespace util
+} // namespace aser
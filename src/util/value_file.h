@@ -0,0 +1,52 @@
+#ifndef UTIL_VALUE_FILE_H_
+#define UTIL_VALUE_FILE_H_
+
+#include <string>
+
+namespace aser {
+namespace util {
+
+/** File holding a number that another process updates (e.g., a heartbeat
+ * counter or the latest latency of a service).
+ *
+ * The file is kept open, so that reading it takes two system calls (one
+ * to check whether it was replaced, and one to read it). The writer can
+ * either overwrite the file or replace it (e.g., by renaming a new file
+ * over it), in which case it is opened again.
+ */
+class value_file {
+public:
+  /** Constructor.
+   *
+   * The file does not need to exist yet.
+   *
+   * @param path The path of the file.
+   */
+  explicit value_file(std::string path);
+
+  ~value_file();
+
+  /** Reads the value in the file.
+   *
+   * @param value Where to store the value.
+   * @return True if the file holds a number; false otherwise.
+   */
+  bool read(double& value);
+
+private:
+  std::string path_;
+  int fd_ { -1 };
+
+  char buffer_[64];
+
+  /** Opens the file if it is not open, or if it was replaced. */
+  void open();
+
+  value_file(const value_file&) = delete;
+  value_file& operator=(const value_file&) = delete;
+};
+
+} // namespace util
+} // namespace aser
+
+#endif // UTIL_VALUE_FILE_H_